@@ -33,8 +33,7 @@
 
 #pragma mark - associated objects names
 static const char * kMapperObjectKey;
-static const char * kClassPropertiesKey;
-static const char * kClassRequiredPropertyNamesKey;
+static const char * kClassPropertyListKey;
 static const char * kIndexPropertyNameKey;
 
 #pragma mark - class static variables
@@ -42,6 +41,8 @@ static NSArray* allowedJSONTypes = nil;
 static NSArray* allowedPrimitiveTypes = nil;
 static OPTLYJSONValueTransformer* valueTransformer = nil;
 static Class OPTLYJSONModelClass = NULL;
+static NSRecursiveLock* classSetupLock = nil;
+static BOOL compiledMappingEnabled = YES;
 
 #pragma mark - model cache
 static OPTLYJSONKeyMapper* globalKeyMapper = nil;
@@ -77,6 +78,9 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
 
             valueTransformer = [[OPTLYJSONValueTransformer alloc] init];
 
+            // guards the one-time inspection of each model class
+            classSetupLock = [[NSRecursiveLock alloc] init];
+
             // This is quite strange, but I found the test isSubclassOfClass: (line ~291) to fail if using [OPTLYJSONModel class].
             // somewhat related: https://stackoverflow.com/questions/6524165/nsclassfromstring-vs-classnamednsstring
             // //; seems to break the unit tests
@@ -90,21 +94,39 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
 
 -(void)__setup__
 {
-    //if first instance of this model, generate the property list
-    if (!objc_getAssociatedObject(self.class, &kClassPropertiesKey)) {
-        [self __inspectProperties];
-    }
+    //the property list is stored last, so once it is there the class is fully set up
+    if (objc_getAssociatedObject(self.class, &kClassPropertyListKey)) return;
+
+    //first instance of this model, inspect the class exactly once
+    [classSetupLock lock];
+    @try {
+        if (!objc_getAssociatedObject(self.class, &kClassPropertyListKey)) {
+
+            //if there's a custom key mapper, store it in the associated object
+            //(it's needed to compile the JSON key paths of the properties)
+            id mapper = [[self class] keyMapper];
+            if (mapper) {
+                objc_setAssociatedObject(
+                                         self.class,
+                                         &kMapperObjectKey,
+                                         mapper,
+                                         OBJC_ASSOCIATION_RETAIN // This is atomic
+                                         );
+            }
 
-    //if there's a custom key mapper, store it in the associated object
-    id mapper = [[self class] keyMapper];
-    if ( mapper && !objc_getAssociatedObject(self.class, &kMapperObjectKey) ) {
-        objc_setAssociatedObject(
-                                 self.class,
-                                 &kMapperObjectKey,
-                                 mapper,
-                                 OBJC_ASSOCIATION_RETAIN // This is atomic
-                                 );
+            //generate the property list
+            [self __inspectProperties];
+        }
     }
+    @finally {
+        [classSetupLock unlock];
+    }
+}
+
+//benchmarking hook: when disabled, models are mapped through KVC and string-built selectors
++(void)__setCompiledMappingEnabled:(BOOL)enabled
+{
+    compiledMappingEnabled = enabled;
 }
 
 -(id)init
@@ -215,59 +237,65 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
 -(BOOL)__doesDictionary:(NSDictionary*)dict matchModelWithKeyMapper:(OPTLYJSONKeyMapper*)keyMapper error:(NSError**)err
 {
     //check if all required properties are present
-    NSArray* incomingKeysArray = [dict allKeys];
-    NSMutableSet* requiredProperties = [self __requiredPropertyNames].mutableCopy;
-    NSSet* incomingKeys = [NSSet setWithArray: incomingKeysArray];
-
-    //transform the key names, if necessary
-    if (keyMapper || globalKeyMapper) {
-
-        NSMutableSet* transformedIncomingKeys = [NSMutableSet setWithCapacity: requiredProperties.count];
-        NSString* transformedName = nil;
+    NSMutableSet* missingProperties = nil;
+    BOOL compiledKeyPaths = [self __canUseCompiledKeyPathsWithKeyMapper:keyMapper];
 
-        //loop over the required properties list
-        for (OPTLYJSONModelClassProperty* property in [self __properties__]) {
-
-            transformedName = (keyMapper||globalKeyMapper) ? [self __mapString:property.name withKeyMapper:keyMapper] : property.name;
+    for (OPTLYJSONModelClassProperty* property in [self __properties__]) {
 
-            //check if exists and if so, add to incoming keys
-            id value;
-            @try {
-                value = [dict valueForKeyPath:transformedName];
-            }
-            @catch (NSException *exception) {
-                value = dict[transformedName];
-            }
+        if (property.isOptional) continue;
 
-            if (value) {
-                [transformedIncomingKeys addObject: property.name];
-            }
+        //check if exists under the (mapped) key name
+        if (![self __jsonValueFromDictionary:dict forProperty:property withKeyMapper:keyMapper compiled:compiledKeyPaths]) {
+            if (!missingProperties) missingProperties = [NSMutableSet set];
+            [missingProperties addObject:property.name];
         }
-
-        //overwrite the raw incoming list with the mapped key names
-        incomingKeys = transformedIncomingKeys;
     }
 
     //check for missing input keys
-    if (![requiredProperties isSubsetOfSet:incomingKeys]) {
-
-        //get a list of the missing properties
-        [requiredProperties minusSet:incomingKeys];
+    if (missingProperties) {
 
         //not all required properties are in - invalid input
-        OPTLYJMLog(@"Incoming data was invalid [%@ initWithDictionary:]. Keys missing: %@", self.class, requiredProperties);
+        OPTLYJMLog(@"Incoming data was invalid [%@ initWithDictionary:]. Keys missing: %@", self.class, missingProperties);
 
-        if (err) *err = [OPTLYJSONModelError errorInvalidDataWithMissingKeys:requiredProperties];
+        if (err) *err = [OPTLYJSONModelError errorInvalidDataWithMissingKeys:missingProperties];
         return NO;
     }
 
-    //not needed anymore
-    incomingKeys= nil;
-    requiredProperties= nil;
-
     return YES;
 }
 
+//the compiled key paths are only valid for the class key mapper
+-(BOOL)__canUseCompiledKeyPathsWithKeyMapper:(OPTLYJSONKeyMapper*)keyMapper
+{
+    return compiledMappingEnabled && !globalKeyMapper && keyMapper == self.__keyMapper;
+}
+
+//reads the JSON value for a property
+-(id)__jsonValueFromDictionary:(NSDictionary*)dict forProperty:(OPTLYJSONModelClassProperty*)property withKeyMapper:(OPTLYJSONKeyMapper*)keyMapper compiled:(BOOL)compiledKeyPaths
+{
+    NSString* jsonKeyPath = nil;
+    BOOL isNestedKeyPath = YES;
+
+    if (compiledKeyPaths) {
+        jsonKeyPath = property.jsonKeyPath;
+        isNestedKeyPath = property.isNestedKeyPath;
+    } else {
+        //convert key name to model keys, if a mapper is provided
+        jsonKeyPath = (keyMapper||globalKeyMapper) ? [self __mapString:property.name withKeyMapper:keyMapper] : property.name;
+    }
+
+    if (!isNestedKeyPath) return dict[jsonKeyPath];
+
+    id jsonValue;
+    @try {
+        jsonValue = [dict valueForKeyPath: jsonKeyPath];
+    }
+    @catch (NSException *exception) {
+        jsonValue = dict[jsonKeyPath];
+    }
+    return jsonValue;
+}
+
 -(NSString*)__mapString:(NSString*)string withKeyMapper:(OPTLYJSONKeyMapper*)keyMapper
 {
     if (keyMapper) {
@@ -287,21 +315,16 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
 
 -(BOOL)__importDictionary:(NSDictionary*)dict withKeyMapper:(OPTLYJSONKeyMapper*)keyMapper validation:(BOOL)validation error:(NSError**)err
 {
+    BOOL compiledKeyPaths = [self __canUseCompiledKeyPathsWithKeyMapper:keyMapper];
+
+    //a fresh instance has nothing to compare against, merges keep unchanged values as they are
+    BOOL compareBeforeSet = !validation;
+
     //loop over the incoming keys and set self's properties
     for (OPTLYJSONModelClassProperty* property in [self __properties__]) {
 
-        //convert key name to model keys, if a mapper is provided
-        NSString* jsonKeyPath = (keyMapper||globalKeyMapper) ? [self __mapString:property.name withKeyMapper:keyMapper] : property.name;
-        //OPTLYJMLog(@"keyPath: %@", jsonKeyPath);
-
         //general check for data type compliance
-        id jsonValue;
-        @try {
-            jsonValue = [dict valueForKeyPath: jsonKeyPath];
-        }
-        @catch (NSException *exception) {
-            jsonValue = dict[jsonKeyPath];
-        }
+        id jsonValue = [self __jsonValueFromDictionary:dict forProperty:property withKeyMapper:keyMapper compiled:compiledKeyPaths];
 
         //check for Optional properties
         if (isNull(jsonValue)) {
@@ -388,9 +411,7 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
                     }
                     return NO;
                 }
-                if (![value isEqual:[self valueForKey:property.name]]) {
-                    [self setValue:value forKey: property.name];
-                }
+                [self __setValue:value forProperty:property compare:compareBeforeSet];
 
                 //for clarity, does the same without continue
                 continue;
@@ -422,9 +443,7 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
                     }
 
                     //set the property value
-                    if (![jsonValue isEqual:[self valueForKey:property.name]]) {
-                        [self setValue:jsonValue forKey: property.name];
-                    }
+                    [self __setValue:jsonValue forProperty:property compare:compareBeforeSet];
                     continue;
                 }
 
@@ -439,39 +458,18 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
                     property.structName
                     ) {
 
-                    // searched around the web how to do this better
-                    // but did not find any solution, maybe that's the best idea? (hardly)
                     Class sourceClass = [OPTLYJSONValueTransformer classByResolvingClusterClasses:[jsonValue class]];
 
-                    //OPTLYJMLog(@"to type: [%@] from type: [%@] transformer: [%@]", p.type, sourceClass, selectorName);
-
-                    //build a method selector for the property and json object classes
-                    NSString* selectorName = [NSString stringWithFormat:@"%@From%@:",
-                                              (property.structName? property.structName : property.type), //target name
-                                              sourceClass]; //source name
-                    SEL selector = NSSelectorFromString(selectorName);
+                    //OPTLYJMLog(@"to type: [%@] from type: [%@]", p.type, sourceClass);
 
-                    //check for custom transformer
-                    BOOL foundCustomTransformer = NO;
-                    if ([valueTransformer respondsToSelector:selector]) {
-                        foundCustomTransformer = YES;
-                    } else {
-                        //try for hidden custom transformer
-                        selectorName = [NSString stringWithFormat:@"__%@",selectorName];
-                        selector = NSSelectorFromString(selectorName);
-                        if ([valueTransformer respondsToSelector:selector]) {
-                            foundCustomTransformer = YES;
-                        }
-                    }
-
-                    //check if there's a transformer with that name
-                    if (foundCustomTransformer) {
+                    //check if there's a transformer for the property and json object classes
+                    SEL selector = [self __transformerSelectorForProperty:property sourceClass:sourceClass];
+                    if (selector) {
                         IMP imp = [valueTransformer methodForSelector:selector];
                         id (*func)(id, SEL, id) = (void *)imp;
                         jsonValue = func(valueTransformer, selector, jsonValue);
 
-                        if (![jsonValue isEqual:[self valueForKey:property.name]])
-                            [self setValue:jsonValue forKey:property.name];
+                        [self __setValue:jsonValue forProperty:property compare:compareBeforeSet];
                     } else {
                         if (err) {
                             NSString* msg = [NSString stringWithFormat:@"%@ type not supported for %@.%@", property.type, [self class], property.name];
@@ -482,8 +480,7 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
                     }
                 } else {
                     // 3.4) handle "all other" cases (if any)
-                    if (![jsonValue isEqual:[self valueForKey:property.name]])
-                        [self setValue:jsonValue forKey:property.name];
+                    [self __setValue:jsonValue forProperty:property compare:compareBeforeSet];
                 }
             }
         }
@@ -492,6 +489,53 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
     return YES;
 }
 
+//sets an object property value, calling the compiled setter directly instead of going through KVC
+-(void)__setValue:(id)value forProperty:(OPTLYJSONModelClassProperty*)property compare:(BOOL)compareBeforeSet
+{
+    if (compareBeforeSet && [value isEqual:[self valueForKey:property.name]]) return;
+
+    //KVO-observed instances have their class swapped, their setters must go through the runtime
+    IMP setterImp = property.setterImp;
+    if (compiledMappingEnabled && setterImp && object_getClass(self) == [self class]) {
+        void (*func)(id, SEL, id) = (void *)setterImp;
+        func(self, property.setterSelector, value);
+        return;
+    }
+
+    [self setValue:value forKey:property.name];
+}
+
+//returns the value transformer selector converting a JSON value class to the property type (or NULL)
+-(SEL)__transformerSelectorForProperty:(OPTLYJSONModelClassProperty*)property sourceClass:(Class)sourceClass
+{
+    SEL selector = NULL;
+
+    if (compiledMappingEnabled) {
+        [property.transformers[NSStringFromClass(sourceClass)] getValue:&selector];
+        return selector;
+    }
+
+    return [[self class] __resolveTransformerSelectorForProperty:property sourceClass:sourceClass];
+}
+
++(SEL)__resolveTransformerSelectorForProperty:(OPTLYJSONModelClassProperty*)property sourceClass:(Class)sourceClass
+{
+    //build a method selector for the property and json object classes
+    NSString* selectorName = [NSString stringWithFormat:@"%@From%@:",
+                              (property.structName? property.structName : property.type), //target name
+                              sourceClass]; //source name
+    SEL selector = NSSelectorFromString(selectorName);
+
+    //check for custom transformer
+    if ([valueTransformer respondsToSelector:selector]) return selector;
+
+    //try for hidden custom transformer
+    selector = NSSelectorFromString([NSString stringWithFormat:@"__%@",selectorName]);
+    if ([valueTransformer respondsToSelector:selector]) return selector;
+
+    return NULL;
+}
+
 #pragma mark - property inspection methods
 
 -(BOOL)__isOPTLYJSONModelSubClass:(Class)class
@@ -504,42 +548,18 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
 #endif
 }
 
-//returns a set of the required keys for the model
--(NSMutableSet*)__requiredPropertyNames
-{
-    //fetch the associated property names
-    NSMutableSet* classRequiredPropertyNames = objc_getAssociatedObject(self.class, &kClassRequiredPropertyNamesKey);
-
-    if (!classRequiredPropertyNames) {
-        classRequiredPropertyNames = [NSMutableSet set];
-        [[self __properties__] enumerateObjectsUsingBlock:^(OPTLYJSONModelClassProperty* p, NSUInteger idx, BOOL *stop) {
-            if (!p.isOptional) [classRequiredPropertyNames addObject:p.name];
-        }];
-
-        //persist the list
-        objc_setAssociatedObject(
-                                 self.class,
-                                 &kClassRequiredPropertyNamesKey,
-                                 classRequiredPropertyNames,
-                                 OBJC_ASSOCIATION_RETAIN // This is atomic
-                                 );
-    }
-    return classRequiredPropertyNames;
-}
-
 //returns a list of the model's properties
 -(NSArray*)__properties__
 {
     //fetch the associated object
-    NSDictionary* classProperties = objc_getAssociatedObject(self.class, &kClassPropertiesKey);
-    if (classProperties) return [classProperties allValues];
+    NSArray* classProperties = objc_getAssociatedObject(self.class, &kClassPropertyListKey);
+    if (classProperties) return classProperties;
 
     //if here, the class needs to inspect itself
     [self __setup__];
 
     //return the property list
-    classProperties = objc_getAssociatedObject(self.class, &kClassPropertiesKey);
-    return [classProperties allValues];
+    return objc_getAssociatedObject(self.class, &kClassPropertyListKey);
 }
 
 //inspects the class, get's a list of the class properties
@@ -715,6 +735,46 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
                     if ([self respondsToSelector:setter])
                         p.customSetters[class] = [NSValue valueWithBytes:&setter objCType:@encode(SEL)];
                 }
+
+                // compile the JSON key path with the class key mapper
+                OPTLYJSONKeyMapper* keyMapper = self.__keyMapper;
+                p.jsonKeyPath = keyMapper ? [keyMapper convertValue:p.name] : p.name;
+                p.isNestedKeyPath = ([p.jsonKeyPath rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@".@"]].location != NSNotFound);
+
+                // resolve the setter implementation, so object values are set without KVC
+                if (p.type) {
+                    NSString *setterName = [NSString stringWithFormat:@"set%@:", name];
+                    for (NSString *attributeItem in attributeItems) {
+                        if ([attributeItem hasPrefix:@"S"]) setterName = [attributeItem substringFromIndex:1];
+                    }
+
+                    SEL setter = NSSelectorFromString(setterName);
+                    if ([[self class] instancesRespondToSelector:setter]) {
+                        p.setterSelector = setter;
+                        p.setterImp = [[self class] instanceMethodForSelector:setter];
+                    }
+                }
+
+                // resolve the value transformers for all JSON value classes
+                if (p.type || p.structName) {
+                    NSMutableDictionary *transformers = [NSMutableDictionary new];
+
+                    for (Class type in allowedJSONTypes)
+                    {
+                        Class sourceClass = [OPTLYJSONValueTransformer classByResolvingClusterClasses:type];
+                        NSString *class = NSStringFromClass(sourceClass);
+
+                        if (transformers[class])
+                            continue;
+
+                        SEL transformer = [[self class] __resolveTransformerSelectorForProperty:p sourceClass:sourceClass];
+
+                        if (transformer)
+                            transformers[class] = [NSValue valueWithBytes:&transformer objCType:@encode(SEL)];
+                    }
+
+                    p.transformers = [transformers copy];
+                }
             }
         }
 
@@ -725,11 +785,11 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
         class = [class superclass];
     }
 
-    //finally store the property index in the static property index
+    //finally store the property list, this marks the class as set up
     objc_setAssociatedObject(
                              self.class,
-                             &kClassPropertiesKey,
-                             [propertyIndex copy],
+                             &kClassPropertyListKey,
+                             [propertyIndex allValues],
                              OBJC_ASSOCIATION_RETAIN // This is atomic
                              );
 }
@@ -856,6 +916,9 @@ static OPTLYJSONKeyMapper* globalKeyMapper = nil;
 #pragma mark - custom transformations
 - (BOOL)__customSetValue:(id <NSObject>)value forProperty:(OPTLYJSONModelClassProperty *)property
 {
+    if (property.customSetters.count == 0)
+        return NO;
+
     NSString *class = NSStringFromClass([OPTLYJSONValueTransformer classByResolvingClusterClasses:[value class]]);
 
     SEL setter = nil;
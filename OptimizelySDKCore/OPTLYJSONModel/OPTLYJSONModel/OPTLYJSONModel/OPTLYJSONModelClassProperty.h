@@ -61,4 +61,17 @@
 /** custom setters for this property, found in the owning model */
 @property (strong, nonatomic) NSMutableDictionary *customSetters;
 
+/** The JSON key path for the property, resolved with the owning model's key mapper */
+@property (copy, nonatomic) NSString *jsonKeyPath;
+
+/** If YES - the JSON key path has to be resolved with valueForKeyPath: */
+@property (assign, nonatomic) BOOL isNestedKeyPath;
+
+/** The setter selector and its implementation in the owning model, used instead of KVC (object properties only) */
+@property (assign, nonatomic) SEL setterSelector;
+@property (assign, nonatomic) IMP setterImp;
+
+/** value transformer selectors for this property, keyed by the name of the JSON value class */
+@property (strong, nonatomic) NSDictionary *transformers;
+
 @end
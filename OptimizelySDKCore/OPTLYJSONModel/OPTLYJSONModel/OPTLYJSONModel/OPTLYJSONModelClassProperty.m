@@ -36,6 +36,7 @@
     if (self.isOptional) [properties addObject:@"Optional"];
     if (self.isMutable) [properties addObject:@"Mutable"];
     if (self.isStandardJSONType) [properties addObject:@"Standard JSON type"];
+    if (self.setterImp) [properties addObject:[NSString stringWithFormat: @"Setter = %@", NSStringFromSelector(self.setterSelector)]];
     if (self.customGetter) [properties addObject:[NSString stringWithFormat: @"Getter = %@", NSStringFromSelector(self.customGetter)]];
 
     if (self.customSetters)
@@ -0,0 +1,168 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+@import OptimizelySDKCore;
+@import XCTest;
+
+static NSUInteger const kMappingIterations = 2000;
+
+@interface OPTLYJSONModel (MappingPerformanceTests)
++ (void)__setCompiledMappingEnabled:(BOOL)enabled;
+@end
+
+// only used by testConcurrentFirstTimeSetup, so its class is inspected by that test
+@interface FirstTimeSetupModel : OPTLYJSONModel
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, strong) NSArray<NSString *> *tags;
+@property (nonatomic, strong) NSString<OPTLYOptional> *note;
+@end
+
+@implementation FirstTimeSetupModel
+@end
+
+@interface MappingPerformanceTests : XCTestCase
+@property (nonatomic, strong) NSDictionary *userProfileDict;
+@property (nonatomic, strong) NSDictionary *experimentDict;
+@end
+
+@implementation MappingPerformanceTests
+
+- (void)setUp
+{
+    [super setUp];
+
+    NSMutableDictionary *bucketMap = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < 10; i++) {
+        NSString *experimentId = [NSString stringWithFormat:@"experiment_id_%lu", (unsigned long)i];
+        bucketMap[experimentId] = @{ OPTLYDatafileKeysUserProfileServiceVariationId : [NSString stringWithFormat:@"variation_id_%lu", (unsigned long)i] };
+    }
+    self.userProfileDict = @{ @"user_id" : @"alda",
+                              @"experiment_bucket_map" : bucketMap };
+
+    self.experimentDict = @{ OPTLYDatafileKeysExperimentId : @"6358043286",
+                             OPTLYDatafileKeysExperimentKey : @"testExperiment",
+                             OPTLYDatafileKeysExperimentStatus : @"Running",
+                             OPTLYDatafileKeysExperimentLayerId : @"6367863211",
+                             OPTLYDatafileKeysExperimentAudienceIds : @[@"6366023138"],
+                             OPTLYDatafileKeysExperimentForcedVariations : @{ @"forced_user" : @"control" },
+                             OPTLYDatafileKeysExperimentTrafficAllocation : @[ @{ OPTLYDatafileKeysTrafficAllocationEntityId : @"6384330451",
+                                                                                  OPTLYDatafileKeysTrafficAllocationEndOfRange : @5000 },
+                                                                               @{ OPTLYDatafileKeysTrafficAllocationEntityId : @"6376141758",
+                                                                                  OPTLYDatafileKeysTrafficAllocationEndOfRange : @10000 } ],
+                             OPTLYDatafileKeysExperimentVariations : @[ @{ OPTLYDatafileKeysVariationId : @"6384330451",
+                                                                          OPTLYDatafileKeysVariationKey : @"control" },
+                                                                       @{ OPTLYDatafileKeysVariationId : @"6376141758",
+                                                                          OPTLYDatafileKeysVariationKey : @"variation" } ] };
+}
+
+- (void)tearDown
+{
+    [OPTLYJSONModel __setCompiledMappingEnabled:YES];
+    [super tearDown];
+}
+
+#pragma mark - Correctness
+
+- (void)testCompiledMappingMatchesKVCMapping
+{
+    NSError *error = nil;
+    OPTLYUserProfile *compiledProfile = [[OPTLYUserProfile alloc] initWithDictionary:self.userProfileDict error:&error];
+    XCTAssertNil(error);
+    OPTLYExperiment *compiledExperiment = [[OPTLYExperiment alloc] initWithDictionary:self.experimentDict error:&error];
+    XCTAssertNil(error);
+
+    [OPTLYJSONModel __setCompiledMappingEnabled:NO];
+    OPTLYUserProfile *kvcProfile = [[OPTLYUserProfile alloc] initWithDictionary:self.userProfileDict error:&error];
+    XCTAssertNil(error);
+    OPTLYExperiment *kvcExperiment = [[OPTLYExperiment alloc] initWithDictionary:self.experimentDict error:&error];
+    XCTAssertNil(error);
+
+    XCTAssertEqualObjects([compiledProfile toDictionary], [kvcProfile toDictionary]);
+    XCTAssertEqualObjects([compiledExperiment toDictionary], [kvcExperiment toDictionary]);
+    XCTAssertEqualObjects([compiledExperiment getVariationForVariationKey:@"variation"].variationId, @"6376141758");
+    XCTAssertEqualObjects([compiledProfile getVariationIdForExperimentId:@"experiment_id_3"], @"variation_id_3");
+}
+
+- (void)testCompiledMappingReportsMissingMappedKeys
+{
+    NSMutableDictionary *experimentDict = [self.experimentDict mutableCopy];
+    [experimentDict removeObjectForKey:OPTLYDatafileKeysExperimentTrafficAllocation];
+
+    NSError *error = nil;
+    OPTLYExperiment *experiment = [[OPTLYExperiment alloc] initWithDictionary:experimentDict error:&error];
+    XCTAssertNil(experiment);
+    XCTAssertEqual(error.code, kOPTLYJSONModelErrorInvalidData);
+    XCTAssertEqualObjects(error.userInfo[kOPTLYJSONModelMissingKeys], @[@"trafficAllocations"]);
+}
+
+- (void)testConcurrentFirstTimeSetup
+{
+    NSDictionary *dict = @{ @"name" : @"model", @"tags" : @[@"a", @"b"] };
+    NSUInteger count = 100;
+    __block NSUInteger mapped = 0;
+    NSObject *lockObject = [NSObject new];
+
+    dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+        FirstTimeSetupModel *model = [[FirstTimeSetupModel alloc] initWithDictionary:dict error:nil];
+        if ([model.name isEqualToString:@"model"] && model.tags.count == 2 && model.note == nil) {
+            @synchronized (lockObject) {
+                mapped++;
+            }
+        }
+    });
+
+    XCTAssertEqual(mapped, count);
+}
+
+#pragma mark - Benchmarks
+
+- (void)testUserProfileMappingPerformance
+{
+    [self measureMappingOfModelClass:[OPTLYUserProfile class] dictionary:self.userProfileDict];
+}
+
+- (void)testUserProfileMappingPerformanceWithKVC
+{
+    [OPTLYJSONModel __setCompiledMappingEnabled:NO];
+    [self measureMappingOfModelClass:[OPTLYUserProfile class] dictionary:self.userProfileDict];
+}
+
+- (void)testExperimentMappingPerformance
+{
+    [self measureMappingOfModelClass:[OPTLYExperiment class] dictionary:self.experimentDict];
+}
+
+- (void)testExperimentMappingPerformanceWithKVC
+{
+    [OPTLYJSONModel __setCompiledMappingEnabled:NO];
+    [self measureMappingOfModelClass:[OPTLYExperiment class] dictionary:self.experimentDict];
+}
+
+#pragma mark - Helper Methods
+
+- (void)measureMappingOfModelClass:(Class)modelClass dictionary:(NSDictionary *)dict
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kMappingIterations; i++) {
+            @autoreleasepool {
+                id model = [[modelClass alloc] initWithDictionary:dict error:nil];
+                XCTAssertNotNil(model);
+            }
+        }
+    }];
+}
+
+@end
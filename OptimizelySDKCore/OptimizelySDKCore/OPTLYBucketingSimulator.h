@@ -0,0 +1,122 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+@class OPTLYExperiment, OPTLYProjectConfig, OPTLYVariation;
+
+/*
+ This class buckets large lists of users offline, e.g. to preview the traffic split of a datafile
+ before it is published. Ids are split into chunks that are bucketed in parallel, and each chunk
+ hashes several ids at a time with a multi-lane MurmurHash3 kernel. Results are identical to
+ OPTLYBucketer and OPTLYDecisionService for the same ids.
+ */
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Default number of ids bucketed by one parallel work item
+extern NSUInteger const OPTLYBucketingSimulatorDefaultChunkSize;
+// Distribution key counting the users that got no variation
+extern NSString *const OPTLYBucketingSimulatorNoVariation;
+
+@interface OPTLYBucketingSimulator : NSObject
+
+/// The project config the users are bucketed against.
+@property (nonatomic, strong, readonly) OPTLYProjectConfig *config;
+
+/// Number of ids bucketed by one parallel work item (defaults to OPTLYBucketingSimulatorDefaultChunkSize).
+@property (nonatomic, assign) NSUInteger chunkSize;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Initializer for the bucketing simulator.
+ *
+ * @param config The project config to bucket users against.
+ * @return An instance of the bucketing simulator.
+ */
+- (nullable instancetype)initWithConfig:(OPTLYProjectConfig *)config;
+
+/**
+ * Reads a list of user ids, one id per line. Empty lines are skipped.
+ *
+ * @param path The path of the file.
+ * @param error Set if the file could not be read.
+ * @return The user ids, or nil if the file could not be read.
+ */
++ (nullable NSArray<NSString *> *)userIdsWithContentsOfFile:(NSString *)path
+                                                      error:(NSError * __autoreleasing *)error;
+
+/**
+ * Computes the bucket values (0 to 9999) of many bucketing ids for one entity (an experiment or a group).
+ * Matches OPTLYBucketer generateBucketValue: of "<bucketingId><entityId>".
+ *
+ * @param bucketValues A buffer of at least bucketingIds.count values to fill.
+ * @param bucketingIds The bucketing ids.
+ * @param entityId The id of the experiment or group.
+ */
+- (void)getBucketValues:(int *)bucketValues
+        forBucketingIds:(NSArray<NSString *> *)bucketingIds
+               entityId:(NSString *)entityId;
+
+/**
+ * Buckets many bucketing ids into an experiment, including the mutually exclusive group check.
+ * Matches OPTLYBucketer bucketExperiment:withBucketingId: for each id.
+ *
+ * @param experiment The experiment to bucket into.
+ * @param bucketingIds The bucketing ids.
+ * @return The variation of each id, or NSNull if an id is not bucketed, in the order of bucketingIds.
+ */
+- (NSArray *)variationsForExperiment:(OPTLYExperiment *)experiment
+                        bucketingIds:(NSArray<NSString *> *)bucketingIds;
+
+/**
+ * Decides the variations of many users sharing the same attributes.
+ * Matches OPTLYDecisionService getVariation:experiment:attributes: for each user, except that
+ * user profiles and forced variations set at runtime are not consulted: the decision only depends
+ * on the datafile (experiment status, whitelisting, audiences and traffic allocation).
+ * Audiences are evaluated once for all users.
+ *
+ * @param experiment The experiment to decide.
+ * @param userIds The user ids.
+ * @param attributes The attributes shared by the users.
+ * @return The variation of each user, or NSNull if a user gets no variation, in the order of userIds.
+ */
+- (NSArray *)decisionsForExperiment:(OPTLYExperiment *)experiment
+                            userIds:(NSArray<NSString *> *)userIds
+                         attributes:(nullable NSDictionary<NSString *, id> *)attributes;
+
+/**
+ * Same decisions as decisionsForExperiment:userIds:attributes:, aggregated without building per-user results.
+ *
+ * @return The number of users per variation key. Users that get no variation are counted under OPTLYBucketingSimulatorNoVariation.
+ */
+- (NSDictionary<NSString *, NSNumber *> *)distributionForExperiment:(OPTLYExperiment *)experiment
+                                                            userIds:(NSArray<NSString *> *)userIds
+                                                         attributes:(nullable NSDictionary<NSString *, id> *)attributes;
+
+/**
+ * Aggregates per-user results into the number of users per variation key.
+ *
+ * @param variations Per-user results of variationsForExperiment:bucketingIds: or decisionsForExperiment:userIds:attributes:.
+ * @return The number of users per variation key. NSNull entries are counted under OPTLYBucketingSimulatorNoVariation.
+ */
++ (NSDictionary<NSString *, NSNumber *> *)distributionOfVariations:(NSArray *)variations;
+
+@end
+
+NS_ASSUME_NONNULL_END
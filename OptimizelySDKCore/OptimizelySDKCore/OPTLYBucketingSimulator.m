@@ -0,0 +1,484 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <string.h>
+#import "OPTLYAudience.h"
+#import "OPTLYBucketer.h"
+#import "OPTLYBucketingSimulator.h"
+#import "OPTLYControlAttributes.h"
+#import "OPTLYExperiment.h"
+#import "OPTLYGroup.h"
+#import "OPTLYNSObject+Validation.h"
+#import "OPTLYProjectConfig.h"
+#import "OPTLYTrafficAllocation.h"
+#import "OPTLYVariation.h"
+
+// Defined in OPTLYBucketer.m
+extern int const MAX_TRAFFIC_VALUE;
+extern int const HASH_SEED;
+extern uint64_t const MAX_HASH_VALUE;
+
+NSUInteger const OPTLYBucketingSimulatorDefaultChunkSize = 1024;
+NSString *const OPTLYBucketingSimulatorNoVariation = @"";
+
+// Number of keys hashed together by the multi-lane kernel
+#define OPTLY_MURMUR_LANES 4
+// Keys up to this size (in bytes) are built on the stack
+#define OPTLY_INLINE_KEY_BYTES 256
+
+// Variation index of ids that are not bucketed
+static NSInteger const OPTLYBucketingSimulatorNotBucketed = -1;
+
+// A traffic allocation resolved to an index, so that parallel chunks never touch the config
+typedef struct {
+    int endOfRange;
+    NSInteger index;
+} OPTLYBucketingSimulatorRange;
+
+#pragma mark - Multi-lane MurmurHash3
+
+static inline uint32_t OPTLYRotl32(uint32_t x, int8_t r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t OPTLYMixBlock(uint32_t h, uint32_t k) {
+    k *= 0xcc9e2d51;
+    k = OPTLYRotl32(k, 15);
+    k *= 0x1b873593;
+    h ^= k;
+    h = OPTLYRotl32(h, 13);
+    return h * 5 + 0xe6546b64;
+}
+
+/*
+ MurmurHash3_x86_32 of OPTLY_MURMUR_LANES keys at once, bit-for-bit identical to murmur3.c.
+ The blocks all keys have in common are mixed in lockstep with fixed-width lane loops,
+ which the compiler turns into SIMD (NEON/SSE) code; the remaining blocks of longer keys,
+ the tails and the finalization are done per lane.
+ */
+static void OPTLYMurmurHash3_x86_32_lanes(const uint8_t *const keys[OPTLY_MURMUR_LANES],
+                                          const int lens[OPTLY_MURMUR_LANES],
+                                          uint32_t seed,
+                                          uint32_t out[OPTLY_MURMUR_LANES]) {
+    uint32_t h[OPTLY_MURMUR_LANES];
+    uint32_t k[OPTLY_MURMUR_LANES];
+    int nblocks[OPTLY_MURMUR_LANES];
+    int minBlocks = INT_MAX;
+    int maxBlocks = 0;
+    for (int lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+        h[lane] = seed;
+        nblocks[lane] = lens[lane] / 4;
+        minBlocks = MIN(minBlocks, nblocks[lane]);
+        maxBlocks = MAX(maxBlocks, nblocks[lane]);
+    }
+    
+    // body, blocks shared by all lanes
+    for (int i = 0; i < minBlocks; i++) {
+        for (int lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+            memcpy(&k[lane], keys[lane] + i * 4, sizeof(uint32_t));
+        }
+        for (int lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+            h[lane] = OPTLYMixBlock(h[lane], k[lane]);
+        }
+    }
+    
+    // body, remaining blocks of the longer keys
+    for (int i = minBlocks; i < maxBlocks; i++) {
+        for (int lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+            if (i < nblocks[lane]) {
+                uint32_t block;
+                memcpy(&block, keys[lane] + i * 4, sizeof(uint32_t));
+                h[lane] = OPTLYMixBlock(h[lane], block);
+            }
+        }
+    }
+    
+    // tail
+    for (int lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+        const uint8_t *tail = keys[lane] + nblocks[lane] * 4;
+        uint32_t k1 = 0;
+        switch (lens[lane] & 3) {
+            case 3: k1 ^= tail[2] << 16;
+            case 2: k1 ^= tail[1] << 8;
+            case 1: k1 ^= tail[0];
+                k1 *= 0xcc9e2d51; k1 = OPTLYRotl32(k1, 15); k1 *= 0x1b873593; h[lane] ^= k1;
+        }
+    }
+    
+    // finalization
+    for (int lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+        uint32_t h1 = h[lane] ^ (uint32_t)lens[lane];
+        h1 ^= h1 >> 16;
+        h1 *= 0x85ebca6b;
+        h1 ^= h1 >> 13;
+        h1 *= 0xc2b2ae35;
+        h1 ^= h1 >> 16;
+        out[lane] = h1;
+    }
+}
+
+/*
+ Fills bucketValues[range] for "<bucketingId><entityId>" keys. Like OPTLYBucketer, the hashed
+ length is the UTF-16 length of the key applied to its UTF-8 bytes.
+ */
+static void OPTLYBucketingSimulatorBucketValues(NSArray<NSString *> *bucketingIds,
+                                                NSRange range,
+                                                NSData *entityIdBytes,
+                                                NSUInteger entityIdLength,
+                                                int *bucketValues) {
+    uint8_t inlineKeys[OPTLY_MURMUR_LANES][OPTLY_INLINE_KEY_BYTES];
+    const uint8_t *keys[OPTLY_MURMUR_LANES];
+    int lens[OPTLY_MURMUR_LANES];
+    uint32_t hashes[OPTLY_MURMUR_LANES];
+    
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i += OPTLY_MURMUR_LANES) {
+        NSUInteger lanes = MIN(OPTLY_MURMUR_LANES, NSMaxRange(range) - i);
+        uint8_t *heapKeys[OPTLY_MURMUR_LANES] = { NULL };
+        for (NSUInteger lane = 0; lane < OPTLY_MURMUR_LANES; lane++) {
+            if (lane >= lanes) {
+                keys[lane] = inlineKeys[lane];
+                lens[lane] = 0;
+                continue;
+            }
+            NSString *bucketingId = bucketingIds[i + lane];
+            NSUInteger length = bucketingId.length;
+            // a UTF-16 code unit takes at most 3 UTF-8 bytes
+            NSUInteger capacity = length * 3 + entityIdBytes.length;
+            uint8_t *key = inlineKeys[lane];
+            if (capacity > OPTLY_INLINE_KEY_BYTES) {
+                key = heapKeys[lane] = malloc(capacity);
+            }
+            NSUInteger used = 0;
+            [bucketingId getBytes:key
+                        maxLength:capacity
+                       usedLength:&used
+                         encoding:NSUTF8StringEncoding
+                          options:0
+                            range:NSMakeRange(0, length)
+                   remainingRange:NULL];
+            memcpy(key + used, entityIdBytes.bytes, entityIdBytes.length);
+            keys[lane] = key;
+            lens[lane] = (int)MIN(length + entityIdLength, used + entityIdBytes.length);
+        }
+        
+        OPTLYMurmurHash3_x86_32_lanes(keys, lens, HASH_SEED, hashes);
+        
+        for (NSUInteger lane = 0; lane < lanes; lane++) {
+            double ratio = (double)hashes[lane] / (double)MAX_HASH_VALUE;
+            bucketValues[i + lane] = ratio * MAX_TRAFFIC_VALUE;
+            free(heapKeys[lane]);
+        }
+    }
+}
+
+static NSInteger OPTLYBucketingSimulatorLookup(const OPTLYBucketingSimulatorRange *ranges, NSUInteger count, int bucketValue) {
+    for (NSUInteger i = 0; i < count; i++) {
+        if (bucketValue < ranges[i].endOfRange) {
+            return ranges[i].index;
+        }
+    }
+    return OPTLYBucketingSimulatorNotBucketed;
+}
+
+#pragma mark - OPTLYBucketingSimulator
+
+@implementation OPTLYBucketingSimulator
+
+- (instancetype)initWithConfig:(OPTLYProjectConfig *)config {
+    if (config == nil) {
+        return nil;
+    }
+    self = [super init];
+    if (self != nil) {
+        _config = config;
+        _chunkSize = OPTLYBucketingSimulatorDefaultChunkSize;
+    }
+    return self;
+}
+
++ (NSArray<NSString *> *)userIdsWithContentsOfFile:(NSString *)path
+                                             error:(NSError * __autoreleasing *)error {
+    NSString *contents = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:error];
+    if (contents == nil) {
+        return nil;
+    }
+    NSMutableArray<NSString *> *userIds = [NSMutableArray new];
+    [contents enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+        if (line.length > 0) {
+            [userIds addObject:line];
+        }
+    }];
+    return [userIds copy];
+}
+
+- (void)getBucketValues:(int *)bucketValues
+        forBucketingIds:(NSArray<NSString *> *)bucketingIds
+               entityId:(NSString *)entityId {
+    NSData *entityIdBytes = [entityId dataUsingEncoding:NSUTF8StringEncoding];
+    NSUInteger entityIdLength = entityId.length;
+    [self applyChunksOfCount:bucketingIds.count block:^(NSRange range) {
+        OPTLYBucketingSimulatorBucketValues(bucketingIds, range, entityIdBytes, entityIdLength, bucketValues);
+    }];
+}
+
+- (NSArray *)variationsForExperiment:(OPTLYExperiment *)experiment
+                        bucketingIds:(NSArray<NSString *> *)bucketingIds {
+    NSMutableArray *table = [NSMutableArray new];
+    NSInteger *indexes = malloc(MAX(bucketingIds.count, 1) * sizeof(NSInteger));
+    [self getVariationIndexes:indexes table:table experiment:experiment bucketingIds:bucketingIds];
+    NSArray *variations = [self variationsWithIndexes:indexes count:bucketingIds.count table:table];
+    free(indexes);
+    return variations;
+}
+
+- (NSArray *)decisionsForExperiment:(OPTLYExperiment *)experiment
+                            userIds:(NSArray<NSString *> *)userIds
+                         attributes:(NSDictionary<NSString *, id> *)attributes {
+    NSMutableArray *table = [NSMutableArray new];
+    NSInteger *indexes = malloc(MAX(userIds.count, 1) * sizeof(NSInteger));
+    [self getDecisionIndexes:indexes table:table experiment:experiment userIds:userIds attributes:attributes];
+    NSArray *variations = [self variationsWithIndexes:indexes count:userIds.count table:table];
+    free(indexes);
+    return variations;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)distributionForExperiment:(OPTLYExperiment *)experiment
+                                                            userIds:(NSArray<NSString *> *)userIds
+                                                         attributes:(NSDictionary<NSString *, id> *)attributes {
+    NSMutableArray *table = [NSMutableArray new];
+    NSInteger *indexes = malloc(MAX(userIds.count, 1) * sizeof(NSInteger));
+    [self getDecisionIndexes:indexes table:table experiment:experiment userIds:userIds attributes:attributes];
+    
+    NSUInteger *counts = calloc(table.count + 1, sizeof(NSUInteger));
+    for (NSUInteger i = 0; i < userIds.count; i++) {
+        counts[indexes[i] + 1]++;
+    }
+    NSMutableDictionary<NSString *, NSNumber *> *distribution = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i <= table.count; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        NSString *key = (i == 0) ? OPTLYBucketingSimulatorNoVariation : ((OPTLYVariation *)table[i - 1]).variationKey;
+        distribution[key] = @([distribution[key] unsignedIntegerValue] + counts[i]);
+    }
+    free(counts);
+    free(indexes);
+    return [distribution copy];
+}
+
++ (NSDictionary<NSString *, NSNumber *> *)distributionOfVariations:(NSArray *)variations {
+    NSMutableDictionary<NSString *, NSNumber *> *distribution = [NSMutableDictionary new];
+    for (id variation in variations) {
+        NSString *key = [variation isKindOfClass:[OPTLYVariation class]] ? ((OPTLYVariation *)variation).variationKey : OPTLYBucketingSimulatorNoVariation;
+        distribution[key] = @([distribution[key] unsignedIntegerValue] + 1);
+    }
+    return [distribution copy];
+}
+
+#pragma mark - Helper Methods
+
+// Runs block over consecutive ranges of at most chunkSize items, in parallel
+- (void)applyChunksOfCount:(NSUInteger)count block:(void (^)(NSRange range))block {
+    if (count == 0) {
+        return;
+    }
+    NSUInteger chunkSize = MAX(self.chunkSize, 1);
+    size_t chunks = (count + chunkSize - 1) / chunkSize;
+    dispatch_apply(chunks, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t chunk) {
+        NSUInteger location = chunk * chunkSize;
+        block(NSMakeRange(location, MIN(chunkSize, count - location)));
+    });
+}
+
+// Returns the index of variation in table, adding it if needed
+- (NSInteger)indexOfVariation:(OPTLYVariation *)variation table:(NSMutableArray *)table {
+    if (variation == nil) {
+        return OPTLYBucketingSimulatorNotBucketed;
+    }
+    NSUInteger index = [table indexOfObjectIdenticalTo:variation];
+    if (index == NSNotFound) {
+        [table addObject:variation];
+        index = table.count - 1;
+    }
+    return index;
+}
+
+- (NSArray *)variationsWithIndexes:(const NSInteger *)indexes count:(NSUInteger)count table:(NSArray *)table {
+    if (count == 0) {
+        return @[];
+    }
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)malloc(count * sizeof(id));
+    NSNull *none = [NSNull null];
+    for (NSUInteger i = 0; i < count; i++) {
+        objects[i] = (indexes[i] == OPTLYBucketingSimulatorNotBucketed) ? none : table[indexes[i]];
+    }
+    NSArray *variations = [NSArray arrayWithObjects:objects count:count];
+    free(objects);
+    return variations;
+}
+
+// Mirrors OPTLYBucketer bucketExperiment:withBucketingId:, with variations reported as indexes into table
+- (void)getVariationIndexes:(NSInteger *)indexes
+                      table:(NSMutableArray *)table
+                 experiment:(OPTLYExperiment *)experiment
+               bucketingIds:(NSArray<NSString *> *)bucketingIds {
+    NSUInteger count = bucketingIds.count;
+    
+    // ---- resolve the mutually exclusive group ----
+    BOOL excluded = NO;
+    OPTLYGroup *group = nil;
+    NSMutableData *groupRanges = nil;
+    if (experiment.groupId != nil) {
+        group = [self.config getGroupForGroupId:experiment.groupId];
+        if (group == nil) {
+            excluded = YES;
+        }
+        else if ([group.policy isEqualToString:OPTLYBucketerOverlappingPolicy]) {
+            group = nil;
+        }
+        else if ([group.policy isEqualToString:OPTLYBucketerMutexPolicy]) {
+            // index 0 stands for "bucketed into this experiment"
+            groupRanges = [NSMutableData dataWithLength:group.trafficAllocations.count * sizeof(OPTLYBucketingSimulatorRange)];
+            OPTLYBucketingSimulatorRange *ranges = groupRanges.mutableBytes;
+            [group.trafficAllocations enumerateObjectsUsingBlock:^(OPTLYTrafficAllocation *trafficAllocation, NSUInteger idx, BOOL *stop) {
+                ranges[idx].endOfRange = trafficAllocation.endOfRange;
+                ranges[idx].index = [trafficAllocation.entityId isEqualToString:experiment.experimentId] ? 0 : OPTLYBucketingSimulatorNotBucketed;
+            }];
+        }
+        else {
+            excluded = YES;
+        }
+    }
+    
+    // ---- resolve the experiment traffic allocation ----
+    NSMutableData *experimentRanges = [NSMutableData dataWithLength:experiment.trafficAllocations.count * sizeof(OPTLYBucketingSimulatorRange)];
+    OPTLYBucketingSimulatorRange *ranges = experimentRanges.mutableBytes;
+    [experiment.trafficAllocations enumerateObjectsUsingBlock:^(OPTLYTrafficAllocation *trafficAllocation, NSUInteger idx, BOOL *stop) {
+        ranges[idx].endOfRange = trafficAllocation.endOfRange;
+        ranges[idx].index = [self indexOfVariation:[experiment getVariationForVariationId:trafficAllocation.entityId] table:table];
+    }];
+    
+    if (excluded || experimentRanges.length == 0) {
+        for (NSUInteger i = 0; i < count; i++) {
+            indexes[i] = OPTLYBucketingSimulatorNotBucketed;
+        }
+        return;
+    }
+    
+    NSData *groupIdBytes = [group.groupId dataUsingEncoding:NSUTF8StringEncoding];
+    NSUInteger groupIdLength = group.groupId.length;
+    NSData *experimentIdBytes = [experiment.experimentId dataUsingEncoding:NSUTF8StringEncoding];
+    NSUInteger experimentIdLength = experiment.experimentId.length;
+    const OPTLYBucketingSimulatorRange *groupRange = groupRanges.bytes;
+    NSUInteger groupRangeCount = groupRanges.length / sizeof(OPTLYBucketingSimulatorRange);
+    const OPTLYBucketingSimulatorRange *experimentRange = experimentRanges.bytes;
+    NSUInteger experimentRangeCount = experimentRanges.length / sizeof(OPTLYBucketingSimulatorRange);
+    int *bucketValues = malloc(count * sizeof(int));
+    
+    [self applyChunksOfCount:count block:^(NSRange range) {
+        if (groupRanges != nil) {
+            OPTLYBucketingSimulatorBucketValues(bucketingIds, range, groupIdBytes, groupIdLength, bucketValues);
+            for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+                indexes[i] = OPTLYBucketingSimulatorLookup(groupRange, groupRangeCount, bucketValues[i]);
+            }
+        }
+        OPTLYBucketingSimulatorBucketValues(bucketingIds, range, experimentIdBytes, experimentIdLength, bucketValues);
+        for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+            if (groupRanges != nil && indexes[i] == OPTLYBucketingSimulatorNotBucketed) {
+                continue;
+            }
+            indexes[i] = OPTLYBucketingSimulatorLookup(experimentRange, experimentRangeCount, bucketValues[i]);
+        }
+    }];
+    free(bucketValues);
+}
+
+// Mirrors OPTLYDecisionService getVariation:experiment:attributes: without user profiles and runtime forced variations
+- (void)getDecisionIndexes:(NSInteger *)indexes
+                     table:(NSMutableArray *)table
+                experiment:(OPTLYExperiment *)experiment
+                   userIds:(NSArray<NSString *> *)userIds
+                attributes:(NSDictionary<NSString *, id> *)attributes {
+    NSUInteger count = userIds.count;
+    for (NSUInteger i = 0; i < count; i++) {
+        indexes[i] = OPTLYBucketingSimulatorNotBucketed;
+    }
+    
+    // ---- check if the experiment is running ----
+    if (![experiment isExperimentRunning]) {
+        return;
+    }
+    
+    // ---- check if the user passes audience targeting, once for all users ----
+    BOOL passesTargeting = [self passesTargeting:experiment attributes:attributes];
+    
+    // ---- bucket users, with a single bucketing id if the attributes set one ----
+    NSString *bucketingId = nil;
+    if ([attributes[OptimizelyBucketId] isValidStringType]) {
+        bucketingId = [attributes[OptimizelyBucketId] getStringOrEmpty];
+    }
+    NSInteger sharedIndex = OPTLYBucketingSimulatorNotBucketed;
+    if (passesTargeting) {
+        if (bucketingId != nil) {
+            [self getVariationIndexes:&sharedIndex table:table experiment:experiment bucketingIds:@[bucketingId]];
+            for (NSUInteger i = 0; i < count; i++) {
+                indexes[i] = sharedIndex;
+            }
+        }
+        else {
+            [self getVariationIndexes:indexes table:table experiment:experiment bucketingIds:userIds];
+        }
+    }
+    
+    // ---- whitelisted users take precedence ----
+    if (experiment.forcedVariations.count > 0) {
+        NSMutableDictionary<NSString *, NSNumber *> *whitelist = [NSMutableDictionary new];
+        for (NSString *userId in experiment.forcedVariations) {
+            OPTLYVariation *variation = [experiment getVariationForVariationKey:experiment.forcedVariations[userId]];
+            if (variation != nil) {
+                whitelist[userId] = @([self indexOfVariation:variation table:table]);
+            }
+        }
+        for (NSUInteger i = 0; i < count; i++) {
+            NSNumber *index = whitelist[userIds[i]];
+            if (index != nil) {
+                indexes[i] = index.integerValue;
+            }
+        }
+    }
+}
+
+- (BOOL)passesTargeting:(OPTLYExperiment *)experiment attributes:(NSDictionary<NSString *, id> *)attributes {
+    attributes = attributes ?: @{};
+    if (experiment.audienceConditions != nil) {
+        if (experiment.audienceConditions.count == 0) {
+            return true;
+        }
+        return [[experiment evaluateConditionsWithAttributes:attributes projectConfig:self.config] boolValue];
+    }
+    if (experiment.audienceIds.count == 0) {
+        return true;
+    }
+    for (NSString *audienceId in experiment.audienceIds) {
+        if ([[[self.config getAudienceForId:audienceId] evaluateConditionsWithAttributes:attributes projectConfig:self.config] boolValue]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+@end
@@ -16,7 +16,7 @@
 
 #import <Foundation/Foundation.h>
 
-@class OPTLYBucketer, OPTLYEventBuilder, OPTLYEventBuilderDefault, OPTLYProjectConfig, OPTLYDecisionService, OPTLYNotificationCenter;
+@class OPTLYBucketer, OPTLYEventBuilder, OPTLYEventBuilderDefault, OPTLYProjectConfig, OPTLYDecisionService, OPTLYDecisionTrace, OPTLYImpressionDeduplicator, OPTLYNotificationCenter;
 @protocol OPTLYDatafileManager, OPTLYErrorHandler, OPTLYEventBuilder, OPTLYEventDispatcher, OPTLYLogger, OPTLYUserProfileService;
 
 /**
@@ -56,6 +56,16 @@ typedef void (^OPTLYBuilderBlock)(OPTLYBuilder * _Nullable builder);
 @property (nonatomic, strong, nonnull) NSString *clientVersion;
 /// The client engine
 @property (nonatomic, strong, nonnull) NSString *clientEngine;
+/// Defer materializing experiments, audiences and events until they are first used. Defaults to NO.
+@property (nonatomic, readwrite, assign) BOOL lazyDatafileParsing;
+/// If greater than 0, an impression for the same user, experiment and variation is sent at most once within this time (in s). Defaults to 0.
+@property (nonatomic, readwrite, assign) NSTimeInterval impressionDeduplicationWindow;
+/// The impression deduplicator created by the builder, if impressionDeduplicationWindow is set.
+@property (nonatomic, readonly, strong, nullable) OPTLYImpressionDeduplicator *impressionDeduplicator;
+/// If greater than 0, 1 in decisionTraceSampleRate decisions is traced and handed to decisionTraceHandler. Defaults to 0.
+@property (nonatomic, readwrite, assign) NSUInteger decisionTraceSampleRate;
+/// Called on a background queue with each sampled decision trace (see OPTLYDecisionService).
+@property (nonatomic, readwrite, copy, nullable) void (^decisionTraceHandler)(OPTLYDecisionTrace * _Nonnull trace);
 
 
 /// Create an Optimizely Builder object.
@@ -19,6 +19,7 @@
 #import "OPTLYErrorHandler.h"
 #import "OPTLYEventBuilder.h"
 #import "OPTLYEventDispatcherBasic.h"
+#import "OPTLYImpressionDeduplicator.h"
 #import "OPTLYLogger.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYDecisionService.h"
@@ -57,6 +58,7 @@
         builder.errorHandler = self.errorHandler;
         builder.clientEngine = self.clientEngine;
         builder.clientVersion = self.clientVersion;
+        builder.lazyDatafileParsing = self.lazyDatafileParsing;
     }]];
     
     if (_config == nil) {
@@ -74,8 +76,14 @@
     
     _bucketer = [[OPTLYBucketer alloc] initWithConfig:_config];
     _decisionService = [[OPTLYDecisionService alloc] initWithProjectConfig:_config bucketer:_bucketer];
+    _decisionService.decisionTraceHandler = _decisionTraceHandler;
+    _decisionService.decisionTraceSampleRate = _decisionTraceSampleRate;
     _eventBuilder = [[OPTLYEventBuilderDefault alloc] initWithConfig:_config];
     _notificationCenter = [[OPTLYNotificationCenter alloc] initWithProjectConfig:_config];
+    if (_impressionDeduplicationWindow > 0) {
+        _impressionDeduplicator = [[OPTLYImpressionDeduplicator alloc] initWithWindow:_impressionDeduplicationWindow
+                                                                           maxEntries:OPTLYImpressionDeduplicatorDefaultMaxEntries];
+    }
     
     return self;
 }
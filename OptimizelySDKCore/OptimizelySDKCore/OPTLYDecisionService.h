@@ -15,15 +15,26 @@
  ***************************************************************************/
 
 #ifdef UNIVERSAL
+    #import "OPTLYDecisionTrace.h"
     #import "OPTLYJSONModelLib.h"
 #else
+    #import <OptimizelySDKCore/OPTLYDecisionTrace.h>
     #import <OptimizelySDKCore/OPTLYJSONModelLib.h>
 #endif
 
+// The number of preallocated decision traces; decisions sampled while they are all being delivered are not traced
+extern NSUInteger const OPTLYDecisionServiceDecisionTracePoolSize;
+
 @class OPTLYExperiment, OPTLYVariation, OPTLYFeatureFlag, OPTLYFeatureDecision;
 
 @interface OPTLYDecisionService : OPTLYJSONModel
 
+/// If greater than 0, 1 in decisionTraceSampleRate decisions is traced and handed to decisionTraceHandler. Defaults to 0.
+@property (nonatomic, assign) NSUInteger decisionTraceSampleRate;
+
+/// Called on a background queue with each sampled decision trace. The trace is reused after the handler returns.
+@property (nonatomic, copy, nullable) OPTLYDecisionTraceHandler decisionTraceHandler;
+
 /**
  * Initializer for the Decision Service.
  *
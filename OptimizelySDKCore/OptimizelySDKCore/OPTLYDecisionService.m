@@ -14,14 +14,17 @@
  * limitations under the License.                                           *
  ***************************************************************************/
 
+#import <stdatomic.h>
 #import "OPTLYAudience.h"
 #import "OPTLYBucketer.h"
 #import "OPTLYDatafileKeys.h"
 #import "OPTLYDecisionService.h"
+#import "OPTLYDecisionTrace.h"
 #import "OPTLYErrorHandler.h"
 #import "OPTLYExperiment.h"
 #import "OPTLYLogger.h"
 #import "OPTLYLoggerMessages.h"
+#import "OPTLYMetrics.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYUserProfile.h"
 #import "OPTLYUserProfileServiceBasic.h"
@@ -33,12 +36,25 @@
 #import "OPTLYControlAttributes.h"
 #import "OPTLYNSObject+Validation.h"
 
+NSUInteger const OPTLYDecisionServiceDecisionTracePoolSize = 4;
+
+// The trace of the sampled decision being made on this thread; nested decisions record their steps in it
+static __thread __unsafe_unretained OPTLYDecisionTrace *gCurrentDecisionTrace;
+
+static OPTLYDecisionTraceOutcome decisionTraceOutcome(BOOL match) {
+    return match ? OPTLYDecisionTraceOutcomeMatch : OPTLYDecisionTraceOutcomeNoMatch;
+}
+
 @interface OPTLYDecisionService()
 @property (nonatomic, strong) OPTLYProjectConfig *config;
 @property (nonatomic, strong) id<OPTLYBucketer> bucketer;
+@property (nonatomic, strong) NSMutableArray<OPTLYDecisionTrace *> *freeDecisionTraces;
+@property (nonatomic, strong) dispatch_queue_t decisionTraceQueue;
 @end
 
-@implementation OPTLYDecisionService
+@implementation OPTLYDecisionService {
+    atomic_ullong _decisionCount;
+}
 
 - (instancetype) initWithProjectConfig:(OPTLYProjectConfig *)config
                               bucketer:(id<OPTLYBucketer>)bucketer
@@ -54,11 +70,31 @@
 - (OPTLYVariation *)getVariation:(NSString *)userId
                       experiment:(OPTLYExperiment *)experiment
                       attributes:(NSDictionary<NSString *, id> *)attributes
+{
+    uint64_t startTime = [OPTLYMetrics startTime];
+    OPTLYDecisionTrace *trace = _decisionTraceSampleRate > 0 ? [self beginDecisionTraceForUser:userId key:experiment.experimentKey isFeature:NO] : nil;
+    OPTLYVariation *variation = nil;
+    @try {
+        variation = [self decideVariation:userId experiment:experiment attributes:attributes];
+    } @finally {
+        if (trace) {
+            [self endDecisionTrace:trace variationKey:variation.variationKey];
+        }
+    }
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyDecision since:startTime];
+    return variation;
+}
+
+- (OPTLYVariation *)decideVariation:(NSString *)userId
+                         experiment:(OPTLYExperiment *)experiment
+                         attributes:(NSDictionary<NSString *, id> *)attributes
 {
     NSDictionary *userProfileDict = nil;
     OPTLYVariation *bucketedVariation = nil;
     NSString *experimentKey = experiment.experimentKey;
     NSString *experimentId = experiment.experimentId;
+    OPTLYDecisionTrace *trace = _decisionTraceSampleRate > 0 ? gCurrentDecisionTrace : nil;
+    uint64_t stepStartTime = 0;
     
     // Acquire bucketingId .
     NSString *bucketingId = [self getBucketingId:userId attributes:attributes];
@@ -70,20 +106,26 @@
     }
     
     // ---- check for forced variation ----
+    stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
     bucketedVariation = [self.config getForcedVariation:experimentKey userId:userId];
+    [trace recordStep:OPTLYDecisionTraceStepForcedVariation since:stepStartTime outcome:decisionTraceOutcome(bucketedVariation != nil)];
     if (bucketedVariation != nil) {
         return bucketedVariation;
     }
     
     // ---- check if the experiment is whitelisted ----
+    stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
+    OPTLYVariation *whitelistedVariation = nil;
     if ([self checkWhitelistingForUser:userId experiment:experiment]) {
-        OPTLYVariation *whitelistedVariation = [self getWhitelistedVariationForUser:userId experiment:experiment];
-        if (whitelistedVariation) {
-            return whitelistedVariation;
-        }
+        whitelistedVariation = [self getWhitelistedVariationForUser:userId experiment:experiment];
+    }
+    [trace recordStep:OPTLYDecisionTraceStepWhitelist since:stepStartTime outcome:decisionTraceOutcome(whitelistedVariation != nil)];
+    if (whitelistedVariation) {
+        return whitelistedVariation;
     }
     
     // ---- check if a valid variation is stored in the user profile ----
+    stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
     if (self.config.userProfileService) {
         userProfileDict = [self.config.userProfileService lookup:userId];
         NSString *storedVariationId = [self getVariationIdFromUserProfile:userProfileDict
@@ -95,29 +137,38 @@
             // make sure that the variation still exists in the datafile
             OPTLYVariation *storedVariation = [[self.config getExperimentForId:experimentId] getVariationForVariationId:storedVariationId];
             if (storedVariation) {
+                [trace recordStep:OPTLYDecisionTraceStepUserProfileLookup since:stepStartTime outcome:OPTLYDecisionTraceOutcomeMatch];
                 return storedVariation;
             } else {
                 [self.config.logger logMessage:[NSString stringWithFormat:OPTLYLoggerMessagesDecisionServiceSavedVariationInvalid, storedVariation.variationKey]
                                      withLevel:OptimizelyLogLevelDebug];
             }
         }
+        [trace recordStep:OPTLYDecisionTraceStepUserProfileLookup since:stepStartTime outcome:OPTLYDecisionTraceOutcomeNoMatch];
     } else {
         [self.config.logger logMessage:OPTLYLoggerMessagesDecisionServiceUserProfileNotExist
                              withLevel:OptimizelyLogLevelDebug];
     }
     
     // ---- check if the user passes audience targeting before bucketing ----
-    if ([self userPassesTargeting:self.config
-                       experiment:experiment
-                           userId:userId
-                       attributes:attributes]) {
+    stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
+    BOOL userPassesTargeting = [self userPassesTargeting:self.config
+                                              experiment:experiment
+                                                  userId:userId
+                                              attributes:attributes];
+    [trace recordStep:OPTLYDecisionTraceStepAudienceEvaluation since:stepStartTime outcome:decisionTraceOutcome(userPassesTargeting)];
+    if (userPassesTargeting) {
         
         // bucket user into a variation
+        stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
         bucketedVariation = [self.bucketer bucketExperiment:experiment
                                             withBucketingId:bucketingId];
+        [trace recordStep:OPTLYDecisionTraceStepBucketing since:stepStartTime outcome:decisionTraceOutcome(bucketedVariation != nil)];
         
         if (bucketedVariation) {
+            stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
             [self saveUserProfile:userProfileDict variation:bucketedVariation experiment:experiment userId:userId];
+            [trace recordStep:OPTLYDecisionTraceStepUserProfileSave since:stepStartTime outcome:OPTLYDecisionTraceOutcomeMatch];
         }
     }
     
@@ -127,6 +178,22 @@
 - (OPTLYFeatureDecision *)getVariationForFeature:(OPTLYFeatureFlag *)featureFlag
                                           userId:(NSString *)userId
                                       attributes:(NSDictionary<NSString *, id> *)attributes {
+    OPTLYDecisionTrace *trace = _decisionTraceSampleRate > 0 ? [self beginDecisionTraceForUser:userId key:featureFlag.key isFeature:YES] : nil;
+    OPTLYFeatureDecision *decision = nil;
+    @try {
+        decision = [self decideVariationForFeature:featureFlag userId:userId attributes:attributes];
+    } @finally {
+        if (trace) {
+            [self endDecisionTrace:trace variationKey:decision.variation.variationKey];
+        }
+    }
+    return decision;
+}
+
+- (OPTLYFeatureDecision *)decideVariationForFeature:(OPTLYFeatureFlag *)featureFlag
+                                             userId:(NSString *)userId
+                                         attributes:(NSDictionary<NSString *, id> *)attributes {
+    OPTLYDecisionTrace *trace = _decisionTraceSampleRate > 0 ? gCurrentDecisionTrace : nil;
     
     //Evaluate in this order:
     
@@ -145,7 +212,9 @@
     
     //2. Attempt to bucket user into rollout using the feature flag.
     // Check if the feature flag has rollout and the user is bucketed into one of it's rules
+    uint64_t stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
     decision = [self getVariationForFeatureRollout:featureFlag userId:userId attributes:attributes];
+    [trace recordStep:OPTLYDecisionTraceStepRolloutRules since:stepStartTime outcome:decisionTraceOutcome(decision != nil)];
     if (decision) {
         return decision;
     }
@@ -158,6 +227,63 @@
     return decision;
 }
 
+# pragma mark - Decision Tracing
+
+- (void)setDecisionTraceSampleRate:(NSUInteger)decisionTraceSampleRate {
+    @synchronized (self) {
+        // the traces are allocated once, when tracing is first turned on
+        if (decisionTraceSampleRate > 0 && !_freeDecisionTraces) {
+            NSMutableArray *traces = [NSMutableArray arrayWithCapacity:OPTLYDecisionServiceDecisionTracePoolSize];
+            for (NSUInteger i = 0; i < OPTLYDecisionServiceDecisionTracePoolSize; i++) {
+                [traces addObject:[OPTLYDecisionTrace new]];
+            }
+            _freeDecisionTraces = traces;
+            _decisionTraceQueue = dispatch_queue_create("com.Optimizely.decisionTrace", DISPATCH_QUEUE_SERIAL);
+        }
+        _decisionTraceSampleRate = decisionTraceSampleRate;
+    }
+}
+
+// Returns a trace if this decision is sampled and a trace is free
+// A decision made while another is traced on the same thread is part of that trace
+- (OPTLYDecisionTrace *)beginDecisionTraceForUser:(NSString *)userId key:(NSString *)key isFeature:(BOOL)isFeature {
+    NSUInteger sampleRate = self.decisionTraceSampleRate;
+    if (sampleRate == 0 || gCurrentDecisionTrace != nil) {
+        return nil;
+    }
+    if (atomic_fetch_add_explicit(&_decisionCount, 1, memory_order_relaxed) % sampleRate != 0) {
+        return nil;
+    }
+    NSMutableArray<OPTLYDecisionTrace *> *freeTraces = self.freeDecisionTraces;
+    OPTLYDecisionTrace *trace = nil;
+    @synchronized (freeTraces) {
+        trace = [freeTraces lastObject];
+        if (trace) {
+            [freeTraces removeLastObject];
+        }
+    }
+    [trace beginDecisionForUser:userId key:key isFeature:isFeature];
+    gCurrentDecisionTrace = trace;
+    return trace;
+}
+
+// Hands the trace to the handler off the decision path, then frees it
+- (void)endDecisionTrace:(OPTLYDecisionTrace *)trace variationKey:(NSString *)variationKey {
+    [trace endDecisionWithVariationKey:variationKey];
+    gCurrentDecisionTrace = nil;
+    OPTLYDecisionTraceHandler handler = self.decisionTraceHandler;
+    NSMutableArray<OPTLYDecisionTrace *> *freeTraces = self.freeDecisionTraces;
+    dispatch_async(self.decisionTraceQueue, ^{
+        if (handler) {
+            handler(trace);
+        }
+        [trace reset];
+        @synchronized (freeTraces) {
+            [freeTraces addObject:trace];
+        }
+    });
+}
+
 # pragma mark - Helper Methods
 
 - (NSString *)getBucketingId:(NSString *)userId
@@ -208,7 +334,10 @@
         NSString *bucketing_id = [self getBucketingId:userId attributes:attributes];
         OPTLYGroup *group = [self.config getGroupForGroupId:groupId];
         if (group) {
+            OPTLYDecisionTrace *trace = _decisionTraceSampleRate > 0 ? gCurrentDecisionTrace : nil;
+            uint64_t stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
             OPTLYExperiment *experiment = [self getExperimentInGroup:group bucketingId:bucketing_id];
+            [trace recordStep:OPTLYDecisionTraceStepGroupBucketing since:stepStartTime outcome:decisionTraceOutcome(experiment != nil)];
             if (experiment && [featureFlag.experimentIds containsObject:experiment.experimentId]) {
                 OPTLYVariation *variation = [self getVariation:userId experiment:experiment attributes:attributes];
                 if (variation) {
@@ -288,17 +417,24 @@
     if ([rolloutRules getValidArray] == nil) {
         return nil;
     }
+    OPTLYDecisionTrace *trace = _decisionTraceSampleRate > 0 ? gCurrentDecisionTrace : nil;
+    uint64_t stepStartTime = 0;
     // Evaluate all rollout rules except for last one
     for (int i = 0; i < rolloutRules.count - 1; i++) {
         OPTLYExperiment *experiment = rolloutRules[i];
         // Evaluate if user meets the audience condition of this rollout rule
-        if (![self userPassesTargeting:self.config experiment:experiment userId:userId attributes:attributes]) {
+        stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
+        BOOL userPassesTargeting = [self userPassesTargeting:self.config experiment:experiment userId:userId attributes:attributes];
+        [trace recordStep:OPTLYDecisionTraceStepAudienceEvaluation since:stepStartTime outcome:decisionTraceOutcome(userPassesTargeting)];
+        if (!userPassesTargeting) {
             // Evaluate this user for the next rule
             continue;
         }
         
         // Evaluate if user satisfies the traffic allocation for this rollout rule
+        stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
         OPTLYVariation *variation = [self.bucketer bucketExperiment:experiment withBucketingId:bucketing_id];
+        [trace recordStep:OPTLYDecisionTraceStepBucketing since:stepStartTime outcome:decisionTraceOutcome(variation.variationKey != nil)];
         if (!variation || !variation.variationKey) {
             break;
         }
@@ -312,8 +448,13 @@
     }
     // Evaluate fall back rule / last rule now
     OPTLYExperiment *experiment = rolloutRules[rolloutRules.count - 1];
-    if ([self userPassesTargeting:self.config experiment:experiment userId:userId attributes:attributes]) {
+    stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
+    BOOL userPassesTargeting = [self userPassesTargeting:self.config experiment:experiment userId:userId attributes:attributes];
+    [trace recordStep:OPTLYDecisionTraceStepAudienceEvaluation since:stepStartTime outcome:decisionTraceOutcome(userPassesTargeting)];
+    if (userPassesTargeting) {
+        stepStartTime = trace ? [OPTLYDecisionTrace startTime] : 0;
         OPTLYVariation *variation = [self.bucketer bucketExperiment:experiment withBucketingId:bucketing_id];
+        [trace recordStep:OPTLYDecisionTraceStepBucketing since:stepStartTime outcome:decisionTraceOutcome(variation.variationKey != nil)];
         if (variation && variation.variationKey) {
             OPTLYFeatureDecision *decision = [[OPTLYFeatureDecision alloc] initWithExperiment:experiment
                                                                                     variation:variation
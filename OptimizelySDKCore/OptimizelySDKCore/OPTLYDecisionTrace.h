@@ -0,0 +1,140 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class records how long each step of a sampled decision takes and what it decided.
+ OPTLYDecisionService fills a trace for 1 in decisionTraceSampleRate decisions and hands it to
+ its decisionTraceHandler on a background queue. Traces are preallocated and reused: recording
+ a step does not allocate, and a trace must not be kept after the handler returns.
+ */
+
+typedef NS_ENUM(NSUInteger, OPTLYDecisionTraceStep) {
+    // the forced variation set with setForcedVariation
+    OPTLYDecisionTraceStepForcedVariation,
+    // the whitelisted variation of the experiment
+    OPTLYDecisionTraceStepWhitelist,
+    // the user profile service lookup of a saved variation
+    OPTLYDecisionTraceStepUserProfileLookup,
+    // the audience evaluation of an experiment or a rollout rule
+    OPTLYDecisionTraceStepAudienceEvaluation,
+    // bucketing into a variation of an experiment or a rollout rule
+    OPTLYDecisionTraceStepBucketing,
+    // saving the bucketed variation in the user profile service
+    OPTLYDecisionTraceStepUserProfileSave,
+    // bucketing into an experiment of a mutually exclusive group
+    OPTLYDecisionTraceStepGroupBucketing,
+    // walking the rules of a feature rollout, which includes their audience evaluations and bucketing
+    OPTLYDecisionTraceStepRolloutRules,
+    OPTLYDecisionTraceStepCOUNT
+};
+
+typedef NS_ENUM(NSUInteger, OPTLYDecisionTraceOutcome) {
+    // the step did not run
+    OPTLYDecisionTraceOutcomeNotEvaluated,
+    // the step found a variation, an experiment or a passing audience
+    OPTLYDecisionTraceOutcomeMatch,
+    // the step found nothing, so the decision went on to the next step
+    OPTLYDecisionTraceOutcomeNoMatch
+};
+
+// Keys of a step in the trace dictionary
+extern NSString * _Nonnull const OPTLYDecisionTraceCountKey;
+extern NSString * _Nonnull const OPTLYDecisionTraceDurationKey;
+extern NSString * _Nonnull const OPTLYDecisionTraceOutcomeKey;
+
+@class OPTLYDecisionTrace;
+
+typedef void (^OPTLYDecisionTraceHandler)(OPTLYDecisionTrace * _Nonnull trace);
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYDecisionTrace : NSObject
+
+/// The user the decision was made for.
+@property (nonatomic, readonly, strong, nullable) NSString *userId;
+/// The key of the experiment, or of the feature flag if isFeature is YES.
+@property (nonatomic, readonly, strong, nullable) NSString *key;
+/// YES for a feature decision, NO for an experiment decision.
+@property (nonatomic, readonly, assign) BOOL isFeature;
+/// The key of the decided variation, nil if the user was not bucketed.
+@property (nonatomic, readonly, strong, nullable) NSString *variationKey;
+/// The duration (in s) of the whole decision.
+@property (nonatomic, readonly, assign) NSTimeInterval duration;
+
+/**
+ * Returns how many times a step ran. Steps run more than once when a feature decision
+ * evaluates several experiments or rollout rules.
+ */
+- (NSUInteger)countOfStep:(OPTLYDecisionTraceStep)step;
+
+/**
+ * Returns the total duration (in s) of a step.
+ */
+- (NSTimeInterval)durationOfStep:(OPTLYDecisionTraceStep)step;
+
+/**
+ * Returns the outcome of the last run of a step.
+ */
+- (OPTLYDecisionTraceOutcome)outcomeOfStep:(OPTLYDecisionTraceStep)step;
+
+/**
+ * Returns the steps that ran, keyed by step name, with their count, duration (in µs) and outcome.
+ */
+- (NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)steps;
+
+/**
+ * Returns the name of a step as used in steps.
+ */
++ (NSString *)nameOfStep:(OPTLYDecisionTraceStep)step;
+
+/**
+ * Returns the name of an outcome as used in steps.
+ */
++ (NSString *)nameOfOutcome:(OPTLYDecisionTraceOutcome)outcome;
+
+#pragma mark - Recording (used by OPTLYDecisionService)
+
+/**
+ * Returns a start time to pass to recordStep:since:outcome:.
+ */
++ (uint64_t)startTime;
+
+/**
+ * Starts recording a decision.
+ */
+- (void)beginDecisionForUser:(nullable NSString *)userId key:(nullable NSString *)key isFeature:(BOOL)isFeature;
+
+/**
+ * Records a run of a step started at a time returned by startTime.
+ */
+- (void)recordStep:(OPTLYDecisionTraceStep)step since:(uint64_t)startTime outcome:(OPTLYDecisionTraceOutcome)outcome;
+
+/**
+ * Stops recording the decision.
+ */
+- (void)endDecisionWithVariationKey:(nullable NSString *)variationKey;
+
+/**
+ * Clears the trace so that it can be reused.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,139 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import "OPTLYDecisionTrace.h"
+#import "OPTLYTime.h"
+
+NSString * const OPTLYDecisionTraceCountKey = @"count";
+NSString * const OPTLYDecisionTraceDurationKey = @"duration_us";
+NSString * const OPTLYDecisionTraceOutcomeKey = @"outcome";
+
+@interface OPTLYDecisionTrace()
+@property (nonatomic, readwrite, strong, nullable) NSString *userId;
+@property (nonatomic, readwrite, strong, nullable) NSString *key;
+@property (nonatomic, readwrite, assign) BOOL isFeature;
+@property (nonatomic, readwrite, strong, nullable) NSString *variationKey;
+@end
+
+@implementation OPTLYDecisionTrace {
+    uint64_t _startTime;
+    uint64_t _duration;                                     // mach time
+    NSUInteger _stepCounts[OPTLYDecisionTraceStepCOUNT];
+    uint64_t _stepDurations[OPTLYDecisionTraceStepCOUNT];   // mach time
+    OPTLYDecisionTraceOutcome _stepOutcomes[OPTLYDecisionTraceStepCOUNT];
+}
+
++ (uint64_t)startTime {
+    return OPTLYTimeNow();
+}
+
+- (void)beginDecisionForUser:(NSString *)userId key:(NSString *)key isFeature:(BOOL)isFeature {
+    [self reset];
+    self.userId = userId;
+    self.key = key;
+    self.isFeature = isFeature;
+    _startTime = OPTLYTimeNow();
+}
+
+- (void)recordStep:(OPTLYDecisionTraceStep)step since:(uint64_t)startTime outcome:(OPTLYDecisionTraceOutcome)outcome {
+    if (step >= OPTLYDecisionTraceStepCOUNT || startTime == 0) {
+        return;
+    }
+    _stepCounts[step]++;
+    _stepDurations[step] += OPTLYTimeNow() - startTime;
+    _stepOutcomes[step] = outcome;
+}
+
+- (void)endDecisionWithVariationKey:(NSString *)variationKey {
+    self.variationKey = variationKey;
+    _duration = OPTLYTimeNow() - _startTime;
+}
+
+- (void)reset {
+    self.userId = nil;
+    self.key = nil;
+    self.isFeature = NO;
+    self.variationKey = nil;
+    _startTime = 0;
+    _duration = 0;
+    memset(_stepCounts, 0, sizeof(_stepCounts));
+    memset(_stepDurations, 0, sizeof(_stepDurations));
+    memset(_stepOutcomes, 0, sizeof(_stepOutcomes));
+}
+
+- (NSTimeInterval)duration {
+    return (NSTimeInterval)OPTLYTimeNanosecondsFromMachTime(_duration) / NSEC_PER_SEC;
+}
+
+- (NSUInteger)countOfStep:(OPTLYDecisionTraceStep)step {
+    return step < OPTLYDecisionTraceStepCOUNT ? _stepCounts[step] : 0;
+}
+
+- (NSTimeInterval)durationOfStep:(OPTLYDecisionTraceStep)step {
+    if (step >= OPTLYDecisionTraceStepCOUNT) {
+        return 0;
+    }
+    return (NSTimeInterval)OPTLYTimeNanosecondsFromMachTime(_stepDurations[step]) / NSEC_PER_SEC;
+}
+
+- (OPTLYDecisionTraceOutcome)outcomeOfStep:(OPTLYDecisionTraceStep)step {
+    return step < OPTLYDecisionTraceStepCOUNT ? _stepOutcomes[step] : OPTLYDecisionTraceOutcomeNotEvaluated;
+}
+
+- (NSDictionary<NSString *, NSDictionary<NSString *, id> *> *)steps {
+    NSMutableDictionary *steps = [NSMutableDictionary new];
+    for (OPTLYDecisionTraceStep step = 0; step < OPTLYDecisionTraceStepCOUNT; step++) {
+        if (_stepCounts[step] == 0) {
+            continue;
+        }
+        steps[[OPTLYDecisionTrace nameOfStep:step]] = @{
+            OPTLYDecisionTraceCountKey : @(_stepCounts[step]),
+            OPTLYDecisionTraceDurationKey : @(OPTLYTimeNanosecondsFromMachTime(_stepDurations[step]) / NSEC_PER_USEC),
+            OPTLYDecisionTraceOutcomeKey : [OPTLYDecisionTrace nameOfOutcome:_stepOutcomes[step]],
+        };
+    }
+    return [steps copy];
+}
+
++ (NSString *)nameOfStep:(OPTLYDecisionTraceStep)step {
+    switch (step) {
+        case OPTLYDecisionTraceStepForcedVariation: return @"forced_variation";
+        case OPTLYDecisionTraceStepWhitelist: return @"whitelist";
+        case OPTLYDecisionTraceStepUserProfileLookup: return @"user_profile_lookup";
+        case OPTLYDecisionTraceStepAudienceEvaluation: return @"audience_evaluation";
+        case OPTLYDecisionTraceStepBucketing: return @"bucketing";
+        case OPTLYDecisionTraceStepUserProfileSave: return @"user_profile_save";
+        case OPTLYDecisionTraceStepGroupBucketing: return @"group_bucketing";
+        case OPTLYDecisionTraceStepRolloutRules: return @"rollout_rules";
+        default: return @"unknown";
+    }
+}
+
++ (NSString *)nameOfOutcome:(OPTLYDecisionTraceOutcome)outcome {
+    switch (outcome) {
+        case OPTLYDecisionTraceOutcomeMatch: return @"match";
+        case OPTLYDecisionTraceOutcomeNoMatch: return @"no_match";
+        default: return @"not_evaluated";
+    }
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p> userId: %@, key: %@, variationKey: %@, duration: %.6f s, steps: %@",
+            NSStringFromClass([self class]), self, self.userId, self.key, self.variationKey, self.duration, [self steps]];
+}
+
+@end
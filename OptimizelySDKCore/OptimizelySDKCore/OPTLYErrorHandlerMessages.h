@@ -44,6 +44,7 @@ extern NSString * const OPTLYErrorHandlerMessagesTrafficAllocationNotInRange;
 extern NSString * const OPTLYErrorHandlerMessagesBucketingIdInvalid;
 extern NSString * const OPTLYErrorHandlerMessagesTrafficAllocationUnknown;
 extern NSString * const OPTLYErrorHandlerMessagesEventDispatchFailed;
+extern NSString * const OPTLYErrorHandlerMessagesEventPayloadInvalid;
 extern NSString * const OPTLYErrorHandlerMessagesConfigInvalid;
 
 extern NSString * const OPTLYErrorHandlerMessagesManagerBuilderInvalid;
@@ -54,6 +55,9 @@ extern NSString *const OPTLYErrorHandlerMessagesDataStoreInvalidDataStoreEntityV
 extern NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTRetryFailure;
 extern NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerGETRetryFailure;
 extern NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerGETIfModifiedFailure;
+extern NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTServerError;
+extern NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTCircuitOpen;
+extern NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTRetryThrottled;
 extern NSString *const OPTLYErrorHandlerMessagesProjectConfigInvalidAudienceCondition;
 
 
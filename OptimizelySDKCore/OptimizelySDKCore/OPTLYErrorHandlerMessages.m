@@ -44,6 +44,7 @@ NSString * const OPTLYErrorHandlerMessagesTrafficAllocationNotInRange= @"Traffic
 NSString * const OPTLYErrorHandlerMessagesBucketingIdInvalid = @"Invalid bucketing ID: %ld."; // bucketing id
 NSString * const OPTLYErrorHandlerMessagesTrafficAllocationUnknown = @"Traffic allocations for %@ does not exist in datafile."; // experiment or group id
 NSString * const OPTLYErrorHandlerMessagesEventDispatchFailed = @"Event %@ failed to dispatch.";
+NSString * const OPTLYErrorHandlerMessagesEventPayloadInvalid = @"Event payload %@ can not be encoded as JSON.";
 NSString * const OPTLYErrorHandlerMessagesConfigInvalid = @"Project config is nil or invalid.";
 
 // Manager Errors
@@ -58,6 +59,9 @@ NSString *const OPTLYErrorHandlerMessagesDataStoreInvalidDataStoreEntityValue =
 NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTRetryFailure = @"[HTTP] The max backoff retry has been exceeded. POST failed with error: %@.";
 NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerGETRetryFailure = @"[HTTP] The max backoff retry has been exceeded. GET failed with error: %@.";
 NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerGETIfModifiedFailure = @"[HTTP] The max backoff retry has been exceeded. GET if modified failed with error: %@.";
+NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTServerError = @"[HTTP] POST failed with status code: %ld.";
+NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTCircuitOpen = @"[HTTP] POST to %@ was not sent because the endpoint keeps failing. It will be probed again later.";
+NSString *const OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTRetryThrottled = @"[HTTP] POST was not retried because the endpoint keeps failing or the retry budget is exhausted. POST failed with error: %@.";
 
 // ---- Project Config ----
 NSString *const OPTLYErrorHandlerMessagesProjectConfigInvalidAudienceCondition = @"[CONFIG] Invalid audience condition.";
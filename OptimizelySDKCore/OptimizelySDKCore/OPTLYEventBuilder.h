@@ -59,6 +59,41 @@ NS_ASSUME_NONNULL_END
                                                  event:(nonnull OPTLYEvent *)event
                                              eventTags:(nullable NSDictionary *)eventTags
                                             attributes:(nullable NSDictionary<NSString *, id> *)attributes;
+
+@optional
+
+/**
+ * Create the parameters for one impression event covering several experiments.
+ * The visitor and its attributes are sent once, in a single snapshot holding a decision
+ * and an activation event for every experiment.
+ *
+ * @param userId The ID of the user.
+ * @param experiments The experiments.
+ * @param variations The variation of each experiment, in the same order.
+ * @param attributes A map of attribute names to current user attribute values.
+ * @return A map of parameters for an impression event. This value is nil if there are no experiments or the arrays differ in length.
+ *
+ */
+- (nullable NSDictionary *)buildImpressionEventForUser:(nonnull NSString *)userId
+                                           experiments:(nonnull NSArray<OPTLYExperiment *> *)experiments
+                                            variations:(nonnull NSArray<OPTLYVariation *> *)variations
+                                            attributes:(nullable NSDictionary<NSString *, id> *)attributes;
+
+/**
+ * Create the parameters for one conversion event covering several events of the same user.
+ * The visitor and its attributes are sent once, in a single snapshot holding every event.
+ *
+ * @param userId The ID of the user.
+ * @param events The events.
+ * @param eventTags The event tags of each event, in the same order (NSNull for an event without tags).
+ * @param attributes A map of attribute names to current user attribute values.
+ * @return A map of parameters for a conversion event. This value is nil if there are no events or the arrays differ in length.
+ *
+ */
+- (nullable NSDictionary *)buildConversionEventForUser:(nonnull NSString *)userId
+                                                events:(nonnull NSArray<OPTLYEvent *> *)events
+                                             eventTags:(nonnull NSArray *)eventTags
+                                            attributes:(nullable NSDictionary<NSString *, id> *)attributes;
 @end
 
 @interface OPTLYEventBuilderDefault : NSObject<OPTLYEventBuilder>
@@ -1,5 +1,5 @@
 /****************************************************************************
- * Copyright 2016,2018-2019, Optimizely, Inc. and contributors                   *
+ * Copyright 2016,2018-2020, Optimizely, Inc. and contributors                   *
  *                                                                          *
  * Licensed under the Apache License, Version 2.0 (the "License");          *
  * you may not use this file except in compliance with the License.         *
@@ -15,13 +15,16 @@
  ***************************************************************************/
 
 #import "OPTLYControlAttributes.h"
+#import "OPTLYErrorHandlerMessages.h"
 #import "OPTLYEvent.h"
 #import "OPTLYEventBuilder.h"
 #import "OPTLYEventFeature.h"
 #import "OPTLYEventMetric.h"
 #import "OPTLYEventParameterKeys.h"
+#import "OPTLYEventPayload.h"
 #import "OPTLYEventTagUtil.h"
 #import "OPTLYExperiment.h"
+#import "OPTLYJSONWriter.h"
 #import "OPTLYLogger.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYVariation.h"
@@ -32,9 +35,23 @@ NSString * const OptimizelyActivateEventKey = @"campaign_activated";
 // --- Event URLs ----
 NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.com/v1/events";
 
+// The project level parameters of an event, encoded once per datafile revision.
+@interface OPTLYEventEnvelope : NSObject
+@property (nonatomic, strong) NSString *revision;
+/// encoded "key":value members of the event object, without braces
+@property (nonatomic, strong) NSData *members;
+@property (nonatomic, assign) NSUInteger memberCount;
+/// encoded bot filtering feature, or nil if the datafile has no bot filtering setting
+@property (nonatomic, strong) NSData *botFilteringFeature;
+@end
+
+@implementation OPTLYEventEnvelope
+@end
+
 @interface OPTLYEventBuilderDefault ()
 
 @property (readonly, strong) OPTLYProjectConfig *config;
+@property (strong) OPTLYEventEnvelope *envelope;
 
 @end
 
@@ -48,11 +65,10 @@ NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.
     return self;
 }
 
-// NOTE: A dictionary is used to build the decision event ticket object instead of
-// OPTLYDecisionEventTicket object to simplify the logic. The OPTLYEventFeature value can be a
-// string, double, float, int, or boolean.
-// The OPTLYJSONModel cannot support a generic primitive/object type, so each event tag
-// value would have to be manually checked and converted to the appropriate OPTLYEventFeature type.
+// NOTE: The event is written straight into JSON bytes instead of building an NSDictionary tree
+// (or OPTLYDecisionEventTicket object), and returned as an OPTLYEventPayload so it is not
+// serialized again when it is stored and sent. The OPTLYEventFeature value can be a
+// string, double, float, int, or boolean, so attributes and event tags are written as generic values.
 - (NSDictionary *)buildImpressionEventForUser:(NSString *)userId
                                   experiment:(OPTLYExperiment *)experiment
                                    variation:(OPTLYVariation *)variation
@@ -61,11 +77,24 @@ NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.
         return nil;
     }
     
-    NSDictionary *commonParams = [self createCommonParamsForUser:userId attributes:attributes];
-    NSDictionary *impressionOnlyParams = [self createImpressionParamsOfExperiment:experiment variation:variation];
-    NSDictionary *impressionParams = [self createImpressionOrConversionParamsWithCommonParams:commonParams conversionOrImpressionOnlyParams:@[impressionOnlyParams]];
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [self beginCommonParamsForUser:userId attributes:attributes writer:writer];
+    [self writeImpressionParamsOfExperiments:@[experiment] variations:@[variation] writer:writer];
+    return [self endCommonParamsWithWriter:writer];
+}
+
+- (NSDictionary *)buildImpressionEventForUser:(NSString *)userId
+                                 experiments:(NSArray<OPTLYExperiment *> *)experiments
+                                  variations:(NSArray<OPTLYVariation *> *)variations
+                                  attributes:(NSDictionary<NSString *, id> *)attributes {
+    if (!self.config || experiments.count == 0 || experiments.count != variations.count) {
+        return nil;
+    }
     
-    return impressionParams;
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [self beginCommonParamsForUser:userId attributes:attributes writer:writer];
+    [self writeImpressionParamsOfExperiments:experiments variations:variations writer:writer];
+    return [self endCommonParamsWithWriter:writer];
 }
 
 - (NSDictionary *)buildConversionEventForUser:(NSString *)userId
@@ -77,83 +106,132 @@ NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.
         return nil;
     }
     
-    NSDictionary *commonParams = [self createCommonParamsForUser:userId attributes:attributes];
-    NSArray *conversionOnlyParams = [self createConversionParamsOfEvent:event userId:userId
-                                                              eventTags:eventTags
-                                                             attributes:attributes];
-    NSDictionary *conversionParams = [self createImpressionOrConversionParamsWithCommonParams:commonParams conversionOrImpressionOnlyParams:conversionOnlyParams];
-    
-    return conversionParams;
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [self beginCommonParamsForUser:userId attributes:attributes writer:writer];
+    [self writeConversionParamsOfEvents:@[event] eventTags:@[eventTags ?: [NSNull null]] writer:writer];
+    return [self endCommonParamsWithWriter:writer];
 }
 
-- (NSDictionary *)createCommonParamsForUser:(NSString *)userId
-                                 attributes:(NSDictionary<NSString *, id> *)attributes {
-    NSMutableDictionary *commonParams = [NSMutableDictionary new];
-    
-    NSMutableDictionary *visitor = [NSMutableDictionary new];
-    visitor[OPTLYEventParameterKeysSnapshots] =  [NSMutableArray new];
-    visitor[OPTLYEventParameterKeysVisitorId] = [userId getStringOrEmpty];
-    visitor[OPTLYEventParameterKeysAttributes] = [self createUserFeatures:self.config attributes:attributes];
-
-    commonParams[OPTLYEventParameterKeysVisitors] = @[visitor];
-    commonParams[OPTLYEventParameterKeysProjectId] = [self.config.projectId getStringOrEmpty];
-    commonParams[OPTLYEventParameterKeysAccountId] = [self.config.accountId getStringOrEmpty];
-    commonParams[OPTLYEventParameterKeysEnrichDecisions] = @YES;
-
-    commonParams[OPTLYEventParameterKeysClientEngine] = [[self.config clientEngine] getStringOrEmpty];
-    commonParams[OPTLYEventParameterKeysClientVersion] = [[self.config clientVersion] getStringOrEmpty];
-    commonParams[OPTLYEventParameterKeysRevision] = [self.config.revision getStringOrEmpty];
-    commonParams[OPTLYEventParameterKeysAnonymizeIP] = @(self.config.anonymizeIP.boolValue);
+- (NSDictionary *)buildConversionEventForUser:(NSString *)userId
+                                      events:(NSArray<OPTLYEvent *> *)events
+                                   eventTags:(NSArray *)eventTags
+                                  attributes:(NSDictionary<NSString *, id> *)attributes {
+    if (!self.config || events.count == 0 || events.count != eventTags.count) {
+        return nil;
+    }
     
-    return [commonParams copy];
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [self beginCommonParamsForUser:userId attributes:attributes writer:writer];
+    [self writeConversionParamsOfEvents:events eventTags:eventTags writer:writer];
+    return [self endCommonParamsWithWriter:writer];
 }
+
+// Opens the event object and writes the visitor, leaving its snapshots array open.
+- (void)beginCommonParamsForUser:(NSString *)userId
+                      attributes:(NSDictionary<NSString *, id> *)attributes
+                          writer:(OPTLYJSONWriter *)writer {
+    OPTLYEventEnvelope *envelope = [self currentEnvelope];
     
-- (NSDictionary *)createImpressionParamsOfExperiment:(OPTLYExperiment *)experiment variation:(OPTLYVariation *)variation {
-    
-    NSMutableDictionary *snapshot = [NSMutableDictionary new];
+    [writer beginObject];
+    [writer writeKey:OPTLYEventParameterKeysVisitors];
+    [writer beginArray];
+    [writer beginObject];
+    [writer writeKey:OPTLYEventParameterKeysVisitorId];
+    [writer writeString:[userId getStringOrEmpty]];
     
-    NSMutableDictionary *decision = [NSMutableDictionary new];
-    decision[OPTLYEventParameterKeysDecisionCampaignId]     = [experiment.layerId getStringOrEmpty];
-    decision[OPTLYEventParameterKeysDecisionExperimentId]   = experiment.experimentId;
-    decision[OPTLYEventParameterKeysDecisionVariationId]    = variation.variationId;
-    NSArray *decisions = @[decision];
-
-    NSMutableDictionary *event = [NSMutableDictionary new];
-    event[OPTLYEventParameterKeysEntityId]      = [experiment.layerId getStringOrEmpty];
-    event[OPTLYEventParameterKeysTimestamp]     = [self time] ? : @0;
-    event[OPTLYEventParameterKeysKey]           = OptimizelyActivateEventKey;
-    event[OPTLYEventParameterKeysUUID]          = [[NSUUID UUID] UUIDString];
-    NSArray *events = @[event];
-
-    snapshot[OPTLYEventParameterKeysDecisions]  = decisions;
-    snapshot[OPTLYEventParameterKeysEvents]     = events;
+    [writer writeKey:OPTLYEventParameterKeysAttributes];
+    [writer beginArray];
+    [self enumerateUserFeatures:self.config attributes:attributes usingBlock:^(NSString *attributeId, NSString *attributeKey, id attributeValue) {
+        [self writeFeatureWithId:attributeId key:attributeKey value:attributeValue writer:writer];
+    }];
+    if (envelope.botFilteringFeature) {
+        [writer writeEncodedValue:envelope.botFilteringFeature];
+    }
+    [writer endArray];
     
-    return snapshot;
+    [writer writeKey:OPTLYEventParameterKeysSnapshots];
+    [writer beginArray];
 }
 
-- (NSDictionary *)createImpressionOrConversionParamsWithCommonParams:(NSDictionary *)commonParams
-                                 conversionOrImpressionOnlyParams:(NSArray *)conversionOrImpressionOnlyParams {
-    
-    NSMutableArray *visitors = commonParams[OPTLYEventParameterKeysVisitors];
-    if(visitors.count > 0) {
-        visitors[0][OPTLYEventParameterKeysSnapshots] = conversionOrImpressionOnlyParams;
+// Closes the snapshots and visitor, then writes the project level parameters.
+- (NSDictionary *)endCommonParamsWithWriter:(OPTLYJSONWriter *)writer {
+    [writer endArray];
+    [writer endObject];
+    [writer endArray];
+
+    OPTLYEventEnvelope *envelope = [self currentEnvelope];
+    [writer writeEncodedMembers:envelope.members count:envelope.memberCount];
+    [writer endObject];
+
+    NSData *data = [writer copyData];
+    if (!data) {
+        NSString *logMessage = [NSString stringWithFormat:OPTLYErrorHandlerMessagesEventPayloadInvalid, [self.config.revision getStringOrEmpty]];
+        [self.config.logger logMessage:logMessage withLevel:OptimizelyLogLevelError];
+        return nil;
     }
-    return commonParams;
+    return [[OPTLYEventPayload alloc] initWithJSONData:data count:writer.rootKeyCount];
 }
 
-- (NSArray *)createConversionParamsOfEvent:(OPTLYEvent *)event
-                                    userId:(NSString *)userId
-                                 eventTags:(NSDictionary *)eventTags
-                                attributes:(NSDictionary *)attributes {
-    
-    NSMutableArray *conversionEventParams = [NSMutableArray new];
-    NSMutableDictionary *snapshot = [NSMutableDictionary new];
-    
-    NSMutableDictionary *eventDict = [NSMutableDictionary new];
-    eventDict[OPTLYEventParameterKeysEntityId]      = [event.eventId getStringOrEmpty];
-    eventDict[OPTLYEventParameterKeysTimestamp]     = [self time] ? : @0;
-    eventDict[OPTLYEventParameterKeysKey]           = event.eventKey;
-    eventDict[OPTLYEventParameterKeysUUID]          = [[NSUUID UUID] UUIDString];
+// Writes one snapshot with a decision and an activation event per experiment.
+- (void)writeImpressionParamsOfExperiments:(NSArray<OPTLYExperiment *> *)experiments
+                                variations:(NSArray<OPTLYVariation *> *)variations
+                                    writer:(OPTLYJSONWriter *)writer {
+    [writer beginObject];
+
+    [writer writeKey:OPTLYEventParameterKeysDecisions];
+    [writer beginArray];
+    for (NSUInteger i = 0; i < experiments.count; i++) {
+        OPTLYExperiment *experiment = experiments[i];
+        [writer beginObject];
+        [self writeKey:OPTLYEventParameterKeysDecisionCampaignId string:[experiment.layerId getStringOrEmpty] writer:writer];
+        [self writeKey:OPTLYEventParameterKeysDecisionExperimentId string:experiment.experimentId writer:writer];
+        [self writeKey:OPTLYEventParameterKeysDecisionVariationId string:variations[i].variationId writer:writer];
+        [writer endObject];
+    }
+    [writer endArray];
+
+    [writer writeKey:OPTLYEventParameterKeysEvents];
+    [writer beginArray];
+    NSNumber *timestamp = [self time] ? : @0;
+    for (OPTLYExperiment *experiment in experiments) {
+        [writer beginObject];
+        [self writeKey:OPTLYEventParameterKeysEntityId string:[experiment.layerId getStringOrEmpty] writer:writer];
+        [writer writeKey:OPTLYEventParameterKeysTimestamp];
+        [writer writeNumber:timestamp];
+        [self writeKey:OPTLYEventParameterKeysKey string:OptimizelyActivateEventKey writer:writer];
+        [self writeKey:OPTLYEventParameterKeysUUID string:[[NSUUID UUID] UUIDString] writer:writer];
+        [writer endObject];
+    }
+    [writer endArray];
+
+    [writer endObject];
+}
+
+// Writes one snapshot with an event per OPTLYEvent; eventTags holds NSNull for events without tags.
+- (void)writeConversionParamsOfEvents:(NSArray<OPTLYEvent *> *)events
+                            eventTags:(NSArray *)eventTags
+                               writer:(OPTLYJSONWriter *)writer {
+    [writer beginObject];
+    [writer writeKey:OPTLYEventParameterKeysEvents];
+    [writer beginArray];
+    for (NSUInteger i = 0; i < events.count; i++) {
+        NSDictionary *tags = [eventTags[i] isKindOfClass:[NSDictionary class]] ? eventTags[i] : nil;
+        [self writeConversionEvent:events[i] eventTags:tags writer:writer];
+    }
+    [writer endArray];
+    [writer endObject];
+}
+
+- (void)writeConversionEvent:(OPTLYEvent *)event
+                   eventTags:(NSDictionary *)eventTags
+                      writer:(OPTLYJSONWriter *)writer {
+    [writer beginObject];
+
+    [self writeKey:OPTLYEventParameterKeysEntityId string:[event.eventId getStringOrEmpty] writer:writer];
+    [writer writeKey:OPTLYEventParameterKeysTimestamp];
+    [writer writeNumber:[self time] ? : @0];
+    [self writeKey:OPTLYEventParameterKeysKey string:event.eventKey writer:writer];
+    [self writeKey:OPTLYEventParameterKeysUUID string:[[NSUUID UUID] UUIDString] writer:writer];
     
     if (eventTags) {
         // remove tags if their types are not supported
@@ -162,24 +240,93 @@ NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.
         // Allow only 'revenue' eventTags with integer values (max long long); otherwise the value will be cast to an integer
         NSNumber *revenueValue = [OPTLYEventTagUtil getRevenueValue:filteredEventTags logger:self.config.logger];
         if (revenueValue != nil) {
-            eventDict[OPTLYEventMetricNameRevenue] = revenueValue;
+            [writer writeKey:OPTLYEventMetricNameRevenue];
+            [writer writeNumber:revenueValue];
         }
         // Allow only 'value' eventTags with double values; otherwise the value will be cast to a double
         NSNumber *numericValue = [OPTLYEventTagUtil getNumericValue:filteredEventTags logger:self.config.logger];
         if (numericValue != nil) {
-            eventDict[OPTLYEventMetricNameValue] = numericValue;
+            [writer writeKey:OPTLYEventMetricNameValue];
+            [writer writeNumber:numericValue];
         }
         
         if (filteredEventTags.count > 0) {
-            eventDict[OPTLYEventParameterKeysTags] = filteredEventTags;
+            [writer writeKey:OPTLYEventParameterKeysTags];
+            [writer writeValue:filteredEventTags];
         }
     }
     
-    snapshot[OPTLYEventParameterKeysEvents] = @[eventDict];
+    [writer endObject];
+}
+
+- (void)writeFeatureWithId:(NSString *)featureId
+                       key:(NSString *)featureKey
+                     value:(id)value
+                    writer:(OPTLYJSONWriter *)writer {
+    [writer beginObject];
+    [writer writeKey:OPTLYEventParameterKeysFeaturesId];
+    [writer writeString:featureId];
+    [writer writeKey:OPTLYEventParameterKeysFeaturesKey];
+    [writer writeString:featureKey];
+    [writer writeKey:OPTLYEventParameterKeysFeaturesType];
+    [writer writeString:OPTLYEventFeatureFeatureTypeCustomAttribute];
+    [writer writeKey:OPTLYEventParameterKeysFeaturesValue];
+    [writer writeValue:value];
+    [writer writeKey:OPTLYEventParameterKeysFeaturesShouldIndex];
+    [writer writeBool:YES];
+    [writer endObject];
+}
+
+// Returns the envelope of the config's revision, encoding it the first time.
+- (OPTLYEventEnvelope *)currentEnvelope {
+    NSString *revision = [self.config.revision getStringOrEmpty];
+    OPTLYEventEnvelope *envelope = self.envelope;
+    if (envelope && [envelope.revision isEqualToString:revision]) {
+        return envelope;
+    }
+    
+    envelope = [OPTLYEventEnvelope new];
+    envelope.revision = revision;
     
-    [conversionEventParams addObject:snapshot];
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter new];
+    [writer beginObject];
+    [writer writeKey:OPTLYEventParameterKeysProjectId];
+    [writer writeString:[self.config.projectId getStringOrEmpty]];
+    [writer writeKey:OPTLYEventParameterKeysAccountId];
+    [writer writeString:[self.config.accountId getStringOrEmpty]];
+    [writer writeKey:OPTLYEventParameterKeysEnrichDecisions];
+    [writer writeBool:YES];
+    [writer writeKey:OPTLYEventParameterKeysClientEngine];
+    [writer writeString:[[self.config clientEngine] getStringOrEmpty]];
+    [writer writeKey:OPTLYEventParameterKeysClientVersion];
+    [writer writeString:[[self.config clientVersion] getStringOrEmpty]];
+    [writer writeKey:OPTLYEventParameterKeysRevision];
+    [writer writeString:revision];
+    [writer writeKey:OPTLYEventParameterKeysAnonymizeIP];
+    [writer writeBool:self.config.anonymizeIP.boolValue];
+    [writer endObject];
+    NSData *data = [writer copyData];
+    envelope.members = [data subdataWithRange:NSMakeRange(1, data.length - 2)];
+    envelope.memberCount = writer.rootKeyCount;
+    
+    //check for botFiltering value in the project config file.
+    NSNumber *botFiltering = self.config.botFiltering;
+    if (botFiltering) {
+        [writer reset];
+        [self writeFeatureWithId:OptimizelyBotFiltering key:OptimizelyBotFiltering value:@(botFiltering.boolValue) writer:writer];
+        envelope.botFilteringFeature = [writer copyData];
+    }
     
-    return [conversionEventParams copy];
+    self.envelope = envelope;
+    return envelope;
+}
+
+// Writes a string field, leaving it out when the value is nil.
+- (void)writeKey:(NSString *)key string:(NSString *)value writer:(OPTLYJSONWriter *)writer {
+    if (value != nil) {
+        [writer writeKey:key];
+        [writer writeString:value];
+    }
 }
 
 - (NSDictionary *)filterEventTags:(NSDictionary *)eventTags {
@@ -203,9 +350,29 @@ NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.
     
     NSNumber *botFiltering = config.botFiltering;
     NSMutableArray *features = [NSMutableArray new];
-    NSArray *attributeKeys = [attributes allKeys];
-    
-    for (NSString *attributeKey in attributeKeys) {
+    [self enumerateUserFeatures:config attributes:attributes usingBlock:^(NSString *attributeId, NSString *attributeKey, id attributeValue) {
+        [features addObject: @{ OPTLYEventParameterKeysFeaturesId           : attributeId,
+                                OPTLYEventParameterKeysFeaturesKey          : attributeKey,
+                                OPTLYEventParameterKeysFeaturesType         : OPTLYEventFeatureFeatureTypeCustomAttribute,
+                                OPTLYEventParameterKeysFeaturesValue        : attributeValue,
+                                OPTLYEventParameterKeysFeaturesShouldIndex  : @YES }];
+    }];
+    //check for botFiltering value in the project config file.
+    if (botFiltering) {
+        [features addObject:@{ OPTLYEventParameterKeysFeaturesId           : OptimizelyBotFiltering,
+                               OPTLYEventParameterKeysFeaturesKey          : OptimizelyBotFiltering,
+                               OPTLYEventParameterKeysFeaturesType         : OPTLYEventFeatureFeatureTypeCustomAttribute,
+                               OPTLYEventParameterKeysFeaturesValue        : @(botFiltering.boolValue),
+                               OPTLYEventParameterKeysFeaturesShouldIndex  : @YES }];
+    }
+    return [features copy];
+}
+
+// Calls the block for every attribute that has a valid value and a datafile attribute id.
+- (void)enumerateUserFeatures:(OPTLYProjectConfig *)config
+                   attributes:(NSDictionary<NSString *, id> *)attributes
+                   usingBlock:(void (^)(NSString *attributeId, NSString *attributeKey, id attributeValue))block {
+    for (NSString *attributeKey in attributes) {
         NSObject *attributeValue = attributes[attributeKey];
         if (![attributeValue isValidAttributeValue]) {
             NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesAttributeValueInvalidFormat, attributeKey];
@@ -217,23 +384,9 @@ NSString * const OPTLYEventBuilderEventsTicketURL   = @"https://logx.optimizely.
             NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesAttributeInvalidFormat, attributeKey];
             [config.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
             continue;
-        } else {
-            [features addObject: @{ OPTLYEventParameterKeysFeaturesId           : attributeId,
-                                    OPTLYEventParameterKeysFeaturesKey          : attributeKey,
-                                    OPTLYEventParameterKeysFeaturesType         : OPTLYEventFeatureFeatureTypeCustomAttribute,
-                                    OPTLYEventParameterKeysFeaturesValue        : attributeValue,
-                                    OPTLYEventParameterKeysFeaturesShouldIndex  : @YES }];
         }
+        block(attributeId, attributeKey, attributeValue);
     }
-    //check for botFiltering value in the project config file.
-    if (botFiltering) {
-        [features addObject:@{ OPTLYEventParameterKeysFeaturesId           : OptimizelyBotFiltering,
-                               OPTLYEventParameterKeysFeaturesKey          : OptimizelyBotFiltering,
-                               OPTLYEventParameterKeysFeaturesType         : OPTLYEventFeatureFeatureTypeCustomAttribute,
-                               OPTLYEventParameterKeysFeaturesValue        : @(botFiltering.boolValue),
-                               OPTLYEventParameterKeysFeaturesShouldIndex  : @YES }];
-    }
-    return [features copy];
 }
 
 // time in milliseconds
@@ -0,0 +1,50 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class is the event parameters dictionary returned by OPTLYEventBuilderDefault.
+ It holds the compact JSON bytes the event was encoded into, so the event can be
+ stored and sent without being serialized again. The dictionary contents are only
+ decoded from the bytes when they are first read.
+ */
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYEventPayload : NSDictionary
+
+/// The encoded JSON object.
+@property (nonatomic, strong, readonly, nullable) NSData *JSONData;
+
+/**
+ * Initializes the payload with encoded JSON bytes.
+ *
+ * @param data The compact JSON encoding of an object.
+ * @param count The number of keys of the object, or NSNotFound if unknown.
+ * @return An instance of the payload.
+ */
+- (instancetype)initWithJSONData:(NSData *)data count:(NSUInteger)count;
+
+/**
+ * Returns a payload for event bytes read back from storage, or nil if the bytes
+ * were not written by OPTLYJSONWriter and have to be parsed instead.
+ */
++ (nullable instancetype)payloadWithStoredJSONData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
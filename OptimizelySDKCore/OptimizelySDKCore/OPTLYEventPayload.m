@@ -0,0 +1,127 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import "OPTLYEventPayload.h"
+#import "OPTLYJSONWriter.h"
+
+@interface OPTLYEventPayload() {
+    NSUInteger _count;
+    NSDictionary *_decodedDictionary;
+}
+@end
+
+@implementation OPTLYEventPayload
+
++ (instancetype)payloadWithStoredJSONData:(NSData *)data {
+    // OPTLYJSONWriter never writes whitespace, so a compact, non-empty object starts with {" and ends with }.
+    // Rows saved by older versions are pretty printed and fail this check.
+    const char *bytes = data.bytes;
+    NSUInteger length = data.length;
+    if (length < 4 || bytes[0] != '{' || bytes[1] != '"' || bytes[length - 1] != '}') {
+        return nil;
+    }
+    return [[self alloc] initWithJSONData:data count:NSNotFound];
+}
+
+- (instancetype)initWithJSONData:(NSData *)data count:(NSUInteger)count {
+    self = [super init];
+    if (self != nil) {
+        _JSONData = [data copy];
+        _count = count;
+    }
+    return self;
+}
+
+- (instancetype)initWithObjects:(const id _Nonnull [])objects
+                        forKeys:(const id<NSCopying> _Nonnull [])keys
+                          count:(NSUInteger)count {
+    NSDictionary *dictionary = [[NSDictionary alloc] initWithObjects:objects forKeys:keys count:count];
+    NSData *data = [OPTLYJSONWriter dataWithJSONObject:dictionary error:nil];
+    self = [self initWithJSONData:data count:dictionary.count];
+    if (self != nil) {
+        _decodedDictionary = dictionary;
+    }
+    return self;
+}
+
+# pragma mark - NSDictionary
+
+- (NSUInteger)count {
+    if (_count != NSNotFound) {
+        return _count;
+    }
+    return [self decodedDictionary].count;
+}
+
+- (id)objectForKey:(id)aKey {
+    return [[self decodedDictionary] objectForKey:aKey];
+}
+
+- (NSEnumerator *)keyEnumerator {
+    return [[self decodedDictionary] keyEnumerator];
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    // immutable
+    return self;
+}
+
+// Two payloads are equal when their bytes are; other dictionaries are compared by content.
+- (BOOL)isEqual:(id)object {
+    if (object == self) {
+        return YES;
+    }
+    if ([object isKindOfClass:[OPTLYEventPayload class]] && self.JSONData && [object JSONData]) {
+        return [self.JSONData isEqualToData:[object JSONData]];
+    }
+    return [super isEqual:object];
+}
+
+- (NSUInteger)hash {
+    return self.count;
+}
+
+- (NSString *)description {
+    if (!self.JSONData) {
+        return [[self decodedDictionary] description];
+    }
+    return [[NSString alloc] initWithData:self.JSONData encoding:NSUTF8StringEncoding];
+}
+
+- (NSString *)descriptionWithLocale:(id)locale {
+    return [self description];
+}
+
+- (NSString *)descriptionWithLocale:(id)locale indent:(NSUInteger)level {
+    return [self description];
+}
+
+# pragma mark - Helper Methods
+
+- (NSDictionary *)decodedDictionary {
+    @synchronized (self) {
+        if (!_decodedDictionary) {
+            id object = nil;
+            if (self.JSONData) {
+                object = [NSJSONSerialization JSONObjectWithData:self.JSONData options:0 error:nil];
+            }
+            _decodedDictionary = [object isKindOfClass:[NSDictionary class]] ? object : @{};
+        }
+        return _decodedDictionary;
+    }
+}
+
+@end
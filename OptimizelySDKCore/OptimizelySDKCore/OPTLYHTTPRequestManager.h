@@ -22,10 +22,26 @@
 
 #import <Foundation/Foundation.h>
 
+@class OPTLYRequestThrottle;
+
 typedef void (^OPTLYHTTPRequestManagerResponse)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error);
 
+// Default minimum POST body size (in bytes) that is gzip compressed when compression is enabled
+extern const NSUInteger OPTLYHTTPRequestManagerDefaultCompressionThreshold;
+// Upper bound (in ms) of a single POST backoff retry delay
+extern const NSInteger OPTLYHTTPRequestManagerMaxBackoffRetryDelay_ms;
+
 @interface OPTLYHTTPRequestManager : NSObject
 
+/// If YES, POST bodies of at least compressionThreshold bytes are sent with Content-Encoding: gzip. Defaults to NO.
+@property (atomic, assign) BOOL compressionEnabled;
+/// The minimum POST body size (in bytes) to compress.
+@property (atomic, assign) NSUInteger compressionThreshold;
+/// Retry budget and circuit breaker for POST requests. Assign the same throttle to several managers to share them.
+@property (atomic, strong, nonnull) OPTLYRequestThrottle *throttle;
+/// The maximum number of simultaneous connections to a host. All requests share one session, so connections are reused. 0 uses the system default.
+@property (nonatomic, assign) NSInteger maximumConnectionsPerHost;
+
 /**
  * GET data from the URL inititialized
  *
@@ -106,7 +122,43 @@ typedef void (^OPTLYHTTPRequestManagerResponse)(NSData * _Nullable data, NSURLRe
          completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
 
 /**
- * POST data with parameters
+ * A GET response with the following conditions:
+ * If the requested variant still has the entity tag in the "If-None-Match" field, or
+ * has not been modified since the time in the "If-Modified-Since" field, an entity will
+ * not be returned from the server; instead, a 304 (not modified) response will be
+ * returned without any message-body. The entity tag takes precedence when both are set.
+ *
+ * @param lastModifiedDate The date since the URL request was last modified
+ * @param entityTag The ETag of the last response
+ * @param url The url to make the GET request.
+ * @param completion The completion block of type OPTLYHTTPRequestManagerResponse
+ */
+- (void)GETIfModifiedSince:(nullable NSString *)lastModifiedDate
+               ifNoneMatch:(nullable NSString *)entityTag
+                       url:(nonnull NSURL *)url
+         completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
+
+/**
+ * A GET with an exponential backoff and retry attempt given the "If-None-Match" and
+ * "If-Modified-Since" conditions of GETIfModifiedSince:ifNoneMatch:url:completionHandler:.
+ *
+ * @param lastModifiedDate The date since the URL request was last modified
+ * @param entityTag The ETag of the last response
+ * @param url The url to make the GET request.
+ * @param backoffRetryInterval The backoff retry time interval the exponential backoff (in ms)
+ * @param retries The total number of backoff retry attempts
+ * @param completion The completion block of type OPTLYHTTPRequestManagerResponse
+ */
+- (void)GETIfModifiedSince:(nullable NSString *)lastModifiedDate
+               ifNoneMatch:(nullable NSString *)entityTag
+                       url:(nonnull NSURL *)url
+      backoffRetryInterval:(NSInteger)backoffRetryInterval
+                   retries:(NSInteger)retries
+         completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
+
+/**
+ * POST data with parameters. The request is not sent (and completes with an error)
+ * while the throttle's circuit breaker is open.
  *
  * @param url The url to make the POST request.
  * @param parameters Dictionary of POST request parameter values
@@ -117,11 +169,13 @@ typedef void (^OPTLYHTTPRequestManagerResponse)(NSData * _Nullable data, NSURLRe
          completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
 
 /**
- * POST data with parameters with an exponential backoff and retry attempt
+ * POST data with parameters with a jittered backoff and retry attempt.
+ * Network and server (5xx) errors are retried while the throttle allows it;
+ * the delay is drawn between backoffRetryInterval and three times the previous delay.
  *
  * @param url The url to make the POST request.
  * @param parameters Dictionary of POST request parameter values
- * @param backoffRetryInterval The backoff retry time interval the exponential backoff (in ms)
+ * @param backoffRetryInterval The minimum backoff retry delay (in ms)
  * @param retries The total number of backoff retry attempts
  * @param completion The completion block of type OPTLYHTTPRequestManagerResponse
  */
@@ -14,20 +14,30 @@
  * limitations under the License.                                           *
  ***************************************************************************/
 
+#include <zlib.h>
 #import "OPTLYErrorHandlerMessages.h"
 #import "OPTLYHTTPRequestManager.h"
+#import "OPTLYJSONWriter.h"
 #import "OPTLYLog.h"
 #import "OPTLYLoggerMessages.h"
+#import "OPTLYRequestThrottle.h"
 
 static NSString * const kHTTPRequestMethodGet = @"GET";
 static NSString * const kHTTPRequestMethodPost = @"POST";
 static NSString * const kHTTPHeaderFieldContentType = @"Content-Type";
 static NSString * const kHTTPHeaderFieldValueApplicationJSON = @"application/json";
+static NSString * const kHTTPHeaderFieldContentEncoding = @"Content-Encoding";
+static NSString * const kHTTPHeaderFieldValueGzip = @"gzip";
+
+const NSUInteger OPTLYHTTPRequestManagerDefaultCompressionThreshold = 1024;
+const NSInteger OPTLYHTTPRequestManagerMaxBackoffRetryDelay_ms = 30000;
 
 @interface OPTLYHTTPRequestManager()
 
 - (NSURLSession *)session;
 
+/// created on first use and shared by all requests, so connections to a host are reused
+@property (nonatomic, strong) NSURLSession *sharedSession;
 // Use this flag to deterine if we are running a unit test
 // The flag is needed to track some values for unit test
 @property (nonatomic, assign) BOOL isRunningTest;
@@ -38,19 +48,36 @@ static NSString * const kHTTPHeaderFieldValueApplicationJSON = @"application/jso
 @implementation OPTLYHTTPRequestManager
 
 - (NSURLSession *)session {
-    NSURLSession *ephemeralSession = nil;
-    
-    @try {
-        ephemeralSession = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration ephemeralSessionConfiguration]];
-        ephemeralSession.configuration.TLSMinimumSupportedProtocol = kTLSProtocol12;
-
+    @synchronized (self) {
+        if (self.sharedSession) {
+            return self.sharedSession;
+        }
+        
+        @try {
+            // session.configuration returns a copy, so settings must be made before the session is created
+            NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+            configuration.TLSMinimumSupportedProtocol = kTLSProtocol12;
+            if (self.maximumConnectionsPerHost > 0) {
+                configuration.HTTPMaximumConnectionsPerHost = self.maximumConnectionsPerHost;
+            }
+            self.sharedSession = [NSURLSession sessionWithConfiguration:configuration];
+        }
+        @catch (NSException *e) {
+            OPTLYLogError(e.description);
+            //return self.backgroundSession;
+        }
+        
+        return self.sharedSession;
     }
-    @catch (NSException *e) {
-        OPTLYLogError(e.description);
-        //return self.backgroundSession;
+}
+
+- (void)setMaximumConnectionsPerHost:(NSInteger)maximumConnectionsPerHost {
+    @synchronized (self) {
+        _maximumConnectionsPerHost = maximumConnectionsPerHost;
+        // requests already running keep the old session until they complete
+        [self.sharedSession finishTasksAndInvalidate];
+        self.sharedSession = nil;
     }
-    
-    return ephemeralSession;
 }
 
 - (NSURLSession *)backgroundSession {
@@ -73,9 +100,18 @@ static NSString * const kHTTPHeaderFieldValueApplicationJSON = @"application/jso
     NSAssert(YES, @"Use initWithURL initialization method.");
     _isRunningTest = [self runningUnitTests];
     self = [super init];
+    if (self != nil) {
+        _compressionThreshold = OPTLYHTTPRequestManagerDefaultCompressionThreshold;
+        _throttle = [OPTLYRequestThrottle new];
+    }
     return self;
 }
 
+- (void)dealloc
+{
+    [_sharedSession finishTasksAndInvalidate];
+}
+
 // Create global serial GCD queue for NSURL tasks
 dispatch_queue_t networkTasksQueue()
 {
@@ -205,9 +241,21 @@ dispatch_queue_t networkTasksQueue()
 - (void)GETIfModifiedSince:(NSString *)lastModifiedDate
                        url:(NSURL *)url
          completionHandler:(OPTLYHTTPRequestManagerResponse)completion
+{
+    [self GETIfModifiedSince:lastModifiedDate
+                 ifNoneMatch:nil
+                         url:url
+           completionHandler:completion];
+}
+
+- (void)GETIfModifiedSince:(NSString *)lastModifiedDate
+               ifNoneMatch:(NSString *)entityTag
+                       url:(NSURL *)url
+         completionHandler:(OPTLYHTTPRequestManagerResponse)completion
 {
     NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
     [request setValue:lastModifiedDate forHTTPHeaderField:@"If-Modified-Since"];
+    [request setValue:entityTag forHTTPHeaderField:@"If-None-Match"];
     
     NSURLSessionDataTask *dataTask = [self.session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
         if (completion) {
@@ -223,12 +271,28 @@ dispatch_queue_t networkTasksQueue()
       backoffRetryInterval:(NSInteger)backoffRetryInterval
                    retries:(NSInteger)retries
          completionHandler:(OPTLYHTTPRequestManagerResponse)completion
+{
+    [self GETIfModifiedSince:lastModifiedDate
+                 ifNoneMatch:nil
+                         url:url
+        backoffRetryInterval:backoffRetryInterval
+                     retries:retries
+           completionHandler:completion];
+}
+
+- (void)GETIfModifiedSince:(NSString *)lastModifiedDate
+               ifNoneMatch:(NSString *)entityTag
+                       url:(NSURL *)url
+      backoffRetryInterval:(NSInteger)backoffRetryInterval
+                   retries:(NSInteger)retries
+         completionHandler:(OPTLYHTTPRequestManagerResponse)completion
 {
     if (self.isRunningTest == YES) {
         self.delaysTest = [NSMutableArray new];
     }
     
     [self GETIfModifiedSince:lastModifiedDate
+                 ifNoneMatch:entityTag
                          url:url
         backoffRetryInterval:backoffRetryInterval
                      retries:retries
@@ -238,6 +302,7 @@ dispatch_queue_t networkTasksQueue()
 }
 
 - (void)GETIfModifiedSince:(NSString *)lastModifiedDate
+               ifNoneMatch:(NSString *)entityTag
                        url:(NSURL *)url
       backoffRetryInterval:(NSInteger)backoffRetryInterval
                    retries:(NSInteger)retries
@@ -269,6 +334,7 @@ dispatch_queue_t networkTasksQueue()
     
     __weak typeof(self) weakSelf = self;
     [self GETIfModifiedSince:lastModifiedDate
+                 ifNoneMatch:entityTag
                          url:url
            completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
                NSInteger statusCode = 503;
@@ -281,6 +347,7 @@ dispatch_queue_t networkTasksQueue()
                                                  backoffRetryInterval:backoffRetryInterval];
                    dispatch_after(delayTime, networkTasksQueue(), ^(void){
                        [weakSelf GETIfModifiedSince:lastModifiedDate
+                                        ifNoneMatch:entityTag
                                                 url:url
                                backoffRetryInterval:backoffRetryInterval
                                             retries:retries
@@ -305,10 +372,10 @@ dispatch_queue_t networkTasksQueue()
     NSMutableURLRequest *request = [[NSMutableURLRequest alloc] initWithURL:url];
     [request setHTTPMethod:kHTTPRequestMethodPost];
     
+    // event payloads built by OPTLYEventBuilderDefault are already encoded
     NSError *JSONSerializationError = nil;
-    NSData *data = [NSJSONSerialization dataWithJSONObject:parameters
-                                                   options:kNilOptions error:&JSONSerializationError];
-    if (JSONSerializationError) {
+    NSData *data = [OPTLYJSONWriter dataWithJSONObject:parameters error:&JSONSerializationError];
+    if (!data) {
         if (completion) {
             completion(nil, nil, JSONSerializationError);
         }
@@ -317,9 +384,36 @@ dispatch_queue_t networkTasksQueue()
     
     [request addValue:kHTTPHeaderFieldValueApplicationJSON forHTTPHeaderField:kHTTPHeaderFieldContentType];
     
+    if (self.compressionEnabled && data.length >= self.compressionThreshold) {
+        NSData *compressedData = [self gzipData:data];
+        // send the JSON as is if compression failed or didn't pay off
+        if (compressedData.length > 0 && compressedData.length < data.length) {
+            data = compressedData;
+            [request addValue:kHTTPHeaderFieldValueGzip forHTTPHeaderField:kHTTPHeaderFieldContentEncoding];
+        }
+    }
+    
+    OPTLYRequestThrottle *throttle = self.throttle;
+    if (![throttle beginRequest]) {
+        if (completion) {
+            NSString *errorMessage = [NSString stringWithFormat:OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTCircuitOpen, url];
+            NSError *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                                 code:OPTLYErrorTypesHTTPRequestManager
+                                             userInfo:@{ NSLocalizedDescriptionKey : errorMessage }];
+            OPTLYLogDebug(errorMessage);
+            completion(nil, nil, error);
+        }
+        return;
+    }
+    
     NSURLSessionUploadTask *uploadTask = [self.session uploadTaskWithRequest:request
                                                                         fromData:data
                                                                completionHandler:^(NSData *data,NSURLResponse *response,NSError *error) {
+                                                                   if (error || [self serverErrorForResponse:response]) {
+                                                                       [throttle recordFailure];
+                                                                   } else {
+                                                                       [throttle recordSuccess];
+                                                                   }
                                                                    if (completion) {
                                                                        completion(data, response, error);
                                                                    }
@@ -344,6 +438,7 @@ dispatch_queue_t networkTasksQueue()
                      retries:retries
            completionHandler:completion
          backoffRetryAttempt:0
+            previousDelay_ms:0
                        error:nil];
 }
 
@@ -353,6 +448,7 @@ dispatch_queue_t networkTasksQueue()
                    retries:(NSInteger)retries
          completionHandler:(OPTLYHTTPRequestManagerResponse)completion
        backoffRetryAttempt:(NSInteger)backoffRetryAttempt
+          previousDelay_ms:(uint64_t)previousDelay_ms
                      error:(NSError *)error
 {
     OPTLYLogDebug(OPTLYHTTPRequestManagerPOSTWithParameters, backoffRetryAttempt);
@@ -382,28 +478,87 @@ dispatch_queue_t networkTasksQueue()
     [self POSTWithParameters:parameters
                          url:url
            completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-               if (error) {
-                   dispatch_time_t delayTime = [weakSelf backoffDelay:backoffRetryAttempt
-                                                 backoffRetryInterval:backoffRetryInterval];
-                   dispatch_after(delayTime, networkTasksQueue(), ^(void){
-                       [weakSelf POSTWithParameters:parameters
-                                                url:url
-                               backoffRetryInterval:backoffRetryInterval
-                                            retries:retries
-                                  completionHandler:completion
-                                backoffRetryAttempt:backoffRetryAttempt+1
-                                              error:error];
-                   });
-               } else {
+               NSError *failure = error ?: [weakSelf serverErrorForResponse:response];
+               if (!failure) {
                    if (completion) {
                        completion(data, response, error);
                    }
+                   return;
+               }
+               
+               // the last attempt failed, report it without waiting
+               if (backoffRetryAttempt >= retries) {
+                   [weakSelf POSTWithParameters:parameters
+                                            url:url
+                           backoffRetryInterval:backoffRetryInterval
+                                        retries:retries
+                              completionHandler:completion
+                            backoffRetryAttempt:backoffRetryAttempt+1
+                               previousDelay_ms:previousDelay_ms
+                                          error:failure];
+                   return;
+               }
+               
+               // a retry would only add load to an endpoint that keeps failing
+               OPTLYRequestThrottle *throttle = weakSelf.throttle;
+               if (throttle.circuitState != OPTLYCircuitStateClosed || ![throttle acquireRetryToken]) {
+                   if (completion) {
+                       NSString *errorMessage = [NSString stringWithFormat:OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTRetryThrottled, failure];
+                       NSError *throttledError = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                                                     code:OPTLYErrorTypesHTTPRequestManager
+                                                                 userInfo:@{ NSLocalizedDescriptionKey : errorMessage }];
+                       OPTLYLogDebug(errorMessage);
+                       completion(nil, nil, throttledError);
+                   }
+                   if (weakSelf.isRunningTest == YES) {
+                       weakSelf.delaysTest = nil;
+                   }
+                   return;
                }
+               
+               uint64_t delay_ms = [weakSelf jitteredBackoffDelay:backoffRetryAttempt
+                                                 previousDelay_ms:previousDelay_ms
+                                             backoffRetryInterval:backoffRetryInterval];
+               dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay_ms * NSEC_PER_MSEC), networkTasksQueue(), ^(void){
+                   [weakSelf POSTWithParameters:parameters
+                                            url:url
+                           backoffRetryInterval:backoffRetryInterval
+                                        retries:retries
+                              completionHandler:completion
+                            backoffRetryAttempt:backoffRetryAttempt+1
+                               previousDelay_ms:delay_ms
+                                          error:failure];
+               });
            }];
 }
 
 # pragma mark - Helper Methods
 
+// deflate with a gzip wrapper (RFC 1952), which is what Content-Encoding: gzip expects
+- (NSData *)gzipData:(NSData *)data {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+    
+    uLong bound = deflateBound(&stream, (uLong)data.length);
+    NSMutableData *compressedData = [NSMutableData dataWithLength:bound];
+    stream.next_in = (Bytef *)data.bytes;
+    stream.avail_in = (uInt)data.length;
+    stream.next_out = (Bytef *)compressedData.mutableBytes;
+    stream.avail_out = (uInt)bound;
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+    
+    if (status != Z_STREAM_END) {
+        OPTLYLogError(@"Unable to compress POST body: %d", status);
+        return nil;
+    }
+    compressedData.length = stream.total_out;
+    return compressedData;
+}
+
 - (BOOL)runningUnitTests {
     BOOL isRunningTest = NSClassFromString(@"XCTestCase") != nil;
     return isRunningTest;
@@ -428,6 +583,44 @@ dispatch_queue_t networkTasksQueue()
     return delayTime;
 }
 
+// decorrelated jitter: a random delay between the retry interval and three times the previous delay,
+// so retries of events that failed together spread out instead of arriving in waves
+- (uint64_t)jitteredBackoffDelay:(NSInteger)backoffRetryAttempt
+                previousDelay_ms:(uint64_t)previousDelay_ms
+            backoffRetryInterval:(NSInteger)backoffRetryInterval
+{
+    uint64_t base_ms = MAX(backoffRetryInterval, 0);
+    uint64_t max_ms = MAX((uint64_t)OPTLYHTTPRequestManagerMaxBackoffRetryDelay_ms, base_ms);
+    uint64_t upper_ms = MIN(MAX(previousDelay_ms, base_ms) * 3, max_ms);
+    uint64_t delay_ms = base_ms + arc4random_uniform((uint32_t)(upper_ms - base_ms + 1));
+    
+    OPTLYLogDebug(OPTLYHTTPRequestManagerJitteredBackoffRetryStates, (long)backoffRetryAttempt, previousDelay_ms, delay_ms);
+    
+    if (self.isRunningTest == YES) {
+        if ([self.delaysTest count] >= backoffRetryAttempt) {
+            self.delaysTest[backoffRetryAttempt] = [NSNumber numberWithLongLong:delay_ms * NSEC_PER_MSEC];
+        }
+    }
+    
+    return delay_ms;
+}
+
+// server errors count as failures; other status codes mean the endpoint is up
+- (NSError *)serverErrorForResponse:(NSURLResponse *)response
+{
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return nil;
+    }
+    NSInteger statusCode = ((NSHTTPURLResponse *)response).statusCode;
+    if (statusCode < 500 && statusCode != 429) {
+        return nil;
+    }
+    NSString *errorMessage = [NSString stringWithFormat:OPTLYErrorHandlerMessagesHTTPRequestManagerPOSTServerError, (long)statusCode];
+    return [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                               code:OPTLYErrorTypesHTTPRequestManager
+                           userInfo:@{ NSLocalizedDescriptionKey : errorMessage }];
+}
+
 - (NSURL *)buildQueryURL:(NSURL *)url
           withParameters:(NSDictionary *)parameters
 {
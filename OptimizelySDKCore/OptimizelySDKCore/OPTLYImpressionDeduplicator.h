@@ -0,0 +1,93 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class remembers the (user, experiment, variation) impressions sent recently, so
+ the same impression is not sent again every time a decision is made.
+ Impressions are kept as 64-bit hashes in two generations of a set: a generation is
+ rotated out once it is older than the window, or once it holds half of maxEntries.
+ An impression is therefore remembered for at least one window, unless more than
+ maxEntries/2 distinct impressions are seen in that window.
+ An impression is reserved when it is checked, and the reservation is cancelled if the
+ impression could not be sent, so it is not suppressed when it is retried.
+ All methods are thread-safe.
+ */
+
+// Default time (in s) an impression is remembered
+extern const NSTimeInterval OPTLYImpressionDeduplicatorDefaultWindow;
+// Default max number of impressions remembered
+extern const NSUInteger OPTLYImpressionDeduplicatorDefaultMaxEntries;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYImpressionDeduplicator : NSObject
+
+@property (nonatomic, assign, readonly) NSTimeInterval window;
+@property (nonatomic, assign, readonly) NSUInteger maxEntries;
+/// The number of impressions that were let through and not cancelled.
+@property (atomic, assign, readonly) NSUInteger numberOfSentImpressions;
+/// The number of duplicate impressions that were suppressed.
+@property (atomic, assign, readonly) NSUInteger numberOfSuppressedImpressions;
+
+/**
+ * Initializes a deduplicator with the default window and size.
+ */
+- (instancetype)init;
+
+/**
+ * Initializes a deduplicator.
+ *
+ * @param window The time (in s) an impression is remembered.
+ * @param maxEntries The max number of impressions remembered.
+ * @return An instance of the deduplicator.
+ */
+- (instancetype)initWithWindow:(NSTimeInterval)window
+                    maxEntries:(NSUInteger)maxEntries NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Asks to send an impression and, if it should be sent, remembers it.
+ *
+ * @param userId The user the impression is for.
+ * @param experimentId The id of the experiment.
+ * @param variationId The id of the variation.
+ * @return NO if the same impression was let through within the window.
+ */
+- (BOOL)shouldSendImpressionForUser:(NSString *)userId
+                       experimentId:(NSString *)experimentId
+                        variationId:(NSString *)variationId;
+
+/**
+ * Forgets an impression that was let through but could not be sent.
+ *
+ * @param userId The user the impression is for.
+ * @param experimentId The id of the experiment.
+ * @param variationId The id of the variation.
+ */
+- (void)cancelImpressionForUser:(NSString *)userId
+                   experimentId:(NSString *)experimentId
+                    variationId:(NSString *)variationId;
+
+/**
+ * Forgets all impressions. The counters are kept.
+ */
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
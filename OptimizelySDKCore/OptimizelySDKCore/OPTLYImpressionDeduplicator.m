@@ -0,0 +1,136 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import "OPTLYImpressionDeduplicator.h"
+
+const NSTimeInterval OPTLYImpressionDeduplicatorDefaultWindow = 60;
+const NSUInteger OPTLYImpressionDeduplicatorDefaultMaxEntries = 10000;
+
+static uint64_t const kFNVOffsetBasis = 14695981039346656037ULL;
+static uint64_t const kFNVPrime = 1099511628211ULL;
+
+@interface OPTLYImpressionDeduplicator()
+@property (atomic, assign) NSUInteger numberOfSentImpressions;
+@property (atomic, assign) NSUInteger numberOfSuppressedImpressions;
+@property (nonatomic, strong) NSMutableSet<NSNumber *> *currentImpressions;
+@property (nonatomic, strong) NSMutableSet<NSNumber *> *previousImpressions;
+/// system uptime when the current generation started
+@property (nonatomic, assign) NSTimeInterval currentStartedAt;
+@end
+
+@implementation OPTLYImpressionDeduplicator
+
+- (instancetype)init {
+    return [self initWithWindow:OPTLYImpressionDeduplicatorDefaultWindow
+                     maxEntries:OPTLYImpressionDeduplicatorDefaultMaxEntries];
+}
+
+- (instancetype)initWithWindow:(NSTimeInterval)window
+                    maxEntries:(NSUInteger)maxEntries {
+    self = [super init];
+    if (self != nil) {
+        _window = MAX(window, 0);
+        _maxEntries = MAX(maxEntries, 2);
+        _currentImpressions = [NSMutableSet new];
+        _previousImpressions = [NSMutableSet new];
+        _currentStartedAt = [self now];
+    }
+    return self;
+}
+
+- (BOOL)shouldSendImpressionForUser:(NSString *)userId
+                       experimentId:(NSString *)experimentId
+                        variationId:(NSString *)variationId {
+    NSNumber *impression = @([self hashOfUser:userId experimentId:experimentId variationId:variationId]);
+    @synchronized (self) {
+        [self rotateIfNeeded];
+        if ([self.currentImpressions containsObject:impression] || [self.previousImpressions containsObject:impression]) {
+            self.numberOfSuppressedImpressions++;
+            return NO;
+        }
+        // reserved in the same critical section so concurrent sends of the same impression let only one through
+        [self.currentImpressions addObject:impression];
+        self.numberOfSentImpressions++;
+        return YES;
+    }
+}
+
+- (void)cancelImpressionForUser:(NSString *)userId
+                   experimentId:(NSString *)experimentId
+                    variationId:(NSString *)variationId {
+    NSNumber *impression = @([self hashOfUser:userId experimentId:experimentId variationId:variationId]);
+    @synchronized (self) {
+        if (![self.currentImpressions containsObject:impression] && ![self.previousImpressions containsObject:impression]) {
+            return;
+        }
+        [self.currentImpressions removeObject:impression];
+        [self.previousImpressions removeObject:impression];
+        self.numberOfSentImpressions--;
+    }
+}
+
+- (void)reset {
+    @synchronized (self) {
+        [self.currentImpressions removeAllObjects];
+        [self.previousImpressions removeAllObjects];
+        self.currentStartedAt = [self now];
+    }
+}
+
+# pragma mark - Helper Methods
+
+// Must be called while synchronized on self.
+- (void)rotateIfNeeded {
+    NSTimeInterval age = [self now] - self.currentStartedAt;
+    if (age < self.window && self.currentImpressions.count < self.maxEntries / 2) {
+        return;
+    }
+    // after an idle gap of two windows even the current generation has expired
+    if (age >= 2 * self.window) {
+        [self.currentImpressions removeAllObjects];
+        [self.previousImpressions removeAllObjects];
+        self.currentStartedAt = [self now];
+        return;
+    }
+    NSMutableSet<NSNumber *> *expiredImpressions = self.previousImpressions;
+    [expiredImpressions removeAllObjects];
+    self.previousImpressions = self.currentImpressions;
+    self.currentImpressions = expiredImpressions;
+    self.currentStartedAt = [self now];
+}
+
+// FNV-1a over the UTF-8 bytes of the ids, separated by a 0 byte so ("ab","c") and ("a","bc") differ
+- (uint64_t)hashOfUser:(NSString *)userId
+          experimentId:(NSString *)experimentId
+           variationId:(NSString *)variationId {
+    uint64_t hash = kFNVOffsetBasis;
+    for (NSString *string in @[userId ?: @"", experimentId ?: @"", variationId ?: @""]) {
+        const char *bytes = string.UTF8String;
+        for (const char *c = bytes; c && *c; c++) {
+            hash ^= (uint8_t)*c;
+            hash *= kFNVPrime;
+        }
+        hash *= kFNVPrime;
+    }
+    return hash;
+}
+
+- (NSTimeInterval)now {
+    return [[NSProcessInfo processInfo] systemUptime];
+}
+
+@end
@@ -0,0 +1,98 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ This is a streaming JSON writer that encodes compact UTF-8 JSON straight into a byte buffer.
+ The buffer keeps its capacity across reset, so a writer can be reused for every event
+ without building an intermediate NSDictionary/NSArray tree.
+ A writer is not thread-safe; use threadLocalWriter to get one per thread.
+ */
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYJSONWriter : NSObject
+
+/// The encoded bytes. Only valid until the writer is reset or written to again.
+@property (nonatomic, strong, readonly) NSData *buffer;
+/// Number of keys written to the outermost object.
+@property (nonatomic, assign, readonly) NSUInteger rootKeyCount;
+/// Set when an invalid value was written (e.g. NaN, an unsupported class or unbalanced containers).
+@property (nonatomic, assign, readonly) BOOL failed;
+
+/**
+ * Returns a writer owned by the current thread, reset and ready to be written to.
+ */
++ (instancetype)threadLocalWriter;
+
+/**
+ * Encodes a Foundation JSON object (NSDictionary, NSArray, NSString, NSNumber, NSNull).
+ *
+ * @param object The object to encode.
+ * @param error Set if the object can not be encoded.
+ * @return The compact JSON bytes, or nil if the object can not be encoded.
+ */
++ (nullable NSData *)dataWithJSONObject:(id)object
+                                  error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Clears the written bytes and state, keeping the buffer capacity.
+ */
+- (void)reset;
+
+- (void)beginObject;
+- (void)endObject;
+- (void)beginArray;
+- (void)endArray;
+
+/**
+ * Writes an object key. It must be followed by exactly one value.
+ */
+- (void)writeKey:(NSString *)key;
+
+- (void)writeString:(nullable NSString *)string;
+- (void)writeNumber:(nullable NSNumber *)number;
+- (void)writeBool:(BOOL)value;
+- (void)writeLongLong:(long long)value;
+- (void)writeNull;
+
+/**
+ * Writes any Foundation JSON object, recursing into dictionaries and arrays.
+ */
+- (void)writeValue:(nullable id)value;
+
+/**
+ * Writes a value that was encoded earlier, e.g. by another writer.
+ */
+- (void)writeEncodedValue:(NSData *)value;
+
+/**
+ * Writes object members that were encoded earlier into the current object.
+ *
+ * @param members Encoded `"key":value` pairs separated by commas, without the braces.
+ * @param count The number of members.
+ */
+- (void)writeEncodedMembers:(NSData *)members count:(NSUInteger)count;
+
+/**
+ * Returns a copy of the encoded bytes, or nil if the writer failed or has unclosed containers.
+ */
+- (nullable NSData *)copyData;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,413 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#import "OPTLYErrorHandlerMessages.h"
+#import "OPTLYEventPayload.h"
+#import "OPTLYJSONWriter.h"
+
+static NSString * const kThreadLocalWriterKey = @"OPTLYJSONWriter";
+// buffers that grew beyond this size are not kept around by reset
+static NSUInteger const kMaxRetainedBufferSize = 64 * 1024;
+// containers nested deeper than this are rejected
+static NSUInteger const kMaxDepth = 64;
+static NSUInteger const kStringChunkSize = 256;
+
+typedef NS_OPTIONS(uint8_t, OPTLYJSONContainerState) {
+    OPTLYJSONContainerStateObject = 1 << 0,
+    OPTLYJSONContainerStateHasElements = 1 << 1,
+};
+
+@interface OPTLYJSONWriter() {
+    NSMutableData *_data;
+    OPTLYJSONContainerState _stack[kMaxDepth];
+    NSUInteger _depth;
+    BOOL _expectingValue;
+    BOOL _rootWritten;
+}
+@end
+
+@implementation OPTLYJSONWriter
+
++ (instancetype)threadLocalWriter {
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    OPTLYJSONWriter *writer = threadDictionary[kThreadLocalWriterKey];
+    if (!writer) {
+        writer = [OPTLYJSONWriter new];
+        threadDictionary[kThreadLocalWriterKey] = writer;
+    }
+    [writer reset];
+    return writer;
+}
+
++ (NSData *)dataWithJSONObject:(id)object error:(NSError * __autoreleasing *)error {
+    // payloads are already encoded
+    if ([object isKindOfClass:[OPTLYEventPayload class]] && [object JSONData]) {
+        return [object JSONData];
+    }
+
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter new];
+    [writer writeValue:object];
+    NSData *data = [writer copyData];
+    if (!data && error) {
+        NSString *description = [NSString stringWithFormat:OPTLYErrorHandlerMessagesEventPayloadInvalid, object];
+        *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                     code:OPTLYErrorTypesEventDispatch
+                                 userInfo:@{NSLocalizedDescriptionKey : description}];
+    }
+    return data;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self != nil) {
+        _data = [[NSMutableData alloc] initWithCapacity:1024];
+    }
+    return self;
+}
+
+- (NSData *)buffer {
+    return _data;
+}
+
+- (void)reset {
+    if (_data.length > kMaxRetainedBufferSize) {
+        _data = [[NSMutableData alloc] initWithCapacity:1024];
+    } else {
+        _data.length = 0;
+    }
+    _depth = 0;
+    _expectingValue = NO;
+    _rootWritten = NO;
+    _rootKeyCount = 0;
+    _failed = NO;
+}
+
+- (NSData *)copyData {
+    if (_failed || _depth != 0 || !_rootWritten) {
+        return nil;
+    }
+    return [_data copy];
+}
+
+# pragma mark - Containers
+
+- (void)beginObject {
+    [self beginContainer:OPTLYJSONContainerStateObject byte:'{'];
+}
+
+- (void)endObject {
+    [self endContainer:OPTLYJSONContainerStateObject byte:'}'];
+}
+
+- (void)beginArray {
+    [self beginContainer:0 byte:'['];
+}
+
+- (void)endArray {
+    [self endContainer:0 byte:']'];
+}
+
+- (void)beginContainer:(OPTLYJSONContainerState)state byte:(char)byte {
+    if (![self prepareForValue]) {
+        return;
+    }
+    if (_depth == kMaxDepth) {
+        _failed = YES;
+        return;
+    }
+    _stack[_depth++] = state;
+    [_data appendBytes:&byte length:1];
+}
+
+- (void)endContainer:(OPTLYJSONContainerState)state byte:(char)byte {
+    if (_failed) {
+        return;
+    }
+    if (_depth == 0
+        || (_stack[_depth - 1] & OPTLYJSONContainerStateObject) != state
+        || _expectingValue) {
+        _failed = YES;
+        return;
+    }
+    _depth--;
+    [_data appendBytes:&byte length:1];
+}
+
+- (void)writeKey:(NSString *)key {
+    if (_failed) {
+        return;
+    }
+    if (_depth == 0
+        || !(_stack[_depth - 1] & OPTLYJSONContainerStateObject)
+        || _expectingValue
+        || ![key isKindOfClass:[NSString class]]) {
+        _failed = YES;
+        return;
+    }
+    [self appendSeparator];
+    [self appendString:key];
+    [_data appendBytes:":" length:1];
+    _expectingValue = YES;
+    if (_depth == 1) {
+        _rootKeyCount++;
+    }
+}
+
+# pragma mark - Values
+
+- (void)writeString:(NSString *)string {
+    if (!string) {
+        [self writeNull];
+        return;
+    }
+    if ([self prepareForValue]) {
+        [self appendString:string];
+    }
+}
+
+- (void)writeNumber:(NSNumber *)number {
+    if (!number) {
+        [self writeNull];
+        return;
+    }
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        [self writeBool:number.boolValue];
+        return;
+    }
+    if (![self prepareForValue]) {
+        return;
+    }
+
+    char buffer[32];
+    int length = 0;
+    if ([number isKindOfClass:[NSDecimalNumber class]]) {
+        if ([number isEqualToNumber:[NSDecimalNumber notANumber]]) {
+            _failed = YES;
+            return;
+        }
+        NSString *stringValue = [number stringValue];
+        [_data appendBytes:stringValue.UTF8String length:[stringValue lengthOfBytesUsingEncoding:NSUTF8StringEncoding]];
+        return;
+    }
+
+    switch (number.objCType[0]) {
+        case 'f':
+        case 'd': {
+            double value = number.doubleValue;
+            if (!isfinite(value)) {
+                _failed = YES;
+                return;
+            }
+            // shortest of the two precisions that survives a round trip
+            length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+            if (strtod(buffer, NULL) != value) {
+                length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+            }
+            break;
+        }
+        case 'C':
+        case 'S':
+        case 'I':
+        case 'L':
+        case 'Q':
+            length = snprintf(buffer, sizeof(buffer), "%llu", number.unsignedLongLongValue);
+            break;
+        default:
+            length = snprintf(buffer, sizeof(buffer), "%lld", number.longLongValue);
+            break;
+    }
+    [_data appendBytes:buffer length:length];
+}
+
+- (void)writeBool:(BOOL)value {
+    if ([self prepareForValue]) {
+        if (value) {
+            [_data appendBytes:"true" length:4];
+        } else {
+            [_data appendBytes:"false" length:5];
+        }
+    }
+}
+
+- (void)writeLongLong:(long long)value {
+    if ([self prepareForValue]) {
+        char buffer[24];
+        int length = snprintf(buffer, sizeof(buffer), "%lld", value);
+        [_data appendBytes:buffer length:length];
+    }
+}
+
+- (void)writeNull {
+    if ([self prepareForValue]) {
+        [_data appendBytes:"null" length:4];
+    }
+}
+
+- (void)writeValue:(id)value {
+    if (_failed) {
+        return;
+    }
+    if (!value || value == [NSNull null]) {
+        [self writeNull];
+    } else if ([value isKindOfClass:[NSString class]]) {
+        [self writeString:value];
+    } else if ([value isKindOfClass:[NSNumber class]]) {
+        [self writeNumber:value];
+    } else if ([value isKindOfClass:[OPTLYEventPayload class]] && [value JSONData]) {
+        [self writeEncodedValue:[value JSONData]];
+    } else if ([value isKindOfClass:[NSDictionary class]]) {
+        [self beginObject];
+        [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+            [self writeKey:key];
+            [self writeValue:obj];
+            *stop = self->_failed;
+        }];
+        [self endObject];
+    } else if ([value isKindOfClass:[NSArray class]]) {
+        [self beginArray];
+        for (id element in (NSArray *)value) {
+            [self writeValue:element];
+            if (_failed) {
+                break;
+            }
+        }
+        [self endArray];
+    } else {
+        _failed = YES;
+    }
+}
+
+- (void)writeEncodedValue:(NSData *)value {
+    if ([self prepareForValue]) {
+        [_data appendData:value];
+    }
+}
+
+- (void)writeEncodedMembers:(NSData *)members count:(NSUInteger)count {
+    if (_failed || count == 0) {
+        return;
+    }
+    if (_depth == 0
+        || !(_stack[_depth - 1] & OPTLYJSONContainerStateObject)
+        || _expectingValue) {
+        _failed = YES;
+        return;
+    }
+    [self appendSeparator];
+    [_data appendData:members];
+    if (_depth == 1) {
+        _rootKeyCount += count;
+    }
+}
+
+# pragma mark - Helper Methods
+
+// Writes the comma between container elements and checks that a value is allowed here.
+- (BOOL)prepareForValue {
+    if (_failed) {
+        return NO;
+    }
+    if (_depth == 0) {
+        if (_rootWritten) {
+            _failed = YES;
+            return NO;
+        }
+        _rootWritten = YES;
+        return YES;
+    }
+    if (_stack[_depth - 1] & OPTLYJSONContainerStateObject) {
+        if (!_expectingValue) {
+            _failed = YES;
+            return NO;
+        }
+        _expectingValue = NO;
+        return YES;
+    }
+    [self appendSeparator];
+    return YES;
+}
+
+- (void)appendSeparator {
+    if (_stack[_depth - 1] & OPTLYJSONContainerStateHasElements) {
+        [_data appendBytes:"," length:1];
+    } else {
+        _stack[_depth - 1] |= OPTLYJSONContainerStateHasElements;
+    }
+}
+
+- (void)appendString:(NSString *)string {
+    [_data appendBytes:"\"" length:1];
+
+    uint8_t chunk[kStringChunkSize];
+    NSRange remaining = NSMakeRange(0, string.length);
+    while (remaining.length > 0) {
+        NSUInteger usedLength = 0;
+        NSRange next = NSMakeRange(0, 0);
+        // unpaired surrogates are replaced rather than failing the whole event
+        BOOL converted = [string getBytes:chunk
+                                maxLength:kStringChunkSize
+                               usedLength:&usedLength
+                                 encoding:NSUTF8StringEncoding
+                                  options:NSStringEncodingConversionAllowLossy
+                                    range:remaining
+                           remainingRange:&next];
+        if (!converted || next.location == remaining.location) {
+            _failed = YES;
+            return;
+        }
+        [self appendEscapedUTF8:chunk length:usedLength];
+        remaining = next;
+    }
+
+    [_data appendBytes:"\"" length:1];
+}
+
+- (void)appendEscapedUTF8:(const uint8_t *)bytes length:(NSUInteger)length {
+    static const char hex[] = "0123456789abcdef";
+    NSUInteger runStart = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        uint8_t byte = bytes[i];
+        if (byte >= 0x20 && byte != '"' && byte != '\\') {
+            continue;
+        }
+        if (i > runStart) {
+            [_data appendBytes:bytes + runStart length:i - runStart];
+        }
+        runStart = i + 1;
+
+        switch (byte) {
+            case '"': [_data appendBytes:"\\\"" length:2]; break;
+            case '\\': [_data appendBytes:"\\\\" length:2]; break;
+            case '\b': [_data appendBytes:"\\b" length:2]; break;
+            case '\f': [_data appendBytes:"\\f" length:2]; break;
+            case '\n': [_data appendBytes:"\\n" length:2]; break;
+            case '\r': [_data appendBytes:"\\r" length:2]; break;
+            case '\t': [_data appendBytes:"\\t" length:2]; break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 0xF] };
+                [_data appendBytes:escaped length:6];
+                break;
+            }
+        }
+    }
+    if (length > runStart) {
+        [_data appendBytes:bytes + runStart length:length - runStart];
+    }
+}
+
+@end
@@ -0,0 +1,91 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class keeps the raw datafile entries of one entity type (experiments, audiences, events)
+ and indexes only their ids and keys up front. The OPTLYJSONModel object for an entry is
+ built the first time it is requested and cached, so every caller gets the same instance.
+ Materialization is thread-safe. An entry that fails to materialize is reported once,
+ then looked up as a missing entity.
+ */
+
+@protocol OPTLYErrorHandler, OPTLYLogger;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYLazyEntityMap : NSObject
+
+/// The model class entries are materialized into.
+@property (nonatomic, strong, readonly) Class modelClass;
+/// Ids of the raw entries, in datafile order.
+@property (nonatomic, strong, readonly) NSArray<NSString *> *entityIds;
+/// Handles the error of an entry that fails to materialize.
+@property (nonatomic, strong, nullable) id<OPTLYErrorHandler> errorHandler;
+/// Logs the entries that fail to materialize.
+@property (nonatomic, strong, nullable) id<OPTLYLogger> logger;
+
+/**
+ * Initializes the map with raw datafile entries.
+ *
+ * @param entries The raw JSON dictionaries of the entity type.
+ * @param modelClass The OPTLYJSONModel subclass to materialize entries into.
+ * @param idKey The datafile key holding the entity id.
+ * @param keyKey The datafile key holding the entity key, or nil.
+ * @param error Set if an entry is missing a valid id or key.
+ * @return An instance of the map, or nil if the entries could not be indexed.
+ */
+- (nullable instancetype)initWithEntries:(NSArray *)entries
+                              modelClass:(Class)modelClass
+                                   idKey:(NSString *)idKey
+                                  keyKey:(nullable NSString *)keyKey
+                                   error:(NSError * __autoreleasing *)error;
+
+/**
+ * Registers an already materialized entity, e.g. an experiment that belongs to a group.
+ * Registered entities are returned by lookups but are not part of `allEntities`.
+ */
+- (void)addEntity:(id)entity entityId:(NSString *)entityId entityKey:(nullable NSString *)entityKey;
+
+/**
+ * Returns the entity id for a key without materializing the entity.
+ */
+- (nullable NSString *)entityIdForKey:(NSString *)entityKey;
+
+/**
+ * Returns the entity for an id, materializing it on first access.
+ */
+- (nullable id)entityForId:(NSString *)entityId;
+
+/**
+ * Returns the entity for a key, materializing it on first access.
+ */
+- (nullable id)entityForKey:(NSString *)entityKey;
+
+/**
+ * Materializes (if needed) and returns all raw entries in datafile order.
+ */
+- (NSArray *)allEntities;
+
+/**
+ * Number of entries that have been materialized so far.
+ */
+- (NSUInteger)materializedCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,201 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#ifdef UNIVERSAL
+    #import "OPTLYJSONModelLib.h"
+#else
+    #import <OptimizelySDKCore/OPTLYJSONModelLib.h>
+#endif
+#import "OPTLYErrorHandler.h"
+#import "OPTLYErrorHandlerMessages.h"
+#import "OPTLYLazyEntityMap.h"
+#import "OPTLYLogger.h"
+#import "OPTLYLoggerMessages.h"
+
+@interface OPTLYLazyEntityMap()
+/// entityId --> raw JSON dictionary
+@property (nonatomic, strong) NSDictionary<NSString *, NSDictionary *> *rawEntries;
+/// entityId --> materialized model (NSNull if the entry failed to materialize)
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *materializedEntities;
+/// entityKey --> entityId, including registered entities
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSString *> *mutableKeyToIdMap;
+/// cached result of allEntities
+@property (nonatomic, strong) NSArray *cachedAllEntities;
+@end
+
+@implementation OPTLYLazyEntityMap
+
+- (instancetype)initWithEntries:(NSArray *)entries
+                     modelClass:(Class)modelClass
+                          idKey:(NSString *)idKey
+                         keyKey:(NSString *)keyKey
+                          error:(NSError * __autoreleasing *)error {
+    self = [super init];
+    if (self != nil) {
+        NSMutableDictionary *rawEntries = [[NSMutableDictionary alloc] initWithCapacity:entries.count];
+        NSMutableArray *entityIds = [[NSMutableArray alloc] initWithCapacity:entries.count];
+        NSMutableDictionary *keyToIdMap = [[NSMutableDictionary alloc] initWithCapacity:entries.count];
+
+        for (NSDictionary *entry in entries) {
+            BOOL isDictionary = [entry isKindOfClass:[NSDictionary class]];
+            NSString *entityId = isDictionary ? entry[idKey] : nil;
+            NSString *entityKey = (isDictionary && keyKey != nil) ? entry[keyKey] : nil;
+            if (![entityId isKindOfClass:[NSString class]]
+                || (keyKey != nil && ![entityKey isKindOfClass:[NSString class]])) {
+                if (error) {
+                    NSString *description = [NSString stringWithFormat:@"%@ entry is missing a valid \"%@\".", NSStringFromClass(modelClass), entityId ? keyKey : idKey];
+                    *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                                 code:OPTLYErrorTypesDatafileInvalid
+                                             userInfo:@{NSLocalizedDescriptionKey : description}];
+                }
+                return nil;
+            }
+            rawEntries[entityId] = entry;
+            [entityIds addObject:entityId];
+            if (entityKey) {
+                keyToIdMap[entityKey] = entityId;
+            }
+        }
+
+        _modelClass = modelClass;
+        _rawEntries = [rawEntries copy];
+        _entityIds = [entityIds copy];
+        _mutableKeyToIdMap = keyToIdMap;
+        _materializedEntities = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+- (void)addEntity:(id)entity entityId:(NSString *)entityId entityKey:(NSString *)entityKey {
+    if (!entity || !entityId) {
+        return;
+    }
+    @synchronized (self) {
+        self.materializedEntities[entityId] = entity;
+        if (entityKey) {
+            self.mutableKeyToIdMap[entityKey] = entityId;
+        }
+    }
+}
+
+- (NSString *)entityIdForKey:(NSString *)entityKey {
+    if (!entityKey) {
+        return nil;
+    }
+    @synchronized (self) {
+        return self.mutableKeyToIdMap[entityKey];
+    }
+}
+
+- (id)entityForId:(NSString *)entityId {
+    if (!entityId) {
+        return nil;
+    }
+    id entity = nil;
+    NSError *error = nil;
+    @synchronized (self) {
+        entity = self.materializedEntities[entityId];
+        if (!entity) {
+            NSDictionary *rawEntry = self.rawEntries[entityId];
+            if (!rawEntry) {
+                return nil;
+            }
+            entity = [self materializeEntry:rawEntry error:&error] ?: [NSNull null];
+            self.materializedEntities[entityId] = entity;
+        }
+    }
+    // reported outside of the lock, the error handler may look up other entities
+    if (error) {
+        [self reportInvalidEntry:entityId error:error];
+    }
+    return (entity == [NSNull null]) ? nil : entity;
+}
+
+- (id)entityForKey:(NSString *)entityKey {
+    return [self entityForId:[self entityIdForKey:entityKey]];
+}
+
+- (NSArray *)allEntities {
+    NSArray<NSString *> *entityIds = nil;
+    @synchronized (self) {
+        if (self.cachedAllEntities) {
+            return self.cachedAllEntities;
+        }
+        entityIds = [self.entityIds copy];
+    }
+    // materialized without holding the lock, so invalid entries are reported outside of it
+    NSMutableArray *all = [[NSMutableArray alloc] initWithCapacity:entityIds.count];
+    for (NSString *entityId in entityIds) {
+        id entity = [self entityForId:entityId];
+        if (entity) {
+            [all addObject:entity];
+        }
+    }
+    @synchronized (self) {
+        // a concurrent call may have published first; every caller gets the same array
+        if (!self.cachedAllEntities) {
+            self.cachedAllEntities = [all copy];
+        }
+        return self.cachedAllEntities;
+    }
+}
+
+- (NSUInteger)materializedCount {
+    @synchronized (self) {
+        NSUInteger count = 0;
+        for (NSString *entityId in self.entityIds) {
+            if (self.materializedEntities[entityId]) {
+                count++;
+            }
+        }
+        return count;
+    }
+}
+
+# pragma mark - Helper Methods
+
+- (id)materializeEntry:(NSDictionary *)rawEntry error:(NSError * __autoreleasing *)error {
+    id entity = nil;
+    @try {
+        entity = [[self.modelClass alloc] initWithDictionary:rawEntry error:error];
+        if (*error) {
+            entity = nil;
+        }
+    }
+    @catch (NSException *exception) {
+        entity = nil;
+        *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                     code:OPTLYErrorTypesDatafileInvalid
+                                 userInfo:@{NSLocalizedDescriptionKey : exception.reason ?: exception.name}];
+    }
+    if (!entity && !*error) {
+        *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                     code:OPTLYErrorTypesDatafileInvalid
+                                 userInfo:@{NSLocalizedDescriptionKey : NSLocalizedString(OPTLYErrorHandlerMessagesDataFileInvalid, nil)}];
+    }
+    return entity;
+}
+
+// Eager parsing rejects the whole datafile instead, so the error is not silent here either.
+- (void)reportInvalidEntry:(NSString *)entityId error:(NSError *)error {
+    NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesProjectConfigInvalidEntity, NSStringFromClass(self.modelClass), entityId, error.localizedDescription];
+    [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelError];
+    [self.errorHandler handleError:[NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                                       code:OPTLYErrorTypesDatafileInvalid
+                                                   userInfo:@{NSLocalizedDescriptionKey : logMessage}]];
+}
+
+@end
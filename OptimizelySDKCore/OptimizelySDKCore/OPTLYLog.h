@@ -37,6 +37,11 @@
 
 void optlyLog(NSString* level, const char* file, int lineNumber, const char* functionName, NSString* format, ...);
 
+@protocol OPTLYLogger;
+
 @interface OPTLYLog : NSObject
 
+/// The logger the OPTLYLog macros write to, e.g. an asynchronous logger. If nil, they write with NSLog.
+@property (class, nonatomic, strong, nullable) id<OPTLYLogger> logger;
+
 @end
@@ -14,22 +14,57 @@
  * limitations under the License.                                           *
  ***************************************************************************/
 
+#import <stdatomic.h>
 #import "OPTLYLog.h"
+#import "OPTLYLogger.h"
 
 @implementation OPTLYLog
 
+// A +1 reference, read without a lock on every log.
+static _Atomic(void *) _logger = NULL;
+// Replaced loggers are kept alive: a concurrent log may still be using the pointer it loaded.
+static NSMutableArray<id<OPTLYLogger>> *_replacedLoggers = nil;
+
++ (id<OPTLYLogger>)logger {
+    return (__bridge id<OPTLYLogger>)atomic_load_explicit(&_logger, memory_order_acquire);
+}
+
++ (void)setLogger:(id<OPTLYLogger>)logger {
+    void *newLogger = logger ? (void *)CFBridgingRetain(logger) : NULL;
+    void *oldLogger = atomic_exchange_explicit(&_logger, newLogger, memory_order_acq_rel);
+    if (oldLogger) {
+        @synchronized (self) {
+            if (!_replacedLoggers) {
+                _replacedLoggers = [NSMutableArray new];
+            }
+            [_replacedLoggers addObject:(id<OPTLYLogger>)CFBridgingRelease(oldLogger)];
+        }
+    }
+}
+
 void optlyLog(NSString* level, const char* file, int lineNumber, const char* functionName, NSString* format, ...)
 {
-    // add new line if needed
-    if (![format hasSuffix:@"\n"]) {
-        format = [format stringByAppendingString:@"\n"];
-    }
-    
     va_list ap;             // variable arguments
     va_start(ap, format);   // initialize variable argument list
-    NSString *body = [[NSMutableString alloc] initWithFormat:format arguments:ap];
+    NSString *body = [[NSString alloc] initWithFormat:format arguments:ap];
     va_end(ap);             // End using variable argument list.
     
+    id<OPTLYLogger> logger = OPTLYLog.logger;
+    if (logger != nil) {
+        OptimizelyLogLevel logLevel = OptimizelyLogLevelInfo;
+        if ([level isEqualToString:@"OPTLYLogError"]) {
+            logLevel = OptimizelyLogLevelError;
+        } else if ([level isEqualToString:@"OPTLYLogDebug"]) {
+            logLevel = OptimizelyLogLevelDebug;
+        }
+        [logger logMessage:[NSString stringWithFormat:@"%@ (%s) %@", level, functionName, body] withLevel:logLevel];
+        return;
+    }
+    
+    // add new line if needed
+    if (![body hasSuffix:@"\n"]) {
+        body = [body stringByAppendingString:@"\n"];
+    }
     NSLog(@"%s (%s) %s", level.UTF8String, functionName, [body UTF8String]);
 }
 
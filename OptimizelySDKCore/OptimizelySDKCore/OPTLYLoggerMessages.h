@@ -82,6 +82,9 @@ extern NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemoveEventError;
 extern NSString *const OPTLYLoggerMessagesDataStoreEventsRemoveAllWarning;
 extern NSString *const OPTLYLoggerMessagesDataStoreDatabaseGetNoEvents;
 extern NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingOldEvents;
+extern NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingExpiredEvents;
+extern NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingEventsOverByteBudget;
+extern NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingImpressionEventsOverTotalBudget;
 
 // File Manager
 // debug
@@ -96,6 +99,7 @@ extern NSString *const OPTLYLoggerMessagesDataStoreFileManagerSaveFile;
 extern NSString *const OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedInvalidStatusCode;
 extern NSString *const OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedError;
 extern NSString *const OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedNoChanges;
+extern NSString *const OPTLYLoggerMessagesDatafileManagerDatafileUnchanged;
 extern NSString *const OPTLYLoggerMessagesDatafileManagerLastModifiedDate;
 extern NSString *const OPTLYLoggerMessagesDatafileManagerLastModifiedDateFound;
 extern NSString *const OPTLYLoggerMessagesDatafileManagerLastModifiedDateNotFound;
@@ -113,6 +117,7 @@ extern NSString *const OPTLYLoggerMessagesDatafileFetchIntervalInvalid;
 // ---- Datafile Versioning ----
 // warning
 extern NSString *const OPTLYLoggerMessagesDatafileVersion;
+extern NSString *const OPTLYLoggerMessagesProjectConfigInvalidEntity;
 
 // ---- Event Builder ----
 // debug
@@ -144,6 +149,7 @@ extern NSString *const OPTLYLoggerMessagesEventDispatcherActivationFailure;
 extern NSString *const OPTLYLoggerMessagesEventDispatcherEventNotTracked;
 extern NSString *const OPTLYLoggerMessagesEventDispatcherAttemptingToSendConversionEvent;
 extern NSString *const OPTLYLoggerMessagesEventDispatcherAttemptingToSendImpressionEvent;
+extern NSString *const OPTLYLoggerMessagesEventDispatcherDuplicateImpressionEvent;
 extern NSString *const OPTLYLoggerMessagesEventDispatcherTrackingSuccess;
 extern NSString *const OPTLYLoggerMessagesEventDispatcherActivationSuccess;
 // warning
@@ -180,7 +186,11 @@ extern NSString *const OPTLYLoggerMessagesManagerInit;
 extern NSString *const OPTLYLoggerMessagesManagerInitWithCallback;
 extern NSString *const OPTLYLoggerMessagesManagerInitWithCallbackErrorDatafileDownload;
 extern NSString *const OPTLYLoggerMessagesManagerInitWithCallbackNoDatafileUpdates;
+extern NSString *const OPTLYLoggerMessagesManagerInitWithCallbackDatafileUnchanged;
 extern NSString *const OPTLYLoggerMessagesManagerBundledDataLoaded;
+extern NSString *const OPTLYLoggerMessagesManagerInitAsync;
+extern NSString *const OPTLYLoggerMessagesManagerInitAsyncReady;
+extern NSString *const OPTLYLoggerMessagesManagerStartupReport;
 
 // ---- Project Config Getters ----
 // debug
@@ -250,6 +260,7 @@ extern NSString *const OPTLYHTTPRequestManagerGETWithParametersAttempt;
 extern NSString *const OPTLYHTTPRequestManagerGETIfModifiedSince;
 extern NSString *const OPTLYHTTPRequestManagerPOSTWithParameters;
 extern NSString *const OPTLYHTTPRequestManagerBackoffRetryStates;
+extern NSString *const OPTLYHTTPRequestManagerJitteredBackoffRetryStates;
 
 // ---- Audience Evaluator ----
 // info
@@ -78,6 +78,9 @@ NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemoveEventError = @"[DATA S
 NSString *const OPTLYLoggerMessagesDataStoreEventsRemoveAllWarning = @"[DATA STORE] Warning: Removing all events from data store! These events will not be tracked by Optimizely.";
 NSString *const OPTLYLoggerMessagesDataStoreDatabaseGetNoEvents = @"[DATA STORE] Get event returned no event. eventType: %@.";
 NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingOldEvents = @"[DATA STORE] Event storage is full. Removing %lu events.";
+NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingExpiredEvents = @"[DATA STORE] Removed %ld %@ events older than %.0f s.";
+NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingEventsOverByteBudget = @"[DATA STORE] Event storage is over its budget of %ld bytes. Removed %ld %@ events.";
+NSString *const OPTLYLoggerMessagesDataStoreDatabaseRemovingImpressionEventsOverTotalBudget = @"[DATA STORE] Event storage is over its total budget of %ld events. Removed %ld impression events.";
 
 // File Manager
 // debug
@@ -92,6 +95,7 @@ NSString *const OPTLYLoggerMessagesDataStoreFileManagerSaveFile = @"[FILE MANAGE
 NSString *const OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedInvalidStatusCode = @"[DATAFILE MANAGER] Datafile for project %@ NOT downloaded. Invalid status code %d.";
 NSString *const OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedError = @"[DATAFILE MANAGER] Datafile for project %@ NOT downloaded. Error received: %@.";
 NSString *const OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedNoChanges = @"[DATAFILE MANAGER] Datafile for project %@ NOT downloaded. No datafile changes have been made.";
+NSString *const OPTLYLoggerMessagesDatafileManagerDatafileUnchanged = @"[DATAFILE MANAGER] Datafile for project %@ downloaded but unchanged. NOT saving the datafile again.";
 NSString *const OPTLYLoggerMessagesDatafileManagerLastModifiedDateFound = @"[DATAFILE MANAGER] Last modified date %@ found for project %@.";
 NSString *const OPTLYLoggerMessagesDatafileManagerLastModifiedDateNotFound = @"[DATAFILE MANAGER] Last modified date not found for project %@.";
 NSString *const OPTLYLoggerMessagesDatafileManagerLastModifiedDate = @"[DATAFILE MANAGER] Datafile was last modified on %@.";
@@ -109,6 +113,7 @@ NSString *const OPTLYLoggerMessagesDatafileFetchIntervalInvalid = @"[DATAFILE MA
 // ---- Datafile Versioning ----
 // info
 NSString *const OPTLYLoggerMessagesDatafileVersion = @"[PROJECT CONFIG] Datafile version is  %@."; // datafile version
+NSString *const OPTLYLoggerMessagesProjectConfigInvalidEntity = @"[PROJECT CONFIG] %@ %@ is invalid in the datafile and is ignored: %@"; // model class, entity id, error
 
 // ---- Event Builder ----
 // debug
@@ -140,6 +145,7 @@ NSString *const OPTLYLoggerMessagesEventDispatcherActivationFailure = @"[EVENT D
 NSString *const OPTLYLoggerMessagesEventDispatcherEventNotTracked = @"[EVENT DISPATCHER] Not tracking event %@ for user %@."; // event key, userId
 NSString *const OPTLYLoggerMessagesEventDispatcherAttemptingToSendConversionEvent = @"[EVENT DISPATCHER] Attempting to send conversion event %@ for user %@";
 NSString *const OPTLYLoggerMessagesEventDispatcherAttemptingToSendImpressionEvent = @"[EVENT DISPATCHER] Attempting to send impression event for user %@ in experiment %@";
+NSString *const OPTLYLoggerMessagesEventDispatcherDuplicateImpressionEvent = @"[EVENT DISPATCHER] Not sending impression event for user %@ in experiment %@ and variation %@: it was already sent recently.";
 NSString *const OPTLYLoggerMessagesEventDispatcherTrackingSuccess = @"[EVENT DISPATCHER] Successfully tracked event %@ for user %@";
 NSString *const OPTLYLoggerMessagesEventDispatcherActivationSuccess = @"[EVENT DISPATCHER] Successfully activated user %@ in experiment %@";
 // warning
@@ -174,7 +180,11 @@ NSString *const OPTLYLoggerMessagesManagerInit = @"[MANAGER] Initializing client
 NSString *const OPTLYLoggerMessagesManagerInitWithCallback = @"[MANAGER] Initializing client with callback for projectId %@ with SDK Key %@.";
 NSString *const OPTLYLoggerMessagesManagerInitWithCallbackErrorDatafileDownload = @"[MANAGER] Error downloading datafile: %@.";
 NSString *const OPTLYLoggerMessagesManagerInitWithCallbackNoDatafileUpdates = @"[MANAGER] Not downloading new datafile — no updates have been made.";
+NSString *const OPTLYLoggerMessagesManagerInitWithCallbackDatafileUnchanged = @"[MANAGER] The datafile is unchanged. Reusing the current client.";
 NSString *const OPTLYLoggerMessagesManagerBundledDataLoaded = @"[MANAGER] The bundled datafile was loaded.";
+NSString *const OPTLYLoggerMessagesManagerInitAsync = @"[MANAGER] Initializing client in the background for projectId %@ with SDK Key %@.";
+NSString *const OPTLYLoggerMessagesManagerInitAsyncReady = @"[MANAGER] Client is ready after %.3f s.";
+NSString *const OPTLYLoggerMessagesManagerStartupReport = @"[MANAGER] Startup report: %@.";
 
 // ---- Project Config Getters ----
 // warning
@@ -244,6 +254,7 @@ NSString *const OPTLYHTTPRequestManagerGETWithParametersAttempt = @"[HTTP] GET w
 NSString *const OPTLYHTTPRequestManagerGETIfModifiedSince = @"[HTTP] GET if modified attempt: %lu";
 NSString *const OPTLYHTTPRequestManagerPOSTWithParameters = @"[HTTP] POST attempt: %lu";
 NSString *const OPTLYHTTPRequestManagerBackoffRetryStates = @"[HTTP] Retry attempt: %d exponentialMultiplier: %u delay_ns: %lu, delayTime: %lu";
+NSString *const OPTLYHTTPRequestManagerJitteredBackoffRetryStates = @"[HTTP] Retry attempt: %ld previous delay_ms: %llu delay_ms: %llu";
 
 // ---- Audience Evaluator ----
 // info
@@ -0,0 +1,137 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class collects lightweight performance metrics across the SDK: counters, gauges and
+ latency histograms with fixed buckets. Updates are lock-free (atomic integer operations), and
+ when metrics are disabled, which is the default, every update returns after reading one flag.
+ Take a snapshot to forward the values to your own telemetry.
+ All methods are thread-safe.
+ */
+
+typedef NS_ENUM(NSUInteger, OPTLYMetricCounter) {
+    // impression and conversion events passed to the event dispatcher
+    OPTLYMetricCounterImpressionEvents,
+    OPTLYMetricCounterConversionEvents,
+    OPTLYMetricCounterEventsDispatched,
+    OPTLYMetricCounterEventDispatchFailures,
+    OPTLYMetricCounterFlushes,
+    OPTLYMetricCounterDatafileDownloads,
+    OPTLYMetricCounterDatafileDownloadFailures,
+    OPTLYMetricCounterCOUNT
+};
+
+typedef NS_ENUM(NSUInteger, OPTLYMetricGauge) {
+    // saved events waiting to be dispatched
+    OPTLYMetricGaugeSavedEvents,
+    // events being uploaded
+    OPTLYMetricGaugeInFlightEvents,
+    OPTLYMetricGaugeCOUNT
+};
+
+typedef NS_ENUM(NSUInteger, OPTLYMetricLatency) {
+    OPTLYMetricLatencyActivate,
+    OPTLYMetricLatencyTrack,
+    // one trackEvents: call, whatever the number of events
+    OPTLYMetricLatencyTrackEvents,
+    OPTLYMetricLatencyIsFeatureEnabled,
+    OPTLYMetricLatencyGetFeatureVariable,
+    // bucketing in the decision service
+    OPTLYMetricLatencyDecision,
+    // one statement (or transaction) in the events database
+    OPTLYMetricLatencyDatabase,
+    OPTLYMetricLatencyDatafileParse,
+    OPTLYMetricLatencyDatafileDownload,
+    OPTLYMetricLatencyCOUNT
+};
+
+// Upper bounds (in µs) of the latency histogram buckets; a last bucket counts everything slower
+extern const uint64_t OPTLYMetricsLatencyBucketBounds_us[];
+extern const NSUInteger OPTLYMetricsLatencyBucketCount;
+
+// Keys of the snapshot
+extern NSString * _Nonnull const OPTLYMetricsSnapshotCountersKey;
+extern NSString * _Nonnull const OPTLYMetricsSnapshotGaugesKey;
+extern NSString * _Nonnull const OPTLYMetricsSnapshotLatenciesKey;
+extern NSString * _Nonnull const OPTLYMetricsSnapshotLatencyCountKey;
+extern NSString * _Nonnull const OPTLYMetricsSnapshotLatencyTotalKey;
+extern NSString * _Nonnull const OPTLYMetricsSnapshotLatencyBucketsKey;
+extern NSString * _Nonnull const OPTLYMetricsSnapshotStartupKey;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYMetrics : NSObject
+
+/// Metrics are only collected while enabled. Defaults to NO.
+@property (class, atomic, assign, getter=isEnabled) BOOL enabled;
+
+/**
+ * Adds to a counter.
+ */
++ (void)incrementCounter:(OPTLYMetricCounter)counter by:(int64_t)value;
+
+/**
+ * Sets a gauge to its current value.
+ */
++ (void)setGauge:(OPTLYMetricGauge)gauge value:(int64_t)value;
+
+/**
+ * Returns a start time to pass to recordLatency:since:, or 0 if metrics are disabled.
+ */
++ (uint64_t)startTime;
+
+/**
+ * Records the time elapsed since a start time returned by startTime. Does nothing if the start time is 0.
+ */
++ (void)recordLatency:(OPTLYMetricLatency)latency since:(uint64_t)startTime;
+
+/**
+ * Records a latency (in s).
+ */
++ (void)recordLatency:(OPTLYMetricLatency)latency duration:(NSTimeInterval)duration;
+
++ (int64_t)valueOfCounter:(OPTLYMetricCounter)counter;
++ (int64_t)valueOfGauge:(OPTLYMetricGauge)gauge;
++ (int64_t)countOfLatency:(OPTLYMetricLatency)latency;
+
+/**
+ * Returns the current values, keyed by metric name:
+ *   counters and gauges map names to numbers;
+ *   latencies map names to their count, total time (in µs) and bucket counts (in the order of OPTLYMetricsLatencyBucketBounds_us).
+ *   startup is the OPTLYStartupReport report, which is recorded even while metrics are disabled.
+ * The number of calls of the public APIs is the count of their latency.
+ * Values updated while the snapshot is taken may or may not be included.
+ */
++ (NSDictionary<NSString *, NSDictionary *> *)snapshot;
+
+/**
+ * Returns the name of a metric as used in the snapshot.
+ */
++ (NSString *)nameOfCounter:(OPTLYMetricCounter)counter;
++ (NSString *)nameOfGauge:(OPTLYMetricGauge)gauge;
++ (NSString *)nameOfLatency:(OPTLYMetricLatency)latency;
+
+/**
+ * Sets every metric back to 0.
+ */
++ (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,201 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <stdatomic.h>
+#import "OPTLYMetrics.h"
+#import "OPTLYStartupReport.h"
+#import "OPTLYTime.h"
+
+const uint64_t OPTLYMetricsLatencyBucketBounds_us[] = { 10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000 };
+const NSUInteger OPTLYMetricsLatencyBucketCount = sizeof(OPTLYMetricsLatencyBucketBounds_us) / sizeof(OPTLYMetricsLatencyBucketBounds_us[0]) + 1;
+
+NSString * const OPTLYMetricsSnapshotCountersKey = @"counters";
+NSString * const OPTLYMetricsSnapshotGaugesKey = @"gauges";
+NSString * const OPTLYMetricsSnapshotLatenciesKey = @"latencies";
+NSString * const OPTLYMetricsSnapshotLatencyCountKey = @"count";
+NSString * const OPTLYMetricsSnapshotLatencyTotalKey = @"total_us";
+NSString * const OPTLYMetricsSnapshotLatencyBucketsKey = @"buckets";
+NSString * const OPTLYMetricsSnapshotStartupKey = @"startup";
+
+#define OPTLY_METRICS_BUCKET_COUNT 12
+
+typedef struct {
+    atomic_llong count;
+    atomic_llong total_us;
+    atomic_llong buckets[OPTLY_METRICS_BUCKET_COUNT];
+} OPTLYMetricsHistogram;
+
+static atomic_bool gEnabled = false;
+static atomic_llong gCounters[OPTLYMetricCounterCOUNT];
+static atomic_llong gGauges[OPTLYMetricGaugeCOUNT];
+static OPTLYMetricsHistogram gLatencies[OPTLYMetricLatencyCOUNT];
+
+static void recordLatency_us(OPTLYMetricLatency latency, uint64_t duration_us) {
+    if (latency >= OPTLYMetricLatencyCOUNT) {
+        return;
+    }
+    NSUInteger bucket = 0;
+    while (bucket < OPTLYMetricsLatencyBucketCount - 1 && duration_us > OPTLYMetricsLatencyBucketBounds_us[bucket]) {
+        bucket++;
+    }
+    OPTLYMetricsHistogram *histogram = &gLatencies[latency];
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->total_us, (long long)duration_us, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->buckets[bucket], 1, memory_order_relaxed);
+}
+
+@implementation OPTLYMetrics
+
++ (BOOL)isEnabled {
+    return atomic_load_explicit(&gEnabled, memory_order_relaxed);
+}
+
++ (void)setEnabled:(BOOL)enabled {
+    atomic_store_explicit(&gEnabled, enabled, memory_order_relaxed);
+}
+
++ (void)incrementCounter:(OPTLYMetricCounter)counter by:(int64_t)value {
+    if (!atomic_load_explicit(&gEnabled, memory_order_relaxed) || counter >= OPTLYMetricCounterCOUNT) {
+        return;
+    }
+    atomic_fetch_add_explicit(&gCounters[counter], value, memory_order_relaxed);
+}
+
++ (void)setGauge:(OPTLYMetricGauge)gauge value:(int64_t)value {
+    if (!atomic_load_explicit(&gEnabled, memory_order_relaxed) || gauge >= OPTLYMetricGaugeCOUNT) {
+        return;
+    }
+    atomic_store_explicit(&gGauges[gauge], value, memory_order_relaxed);
+}
+
++ (uint64_t)startTime {
+    if (!atomic_load_explicit(&gEnabled, memory_order_relaxed)) {
+        return 0;
+    }
+    return OPTLYTimeNow();
+}
+
++ (void)recordLatency:(OPTLYMetricLatency)latency since:(uint64_t)startTime {
+    if (startTime == 0 || !atomic_load_explicit(&gEnabled, memory_order_relaxed)) {
+        return;
+    }
+    recordLatency_us(latency, OPTLYTimeNanosecondsFromMachTime(OPTLYTimeNow() - startTime) / NSEC_PER_USEC);
+}
+
++ (void)recordLatency:(OPTLYMetricLatency)latency duration:(NSTimeInterval)duration {
+    if (!atomic_load_explicit(&gEnabled, memory_order_relaxed)) {
+        return;
+    }
+    recordLatency_us(latency, (uint64_t)llround(MAX(duration, 0) * USEC_PER_SEC));
+}
+
++ (int64_t)valueOfCounter:(OPTLYMetricCounter)counter {
+    return counter < OPTLYMetricCounterCOUNT ? atomic_load_explicit(&gCounters[counter], memory_order_relaxed) : 0;
+}
+
++ (int64_t)valueOfGauge:(OPTLYMetricGauge)gauge {
+    return gauge < OPTLYMetricGaugeCOUNT ? atomic_load_explicit(&gGauges[gauge], memory_order_relaxed) : 0;
+}
+
++ (int64_t)countOfLatency:(OPTLYMetricLatency)latency {
+    return latency < OPTLYMetricLatencyCOUNT ? atomic_load_explicit(&gLatencies[latency].count, memory_order_relaxed) : 0;
+}
+
++ (NSDictionary<NSString *, NSDictionary *> *)snapshot {
+    NSMutableDictionary *counters = [NSMutableDictionary new];
+    for (OPTLYMetricCounter counter = 0; counter < OPTLYMetricCounterCOUNT; counter++) {
+        counters[[self nameOfCounter:counter]] = @([self valueOfCounter:counter]);
+    }
+    NSMutableDictionary *gauges = [NSMutableDictionary new];
+    for (OPTLYMetricGauge gauge = 0; gauge < OPTLYMetricGaugeCOUNT; gauge++) {
+        gauges[[self nameOfGauge:gauge]] = @([self valueOfGauge:gauge]);
+    }
+    NSMutableDictionary *latencies = [NSMutableDictionary new];
+    for (OPTLYMetricLatency latency = 0; latency < OPTLYMetricLatencyCOUNT; latency++) {
+        OPTLYMetricsHistogram *histogram = &gLatencies[latency];
+        NSMutableArray *buckets = [NSMutableArray arrayWithCapacity:OPTLYMetricsLatencyBucketCount];
+        for (NSUInteger bucket = 0; bucket < OPTLYMetricsLatencyBucketCount; bucket++) {
+            [buckets addObject:@(atomic_load_explicit(&histogram->buckets[bucket], memory_order_relaxed))];
+        }
+        latencies[[self nameOfLatency:latency]] = @{
+            OPTLYMetricsSnapshotLatencyCountKey : @(atomic_load_explicit(&histogram->count, memory_order_relaxed)),
+            OPTLYMetricsSnapshotLatencyTotalKey : @(atomic_load_explicit(&histogram->total_us, memory_order_relaxed)),
+            OPTLYMetricsSnapshotLatencyBucketsKey : buckets,
+        };
+    }
+    return @{
+        OPTLYMetricsSnapshotCountersKey : counters,
+        OPTLYMetricsSnapshotGaugesKey : gauges,
+        OPTLYMetricsSnapshotLatenciesKey : latencies,
+        OPTLYMetricsSnapshotStartupKey : [OPTLYStartupReport report],
+    };
+}
+
++ (NSString *)nameOfCounter:(OPTLYMetricCounter)counter {
+    switch (counter) {
+        case OPTLYMetricCounterImpressionEvents: return @"impression_events";
+        case OPTLYMetricCounterConversionEvents: return @"conversion_events";
+        case OPTLYMetricCounterEventsDispatched: return @"events_dispatched";
+        case OPTLYMetricCounterEventDispatchFailures: return @"event_dispatch_failures";
+        case OPTLYMetricCounterFlushes: return @"flushes";
+        case OPTLYMetricCounterDatafileDownloads: return @"datafile_downloads";
+        case OPTLYMetricCounterDatafileDownloadFailures: return @"datafile_download_failures";
+        default: return @"unknown";
+    }
+}
+
++ (NSString *)nameOfGauge:(OPTLYMetricGauge)gauge {
+    switch (gauge) {
+        case OPTLYMetricGaugeSavedEvents: return @"saved_events";
+        case OPTLYMetricGaugeInFlightEvents: return @"in_flight_events";
+        default: return @"unknown";
+    }
+}
+
++ (NSString *)nameOfLatency:(OPTLYMetricLatency)latency {
+    switch (latency) {
+        case OPTLYMetricLatencyActivate: return @"activate";
+        case OPTLYMetricLatencyTrack: return @"track";
+        case OPTLYMetricLatencyTrackEvents: return @"track_events";
+        case OPTLYMetricLatencyIsFeatureEnabled: return @"is_feature_enabled";
+        case OPTLYMetricLatencyGetFeatureVariable: return @"get_feature_variable";
+        case OPTLYMetricLatencyDecision: return @"decision";
+        case OPTLYMetricLatencyDatabase: return @"database";
+        case OPTLYMetricLatencyDatafileParse: return @"datafile_parse";
+        case OPTLYMetricLatencyDatafileDownload: return @"datafile_download";
+        default: return @"unknown";
+    }
+}
+
++ (void)reset {
+    for (NSUInteger i = 0; i < OPTLYMetricCounterCOUNT; i++) {
+        atomic_store_explicit(&gCounters[i], 0, memory_order_relaxed);
+    }
+    for (NSUInteger i = 0; i < OPTLYMetricGaugeCOUNT; i++) {
+        atomic_store_explicit(&gGauges[i], 0, memory_order_relaxed);
+    }
+    for (NSUInteger i = 0; i < OPTLYMetricLatencyCOUNT; i++) {
+        OPTLYMetricsHistogram *histogram = &gLatencies[i];
+        atomic_store_explicit(&histogram->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&histogram->total_us, 0, memory_order_relaxed);
+        for (NSUInteger bucket = 0; bucket < OPTLY_METRICS_BUCKET_COUNT; bucket++) {
+            atomic_store_explicit(&histogram->buckets[bucket], 0, memory_order_relaxed);
+        }
+    }
+}
+
+@end
@@ -16,6 +16,7 @@
 
 #import <Foundation/Foundation.h>
 #import "OPTLYHTTPRequestManager.h"
+#import "OPTLYRequestScheduler.h"
 
 NS_ASSUME_NONNULL_BEGIN
 extern NSString * const OPTLYNetworkServiceCDNServerURL;
@@ -24,9 +25,29 @@ extern const NSInteger OPTLYNetworkServiceEventDispatchMaxBackoffRetryAttempts;
 extern const NSInteger OPTLYNetworkServiceEventDispatchMaxBackoffRetryTimeInterval_ms;
 extern const NSInteger OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryAttempts;
 extern const NSInteger OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_ms;
+extern const NSUInteger OPTLYNetworkServiceDefaultMaxConcurrentEventUploads;
+extern const NSUInteger OPTLYNetworkServiceMaxConcurrentDatafileDownloads;
 NS_ASSUME_NONNULL_END
 
 @interface OPTLYNetworkService : NSObject
+
+/// If YES, dispatched events of at least eventCompressionThreshold bytes are sent gzip compressed. Defaults to NO.
+@property (nonatomic, assign) BOOL eventCompressionEnabled;
+/// The minimum encoded event size (in bytes) to compress.
+@property (nonatomic, assign) NSUInteger eventCompressionThreshold;
+/// The maximum number of event uploads in flight (including their retries). Defaults to OPTLYNetworkServiceDefaultMaxConcurrentEventUploads.
+@property (nonatomic, assign) NSUInteger maxConcurrentEventUploads;
+/// The maximum number of simultaneous connections to a host. 0 uses the system default.
+@property (nonatomic, assign) NSInteger maxConnectionsPerHost;
+/// Event uploads that have started and not completed yet.
+@property (nonatomic, assign, readonly) NSUInteger eventUploadsInFlight;
+/// Event uploads waiting for a free slot.
+@property (nonatomic, assign, readonly) NSUInteger eventUploadsQueued;
+/// Datafile downloads that have started and not completed yet. Datafile downloads never wait behind event uploads.
+@property (nonatomic, assign, readonly) NSUInteger datafileDownloadsInFlight;
+/// Datafile downloads waiting for a free slot.
+@property (nonatomic, assign, readonly) NSUInteger datafileDownloadsQueued;
+
 /**
  * Download the project config file from remote server
  *
@@ -52,6 +73,22 @@ NS_ASSUME_NONNULL_END
                  lastModified:(nonnull NSString *)lastModifiedDate
             completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
 
+/**
+ * Download the project config file from remote server only if it
+ * has changed since the response with this ETag or last modified date.
+ *
+ * @param projectURL The project URL of the datafile to download
+ * @param backoffRetry Indicates if backoff retry should be enabled
+ * @param lastModifiedDate The date the datafile was last modified
+ * @param entityTag The ETag of the last downloaded datafile
+ * @param completion The completion block of type OPTLYHTTPRequestManagerResponse
+ */
+- (void)downloadProjectConfig:(nonnull NSURL *)projectURL
+                 backoffRetry:(BOOL)backoffRetry
+                 lastModified:(nullable NSString *)lastModifiedDate
+                    entityTag:(nullable NSString *)entityTag
+            completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
+
 /**
  * Dispatches an event to a url
  * @param params Dictionary of the event parameter values
@@ -64,4 +101,18 @@ NS_ASSUME_NONNULL_END
                 toURL:(nonnull NSURL *)url
     completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
 
+/**
+ * Dispatches an event to a url once an upload slot is free
+ * @param params Dictionary of the event parameter values
+ * @param backoffRetry Indicates if the exponential backoff retry should be enabled
+ * @param priority Queued uploads with a higher priority start first
+ * @param url The url to dispatch the event
+ * @param completion The completion handler
+ */
+- (void)dispatchEvent:(nonnull NSDictionary *)params
+         backoffRetry:(BOOL)backoffRetry
+             priority:(OPTLYRequestPriority)priority
+                toURL:(nonnull NSURL *)url
+    completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
+
 @end
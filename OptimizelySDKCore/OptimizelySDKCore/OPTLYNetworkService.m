@@ -28,8 +28,14 @@ const NSInteger OPTLYNetworkServiceEventDispatchMaxBackoffRetryTimeInterval_ms =
 const NSInteger OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryAttempts = 2; // retries after first failed attempt
 const NSInteger OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_ms = 1000;
 
+// ---- Event uploads and datafile downloads are scheduled in separate lanes ----
+const NSUInteger OPTLYNetworkServiceDefaultMaxConcurrentEventUploads = 4;
+const NSUInteger OPTLYNetworkServiceMaxConcurrentDatafileDownloads = 2;
+
 @interface OPTLYNetworkService()
 @property (nonatomic, strong)  OPTLYHTTPRequestManager *requestManager;
+@property (nonatomic, strong) OPTLYRequestScheduler *eventScheduler;
+@property (nonatomic, strong) OPTLYRequestScheduler *datafileScheduler;
 @end
 
 @implementation OPTLYNetworkService
@@ -39,41 +45,117 @@ const NSInteger OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_m
     self = [super init];
     if (self) {
         _requestManager = [OPTLYHTTPRequestManager new];
+        _eventScheduler = [[OPTLYRequestScheduler alloc] initWithName:@"events"
+                                                maxConcurrentRequests:OPTLYNetworkServiceDefaultMaxConcurrentEventUploads];
+        _datafileScheduler = [[OPTLYRequestScheduler alloc] initWithName:@"datafile"
+                                                   maxConcurrentRequests:OPTLYNetworkServiceMaxConcurrentDatafileDownloads];
     }
     return self;
 }
 
+- (NSUInteger)maxConcurrentEventUploads {
+    return self.eventScheduler.maxConcurrentRequests;
+}
+
+- (void)setMaxConcurrentEventUploads:(NSUInteger)maxConcurrentEventUploads {
+    self.eventScheduler.maxConcurrentRequests = maxConcurrentEventUploads;
+}
+
+- (NSInteger)maxConnectionsPerHost {
+    return self.requestManager.maximumConnectionsPerHost;
+}
+
+- (void)setMaxConnectionsPerHost:(NSInteger)maxConnectionsPerHost {
+    self.requestManager.maximumConnectionsPerHost = maxConnectionsPerHost;
+}
+
+- (NSUInteger)eventUploadsInFlight {
+    return self.eventScheduler.inFlightCount;
+}
+
+- (NSUInteger)eventUploadsQueued {
+    return self.eventScheduler.queuedCount;
+}
+
+- (NSUInteger)datafileDownloadsInFlight {
+    return self.datafileScheduler.inFlightCount;
+}
+
+- (NSUInteger)datafileDownloadsQueued {
+    return self.datafileScheduler.queuedCount;
+}
+
+// the request manager only compresses POST bodies, so these apply to dispatched events
+- (BOOL)eventCompressionEnabled {
+    return self.requestManager.compressionEnabled;
+}
+
+- (void)setEventCompressionEnabled:(BOOL)eventCompressionEnabled {
+    self.requestManager.compressionEnabled = eventCompressionEnabled;
+}
+
+- (NSUInteger)eventCompressionThreshold {
+    return self.requestManager.compressionThreshold;
+}
+
+- (void)setEventCompressionThreshold:(NSUInteger)eventCompressionThreshold {
+    self.requestManager.compressionThreshold = eventCompressionThreshold;
+}
+
 - (void)downloadProjectConfig:(nonnull NSURL *)datafileConfigURL
                  backoffRetry:(BOOL)backoffRetry
                  lastModified:(nonnull NSString *)lastModifiedDate
             completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion
 {
-    if (backoffRetry) {
-        [self.requestManager GETIfModifiedSince:lastModifiedDate
-                                            url:datafileConfigURL
-                           backoffRetryInterval:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_ms
-                                        retries:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryAttempts
-                              completionHandler:completion];
-    } else {
-        [self.requestManager GETIfModifiedSince:lastModifiedDate
-                                            url:datafileConfigURL
-                              completionHandler:completion];
-    }
+    [self downloadProjectConfig:datafileConfigURL
+                   backoffRetry:backoffRetry
+                   lastModified:lastModifiedDate
+                      entityTag:nil
+              completionHandler:completion];
+}
+
+- (void)downloadProjectConfig:(nonnull NSURL *)datafileConfigURL
+                 backoffRetry:(BOOL)backoffRetry
+                 lastModified:(nullable NSString *)lastModifiedDate
+                    entityTag:(nullable NSString *)entityTag
+            completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion
+{
+    OPTLYHTTPRequestManager *requestManager = self.requestManager;
+    [self.datafileScheduler scheduleRequest:^(dispatch_block_t done) {
+        OPTLYHTTPRequestManagerResponse scheduledCompletion = [self completion:completion callingDone:done];
+        if (backoffRetry) {
+            [requestManager GETIfModifiedSince:lastModifiedDate
+                                   ifNoneMatch:entityTag
+                                           url:datafileConfigURL
+                          backoffRetryInterval:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_ms
+                                       retries:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryAttempts
+                             completionHandler:scheduledCompletion];
+        } else {
+            [requestManager GETIfModifiedSince:lastModifiedDate
+                                   ifNoneMatch:entityTag
+                                           url:datafileConfigURL
+                             completionHandler:scheduledCompletion];
+        }
+    } priority:OPTLYRequestPriorityDefault];
 }
 
 - (void)downloadProjectConfig:(nonnull NSURL *)datafileConfigURL
                  backoffRetry:(BOOL)backoffRetry
             completionHandler:(OPTLYHTTPRequestManagerResponse)completion
 {
-    if (backoffRetry) {
-        [self.requestManager GETWithBackoffRetryInterval:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_ms
-                                                     url:datafileConfigURL
-                                                 retries:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryAttempts
-                                       completionHandler:completion];
-    } else {
-        [self.requestManager GETWithURL:datafileConfigURL
-                             completion:completion];
-    }
+    OPTLYHTTPRequestManager *requestManager = self.requestManager;
+    [self.datafileScheduler scheduleRequest:^(dispatch_block_t done) {
+        OPTLYHTTPRequestManagerResponse scheduledCompletion = [self completion:completion callingDone:done];
+        if (backoffRetry) {
+            [requestManager GETWithBackoffRetryInterval:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_ms
+                                                    url:datafileConfigURL
+                                                retries:OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryAttempts
+                                      completionHandler:scheduledCompletion];
+        } else {
+            [requestManager GETWithURL:datafileConfigURL
+                            completion:scheduledCompletion];
+        }
+    } priority:OPTLYRequestPriorityDefault];
 }
 
 - (void)dispatchEvent:(nonnull NSDictionary *)params
@@ -81,17 +163,49 @@ const NSInteger OPTLYNetworkServiceDatafileDownloadMaxBackoffRetryTimeInterval_m
                 toURL:(nonnull NSURL *)url
     completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion
 {
-    if (backoffRetry) {
-        [self.requestManager POSTWithParameters:params
-                                            url:url
-                           backoffRetryInterval:OPTLYNetworkServiceEventDispatchMaxBackoffRetryTimeInterval_ms
-                                        retries:OPTLYNetworkServiceEventDispatchMaxBackoffRetryAttempts
-                              completionHandler:completion];
-    } else {
-        [self.requestManager POSTWithParameters:params
-                                            url:url
-                              completionHandler:completion];
-    }
+    [self dispatchEvent:params
+           backoffRetry:backoffRetry
+               priority:OPTLYRequestPriorityDefault
+                  toURL:url
+      completionHandler:completion];
+}
+
+- (void)dispatchEvent:(nonnull NSDictionary *)params
+         backoffRetry:(BOOL)backoffRetry
+             priority:(OPTLYRequestPriority)priority
+                toURL:(nonnull NSURL *)url
+    completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion
+{
+    OPTLYHTTPRequestManager *requestManager = self.requestManager;
+    // the slot is held through the retries, so a failing endpoint can't take more than maxConcurrentEventUploads connections
+    [self.eventScheduler scheduleRequest:^(dispatch_block_t done) {
+        OPTLYHTTPRequestManagerResponse scheduledCompletion = [self completion:completion callingDone:done];
+        if (backoffRetry) {
+            [requestManager POSTWithParameters:params
+                                           url:url
+                          backoffRetryInterval:OPTLYNetworkServiceEventDispatchMaxBackoffRetryTimeInterval_ms
+                                       retries:OPTLYNetworkServiceEventDispatchMaxBackoffRetryAttempts
+                             completionHandler:scheduledCompletion];
+        } else {
+            [requestManager POSTWithParameters:params
+                                           url:url
+                             completionHandler:scheduledCompletion];
+        }
+    } priority:priority];
+}
+
+# pragma mark - Helper Methods
+
+// frees the scheduler slot before handing the response to the caller
+- (OPTLYHTTPRequestManagerResponse)completion:(OPTLYHTTPRequestManagerResponse)completion
+                                  callingDone:(dispatch_block_t)done
+{
+    return ^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        done();
+        if (completion) {
+            completion(data, response, error);
+        }
+    };
 }
 
 @end
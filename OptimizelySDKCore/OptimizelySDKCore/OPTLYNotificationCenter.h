@@ -141,4 +141,11 @@ extern NSString * _Nonnull const OPTLYDecisionTypeFeatureTest;
  * @param args The arg list changes depending on the type of notification sent.
  */
 - (void)sendNotifications:(OPTLYNotificationType)type args:(nullable NSDictionary *)args;
+
+/**
+ * fire notifications of a certain type once for each arg list, looking up the listeners only once.
+ * @param type type of OPTLYNotificationType to fire.
+ * @param argsList The arg lists, each one as for sendNotifications:args:.
+ */
+- (void)sendNotifications:(OPTLYNotificationType)type argsList:(nonnull NSArray<NSDictionary *> *)argsList;
 @end
@@ -123,29 +123,42 @@ NSString * _Nonnull const OPTLYDecisionTypeFeatureTest      = @"feature-test";
 - (void)sendNotifications:(OPTLYNotificationType)type args:(NSDictionary *)args {
     OPTLYNotificationHolder *notification = _notifications[@(type)];
     for (GenericListener listener in notification.allValues) {
-        @try {
-            switch (type) {
-                case OPTLYNotificationTypeActivate:
-                    [self notifyActivateListener:((ActivateListener) listener) args:args];
-                    break;
-                case OPTLYNotificationTypeTrack:
-                    [self notifyTrackListener:((TrackListener) listener) args:args];
-                    break;
-                case OPTLYNotificationTypeDecision:
-                    [self notifyDecisionListener:((DecisionListener) listener) args:args];
-                    break;
-                default:
-                    listener(args);
-            }
-        } @catch (NSException *exception) {
-            NSString *logMessage = [NSString stringWithFormat:@"Problem calling notify callback. Error: %@", exception.reason];
-            [_config.logger logMessage:logMessage withLevel:OptimizelyLogLevelError];
+        [self notifyListener:listener type:type args:args];
+    }
+}
+
+- (void)sendNotifications:(OPTLYNotificationType)type argsList:(NSArray<NSDictionary *> *)argsList {
+    OPTLYNotificationHolder *notification = _notifications[@(type)];
+    for (GenericListener listener in notification.allValues) {
+        for (NSDictionary *args in argsList) {
+            [self notifyListener:listener type:type args:args];
         }
     }
 }
 
 #pragma mark - Private Methods
 
+- (void)notifyListener:(GenericListener)listener type:(OPTLYNotificationType)type args:(NSDictionary *)args {
+    @try {
+        switch (type) {
+            case OPTLYNotificationTypeActivate:
+                [self notifyActivateListener:((ActivateListener) listener) args:args];
+                break;
+            case OPTLYNotificationTypeTrack:
+                [self notifyTrackListener:((TrackListener) listener) args:args];
+                break;
+            case OPTLYNotificationTypeDecision:
+                [self notifyDecisionListener:((DecisionListener) listener) args:args];
+                break;
+            default:
+                listener(args);
+        }
+    } @catch (NSException *exception) {
+        NSString *logMessage = [NSString stringWithFormat:@"Problem calling notify callback. Error: %@", exception.reason];
+        [_config.logger logMessage:logMessage withLevel:OptimizelyLogLevelError];
+    }
+}
+
 - (NSInteger)addNotification:(OPTLYNotificationType)type listener:(GenericListener)listener {
     NSNumber *notificationTypeNumber = [NSNumber numberWithUnsignedInteger:type];
     NSNumber *notificationIdNumber = [NSNumber numberWithUnsignedInteger:_notificationId];
@@ -109,6 +109,11 @@ __attribute((deprecated("Use OPTLYProjectConfig initWithBuilder method instead."
 **/
 - (nullable NSString *)getExperimentIdForKey:(nonnull NSString *)experimentKey;
 
+/**
+ * Get the Ids of the experiments that are not in a group, without materializing lazily parsed experiments.
+ */
+- (nonnull NSArray<NSString *> *)experimentIds;
+
 /**
  * Returns true if experiment belongs to any feature, false otherwise.
  **/
@@ -23,9 +23,12 @@
 #import "OPTLYEvent.h"
 #import "OPTLYExperiment.h"
 #import "OPTLYGroup.h"
+#import "OPTLYLazyEntityMap.h"
 #import "OPTLYLog.h"
 #import "OPTLYLogger.h"
+#import "OPTLYMetrics.h"
 #import "OPTLYProjectConfig.h"
+#import "OPTLYStartupReport.h"
 #import "OPTLYUserProfileServiceBasic.h"
 #import "OPTLYVariation.h"
 #import "OPTLYFeatureFlag.h"
@@ -33,6 +36,7 @@
 
 NSString * const kExpectedDatafileVersion = @"4";
 NSString * const kReservedAttributePrefix = @"$opt_";
+NSString * const kTypedAudiencesKey = @"typedAudiences";
 // Array representing supported datafile versions.
 static NSArray *supportedDatafileVersions = nil;
 
@@ -52,6 +56,11 @@ static NSArray *supportedDatafileVersions = nil;
 //@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSString *>><OPTLYIgnore> *forcedVariationMap;
 //    userId --> experimentId --> variationId
 @property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableDictionary *><OPTLYIgnore> *forcedVariationMap;
+// Lazily materialized datafile sections (only set when the config is built with lazyDatafileParsing)
+@property (nonatomic, strong) OPTLYLazyEntityMap<OPTLYIgnore> *lazyExperiments;
+@property (nonatomic, strong) OPTLYLazyEntityMap<OPTLYIgnore> *lazyAudiences;
+@property (nonatomic, strong) OPTLYLazyEntityMap<OPTLYIgnore> *lazyTypedAudiences;
+@property (nonatomic, strong) OPTLYLazyEntityMap<OPTLYIgnore> *lazyEvents;
 
 @end
 
@@ -117,7 +126,14 @@ static NSArray *supportedDatafileVersions = nil;
     // check datafile is valid
     @try {
         NSError *datafileError;
-        OPTLYProjectConfig *projectConfig = [[OPTLYProjectConfig alloc] initWithData:builder.datafile error:&datafileError];
+        OPTLYProjectConfig *projectConfig = nil;
+        uint64_t startTime = [OPTLYMetrics startTime];
+        if (builder.lazyDatafileParsing) {
+            projectConfig = [[OPTLYProjectConfig alloc] initLazilyWithData:builder.datafile error:&datafileError];
+        } else {
+            projectConfig = [[OPTLYProjectConfig alloc] initWithData:builder.datafile error:&datafileError];
+        }
+        [OPTLYMetrics recordLatency:OPTLYMetricLatencyDatafileParse since:startTime];
         
         if (!datafileError && ![supportedDatafileVersions containsObject:projectConfig.version]) {
             NSString *description = [NSString stringWithFormat:OPTLYErrorHandlerMessagesDataFileInvalid, projectConfig.version];
@@ -167,6 +183,12 @@ static NSArray *supportedDatafileVersions = nil;
     
     _errorHandler = (id<OPTLYErrorHandler, OPTLYIgnore>)builder.errorHandler;
     _logger = (id<OPTLYLogger, OPTLYIgnore>)builder.logger;
+    
+    // lazily parsed entries are validated on first access, which is when their errors are reported
+    for (OPTLYLazyEntityMap *lazyEntities in [self lazyEntityMaps]) {
+        lazyEntities.errorHandler = builder.errorHandler;
+        lazyEntities.logger = builder.logger;
+    }
     return self;
 }
 
@@ -176,10 +198,126 @@ static NSArray *supportedDatafileVersions = nil;
     }]];
 }
 
+// Parses the datafile but only indexes ids and keys of experiments, audiences and events.
+// The raw JSON of those entries is kept and turned into model objects on first access.
+- (instancetype)initLazilyWithData:(NSData *)data error:(NSError * __autoreleasing *)error {
+    if (!data) {
+        if (error) *error = [OPTLYJSONModelError errorInputIsNil];
+        return nil;
+    }
+    uint64_t startTime = [OPTLYStartupReport startTime];
+    NSError *jsonError = nil;
+    NSDictionary *datafile = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:&jsonError];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileJSONParse since:startTime];
+    if (jsonError || ![datafile isKindOfClass:[NSDictionary class]]) {
+        if (error) *error = [OPTLYJSONModelError errorBadJSON];
+        return nil;
+    }
+    
+    // strip the lazy sections so the model import only builds the remaining entities
+    NSArray *lazySectionKeys = @[OPTLYDatafileKeysExperiments, OPTLYDatafileKeysAudiences, kTypedAudiencesKey, OPTLYDatafileKeysEvents];
+    NSMutableDictionary *eagerSections = [datafile mutableCopy];
+    for (NSString *key in lazySectionKeys) {
+        if ([datafile[key] isKindOfClass:[NSArray class]]) {
+            eagerSections[key] = @[];
+        }
+    }
+    
+    startTime = [OPTLYStartupReport startTime];
+    self = [self initWithDictionary:eagerSections error:error];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseModelMaterialization since:startTime];
+    if (!self) {
+        return nil;
+    }
+    
+    startTime = [OPTLYStartupReport startTime];
+    _lazyExperiments = (OPTLYLazyEntityMap<OPTLYIgnore> *)[[OPTLYLazyEntityMap alloc] initWithEntries:datafile[OPTLYDatafileKeysExperiments]
+                                                                                          modelClass:[OPTLYExperiment class]
+                                                                                               idKey:OPTLYDatafileKeysExperimentId
+                                                                                              keyKey:OPTLYDatafileKeysExperimentKey
+                                                                                               error:error];
+    _lazyAudiences = (OPTLYLazyEntityMap<OPTLYIgnore> *)[[OPTLYLazyEntityMap alloc] initWithEntries:datafile[OPTLYDatafileKeysAudiences]
+                                                                                        modelClass:[OPTLYAudience class]
+                                                                                             idKey:OPTLYDatafileKeysAudienceId
+                                                                                            keyKey:nil
+                                                                                             error:error];
+    _lazyEvents = (OPTLYLazyEntityMap<OPTLYIgnore> *)[[OPTLYLazyEntityMap alloc] initWithEntries:datafile[OPTLYDatafileKeysEvents]
+                                                                                     modelClass:[OPTLYEvent class]
+                                                                                          idKey:OPTLYDatafileKeysEventId
+                                                                                         keyKey:OPTLYDatafileKeysEventKey
+                                                                                          error:error];
+    if (!_lazyExperiments || !_lazyAudiences || !_lazyEvents) {
+        return nil;
+    }
+    if ([datafile[kTypedAudiencesKey] isKindOfClass:[NSArray class]]) {
+        _lazyTypedAudiences = (OPTLYLazyEntityMap<OPTLYIgnore> *)[[OPTLYLazyEntityMap alloc] initWithEntries:datafile[kTypedAudiencesKey]
+                                                                                                 modelClass:[OPTLYAudience class]
+                                                                                                      idKey:OPTLYDatafileKeysAudienceId
+                                                                                                     keyKey:nil
+                                                                                                      error:error];
+        if (!_lazyTypedAudiences) {
+            return nil;
+        }
+    }
+    
+    // group experiments are materialized together with their group, register them so lookups return the same instances
+    for (OPTLYGroup *group in self.groups) {
+        for (OPTLYExperiment *experiment in group.experiments) {
+            [_lazyExperiments addEntity:experiment entityId:experiment.experimentId entityKey:experiment.experimentKey];
+        }
+    }
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
+    return self;
+}
+
+- (NSArray<OPTLYLazyEntityMap *> *)lazyEntityMaps {
+    NSMutableArray<OPTLYLazyEntityMap *> *lazyEntityMaps = [NSMutableArray new];
+    if (_lazyExperiments) {
+        [lazyEntityMaps addObject:_lazyExperiments];
+    }
+    if (_lazyAudiences) {
+        [lazyEntityMaps addObject:_lazyAudiences];
+    }
+    if (_lazyTypedAudiences) {
+        [lazyEntityMaps addObject:_lazyTypedAudiences];
+    }
+    if (_lazyEvents) {
+        [lazyEntityMaps addObject:_lazyEvents];
+    }
+    return lazyEntityMaps;
+}
+
+// Same as OPTLYJSONModel, with the JSON parse and the model materialization recorded as separate startup phases
+- (instancetype)initWithData:(NSData *)data error:(NSError * __autoreleasing *)error {
+    if (!data) {
+        if (error) *error = [OPTLYJSONModelError errorInputIsNil];
+        return nil;
+    }
+    uint64_t startTime = [OPTLYStartupReport startTime];
+    NSError *jsonError = nil;
+    id datafile = [NSJSONSerialization JSONObjectWithData:data options:kNilOptions error:&jsonError];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileJSONParse since:startTime];
+    if (jsonError) {
+        if (error) *error = [OPTLYJSONModelError errorBadJSON];
+        return nil;
+    }
+    
+    startTime = [OPTLYStartupReport startTime];
+    self = [self initWithDictionary:datafile error:error];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseModelMaterialization since:startTime];
+    return self;
+}
+
 #pragma mark -- Getters --
 - (OPTLYAudience *)getAudienceForId:(NSString *)audienceId
 {
-    OPTLYAudience *audience = self.audienceIdToAudienceMap[audienceId];
+    OPTLYAudience *audience = nil;
+    if (self.lazyAudiences) {
+        //typed audiences override audiences with the same id
+        audience = [self.lazyTypedAudiences entityForId:audienceId] ?: [self.lazyAudiences entityForId:audienceId];
+    } else {
+        audience = self.audienceIdToAudienceMap[audienceId];
+    }
     if (!audience) {
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesAudienceUnknownForAudienceId, audienceId];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
@@ -218,7 +356,7 @@ static NSArray *supportedDatafileVersions = nil;
 }
 
 - (NSString *)getEventIdForKey:(NSString *)eventKey {
-    NSString *eventId = self.eventKeyToEventIdMap[eventKey];
+    NSString *eventId = self.lazyEvents ? [self.lazyEvents entityIdForKey:eventKey] : self.eventKeyToEventIdMap[eventKey];
     if (!eventId) {
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventIdUnknownForEventKey, eventKey];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
@@ -227,7 +365,7 @@ static NSArray *supportedDatafileVersions = nil;
 }
 
 - (OPTLYEvent *)getEventForKey:(NSString *)eventKey{
-    OPTLYEvent *event = self.eventKeyToEventMap[eventKey];
+    OPTLYEvent *event = self.lazyEvents ? [self.lazyEvents entityForKey:eventKey] : self.eventKeyToEventMap[eventKey];
     if (!event) {
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventUnknownForEventKey, eventKey];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
@@ -236,7 +374,7 @@ static NSArray *supportedDatafileVersions = nil;
 }
 
 - (OPTLYExperiment *)getExperimentForId:(NSString *)experimentId {
-    OPTLYExperiment *experiment = self.experimentIdToExperimentMap[experimentId];
+    OPTLYExperiment *experiment = self.lazyExperiments ? [self.lazyExperiments entityForId:experimentId] : self.experimentIdToExperimentMap[experimentId];
     if (!experiment) {
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesExperimentUnknownForExperimentId, experimentId];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
@@ -245,7 +383,7 @@ static NSArray *supportedDatafileVersions = nil;
 }
 
 - (OPTLYExperiment *)getExperimentForKey:(NSString *)experimentKey {
-    OPTLYExperiment *experiment = self.experimentKeyToExperimentMap[experimentKey];
+    OPTLYExperiment *experiment = self.lazyExperiments ? [self.lazyExperiments entityForKey:experimentKey] : self.experimentKeyToExperimentMap[experimentKey];
     if (!experiment) {
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesExperimentUnknownForExperimentKey, experimentKey];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
@@ -255,7 +393,7 @@ static NSArray *supportedDatafileVersions = nil;
 
 - (NSString *)getExperimentIdForKey:(NSString *)experimentKey
 {
-    NSString *experimentId = self.experimentKeyToExperimentIdMap[experimentKey];
+    NSString *experimentId = self.lazyExperiments ? [self.lazyExperiments entityIdForKey:experimentKey] : self.experimentKeyToExperimentIdMap[experimentKey];
     if (!experimentId) {
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesExperimentIdUnknownForExperimentKey, experimentKey];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
@@ -388,6 +526,50 @@ static NSArray *supportedDatafileVersions = nil;
 
 #pragma mark -- Property Getters --
 
+- (NSArray<OPTLYExperiment *><OPTLYExperiment> *)experiments
+{
+    if (self.lazyExperiments) {
+        return (NSArray<OPTLYExperiment *><OPTLYExperiment> *)[self.lazyExperiments allEntities];
+    }
+    return _experiments;
+}
+
+- (NSArray<NSString *> *)experimentIds
+{
+    if (self.lazyExperiments) {
+        return self.lazyExperiments.entityIds;
+    }
+    NSMutableArray<NSString *> *experimentIds = [[NSMutableArray alloc] initWithCapacity:_experiments.count];
+    for (OPTLYExperiment *experiment in _experiments) {
+        [experimentIds addObject:experiment.experimentId];
+    }
+    return experimentIds;
+}
+
+- (NSArray<OPTLYAudience *><OPTLYAudience> *)audiences
+{
+    if (self.lazyAudiences) {
+        return (NSArray<OPTLYAudience *><OPTLYAudience> *)[self.lazyAudiences allEntities];
+    }
+    return _audiences;
+}
+
+- (NSArray<OPTLYAudience *><OPTLYAudience, OPTLYOptional> *)typedAudiences
+{
+    if (self.lazyTypedAudiences) {
+        return (NSArray<OPTLYAudience *><OPTLYAudience, OPTLYOptional> *)[self.lazyTypedAudiences allEntities];
+    }
+    return _typedAudiences;
+}
+
+- (NSArray<OPTLYEvent *><OPTLYEvent> *)events
+{
+    if (self.lazyEvents) {
+        return (NSArray<OPTLYEvent *><OPTLYEvent> *)[self.lazyEvents allEntities];
+    }
+    return _events;
+}
+
 - (NSArray *)allExperiments
 {
     if (!_allExperiments) {
@@ -405,7 +587,9 @@ static NSArray *supportedDatafileVersions = nil;
 - (NSDictionary *)audienceIdToAudienceMap
 {
     if (!_audienceIdToAudienceMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _audienceIdToAudienceMap = [self generateAudienceIdToAudienceMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _audienceIdToAudienceMap;
 }
@@ -414,35 +598,45 @@ static NSArray *supportedDatafileVersions = nil;
 - (NSDictionary *)attributeKeyToAttributeMap
 {
     if (!_attributeKeyToAttributeMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _attributeKeyToAttributeMap = [self generateAttributeToKeyMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _attributeKeyToAttributeMap;
 }
 
 - (NSDictionary *)eventKeyToEventIdMap {
     if (!_eventKeyToEventIdMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _eventKeyToEventIdMap = [self generateEventKeyToEventIdMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _eventKeyToEventIdMap;
 }
 
 - (NSDictionary *)eventKeyToEventMap {
     if (!_eventKeyToEventMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _eventKeyToEventMap = [self generateEventKeyToEventMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _eventKeyToEventMap;
 }
 
 - (NSDictionary<NSString *, OPTLYExperiment *> *)experimentIdToExperimentMap {
     if (!_experimentIdToExperimentMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _experimentIdToExperimentMap = [self generateExperimentIdToExperimentMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _experimentIdToExperimentMap;
 }
 
 - (NSDictionary<NSString *, OPTLYExperiment *> *)experimentKeyToExperimentMap {
     if (!_experimentKeyToExperimentMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _experimentKeyToExperimentMap = [self generateExperimentKeyToExperimentMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return  _experimentKeyToExperimentMap;
 }
@@ -450,7 +644,9 @@ static NSArray *supportedDatafileVersions = nil;
 - (NSDictionary<NSString *, NSString *> *)experimentKeyToExperimentIdMap
 {
     if (!_experimentKeyToExperimentIdMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _experimentKeyToExperimentIdMap = [self generateExperimentKeyToIdMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _experimentKeyToExperimentIdMap;
 }
@@ -458,14 +654,18 @@ static NSArray *supportedDatafileVersions = nil;
 - (NSDictionary<NSString *,NSArray *><OPTLYIgnore> *)experimentIdToFeatureIdsMap
 {
     if (!_experimentIdToFeatureIdsMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _experimentIdToFeatureIdsMap = [self generateExperimentIdToFeatureIdsMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _experimentIdToFeatureIdsMap;
 }
 
 - (NSDictionary<NSString *, OPTLYGroup *> *)groupIdToGroupMap {
     if (!_groupIdToGroupMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _groupIdToGroupMap = [OPTLYProjectConfig generateGroupIdToGroupMapFromGroupsArray:_groups];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _groupIdToGroupMap;
 }
@@ -482,14 +682,18 @@ static NSArray *supportedDatafileVersions = nil;
 
 - (NSDictionary<NSString *, OPTLYFeatureFlag *> *)featureFlagKeyToFeatureFlagMap {
     if (!_featureFlagKeyToFeatureFlagMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _featureFlagKeyToFeatureFlagMap = [self generateFeatureFlagKeyToFeatureFlagMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return  _featureFlagKeyToFeatureFlagMap;
 }
 
 - (NSDictionary<NSString *, OPTLYRollout *> *)rolloutIdToRolloutMap {
     if (!_rolloutIdToRolloutMap) {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _rolloutIdToRolloutMap = [self generateRolloutIdToRolloutMap];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseIndexConstruction since:startTime];
     }
     return _rolloutIdToRolloutMap;
 }
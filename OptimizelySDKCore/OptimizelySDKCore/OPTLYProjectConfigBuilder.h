@@ -48,6 +48,9 @@ typedef void (^OPTLYProjectConfigBuilderBlock)(OPTLYProjectConfigBuilder * _Null
 @property (nonatomic, strong, nonnull) NSString *clientVersion;
 /// The client engine
 @property (nonatomic, strong, nonnull) NSString *clientEngine;
+/// When YES, experiments, audiences and events are only indexed by id and key while parsing
+/// and their model objects are materialized on first access. Defaults to NO.
+@property (nonatomic, assign) BOOL lazyDatafileParsing;
 
 
 @end
@@ -0,0 +1,72 @@
+/****************************************************************************
+ * Copyright 2016-2020, Optimizely, Inc. and contributors                   *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class limits how many network requests run at the same time.
+ Requests that can't start yet wait in a queue; higher priority requests start first and
+ requests of the same priority start in the order they were scheduled.
+ All methods are thread-safe.
+ */
+
+typedef NS_ENUM(NSInteger, OPTLYRequestPriority) {
+    OPTLYRequestPriorityLow,
+    OPTLYRequestPriorityDefault,
+    OPTLYRequestPriorityHigh,
+};
+
+/// A scheduled request. It must call done exactly once, when the request has completed.
+typedef void (^OPTLYRequestSchedulerRequest)(dispatch_block_t _Nonnull done);
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYRequestScheduler : NSObject
+
+/// The name of the scheduler, used to label its queue.
+@property (nonatomic, strong, readonly) NSString *name;
+/// The maximum number of requests in flight. Values less than 1 are treated as 1.
+@property (atomic, assign) NSUInteger maxConcurrentRequests;
+/// The number of requests that have started and not called done yet.
+@property (atomic, assign, readonly) NSUInteger inFlightCount;
+/// The number of requests waiting to start.
+@property (atomic, assign, readonly) NSUInteger queuedCount;
+
+/**
+ * Initializes a scheduler.
+ *
+ * @param name The name of the scheduler.
+ * @param maxConcurrentRequests The maximum number of requests in flight.
+ * @return An instance of the scheduler.
+ */
+- (instancetype)initWithName:(NSString *)name
+       maxConcurrentRequests:(NSUInteger)maxConcurrentRequests NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Schedules a request. It starts right away if there is a free slot,
+ * otherwise it is queued behind requests of the same or higher priority.
+ *
+ * @param request The block that performs the request.
+ * @param priority The priority of the request.
+ */
+- (void)scheduleRequest:(OPTLYRequestSchedulerRequest)request
+               priority:(OPTLYRequestPriority)priority;
+
+@end
+
+NS_ASSUME_NONNULL_END
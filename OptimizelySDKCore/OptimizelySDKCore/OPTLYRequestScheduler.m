@@ -0,0 +1,124 @@
+/****************************************************************************
+ * Copyright 2016-2020, Optimizely, Inc. and contributors                   *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import "OPTLYRequestScheduler.h"
+
+static NSUInteger const kPriorityCount = OPTLYRequestPriorityHigh + 1;
+
+@interface OPTLYRequestScheduler()
+@property (atomic, assign, readwrite) NSUInteger inFlightCount;
+@property (atomic, assign, readwrite) NSUInteger queuedCount;
+/// serializes all changes to the queues and counts
+@property (nonatomic, strong) dispatch_queue_t schedulerQueue;
+/// one FIFO queue per priority
+@property (nonatomic, strong) NSArray<NSMutableArray<OPTLYRequestSchedulerRequest> *> *pendingRequests;
+@end
+
+@implementation OPTLYRequestScheduler
+
+@synthesize maxConcurrentRequests = _maxConcurrentRequests;
+
+- (instancetype)initWithName:(NSString *)name
+       maxConcurrentRequests:(NSUInteger)maxConcurrentRequests {
+    self = [super init];
+    if (self != nil) {
+        _name = [name copy];
+        _maxConcurrentRequests = MAX(maxConcurrentRequests, 1);
+        NSString *queueLabel = [NSString stringWithFormat:@"com.Optimizely.requestScheduler.%@", name];
+        _schedulerQueue = dispatch_queue_create([queueLabel UTF8String], DISPATCH_QUEUE_SERIAL);
+        NSMutableArray *pendingRequests = [[NSMutableArray alloc] initWithCapacity:kPriorityCount];
+        for (NSUInteger i = 0; i < kPriorityCount; i++) {
+            [pendingRequests addObject:[NSMutableArray new]];
+        }
+        _pendingRequests = [pendingRequests copy];
+    }
+    return self;
+}
+
+- (NSUInteger)maxConcurrentRequests {
+    @synchronized (self) {
+        return _maxConcurrentRequests;
+    }
+}
+
+- (void)setMaxConcurrentRequests:(NSUInteger)maxConcurrentRequests {
+    @synchronized (self) {
+        _maxConcurrentRequests = MAX(maxConcurrentRequests, 1);
+    }
+    // a larger limit can start queued requests
+    dispatch_async(self.schedulerQueue, ^{
+        [self startPendingRequests];
+    });
+}
+
+- (void)scheduleRequest:(OPTLYRequestSchedulerRequest)request
+               priority:(OPTLYRequestPriority)priority {
+    if (!request) {
+        return;
+    }
+    NSUInteger index = MIN(MAX(priority, OPTLYRequestPriorityLow), OPTLYRequestPriorityHigh);
+    OPTLYRequestSchedulerRequest requestCopy = [request copy];
+    dispatch_async(self.schedulerQueue, ^{
+        [self.pendingRequests[index] addObject:requestCopy];
+        self.queuedCount++;
+        [self startPendingRequests];
+    });
+}
+
+# pragma mark - Helper Methods
+
+// must be called on schedulerQueue
+- (void)startPendingRequests {
+    while (self.inFlightCount < self.maxConcurrentRequests) {
+        OPTLYRequestSchedulerRequest request = [self dequeueRequest];
+        if (!request) {
+            return;
+        }
+        self.inFlightCount++;
+        
+        __block BOOL finished = NO;
+        dispatch_block_t done = ^{
+            dispatch_async(self.schedulerQueue, ^{
+                if (finished) {
+                    return;
+                }
+                finished = YES;
+                self.inFlightCount--;
+                [self startPendingRequests];
+            });
+        };
+        // requests may do work before going async, so don't run them on the scheduler queue
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            request(done);
+        });
+    }
+}
+
+// must be called on schedulerQueue
+- (OPTLYRequestSchedulerRequest)dequeueRequest {
+    for (NSInteger i = kPriorityCount - 1; i >= 0; i--) {
+        NSMutableArray *requests = self.pendingRequests[i];
+        if (requests.count > 0) {
+            OPTLYRequestSchedulerRequest request = requests.firstObject;
+            [requests removeObjectAtIndex:0];
+            self.queuedCount--;
+            return request;
+        }
+    }
+    return nil;
+}
+
+@end
@@ -0,0 +1,98 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class decides whether a request may be sent or retried, so a failing endpoint is not
+ hammered by every queued event at once.
+ - Retries draw from a token budget that successful requests slowly refill.
+ - A circuit breaker opens after consecutive failures. While it is open no request is sent;
+   once the open interval has passed it lets a single probe request through, which either
+   closes the circuit again or reopens it.
+ All methods are thread-safe.
+ */
+
+typedef NS_ENUM(NSInteger, OPTLYCircuitState) {
+    OPTLYCircuitStateClosed,
+    OPTLYCircuitStateOpen,
+    OPTLYCircuitStateHalfOpen,
+};
+
+// Default number of retries that can be made without a successful request in between
+extern const double OPTLYRequestThrottleDefaultMaxRetryTokens;
+// Default number of consecutive failures that opens the circuit
+extern const NSUInteger OPTLYRequestThrottleDefaultFailureThreshold;
+// Default time (in s) the circuit stays open before a probe request is allowed
+extern const NSTimeInterval OPTLYRequestThrottleDefaultOpenInterval;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYRequestThrottle : NSObject
+
+@property (nonatomic, assign, readonly) double maxRetryTokens;
+@property (nonatomic, assign, readonly) NSUInteger failureThreshold;
+@property (nonatomic, assign, readonly) NSTimeInterval openInterval;
+/// The current state of the circuit breaker.
+@property (atomic, assign, readonly) OPTLYCircuitState circuitState;
+/// The retry tokens left.
+@property (atomic, assign, readonly) double retryTokens;
+
+/**
+ * Initializes a throttle with the default budget and breaker settings.
+ */
+- (instancetype)init;
+
+/**
+ * Initializes a throttle.
+ *
+ * @param maxRetryTokens The size of the retry budget.
+ * @param failureThreshold The number of consecutive failures that opens the circuit.
+ * @param openInterval The time (in s) the circuit stays open before a probe is allowed.
+ * @return An instance of the throttle.
+ */
+- (instancetype)initWithMaxRetryTokens:(double)maxRetryTokens
+                      failureThreshold:(NSUInteger)failureThreshold
+                          openInterval:(NSTimeInterval)openInterval NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Asks to send a request. Every request that is allowed must be followed by
+ * recordSuccess or recordFailure.
+ *
+ * @return NO if the circuit is open, or if it is half-open and the probe is already in flight.
+ */
+- (BOOL)beginRequest;
+
+/**
+ * Takes a token from the retry budget.
+ *
+ * @return NO if the budget is exhausted and the request should not be retried.
+ */
+- (BOOL)acquireRetryToken;
+
+/**
+ * Records a request that reached the server, closing the circuit and refilling the budget.
+ */
+- (void)recordSuccess;
+
+/**
+ * Records a failed request (a network error or a server error).
+ */
+- (void)recordFailure;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,110 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import "OPTLYRequestThrottle.h"
+
+const double OPTLYRequestThrottleDefaultMaxRetryTokens = 10;
+const NSUInteger OPTLYRequestThrottleDefaultFailureThreshold = 5;
+const NSTimeInterval OPTLYRequestThrottleDefaultOpenInterval = 30;
+
+// every successful request gives back this fraction of a retry token
+static double const kRetryTokenRefund = 0.2;
+
+@interface OPTLYRequestThrottle()
+@property (atomic, assign) OPTLYCircuitState circuitState;
+@property (atomic, assign) double retryTokens;
+@property (nonatomic, assign) NSUInteger consecutiveFailures;
+/// system uptime when the circuit last opened
+@property (nonatomic, assign) NSTimeInterval openedAt;
+@end
+
+@implementation OPTLYRequestThrottle
+
+- (instancetype)init {
+    return [self initWithMaxRetryTokens:OPTLYRequestThrottleDefaultMaxRetryTokens
+                       failureThreshold:OPTLYRequestThrottleDefaultFailureThreshold
+                           openInterval:OPTLYRequestThrottleDefaultOpenInterval];
+}
+
+- (instancetype)initWithMaxRetryTokens:(double)maxRetryTokens
+                      failureThreshold:(NSUInteger)failureThreshold
+                          openInterval:(NSTimeInterval)openInterval {
+    self = [super init];
+    if (self != nil) {
+        _maxRetryTokens = MAX(maxRetryTokens, 0);
+        _failureThreshold = MAX(failureThreshold, 1);
+        _openInterval = MAX(openInterval, 0);
+        _retryTokens = _maxRetryTokens;
+        _circuitState = OPTLYCircuitStateClosed;
+    }
+    return self;
+}
+
+- (BOOL)beginRequest {
+    @synchronized (self) {
+        switch (self.circuitState) {
+            case OPTLYCircuitStateClosed:
+                return YES;
+            case OPTLYCircuitStateOpen:
+                if ([self now] - self.openedAt < self.openInterval) {
+                    return NO;
+                }
+                // this request is the probe
+                self.circuitState = OPTLYCircuitStateHalfOpen;
+                return YES;
+            case OPTLYCircuitStateHalfOpen:
+                return NO;
+        }
+    }
+}
+
+- (BOOL)acquireRetryToken {
+    @synchronized (self) {
+        if (self.retryTokens < 1) {
+            return NO;
+        }
+        self.retryTokens -= 1;
+        return YES;
+    }
+}
+
+- (void)recordSuccess {
+    @synchronized (self) {
+        self.consecutiveFailures = 0;
+        self.circuitState = OPTLYCircuitStateClosed;
+        self.retryTokens = MIN(self.retryTokens + kRetryTokenRefund, self.maxRetryTokens);
+    }
+}
+
+- (void)recordFailure {
+    @synchronized (self) {
+        self.consecutiveFailures++;
+        if (self.circuitState == OPTLYCircuitStateHalfOpen
+            || self.consecutiveFailures >= self.failureThreshold) {
+            self.circuitState = OPTLYCircuitStateOpen;
+            self.openedAt = [self now];
+        }
+    }
+}
+
+# pragma mark - Helper Methods
+
+// monotonic, so wall clock changes don't keep the circuit open
+- (NSTimeInterval)now {
+    return [[NSProcessInfo processInfo] systemUptime];
+}
+
+@end
@@ -0,0 +1,114 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class breaks down the time the SDK spends starting up. The manager, the data store,
+ the datafile manager and the project config record how long each startup phase takes, and
+ the report lists them by phase name. Unlike OPTLYMetrics, phases are always recorded: each
+ happens a few times per launch. The manager seals the report once its first client is created;
+ the phases are frozen from then on, so later flushes, polls and config rebuilds are not counted.
+ The report is also part of the OPTLYMetrics snapshot.
+ All methods are thread-safe.
+ */
+
+typedef NS_ENUM(NSUInteger, OPTLYStartupPhase) {
+    // creating the OPTLYDataStore singleton
+    OPTLYStartupPhaseDataStore,
+    // opening the events database and creating its tables
+    OPTLYStartupPhaseDatabaseOpen,
+    // reading the saved datafile
+    OPTLYStartupPhaseDatafileRead,
+    // parsing the datafile JSON
+    OPTLYStartupPhaseDatafileJSONParse,
+    // building the OPTLYJSONModel objects of the project config
+    OPTLYStartupPhaseModelMaterialization,
+    // building the lookup indexes of the project config (when first used, unless parsed lazily)
+    OPTLYStartupPhaseIndexConstruction,
+    // migrating legacy user profiles
+    OPTLYStartupPhaseUserProfileMigration,
+    // setting up the datafile download and event dispatch timers
+    OPTLYStartupPhaseTimerSetup,
+    // the manager initializer, which creates the SDK components
+    OPTLYStartupPhaseManagerInitialization,
+    // creating a client from a datafile, which includes building the project config
+    OPTLYStartupPhaseClientInitialization,
+    OPTLYStartupPhaseCOUNT
+};
+
+// Keys of a phase in the report
+extern NSString * _Nonnull const OPTLYStartupReportCountKey;
+extern NSString * _Nonnull const OPTLYStartupReportTotalKey;
+extern NSString * _Nonnull const OPTLYStartupReportOffsetKey;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYStartupReport : NSObject
+
+/**
+ * Returns a start time to pass to recordPhase:since:.
+ */
++ (uint64_t)startTime;
+
+/**
+ * Records the time elapsed since a start time returned by startTime. Ignored once the report is sealed.
+ */
++ (void)recordPhase:(OPTLYStartupPhase)phase since:(uint64_t)startTime;
+
+/**
+ * Ends startup: phases recorded from now on are ignored.
+ *
+ * @return YES if this call sealed the report, NO if it was already sealed.
+ */
++ (BOOL)seal;
+
+/**
+ * Returns YES once the report is sealed.
+ */
++ (BOOL)isSealed;
+
+/**
+ * Returns how many times a phase was recorded.
+ */
++ (int64_t)countOfPhase:(OPTLYStartupPhase)phase;
+
+/**
+ * Returns the total time (in s) recorded for a phase.
+ */
++ (NSTimeInterval)durationOfPhase:(OPTLYStartupPhase)phase;
+
+/**
+ * Returns the recorded phases, keyed by phase name. Each phase has its count, its total time (in µs),
+ * and the offset (in µs) of its first start from the first start of any phase, which orders the phases.
+ * Phases never recorded are omitted. Phases nest: the manager and client initializations include other phases.
+ */
++ (NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)report;
+
+/**
+ * Returns the name of a phase as used in the report.
+ */
++ (NSString *)nameOfPhase:(OPTLYStartupPhase)phase;
+
+/**
+ * Clears every phase and unseals the report.
+ */
++ (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,128 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <stdatomic.h>
+#import "OPTLYStartupReport.h"
+#import "OPTLYTime.h"
+
+NSString * const OPTLYStartupReportCountKey = @"count";
+NSString * const OPTLYStartupReportTotalKey = @"total_us";
+NSString * const OPTLYStartupReportOffsetKey = @"offset_us";
+
+typedef struct {
+    atomic_llong count;
+    atomic_ullong total;            // mach time
+    atomic_ullong firstStartTime;   // mach time, 0 until recorded
+} OPTLYStartupReportPhase;
+
+static OPTLYStartupReportPhase gPhases[OPTLYStartupPhaseCOUNT];
+static atomic_ullong gFirstStartTime;
+static atomic_bool gSealed;
+
+// Keeps the earliest start time: nested phases are recorded after they started
+static void storeFirstStartTime(atomic_ullong *firstStartTime, uint64_t startTime) {
+    unsigned long long expected = atomic_load_explicit(firstStartTime, memory_order_relaxed);
+    while ((expected == 0 || startTime < expected) &&
+           !atomic_compare_exchange_weak_explicit(firstStartTime, &expected, startTime, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+@implementation OPTLYStartupReport
+
++ (uint64_t)startTime {
+    return OPTLYTimeNow();
+}
+
++ (void)recordPhase:(OPTLYStartupPhase)phase since:(uint64_t)startTime {
+    if (phase >= OPTLYStartupPhaseCOUNT || startTime == 0 || atomic_load_explicit(&gSealed, memory_order_relaxed)) {
+        return;
+    }
+    uint64_t duration = OPTLYTimeNow() - startTime;
+    OPTLYStartupReportPhase *reportPhase = &gPhases[phase];
+    storeFirstStartTime(&gFirstStartTime, startTime);
+    storeFirstStartTime(&reportPhase->firstStartTime, startTime);
+    atomic_fetch_add_explicit(&reportPhase->total, duration, memory_order_relaxed);
+    atomic_fetch_add_explicit(&reportPhase->count, 1, memory_order_relaxed);
+}
+
++ (BOOL)seal {
+    return !atomic_exchange_explicit(&gSealed, true, memory_order_relaxed);
+}
+
++ (BOOL)isSealed {
+    return atomic_load_explicit(&gSealed, memory_order_relaxed);
+}
+
++ (int64_t)countOfPhase:(OPTLYStartupPhase)phase {
+    return phase < OPTLYStartupPhaseCOUNT ? atomic_load_explicit(&gPhases[phase].count, memory_order_relaxed) : 0;
+}
+
++ (NSTimeInterval)durationOfPhase:(OPTLYStartupPhase)phase {
+    if (phase >= OPTLYStartupPhaseCOUNT) {
+        return 0;
+    }
+    return (NSTimeInterval)OPTLYTimeNanosecondsFromMachTime(atomic_load_explicit(&gPhases[phase].total, memory_order_relaxed)) / NSEC_PER_SEC;
+}
+
++ (NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)report {
+    uint64_t firstStartTime = atomic_load_explicit(&gFirstStartTime, memory_order_relaxed);
+    NSMutableDictionary *report = [NSMutableDictionary new];
+    for (OPTLYStartupPhase phase = 0; phase < OPTLYStartupPhaseCOUNT; phase++) {
+        OPTLYStartupReportPhase *reportPhase = &gPhases[phase];
+        int64_t count = atomic_load_explicit(&reportPhase->count, memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        uint64_t total = atomic_load_explicit(&reportPhase->total, memory_order_relaxed);
+        uint64_t phaseStartTime = atomic_load_explicit(&reportPhase->firstStartTime, memory_order_relaxed);
+        uint64_t offset = phaseStartTime > firstStartTime ? phaseStartTime - firstStartTime : 0;
+        report[[self nameOfPhase:phase]] = @{
+            OPTLYStartupReportCountKey : @(count),
+            OPTLYStartupReportTotalKey : @(OPTLYTimeNanosecondsFromMachTime(total) / NSEC_PER_USEC),
+            OPTLYStartupReportOffsetKey : @(OPTLYTimeNanosecondsFromMachTime(offset) / NSEC_PER_USEC),
+        };
+    }
+    return [report copy];
+}
+
++ (NSString *)nameOfPhase:(OPTLYStartupPhase)phase {
+    switch (phase) {
+        case OPTLYStartupPhaseDataStore: return @"data_store";
+        case OPTLYStartupPhaseDatabaseOpen: return @"database_open";
+        case OPTLYStartupPhaseDatafileRead: return @"datafile_read";
+        case OPTLYStartupPhaseDatafileJSONParse: return @"datafile_json_parse";
+        case OPTLYStartupPhaseModelMaterialization: return @"model_materialization";
+        case OPTLYStartupPhaseIndexConstruction: return @"index_construction";
+        case OPTLYStartupPhaseUserProfileMigration: return @"user_profile_migration";
+        case OPTLYStartupPhaseTimerSetup: return @"timer_setup";
+        case OPTLYStartupPhaseManagerInitialization: return @"manager_initialization";
+        case OPTLYStartupPhaseClientInitialization: return @"client_initialization";
+        default: return @"unknown";
+    }
+}
+
++ (void)reset {
+    for (NSUInteger i = 0; i < OPTLYStartupPhaseCOUNT; i++) {
+        atomic_store_explicit(&gPhases[i].count, 0, memory_order_relaxed);
+        atomic_store_explicit(&gPhases[i].total, 0, memory_order_relaxed);
+        atomic_store_explicit(&gPhases[i].firstStartTime, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&gFirstStartTime, 0, memory_order_relaxed);
+    atomic_store_explicit(&gSealed, false, memory_order_relaxed);
+}
+
+@end
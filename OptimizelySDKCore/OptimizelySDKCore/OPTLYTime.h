@@ -0,0 +1,37 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ Conversions of mach_absolute_time() values, shared by the metrics, the startup report and the
+ decision traces. The mach timebase is read once.
+ */
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Returns the current mach absolute time.
+ */
+uint64_t OPTLYTimeNow(void);
+
+/**
+ * Converts a mach time interval to nanoseconds.
+ */
+uint64_t OPTLYTimeNanosecondsFromMachTime(uint64_t machTime);
+
+NS_ASSUME_NONNULL_END
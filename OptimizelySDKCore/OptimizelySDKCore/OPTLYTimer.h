@@ -0,0 +1,79 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ This is a repeating timer built on a dispatch source. The handler runs on a private serial
+ queue, so the timer doesn't need a run loop and never wakes the main thread.
+ The tolerance lets the system coalesce the timer with other wakeups.
+ A timer is created suspended; call resume to start it. Unlike NSTimer, it doesn't
+ retain the objects its handler refers to, so capture the owner weakly.
+ All methods are thread-safe.
+ */
+
+// Tolerance used when a negative tolerance is given, as a fraction of the interval
+extern const double OPTLYTimerDefaultToleranceRatio;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYTimer : NSObject
+
+/// The name of the timer, used to label its queue.
+@property (nonatomic, strong, readonly) NSString *name;
+/// The time (in s) between two firings.
+@property (nonatomic, assign, readonly) NSTimeInterval timeInterval;
+/// How late (in s) the timer may fire.
+@property (nonatomic, assign, readonly) NSTimeInterval tolerance;
+/// NO once the timer has been invalidated.
+@property (atomic, assign, readonly, getter=isValid) BOOL valid;
+/// YES while the timer is not firing: before the first resume and after suspend.
+@property (atomic, assign, readonly, getter=isSuspended) BOOL suspended;
+
+/**
+ * Initializes a suspended timer.
+ *
+ * @param name The name of the timer.
+ * @param timeInterval The time (in s) between two firings. The first firing is one interval after resume.
+ * @param tolerance How late (in s) the timer may fire. A negative value uses OPTLYTimerDefaultToleranceRatio of the interval.
+ * @param handler The block to run every time the timer fires.
+ * @return An instance of the timer.
+ */
+- (instancetype)initWithName:(NSString *)name
+                timeInterval:(NSTimeInterval)timeInterval
+                   tolerance:(NSTimeInterval)tolerance
+                     handler:(dispatch_block_t)handler NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Starts the timer, or restarts a suspended timer one interval from now.
+ */
+- (void)resume;
+
+/**
+ * Stops the timer from firing until it is resumed.
+ */
+- (void)suspend;
+
+/**
+ * Stops the timer for good. The handler is released.
+ */
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
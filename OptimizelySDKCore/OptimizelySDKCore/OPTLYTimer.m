@@ -0,0 +1,92 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import "OPTLYTimer.h"
+
+const double OPTLYTimerDefaultToleranceRatio = 0.1;
+
+@interface OPTLYTimer()
+@property (atomic, assign, readwrite, getter=isValid) BOOL valid;
+@property (atomic, assign, readwrite, getter=isSuspended) BOOL suspended;
+@property (nonatomic, strong) dispatch_source_t source;
+@end
+
+@implementation OPTLYTimer
+
+- (instancetype)initWithName:(NSString *)name
+                timeInterval:(NSTimeInterval)timeInterval
+                   tolerance:(NSTimeInterval)tolerance
+                     handler:(dispatch_block_t)handler {
+    self = [super init];
+    if (self != nil) {
+        _name = [name copy];
+        _timeInterval = MAX(timeInterval, 0);
+        _tolerance = tolerance >= 0 ? tolerance : _timeInterval * OPTLYTimerDefaultToleranceRatio;
+        NSString *queueLabel = [NSString stringWithFormat:@"com.Optimizely.timer.%@", name];
+        dispatch_queue_t queue = dispatch_queue_create([queueLabel UTF8String], DISPATCH_QUEUE_SERIAL);
+        _source = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, queue);
+        dispatch_source_set_event_handler(_source, handler);
+        // dispatch sources are created suspended
+        _suspended = YES;
+        _valid = YES;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self invalidate];
+}
+
+- (void)resume {
+    @synchronized (self) {
+        if (!self.valid || !self.suspended) {
+            return;
+        }
+        uint64_t interval_ns = (uint64_t)(self.timeInterval * NSEC_PER_SEC);
+        dispatch_source_set_timer(self.source,
+                                  dispatch_time(DISPATCH_TIME_NOW, interval_ns),
+                                  interval_ns,
+                                  (uint64_t)(self.tolerance * NSEC_PER_SEC));
+        dispatch_resume(self.source);
+        self.suspended = NO;
+    }
+}
+
+- (void)suspend {
+    @synchronized (self) {
+        if (!self.valid || self.suspended) {
+            return;
+        }
+        dispatch_suspend(self.source);
+        self.suspended = YES;
+    }
+}
+
+- (void)invalidate {
+    @synchronized (self) {
+        if (!self.valid) {
+            return;
+        }
+        dispatch_source_cancel(self.source);
+        // a suspended source must be resumed to finish cancelling and be released
+        if (self.suspended) {
+            dispatch_resume(self.source);
+        }
+        self.valid = NO;
+    }
+}
+
+@end
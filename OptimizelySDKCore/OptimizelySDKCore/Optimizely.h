@@ -17,9 +17,15 @@
 #import <Foundation/Foundation.h>
 #import "OPTLYBuilder.h"
 
-@class OPTLYProjectConfig, OPTLYVariation, OPTLYDecisionService, OPTLYNotificationCenter;
+@class OPTLYProjectConfig, OPTLYVariation, OPTLYDecisionService, OPTLYImpressionDeduplicator, OPTLYNotificationCenter;
 @protocol OPTLYBucketer, OPTLYErrorHandler, OPTLYEventBuilder, OPTLYEventDispatcher, OPTLYLogger;
 
+// Keys of the events passed to trackEvents:userId:attributes:
+NS_ASSUME_NONNULL_BEGIN
+extern NSString * const OPTLYTrackEventKey;
+extern NSString * const OPTLYTrackEventTagsKey;
+NS_ASSUME_NONNULL_END
+
 @protocol Optimizely <NSObject>
 
 #pragma mark - activateExperiment methods
@@ -66,6 +72,22 @@
                                userId:(nonnull NSString *)userId
                            attributes:(nullable NSDictionary<NSString *, id> *)attributes;
 
+/**
+ * Activates several A/B tests for a user at once, for example all the experiments on a screen.
+ * Behaves like calling `activate` for each experiment, except that a single impression event
+ * carrying every decision is sent, so the user and their attributes are only sent once.
+ *
+ * @param experimentKeys The keys of the experiments to activate.
+ * @param userId         The user ID.
+ * @param attributes     A map of custom key-value string pairs specifying attributes for the user.
+ *
+ * @return               A map of experiment keys to the variation where the user is bucketed. Experiments
+ *                       the user doesn't qualify for are left out.
+ */
+- (nonnull NSDictionary<NSString *, OPTLYVariation *> *)activateExperiments:(nonnull NSArray<NSString *> *)experimentKeys
+                                                                     userId:(nonnull NSString *)userId
+                                                                 attributes:(nullable NSDictionary<NSString *, id> *)attributes;
+
 #pragma mark - getVariation methods
 /**
  * Use the `getVariation` method if `activate` has been called and the current variation assignment
@@ -356,6 +378,20 @@
    attributes:(nullable NSDictionary<NSString *, id> *)attributes
     eventTags:(nullable NSDictionary<NSString *, id> *)eventTags;
 
+/**
+ * Tracks several conversion events for a user at once, for example one event per item in a cart.
+ * Behaves like calling `track` for each event, except that a single conversion event carrying
+ * every event is sent, so the user and their attributes are only sent once.
+ *
+ * @param events     The events to track. Each event is a map holding its key under `OPTLYTrackEventKey`
+ *                   and, optionally, its event tags under `OPTLYTrackEventTagsKey`. The same key can appear more than once.
+ * @param userId     The ID of the user associated with the events being tracked.
+ * @param attributes A map of custom key-value string pairs specifying attributes for the user.
+ */
+- (void)trackEvents:(nonnull NSArray<NSDictionary<NSString *, id> *> *)events
+             userId:(nonnull NSString *)userId
+         attributes:(nullable NSDictionary<NSString *, id> *)attributes;
+
 @end
 
 /**
@@ -373,6 +409,8 @@
 @property (nonatomic, strong, readonly, nullable) id<OPTLYLogger> logger;
 @property (nonatomic, strong, readonly, nullable) id<OPTLYUserProfileService> userProfileService;
 @property (nonatomic, strong, readonly, nullable) OPTLYNotificationCenter *notificationCenter;
+/// Suppresses repeated impressions (nil unless the builder sets impressionDeduplicationWindow).
+@property (nonatomic, strong, readonly, nullable) OPTLYImpressionDeduplicator *impressionDeduplicator;
 
 /**
  * Instantiate and initialize an `Optimizely` instance using a builder block.
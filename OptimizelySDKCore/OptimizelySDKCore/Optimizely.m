@@ -27,7 +27,9 @@
 #import "OPTLYEventParameterKeys.h"
 #import "OPTLYEvent.h"
 #import "OPTLYExperiment.h"
+#import "OPTLYImpressionDeduplicator.h"
 #import "OPTLYLogger.h"
+#import "OPTLYMetrics.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYUserProfileServiceBasic.h"
 #import "OPTLYVariation.h"
@@ -39,6 +41,9 @@
 #import "OPTLYNotificationCenter.h"
 #import "OPTLYNSObject+Validation.h"
 
+NSString * const OPTLYTrackEventKey = @"eventKey";
+NSString * const OPTLYTrackEventTagsKey = @"eventTags";
+
 @implementation Optimizely
 
 + (instancetype)init:(OPTLYBuilderBlock)builderBlock {
@@ -62,6 +67,7 @@
             _logger = builder.logger;
             _userProfileService = builder.userProfileService;
             _notificationCenter = builder.notificationCenter;
+            _impressionDeduplicator = builder.impressionDeduplicator;
         } else {
             // Provided OPTLYBuilder object is invalid
             if (_logger == nil) {
@@ -101,6 +107,16 @@
                       userId:(NSString *)userId
                   attributes:(NSDictionary<NSString *, id> *)attributes
                     callback:(void (^)(NSError *))callback {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    OPTLYVariation *variation = [self activateExperiment:experimentKey userId:userId attributes:attributes callback:callback];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyActivate since:startTime];
+    return variation;
+}
+
+- (OPTLYVariation *)activateExperiment:(NSString *)experimentKey
+                                userId:(NSString *)userId
+                            attributes:(NSDictionary<NSString *, id> *)attributes
+                              callback:(void (^)(NSError *))callback {
     
     __weak void (^_callback)(NSError *) = callback ? : ^(NSError *error) {};
     
@@ -160,6 +176,46 @@
     return variation;
 }
 
+- (NSDictionary<NSString *, OPTLYVariation *> *)activateExperiments:(NSArray<NSString *> *)experimentKeys
+                                                             userId:(NSString *)userId
+                                                         attributes:(NSDictionary<NSString *, id> *)attributes {
+    NSMutableDictionary<NSString *, OPTLYVariation *> *variations = [NSMutableDictionary new];
+    if (![userId isValidStringType]) {
+        [self handleErrorLogsForActivate:OPTLYLoggerMessagesUserIdInvalid ofLevel:OptimizelyLogLevelError];
+        return variations;
+    }
+    
+    NSMutableArray<OPTLYExperiment *> *experiments = [NSMutableArray new];
+    NSMutableArray<OPTLYVariation *> *experimentVariations = [NSMutableArray new];
+    for (NSString *experimentKey in experimentKeys) {
+        if ([experimentKey getValidString] == nil) {
+            [self handleErrorLogsForActivate:OPTLYLoggerMessagesActivateExperimentKeyEmpty ofLevel:OptimizelyLogLevelError];
+            continue;
+        }
+        if (variations[experimentKey]) {
+            continue;
+        }
+        OPTLYExperiment *experiment = [self.config getExperimentForKey:experimentKey];
+        if (!experiment) {
+            NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesActivateExperimentKeyInvalid, experimentKey];
+            [self handleErrorLogsForActivate:logMessage ofLevel:OptimizelyLogLevelError];
+            continue;
+        }
+        OPTLYVariation *variation = [self variation:experimentKey userId:userId attributes:attributes];
+        if (!variation) {
+            NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherActivationFailure, userId, experimentKey];
+            [self handleErrorLogsForActivate:logMessage ofLevel:OptimizelyLogLevelInfo];
+            continue;
+        }
+        variations[experimentKey] = variation;
+        [experiments addObject:experiment];
+        [experimentVariations addObject:variation];
+    }
+    
+    [self sendImpressionEventForExperiments:experiments variations:experimentVariations userId:userId attributes:attributes];
+    return variations;
+}
+
 #pragma mark getVariation methods
 - (OPTLYVariation *)variation:(NSString *)experimentKey
                        userId:(NSString *)userId {
@@ -243,6 +299,13 @@
 #pragma mark - Feature Flag Methods
 
 - (BOOL)isFeatureEnabled:(NSString *)featureKey userId:(NSString *)userId attributes:(nullable NSDictionary<NSString *, id> *)attributes {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    BOOL result = [self featureEnabled:featureKey userId:userId attributes:attributes];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyIsFeatureEnabled since:startTime];
+    return result;
+}
+
+- (BOOL)featureEnabled:(NSString *)featureKey userId:(NSString *)userId attributes:(nullable NSDictionary<NSString *, id> *)attributes {
     BOOL result = false;
     NSMutableDictionary<NSString *, NSString *> *inputValues = [[NSMutableDictionary alloc] initWithDictionary:@{
                                                                                                                     OPTLYNotificationUserIdKey:[self ObjectOrNull:userId],
@@ -317,6 +380,17 @@
                          variableKey:(nullable NSString *)variableKey
                               userId:(nullable NSString *)userId
                           attributes:(nullable NSDictionary<NSString *, id> *)attributes {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    id value = [self featureVariableValueForType:variableType featureKey:featureKey variableKey:variableKey userId:userId attributes:attributes];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyGetFeatureVariable since:startTime];
+    return value;
+}
+
+- (id)featureVariableValueForType:(NSString *)variableType
+                       featureKey:(nullable NSString *)featureKey
+                      variableKey:(nullable NSString *)variableKey
+                           userId:(nullable NSString *)userId
+                       attributes:(nullable NSDictionary<NSString *, id> *)attributes {
     
     NSMutableDictionary<NSString *, NSString *> *inputValues = [[NSMutableDictionary alloc] initWithDictionary:@{
                                                                                                                     OPTLYNotificationUserIdKey:[self ObjectOrNull:userId],
@@ -506,6 +580,23 @@
        userId:(NSString *)userId
    attributes:(NSDictionary<NSString *, id> *)attributes
     eventTags:(NSDictionary<NSString *,id> *)eventTags {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    [self trackEvent:eventKey userId:userId attributes:attributes eventTags:eventTags];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyTrack since:startTime];
+}
+
+- (void)trackEvents:(NSArray<NSDictionary<NSString *, id> *> *)events
+             userId:(NSString *)userId
+         attributes:(NSDictionary<NSString *, id> *)attributes {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    [self trackEventBatch:events userId:userId attributes:attributes];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyTrackEvents since:startTime];
+}
+
+- (void)trackEvent:(NSString *)eventKey
+            userId:(NSString *)userId
+        attributes:(NSDictionary<NSString *, id> *)attributes
+         eventTags:(NSDictionary<NSString *,id> *)eventTags {
     
     if ([eventKey getValidString] == nil) {
         [self handleErrorLogsForTrack:OPTLYLoggerMessagesTrackEventKeyEmpty ofLevel:OptimizelyLogLevelError];
@@ -529,35 +620,64 @@
                                                                                    event:event
                                                                                eventTags:eventTags
                                                                               attributes:attributes];
-    if ([conversionEventParams getValidDictionary] == nil) {
-        NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherEventNotTracked, eventKey, userId];
-        [self handleErrorLogsForTrack:logMessage ofLevel:OptimizelyLogLevelInfo];
+    [self sendConversionEvent:conversionEventParams
+                    eventKeys:@[eventKey]
+                    eventTags:@[eventTags ?: [NSNull null]]
+                       userId:userId
+                   attributes:attributes];
+}
+
+- (void)trackEventBatch:(NSArray<NSDictionary<NSString *, id> *> *)events
+                 userId:(NSString *)userId
+             attributes:(NSDictionary<NSString *, id> *)attributes {
+    
+    if (![userId isValidStringType]) {
+        [self handleErrorLogsForTrack:OPTLYLoggerMessagesUserIdInvalid ofLevel:OptimizelyLogLevelError];
         return;
     }
     
-    NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherAttemptingToSendConversionEvent, eventKey, userId];
-    [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
+    NSMutableArray<OPTLYEvent *> *eventsToTrack = [NSMutableArray new];
+    NSMutableArray *eventTagsToTrack = [NSMutableArray new];
+    NSMutableArray<NSString *> *eventKeys = [NSMutableArray new];
+    for (NSDictionary<NSString *, id> *trackEvent in events) {
+        NSString *eventKey = [trackEvent isKindOfClass:[NSDictionary class]] ? trackEvent[OPTLYTrackEventKey] : nil;
+        if ([eventKey getValidString] == nil) {
+            [self handleErrorLogsForTrack:OPTLYLoggerMessagesTrackEventKeyEmpty ofLevel:OptimizelyLogLevelError];
+            continue;
+        }
+        OPTLYEvent *event = [self.config getEventForKey:eventKey];
+        if (!event) {
+            NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherEventNotTracked, eventKey, userId];
+            [self handleErrorLogsForTrack:logMessage ofLevel:OptimizelyLogLevelInfo];
+            continue;
+        }
+        NSDictionary *eventTags = [trackEvent[OPTLYTrackEventTagsKey] getValidDictionary];
+        [eventsToTrack addObject:event];
+        [eventTagsToTrack addObject:eventTags ?: [NSNull null]];
+        [eventKeys addObject:eventKey];
+    }
+    if (eventsToTrack.count == 0) {
+        return;
+    }
     
-    __weak typeof(self) weakSelf = self;
-    [self.eventDispatcher dispatchConversionEvent:conversionEventParams
-                                         callback:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-                                             if (error) {
-                                                 NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherEventNotTracked, eventKey, userId];
-                                                 [weakSelf handleErrorLogsForTrack:logMessage ofLevel:OptimizelyLogLevelInfo];
-                                             } else {
-                                                 NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherTrackingSuccess, eventKey, userId];
-                                                 [weakSelf.logger logMessage:logMessage
-                                                                     withLevel:OptimizelyLogLevelInfo];
-                                             }
-                                         }];
-    NSMutableDictionary *args = [[NSMutableDictionary alloc] init];
-    [args setValue:eventKey forKey:OPTLYNotificationEventKey];
-    [args setValue:userId forKey:OPTLYNotificationUserIdKey];
-    [args setValue:attributes forKey:OPTLYNotificationAttributesKey];
-    [args setValue:eventTags forKey:OPTLYNotificationEventTagsKey];
-    [args setValue:conversionEventParams forKey:OPTLYNotificationLogEventParamsKey];
+    // custom event builders that can't batch track each event on its own
+    if (![self.eventBuilder respondsToSelector:@selector(buildConversionEventForUser:events:eventTags:attributes:)]) {
+        for (NSUInteger i = 0; i < eventKeys.count; i++) {
+            NSDictionary *eventTags = [eventTagsToTrack[i] isKindOfClass:[NSDictionary class]] ? eventTagsToTrack[i] : nil;
+            [self trackEvent:eventKeys[i] userId:userId attributes:attributes eventTags:eventTags];
+        }
+        return;
+    }
     
-    [_notificationCenter sendNotifications:OPTLYNotificationTypeTrack args:args];
+    NSDictionary *conversionEventParams = [self.eventBuilder buildConversionEventForUser:userId
+                                                                                  events:eventsToTrack
+                                                                               eventTags:eventTagsToTrack
+                                                                              attributes:attributes];
+    [self sendConversionEvent:conversionEventParams
+                    eventKeys:eventKeys
+                    eventTags:eventTagsToTrack
+                       userId:userId
+                   attributes:attributes];
 }
 
 #pragma GCC diagnostic pop // "-Wdeprecated-declarations" "-Wdeprecated-implementations"
@@ -573,6 +693,50 @@
     [self.logger logMessage:logMessage withLevel:level];
 }
 
+// Dispatches a conversion event built for one or more events, then notifies the track listeners once per event.
+// eventTags holds the tags of each event, or NSNull.
+- (void)sendConversionEvent:(NSDictionary *)conversionEventParams
+                  eventKeys:(NSArray<NSString *> *)eventKeys
+                  eventTags:(NSArray *)eventTags
+                     userId:(NSString *)userId
+                 attributes:(NSDictionary<NSString *, id> *)attributes {
+    NSString *trackedEventKeys = [eventKeys componentsJoinedByString:@", "];
+    if ([conversionEventParams getValidDictionary] == nil) {
+        NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherEventNotTracked, trackedEventKeys, userId];
+        [self handleErrorLogsForTrack:logMessage ofLevel:OptimizelyLogLevelInfo];
+        return;
+    }
+    
+    NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherAttemptingToSendConversionEvent, trackedEventKeys, userId];
+    [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
+    
+    __weak typeof(self) weakSelf = self;
+    [OPTLYMetrics incrementCounter:OPTLYMetricCounterConversionEvents by:eventKeys.count];
+    [self.eventDispatcher dispatchConversionEvent:conversionEventParams
+                                         callback:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                                             if (error) {
+                                                 NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherEventNotTracked, trackedEventKeys, userId];
+                                                 [weakSelf handleErrorLogsForTrack:logMessage ofLevel:OptimizelyLogLevelInfo];
+                                             } else {
+                                                 NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherTrackingSuccess, trackedEventKeys, userId];
+                                                 [weakSelf.logger logMessage:logMessage
+                                                                     withLevel:OptimizelyLogLevelInfo];
+                                             }
+                                         }];
+    
+    NSMutableArray<NSDictionary *> *argsList = [NSMutableArray arrayWithCapacity:eventKeys.count];
+    for (NSUInteger i = 0; i < eventKeys.count; i++) {
+        NSMutableDictionary *args = [[NSMutableDictionary alloc] init];
+        [args setValue:eventKeys[i] forKey:OPTLYNotificationEventKey];
+        [args setValue:userId forKey:OPTLYNotificationUserIdKey];
+        [args setValue:attributes forKey:OPTLYNotificationAttributesKey];
+        [args setValue:[eventTags[i] isKindOfClass:[NSDictionary class]] ? eventTags[i] : nil forKey:OPTLYNotificationEventTagsKey];
+        [args setValue:conversionEventParams forKey:OPTLYNotificationLogEventParamsKey];
+        [argsList addObject:args];
+    }
+    [_notificationCenter sendNotifications:OPTLYNotificationTypeTrack argsList:argsList];
+}
+
 // log and propagate error for a activate failure
 - (NSError *)handleErrorLogsForActivate:(NSString *)logMessage ofLevel:(OptimizelyLogLevel)level {
     NSDictionary *errorDictionary = [NSDictionary dictionaryWithObject:logMessage forKey:NSLocalizedDescriptionKey];
@@ -594,6 +758,18 @@
                                 attributes:(NSDictionary<NSString *, id> *)attributes
                                   callback:(void (^)(NSError *))callback {
     
+    // the same impression was sent recently, so there is nothing to build, save or send
+    if (self.impressionDeduplicator && ![self.impressionDeduplicator shouldSendImpressionForUser:userId
+                                                                                    experimentId:experiment.experimentId
+                                                                                     variationId:variation.variationId]) {
+        NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherDuplicateImpressionEvent, userId, experiment.experimentKey, variation.variationKey];
+        [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
+        if (callback) {
+            callback(nil);
+        }
+        return variation;
+    }
+    
     // send impression event
     NSDictionary *impressionEventParams = [self.eventBuilder buildImpressionEventForUser:userId
                                                                               experiment:experiment
@@ -601,6 +777,8 @@
                                                                               attributes:attributes];
     
     if ([impressionEventParams getValidDictionary] == nil) {
+        // not sent, so a retry must not be suppressed
+        [self cancelImpressionsForUser:userId experiments:@[experiment] variations:@[variation]];
         return nil;
     }
     
@@ -608,17 +786,24 @@
     [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
     
     __weak typeof(self) weakSelf = self;
-    [self.eventDispatcher dispatchImpressionEvent:impressionEventParams
-                                         callback:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-                                             if (!error) {
-                                                 NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherActivationSuccess, userId, experiment.experimentKey];
-                                                 [weakSelf.logger logMessage:logMessage
-                                                                   withLevel:OptimizelyLogLevelInfo];
-                                             }
-                                             if (callback) {
-                                                 callback(error);
-                                             }
-                                         }];
+    [OPTLYMetrics incrementCounter:OPTLYMetricCounterImpressionEvents by:1];
+    @try {
+        [self.eventDispatcher dispatchImpressionEvent:impressionEventParams
+                                             callback:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                                                 if (!error) {
+                                                     NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherActivationSuccess, userId, experiment.experimentKey];
+                                                     [weakSelf.logger logMessage:logMessage
+                                                                       withLevel:OptimizelyLogLevelInfo];
+                                                 }
+                                                 if (callback) {
+                                                     callback(error);
+                                                 }
+                                             }];
+    }
+    @catch (NSException *exception) {
+        [self cancelImpressionsForUser:userId experiments:@[experiment] variations:@[variation]];
+        @throw;
+    }
     
     NSMutableDictionary *args = [[NSMutableDictionary alloc] init];
     [args setValue:experiment forKey:OPTLYNotificationExperimentKey];
@@ -632,6 +817,91 @@
     return variation;
 }
 
+// Sends one impression event for all the experiments, or one per experiment if the event builder can't batch them.
+- (void)sendImpressionEventForExperiments:(NSArray<OPTLYExperiment *> *)experiments
+                               variations:(NSArray<OPTLYVariation *> *)variations
+                                   userId:(NSString *)userId
+                               attributes:(NSDictionary<NSString *, id> *)attributes {
+    if (![self.eventBuilder respondsToSelector:@selector(buildImpressionEventForUser:experiments:variations:attributes:)]) {
+        for (NSUInteger i = 0; i < experiments.count; i++) {
+            [self sendImpressionEventFor:experiments[i] variation:variations[i] userId:userId attributes:attributes callback:nil];
+        }
+        return;
+    }
+    
+    NSMutableArray<OPTLYExperiment *> *experimentsToSend = [NSMutableArray new];
+    NSMutableArray<OPTLYVariation *> *variationsToSend = [NSMutableArray new];
+    for (NSUInteger i = 0; i < experiments.count; i++) {
+        OPTLYExperiment *experiment = experiments[i];
+        OPTLYVariation *variation = variations[i];
+        // the same impression was sent recently, so there is nothing to build, save or send
+        if (self.impressionDeduplicator && ![self.impressionDeduplicator shouldSendImpressionForUser:userId
+                                                                                        experimentId:experiment.experimentId
+                                                                                         variationId:variation.variationId]) {
+            NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherDuplicateImpressionEvent, userId, experiment.experimentKey, variation.variationKey];
+            [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
+            continue;
+        }
+        [experimentsToSend addObject:experiment];
+        [variationsToSend addObject:variation];
+    }
+    if (experimentsToSend.count == 0) {
+        return;
+    }
+    
+    NSDictionary *impressionEventParams = [self.eventBuilder buildImpressionEventForUser:userId
+                                                                             experiments:experimentsToSend
+                                                                              variations:variationsToSend
+                                                                              attributes:attributes];
+    if ([impressionEventParams getValidDictionary] == nil) {
+        [self cancelImpressionsForUser:userId experiments:experimentsToSend variations:variationsToSend];
+        return;
+    }
+    
+    NSString *experimentKeys = [[experimentsToSend valueForKey:@"experimentKey"] componentsJoinedByString:@", "];
+    NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherAttemptingToSendImpressionEvent, userId, experimentKeys];
+    [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
+    
+    __weak typeof(self) weakSelf = self;
+    [OPTLYMetrics incrementCounter:OPTLYMetricCounterImpressionEvents by:1];
+    @try {
+        [self.eventDispatcher dispatchImpressionEvent:impressionEventParams
+                                             callback:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                                                 if (!error) {
+                                                     NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherActivationSuccess, userId, experimentKeys];
+                                                     [weakSelf.logger logMessage:logMessage
+                                                                       withLevel:OptimizelyLogLevelInfo];
+                                                 }
+                                             }];
+    }
+    @catch (NSException *exception) {
+        [self cancelImpressionsForUser:userId experiments:experimentsToSend variations:variationsToSend];
+        @throw;
+    }
+    
+    for (NSUInteger i = 0; i < experimentsToSend.count; i++) {
+        NSMutableDictionary *args = [[NSMutableDictionary alloc] init];
+        [args setValue:experimentsToSend[i] forKey:OPTLYNotificationExperimentKey];
+        [args setValue:userId forKey:OPTLYNotificationUserIdKey];
+        [args setValue:attributes forKey:OPTLYNotificationAttributesKey];
+        [args setValue:variationsToSend[i] forKey:OPTLYNotificationVariationKey];
+        [args setValue:impressionEventParams forKey:OPTLYNotificationLogEventParamsKey];
+        [_notificationCenter sendNotifications:OPTLYNotificationTypeActivate args:args];
+    }
+}
+
+// Releases the deduplicator reservations of impressions that could not be built or handed to the event dispatcher.
+// Errors reported later by the dispatcher callback are not cancelled: the dispatcher keeps the event and retries it.
+- (void)cancelImpressionsForUser:(NSString *)userId
+                     experiments:(NSArray<OPTLYExperiment *> *)experiments
+                      variations:(NSArray<OPTLYVariation *> *)variations {
+    for (NSUInteger i = 0; i < experiments.count; i++) {
+        [self.impressionDeduplicator cancelImpressionForUser:userId
+                                                experimentId:experiments[i].experimentId
+                                                 variationId:variations[i].variationId];
+    }
+}
+
 + (BOOL)isEmptyArray:(NSObject*)array {
     return (!array
             || ![array isKindOfClass:[NSArray class]]
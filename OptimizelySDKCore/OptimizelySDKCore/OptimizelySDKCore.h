@@ -20,10 +20,12 @@
 #import "OPTLYBaseCondition.h"
 #import "OPTLYAudienceBaseCondition.h"
 #import "OPTLYBucketer.h"
+#import "OPTLYBucketingSimulator.h"
 #import "OPTLYBuilder.h"
 #import "OPTLYCondition.h"
 #import "OPTLYDatafileKeys.h"
 #import "OPTLYDecisionService.h"
+#import "OPTLYDecisionTrace.h"
 #import "OPTLYDecisionEventTicket.h"
 #import "OPTLYErrorHandler.h"
 #import "OPTLYErrorHandlerMessages.h"
@@ -38,6 +40,7 @@
 #import "OPTLYEventLayerState.h"
 #import "OPTLYEventMetric.h"
 #import "OPTLYEventParameterKeys.h"
+#import "OPTLYEventPayload.h"
 #import "OPTLYEventRelatedEvent.h"
 #import "OPTLYEventView.h"
 #import "OPTLYExperiment.h"
@@ -47,15 +50,24 @@
 #import "OPTLYFeatureVariable.h"
 #import "OPTLYGroup.h"
 #import "OPTLYHTTPRequestManager.h"
+#import "OPTLYImpressionDeduplicator.h"
+#import "OPTLYJSONWriter.h"
+#import "OPTLYLazyEntityMap.h"
 #import "OPTLYLog.h"
 #import "OPTLYLogger.h"
 #import "OPTLYLoggerMessages.h"
+#import "OPTLYMetrics.h"
 #import "OPTLYNetworkService.h"
 #import "OPTLYNotificationCenter.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYProjectConfigBuilder.h"
 #import "OPTLYQueue.h"
+#import "OPTLYRequestScheduler.h"
+#import "OPTLYRequestThrottle.h"
 #import "OPTLYRollout.h"
+#import "OPTLYStartupReport.h"
+#import "OPTLYTime.h"
+#import "OPTLYTimer.h"
 #import "OPTLYTrafficAllocation.h"
 #import "OPTLYUserProfile.h"
 #import "OPTLYUserProfileServiceBasic.h"
@@ -0,0 +1,84 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class runs a block repeatedly and reports how long one call takes.
+ After the warmup calls, every call is timed on its own so percentiles can be computed. The calls are
+ then run again with a malloc logger installed, which counts every heap allocation (and its size) made
+ on the calling thread, freed or not.
+ Results are dictionaries with the keys below, ready to be written as JSON.
+ */
+
+extern NSString * _Nonnull const OPTLYBenchmarkResultNameKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultIterationsKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultMeanKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultMinKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultP50Key;
+extern NSString * _Nonnull const OPTLYBenchmarkResultP90Key;
+extern NSString * _Nonnull const OPTLYBenchmarkResultP99Key;
+extern NSString * _Nonnull const OPTLYBenchmarkResultMaxKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultAllocationsKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultAllocatedBytesKey;
+extern NSString * _Nonnull const OPTLYBenchmarkResultFootprintKey;
+
+// Environment variable with the path of the JSON results file
+extern NSString * _Nonnull const OPTLYBenchmarkOutputPathEnvironmentKey;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYBenchmark : NSObject
+
+/// Name of the benchmark in the results
+@property (nonatomic, strong, readonly) NSString *name;
+/// Number of untimed calls before the timed ones
+@property (nonatomic, assign, readonly) NSUInteger warmupIterations;
+/// Number of timed calls
+@property (nonatomic, assign, readonly) NSUInteger iterations;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+- (instancetype)initWithName:(NSString *)name
+            warmupIterations:(NSUInteger)warmupIterations
+                  iterations:(NSUInteger)iterations NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Runs the block and returns its result: times are in µs, allocations are per call.
+ */
+- (NSDictionary<NSString *, id> *)run:(void (^)(void))block;
+
+/**
+ * Returns the heap footprint (in bytes) of the object created by the block, as a result named name.
+ */
++ (NSDictionary<NSString *, id> *)footprintWithName:(NSString *)name ofObjectCreatedBy:(id _Nullable (^)(void))block;
+
+/**
+ * Returns the path the results are written to: the OPTLY_BENCHMARK_OUTPUT environment
+ * variable, or a file in the temporary directory.
+ */
++ (NSString *)outputPath;
+
+/**
+ * Adds results to the results file, replacing older results with the same name.
+ * Each result is also logged on one line starting with "OPTLYBenchmark " for headless runs.
+ */
++ (BOOL)recordResults:(NSArray<NSDictionary<NSString *, id> *> *)results error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
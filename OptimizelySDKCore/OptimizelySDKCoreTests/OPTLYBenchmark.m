@@ -0,0 +1,210 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <mach/mach_time.h>
+#import <malloc/malloc.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import "OPTLYBenchmark.h"
+
+NSString * const OPTLYBenchmarkResultNameKey = @"name";
+NSString * const OPTLYBenchmarkResultIterationsKey = @"iterations";
+NSString * const OPTLYBenchmarkResultMeanKey = @"mean_us";
+NSString * const OPTLYBenchmarkResultMinKey = @"min_us";
+NSString * const OPTLYBenchmarkResultP50Key = @"p50_us";
+NSString * const OPTLYBenchmarkResultP90Key = @"p90_us";
+NSString * const OPTLYBenchmarkResultP99Key = @"p99_us";
+NSString * const OPTLYBenchmarkResultMaxKey = @"max_us";
+NSString * const OPTLYBenchmarkResultAllocationsKey = @"allocations";
+NSString * const OPTLYBenchmarkResultAllocatedBytesKey = @"allocated_bytes";
+NSString * const OPTLYBenchmarkResultFootprintKey = @"footprint_bytes";
+
+NSString * const OPTLYBenchmarkOutputPathEnvironmentKey = @"OPTLY_BENCHMARK_OUTPUT";
+
+static NSString * const kDefaultOutputFileName = @"optimizely-benchmarks.json";
+
+// The hook malloc stack logging uses (see libmalloc's stack_logging.h): libmalloc calls it on every
+// allocation, reallocation and free of the malloc zones.
+typedef void (malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t num_hot_frames_to_skip);
+extern malloc_logger_t *malloc_logger;
+
+static uint32_t const kMallocLogTypeAllocate = 2;
+static uint32_t const kMallocLogTypeDeallocate = 4;
+
+static malloc_logger_t *previousMallocLogger = NULL;
+static pthread_t countedThread = NULL;
+static _Atomic uint64_t numberOfAllocations = 0;
+static _Atomic uint64_t numberOfAllocatedBytes = 0;
+
+// Must not allocate.
+static void OPTLYBenchmarkMallocLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numHotFramesToSkip) {
+    if (previousMallocLogger) {
+        previousMallocLogger(type, arg1, arg2, arg3, result, numHotFramesToSkip + 1);
+    }
+    if (!(type & kMallocLogTypeAllocate) || !pthread_equal(pthread_self(), countedThread)) {
+        return;
+    }
+    // a realloc is logged as an allocation and a deallocation, with the new size in arg3
+    uintptr_t size = (type & kMallocLogTypeDeallocate) ? arg3 : arg2;
+    atomic_fetch_add_explicit(&numberOfAllocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&numberOfAllocatedBytes, size, memory_order_relaxed);
+}
+
+@implementation OPTLYBenchmark
+
+- (instancetype)initWithName:(NSString *)name
+            warmupIterations:(NSUInteger)warmupIterations
+                  iterations:(NSUInteger)iterations {
+    self = [super init];
+    if (self != nil) {
+        _name = [name copy];
+        _warmupIterations = warmupIterations;
+        _iterations = MAX(iterations, 1);
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *, id> *)run:(void (^)(void))block {
+    for (NSUInteger i = 0; i < self.warmupIterations; i++) {
+        @autoreleasepool {
+            block();
+        }
+    }
+    
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    
+    double *durations = malloc(self.iterations * sizeof(double));
+    for (NSUInteger i = 0; i < self.iterations; i++) {
+        uint64_t start = mach_absolute_time();
+        @autoreleasepool {
+            block();
+        }
+        durations[i] = (double)(mach_absolute_time() - start) * timebase.numer / timebase.denom / NSEC_PER_USEC;
+    }
+    
+    // allocations are counted in a separate pass so the malloc logger does not slow the timed calls down
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    [[self class] countAllocationsOf:^{
+        for (NSUInteger i = 0; i < self.iterations; i++) {
+            @autoreleasepool {
+                block();
+            }
+        }
+    } allocations:&allocations allocatedBytes:&allocatedBytes];
+    
+    qsort_b(durations, self.iterations, sizeof(double), ^int(const void *a, const void *b) {
+        double x = *(const double *)a;
+        double y = *(const double *)b;
+        return x < y ? -1 : (x > y ? 1 : 0);
+    });
+    double total = 0;
+    for (NSUInteger i = 0; i < self.iterations; i++) {
+        total += durations[i];
+    }
+    NSDictionary *result = @{
+        OPTLYBenchmarkResultNameKey : self.name,
+        OPTLYBenchmarkResultIterationsKey : @(self.iterations),
+        OPTLYBenchmarkResultMeanKey : @(total / self.iterations),
+        OPTLYBenchmarkResultMinKey : @(durations[0]),
+        OPTLYBenchmarkResultP50Key : @([self percentile:0.5 ofSortedDurations:durations]),
+        OPTLYBenchmarkResultP90Key : @([self percentile:0.9 ofSortedDurations:durations]),
+        OPTLYBenchmarkResultP99Key : @([self percentile:0.99 ofSortedDurations:durations]),
+        OPTLYBenchmarkResultMaxKey : @(durations[self.iterations - 1]),
+        OPTLYBenchmarkResultAllocationsKey : @((double)allocations / self.iterations),
+        OPTLYBenchmarkResultAllocatedBytesKey : @((double)allocatedBytes / self.iterations),
+    };
+    free(durations);
+    return result;
+}
+
++ (NSDictionary<NSString *, id> *)footprintWithName:(NSString *)name ofObjectCreatedBy:(id (^)(void))block {
+    malloc_statistics_t before, after;
+    id object = nil;
+    malloc_zone_statistics(NULL, &before);
+    @autoreleasepool {
+        object = block();
+    }
+    malloc_zone_statistics(NULL, &after);
+    NSDictionary *result = @{
+        OPTLYBenchmarkResultNameKey : name,
+        OPTLYBenchmarkResultFootprintKey : @((long long)after.size_in_use - (long long)before.size_in_use),
+    };
+    object = nil;
+    return result;
+}
+
++ (NSString *)outputPath {
+    NSString *path = [[NSProcessInfo processInfo] environment][OPTLYBenchmarkOutputPathEnvironmentKey];
+    if ([path length] > 0) {
+        return path;
+    }
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:kDefaultOutputFileName];
+}
+
++ (BOOL)recordResults:(NSArray<NSDictionary<NSString *, id> *> *)results error:(NSError * __autoreleasing *)error {
+    @synchronized (self) {
+        NSString *path = [self outputPath];
+        NSMutableDictionary *resultsByName = [NSMutableDictionary new];
+        NSData *savedData = [NSData dataWithContentsOfFile:path];
+        if (savedData) {
+            NSArray *savedResults = [NSJSONSerialization JSONObjectWithData:savedData options:kNilOptions error:nil];
+            if ([savedResults isKindOfClass:[NSArray class]]) {
+                for (NSDictionary *result in savedResults) {
+                    resultsByName[result[OPTLYBenchmarkResultNameKey]] = result;
+                }
+            }
+        }
+        for (NSDictionary *result in results) {
+            resultsByName[result[OPTLYBenchmarkResultNameKey]] = result;
+            NSData *line = [NSJSONSerialization dataWithJSONObject:result options:kNilOptions error:nil];
+            NSLog(@"OPTLYBenchmark %@", [[NSString alloc] initWithData:line encoding:NSUTF8StringEncoding]);
+        }
+        
+        NSSortDescriptor *byName = [NSSortDescriptor sortDescriptorWithKey:OPTLYBenchmarkResultNameKey ascending:YES];
+        NSArray *sortedResults = [[resultsByName allValues] sortedArrayUsingDescriptors:@[byName]];
+        NSData *data = [NSJSONSerialization dataWithJSONObject:sortedResults options:NSJSONWritingPrettyPrinted error:error];
+        return data && [data writeToFile:path options:NSDataWritingAtomic error:error];
+    }
+}
+
+#pragma mark - Helper Methods
+
+// Counts the heap allocations made by the block on the calling thread.
++ (void)countAllocationsOf:(void (^)(void))block allocations:(uint64_t *)allocations allocatedBytes:(uint64_t *)allocatedBytes {
+    @synchronized ([OPTLYBenchmark class]) {
+        atomic_store(&numberOfAllocations, 0);
+        atomic_store(&numberOfAllocatedBytes, 0);
+        countedThread = pthread_self();
+        previousMallocLogger = malloc_logger;
+        malloc_logger = OPTLYBenchmarkMallocLogger;
+        block();
+        malloc_logger = previousMallocLogger;
+        countedThread = NULL;
+        *allocations = atomic_load(&numberOfAllocations);
+        *allocatedBytes = atomic_load(&numberOfAllocatedBytes);
+    }
+}
+
+// nearest-rank percentile
+- (double)percentile:(double)percentile ofSortedDurations:(const double *)durations {
+    NSUInteger rank = (NSUInteger)ceil(percentile * self.iterations);
+    return durations[MIN(MAX(rank, 1), self.iterations) - 1];
+}
+
+@end
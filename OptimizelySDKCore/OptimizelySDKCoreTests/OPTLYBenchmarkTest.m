@@ -0,0 +1,293 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <XCTest/XCTest.h>
+#import "Optimizely.h"
+#import "OPTLYAudience.h"
+#import "OPTLYBenchmark.h"
+#import "OPTLYBucketer.h"
+#import "OPTLYDatafileGenerator.h"
+#import "OPTLYEvent.h"
+#import "OPTLYEventBuilder.h"
+#import "OPTLYEventDispatcherBasic.h"
+#import "OPTLYEventMetric.h"
+#import "OPTLYExperiment.h"
+#import "OPTLYLogger.h"
+#import "OPTLYProjectConfig.h"
+#import "OPTLYTestHelper.h"
+#import "OPTLYVariation.h"
+
+// Benchmarks of the decision and event paths. Every test adds its results to
+// [OPTLYBenchmark outputPath] (set OPTLY_BENCHMARK_OUTPUT to choose the file) so runs can be compared.
+// They run in Release with the OptimizelySDKCoreBenchmarks scheme, and are skipped by the iOS and tvOS test schemes.
+
+static NSString * const kDatafileName = @"test_data_10_experiments";
+static NSString * const kUserId = @"6369992312";
+static NSString * const kExperimentKey = @"testExperimentWithFirefoxAudience";
+static NSString * const kAudienceId = @"6369992312";
+static NSString * const kEventKey = @"testEventWithAudiences";
+static NSString * const kFeatureKey = @"multiVariateFeature";
+static NSString * const kVariableFeatureKey = @"stringSingleVariableFeature";
+static NSString * const kVariableKey = @"stringVariable";
+static NSString * const kAttributeKeyBrowserType = @"browser_type";
+static NSString * const kAttributeValueFirefox = @"firefox";
+static NSUInteger const kWarmupIterations = 100;
+static NSUInteger const kIterations = 2000;
+static NSUInteger const kParsingWarmupIterations = 3;
+static NSUInteger const kParsingIterations = 30;
+static NSUInteger const kNumberOfUserIds = 1000;
+static NSUInteger const kGeneratedDatafileIterations = 10;
+
+@interface OPTLYBenchmarkTest : XCTestCase
+@property (nonatomic, strong) NSData *datafile;
+@property (nonatomic, strong) Optimizely *optimizely;
+@property (nonatomic, strong) NSDictionary<NSString *, id> *attributes;
+@property (nonatomic, strong) NSArray<NSString *> *userIds;
+@end
+
+@implementation OPTLYBenchmarkTest
+
+- (void)setUp {
+    [super setUp];
+    self.datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDatafileName];
+    self.optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = [OPTLYEventDispatcherNoOp new];
+    }]];
+    self.attributes = @{ kAttributeKeyBrowserType : kAttributeValueFirefox };
+    NSMutableArray *userIds = [NSMutableArray arrayWithCapacity:kNumberOfUserIds];
+    for (NSUInteger i = 0; i < kNumberOfUserIds; i++) {
+        [userIds addObject:[NSString stringWithFormat:@"user_%lu", (unsigned long)i]];
+    }
+    self.userIds = userIds;
+}
+
+- (void)tearDown {
+    self.optimizely = nil;
+    self.datafile = nil;
+    [super tearDown];
+}
+
+- (void)testBenchmarkDatafileParsing {
+    NSArray *datafileNames = @[@"test_data_10_experiments", @"test_data_25_experiments", @"test_data_50_experiments"];
+    NSMutableArray *results = [NSMutableArray new];
+    for (NSString *datafileName in datafileNames) {
+        NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:datafileName];
+        for (NSNumber *lazy in @[@NO, @YES]) {
+            NSString *name = [NSString stringWithFormat:@"parse_%@%@", lazy.boolValue ? @"lazily_" : @"", datafileName];
+            [results addObject:[self run:name warmupIterations:kParsingWarmupIterations iterations:kParsingIterations block:^(NSUInteger i) {
+                OPTLYProjectConfig *config = [OPTLYProjectConfig init:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+                    builder.datafile = datafile;
+                    builder.lazyDatafileParsing = lazy.boolValue;
+                }];
+                NSCAssert(config != nil, @"Invalid datafile %@", datafileName);
+            }]];
+        }
+    }
+    [self recordResults:results];
+}
+
+- (void)testBenchmarkBucketing {
+    OPTLYBucketer *bucketer = [[OPTLYBucketer alloc] initWithConfig:self.optimizely.config];
+    OPTLYExperiment *experiment = [self.optimizely.config getExperimentForKey:kExperimentKey];
+    NSArray<NSString *> *userIds = self.userIds;
+    [self recordResults:@[[self run:@"bucket_experiment" block:^(NSUInteger i) {
+        [bucketer bucketExperiment:experiment withBucketingId:userIds[i % kNumberOfUserIds]];
+    }]]];
+}
+
+- (void)testBenchmarkAudienceEvaluation {
+    OPTLYProjectConfig *config = self.optimizely.config;
+    OPTLYAudience *audience = [config getAudienceForId:kAudienceId];
+    NSDictionary *attributes = self.attributes;
+    [self recordResults:@[[self run:@"evaluate_audience" block:^(NSUInteger i) {
+        [audience evaluateConditionsWithAttributes:attributes projectConfig:config];
+    }]]];
+}
+
+- (void)testBenchmarkActivate {
+    Optimizely *optimizely = self.optimizely;
+    NSArray<NSString *> *userIds = self.userIds;
+    NSDictionary *attributes = self.attributes;
+    [self recordResults:@[[self run:@"activate" block:^(NSUInteger i) {
+        [optimizely activate:kExperimentKey userId:userIds[i % kNumberOfUserIds] attributes:attributes];
+    }]]];
+}
+
+- (void)testBenchmarkFeatures {
+    Optimizely *optimizely = self.optimizely;
+    NSArray<NSString *> *userIds = self.userIds;
+    NSDictionary *attributes = self.attributes;
+    [self recordResults:@[
+        [self run:@"is_feature_enabled" block:^(NSUInteger i) {
+            [optimizely isFeatureEnabled:kFeatureKey userId:userIds[i % kNumberOfUserIds] attributes:attributes];
+        }],
+        [self run:@"get_enabled_features" block:^(NSUInteger i) {
+            [optimizely getEnabledFeatures:userIds[i % kNumberOfUserIds] attributes:attributes];
+        }],
+        [self run:@"get_feature_variable_string" block:^(NSUInteger i) {
+            [optimizely getFeatureVariableString:kVariableFeatureKey variableKey:kVariableKey userId:userIds[i % kNumberOfUserIds] attributes:attributes];
+        }],
+    ]];
+}
+
+- (void)testBenchmarkEventBuilding {
+    OPTLYEventBuilderDefault *eventBuilder = [[OPTLYEventBuilderDefault alloc] initWithConfig:self.optimizely.config];
+    OPTLYExperiment *experiment = [self.optimizely.config getExperimentForKey:kExperimentKey];
+    OPTLYVariation *variation = experiment.variations[0];
+    OPTLYEvent *event = [self.optimizely.config getEventForKey:kEventKey];
+    NSDictionary *attributes = self.attributes;
+    [self recordResults:@[
+        [self run:@"build_impression_event" block:^(NSUInteger i) {
+            [eventBuilder buildImpressionEventForUser:kUserId experiment:experiment variation:variation attributes:attributes];
+        }],
+        [self run:@"build_conversion_event" block:^(NSUInteger i) {
+            [eventBuilder buildConversionEventForUser:kUserId event:event eventTags:@{ @"revenue" : @(88) } attributes:attributes];
+        }],
+    ]];
+}
+
+// track: builds the conversion payload straight to JSON bytes; allocations per call show regressions
+- (void)testBenchmarkTrack {
+    Optimizely *optimizely = self.optimizely;
+    NSArray<NSString *> *userIds = self.userIds;
+    NSDictionary *attributes = self.attributes;
+    NSDictionary *eventTags = @{ OPTLYEventMetricNameRevenue : @(88) };
+    [self recordResults:@[[self run:@"track" block:^(NSUInteger i) {
+        [optimizely track:kEventKey userId:userIds[i % kNumberOfUserIds] attributes:attributes eventTags:eventTags];
+    }]]];
+}
+
+// every allocation is counted, including the ones freed before the call returns
+- (void)testBenchmarkCountsFreedAllocations {
+    OPTLYBenchmark *benchmark = [[OPTLYBenchmark alloc] initWithName:@"malloc_and_free" warmupIterations:1 iterations:10];
+    NSDictionary *result = [benchmark run:^{
+        void * volatile small = malloc(100);
+        void * volatile large = malloc(1000);
+        free(small);
+        free(large);
+    }];
+    XCTAssertGreaterThanOrEqual([result[OPTLYBenchmarkResultAllocationsKey] doubleValue], 2);
+    XCTAssertGreaterThanOrEqual([result[OPTLYBenchmarkResultAllocatedBytesKey] doubleValue], 1100);
+}
+
+- (void)testGeneratedDatafileIsValid {
+    OPTLYDatafileGenerator *generator = [OPTLYDatafileGenerator generatorWithBlock:^(OPTLYDatafileGenerator *generator) {
+        generator.numberOfExperiments = 30;
+        generator.numberOfFeatureFlags = 10;
+    }];
+    NSData *datafile = [generator datafile];
+    XCTAssertEqualObjects(datafile, [generator datafile]);
+    
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = [OPTLYEventDispatcherNoOp new];
+    }]];
+    XCTAssertNotNil(optimizely);
+    XCTAssertEqual(optimizely.config.experiments.count, 30);
+    XCTAssertEqual(optimizely.config.allExperiments.count, 30 + generator.numberOfGroups * generator.numberOfExperimentsPerGroup);
+    XCTAssertEqual(optimizely.config.featureFlags.count, 10);
+    XCTAssertEqual(optimizely.config.rollouts.count, 10);
+    XCTAssertNotNil([optimizely.config getEventForKey:[generator eventKeyAtIndex:0]]);
+    
+    // the attributes satisfy every audience, so only the traffic allocation decides
+    NSDictionary *attributes = [generator userAttributes];
+    XCTAssertNotNil([optimizely activate:[generator experimentKeyAtIndex:0] userId:kUserId attributes:attributes]);
+    XCTAssertTrue([optimizely isFeatureEnabled:[generator featureFlagKeyAtIndex:0] userId:kUserId attributes:attributes]);
+    NSString *whitelistedUserId = [NSString stringWithFormat:@"%@_user_1", [generator experimentKeyAtIndex:1]];
+    XCTAssertEqualObjects([optimizely variation:[generator experimentKeyAtIndex:1] userId:whitelistedUserId].variationKey, @"variation_1");
+}
+
+// parse time, memory footprint and decision latency against the size of the datafile
+- (void)testBenchmarkGeneratedDatafiles {
+    NSMutableArray *results = [NSMutableArray new];
+    for (NSNumber *numberOfExperiments in @[@100, @250, @500]) {
+        OPTLYDatafileGenerator *generator = [OPTLYDatafileGenerator generatorWithBlock:^(OPTLYDatafileGenerator *generator) {
+            generator.numberOfExperiments = numberOfExperiments.unsignedIntegerValue;
+            generator.numberOfGroups = numberOfExperiments.unsignedIntegerValue / 20;
+            generator.numberOfFeatureFlags = numberOfExperiments.unsignedIntegerValue / 5;
+            generator.numberOfAudiences = numberOfExperiments.unsignedIntegerValue / 5;
+            generator.numberOfEvents = numberOfExperiments.unsignedIntegerValue / 2;
+            generator.numberOfWhitelistedUsersPerExperiment = 20;
+        }];
+        NSData *datafile = [generator datafile];
+        NSString *suffix = [NSString stringWithFormat:@"generated_%@_experiments", numberOfExperiments];
+        
+        for (NSNumber *lazy in @[@NO, @YES]) {
+            NSString *name = [NSString stringWithFormat:@"parse_%@%@", lazy.boolValue ? @"lazily_" : @"", suffix];
+            OPTLYProjectConfig * (^parse)(void) = ^{
+                return [OPTLYProjectConfig init:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+                    builder.datafile = datafile;
+                    builder.lazyDatafileParsing = lazy.boolValue;
+                }];
+            };
+            NSMutableDictionary *result = [[self run:name warmupIterations:1 iterations:kGeneratedDatafileIterations block:^(NSUInteger i) {
+                parse();
+            }] mutableCopy];
+            [result addEntriesFromDictionary:[OPTLYBenchmark footprintWithName:name ofObjectCreatedBy:parse]];
+            result[@"datafile_bytes"] = @(datafile.length);
+            [results addObject:result];
+        }
+        
+        Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+            builder.datafile = datafile;
+            builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+            builder.eventDispatcher = [OPTLYEventDispatcherNoOp new];
+        }]];
+        NSArray<NSString *> *userIds = self.userIds;
+        NSDictionary *attributes = [generator userAttributes];
+        NSUInteger numberOfFeatureFlags = generator.numberOfFeatureFlags;
+        NSUInteger lastExperimentIndex = generator.numberOfExperiments - 1;
+        [results addObject:[self run:[@"activate_" stringByAppendingString:suffix] block:^(NSUInteger i) {
+            [optimizely activate:[generator experimentKeyAtIndex:lastExperimentIndex] userId:userIds[i % kNumberOfUserIds] attributes:attributes];
+        }]];
+        [results addObject:[self run:[@"is_feature_enabled_" stringByAppendingString:suffix] block:^(NSUInteger i) {
+            [optimizely isFeatureEnabled:[generator featureFlagKeyAtIndex:i % numberOfFeatureFlags] userId:userIds[i % kNumberOfUserIds] attributes:attributes];
+        }]];
+    }
+    [self recordResults:results];
+}
+
+#pragma mark - Helper Methods
+
+- (NSDictionary *)run:(NSString *)name block:(void (^)(NSUInteger i))block {
+    return [self run:name warmupIterations:kWarmupIterations iterations:kIterations block:block];
+}
+
+- (NSDictionary *)run:(NSString *)name
+     warmupIterations:(NSUInteger)warmupIterations
+           iterations:(NSUInteger)iterations
+                block:(void (^)(NSUInteger i))block {
+    OPTLYBenchmark *benchmark = [[OPTLYBenchmark alloc] initWithName:name warmupIterations:warmupIterations iterations:iterations];
+    __block NSUInteger i = 0;
+    NSDictionary *result = [benchmark run:^{
+        block(i++);
+    }];
+    XCTAssertEqualObjects(result[OPTLYBenchmarkResultIterationsKey], @(iterations));
+    XCTAssertGreaterThan([result[OPTLYBenchmarkResultP99Key] doubleValue], 0);
+    XCTAssertNotNil(result[OPTLYBenchmarkResultAllocationsKey]);
+    return result;
+}
+
+- (void)recordResults:(NSArray<NSDictionary *> *)results {
+    NSError *error = nil;
+    XCTAssertTrue([OPTLYBenchmark recordResults:results error:&error], @"%@", error);
+}
+
+@end
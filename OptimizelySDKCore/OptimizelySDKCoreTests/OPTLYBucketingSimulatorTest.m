@@ -0,0 +1,164 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <XCTest/XCTest.h>
+#import "OPTLYBucketer.h"
+#import "OPTLYBucketingSimulator.h"
+#import "OPTLYControlAttributes.h"
+#import "OPTLYDatafileGenerator.h"
+#import "OPTLYDecisionService.h"
+#import "OPTLYExperiment.h"
+#import "OPTLYLogger.h"
+#import "OPTLYProjectConfig.h"
+#import "OPTLYTestHelper.h"
+#import "OPTLYVariation.h"
+
+static NSString *const kBucketerTestDatafileName = @"BucketerTestsDatafile";
+static NSUInteger const kNumberOfUserIds = 3000;
+
+@interface OPTLYBucketingSimulatorTest : XCTestCase
+@property (nonatomic, strong) NSArray<NSString *> *userIds;
+@end
+
+@implementation OPTLYBucketingSimulatorTest
+
+- (void)setUp {
+    [super setUp];
+    // ids of every length from 0 to 80 characters, non-ASCII ids and whitelisted ids of the generated datafile
+    NSMutableArray<NSString *> *userIds = [NSMutableArray new];
+    for (NSUInteger i = 0; i < kNumberOfUserIds; i++) {
+        switch (i % 4) {
+            case 0:
+                [userIds addObject:[NSString stringWithFormat:@"user_%lu", (unsigned long)i]];
+                break;
+            case 1:
+                [userIds addObject:[@"" stringByPaddingToLength:i % 81 withString:@"abcdefg" startingAtIndex:i % 7]];
+                break;
+            case 2:
+                [userIds addObject:[NSString stringWithFormat:@"utilisateur_é_%lu_ユーザー_😀", (unsigned long)i]];
+                break;
+            default:
+                [userIds addObject:[NSString stringWithFormat:@"experiment_%lu_user_%lu", (unsigned long)(i % 10), (unsigned long)(i % 20)]];
+                break;
+        }
+    }
+    self.userIds = userIds;
+}
+
+- (OPTLYProjectConfig *)configWithDatafile:(NSData *)datafile {
+    return [OPTLYProjectConfig init:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+    }];
+}
+
+- (NSArray<OPTLYProjectConfig *> *)configs {
+    OPTLYDatafileGenerator *generator = [OPTLYDatafileGenerator generatorWithBlock:^(OPTLYDatafileGenerator *generator) {
+        generator.numberOfExperiments = 10;
+        generator.numberOfVariations = 3;
+    }];
+    return @[[self configWithDatafile:[OPTLYTestHelper loadJSONDatafileIntoDataObject:kBucketerTestDatafileName]],
+             [self configWithDatafile:[generator datafile]]];
+}
+
+- (void)testInitWithConfig {
+    XCTAssertNotNil([[OPTLYBucketingSimulator alloc] initWithConfig:[self configs][0]]);
+    XCTAssertNil([[OPTLYBucketingSimulator alloc] initWithConfig:nil]);
+}
+
+- (void)testBucketValuesMatchBucketer {
+    OPTLYProjectConfig *config = [self configs][0];
+    OPTLYBucketer *bucketer = [[OPTLYBucketer alloc] initWithConfig:config];
+    OPTLYBucketingSimulator *simulator = [[OPTLYBucketingSimulator alloc] initWithConfig:config];
+    simulator.chunkSize = 100;
+    
+    for (NSString *entityId in @[@"1886780721", @"", @"実験"]) {
+        int *bucketValues = malloc(self.userIds.count * sizeof(int));
+        [simulator getBucketValues:bucketValues forBucketingIds:self.userIds entityId:entityId];
+        for (NSUInteger i = 0; i < self.userIds.count; i++) {
+            NSString *hashId = [bucketer makeHashIdFromBucketingId:self.userIds[i] andEntityId:entityId];
+            XCTAssertEqual(bucketValues[i], [bucketer generateBucketValue:hashId], @"%@", hashId);
+        }
+        free(bucketValues);
+    }
+}
+
+- (void)testVariationsMatchBucketer {
+    for (OPTLYProjectConfig *config in [self configs]) {
+        OPTLYBucketer *bucketer = [[OPTLYBucketer alloc] initWithConfig:config];
+        OPTLYBucketingSimulator *simulator = [[OPTLYBucketingSimulator alloc] initWithConfig:config];
+        for (OPTLYExperiment *experiment in config.allExperiments) {
+            NSArray *variations = [simulator variationsForExperiment:experiment bucketingIds:self.userIds];
+            XCTAssertEqual(variations.count, self.userIds.count);
+            for (NSUInteger i = 0; i < self.userIds.count; i++) {
+                id expected = [bucketer bucketExperiment:experiment withBucketingId:self.userIds[i]] ?: [NSNull null];
+                XCTAssertEqual(variations[i], expected, @"%@ %@", experiment.experimentKey, self.userIds[i]);
+            }
+        }
+    }
+}
+
+- (void)testDecisionsMatchDecisionService {
+    OPTLYDatafileGenerator *generator = [OPTLYDatafileGenerator new];
+    for (OPTLYProjectConfig *config in [self configs]) {
+        OPTLYDecisionService *decisionService = [[OPTLYDecisionService alloc] initWithProjectConfig:config
+                                                                                           bucketer:[[OPTLYBucketer alloc] initWithConfig:config]];
+        OPTLYBucketingSimulator *simulator = [[OPTLYBucketingSimulator alloc] initWithConfig:config];
+        // attributes passing all audiences, no attributes, and a bucketing id shared by all users
+        for (NSDictionary *attributes in @[[generator userAttributes], @{}, @{ OptimizelyBucketId : @"shared" }]) {
+            for (OPTLYExperiment *experiment in config.allExperiments) {
+                NSArray *decisions = [simulator decisionsForExperiment:experiment userIds:self.userIds attributes:attributes];
+                for (NSUInteger i = 0; i < self.userIds.count; i++) {
+                    id expected = [decisionService getVariation:self.userIds[i] experiment:experiment attributes:attributes] ?: [NSNull null];
+                    XCTAssertEqual(decisions[i], expected, @"%@ %@", experiment.experimentKey, self.userIds[i]);
+                }
+                XCTAssertEqualObjects([simulator distributionForExperiment:experiment userIds:self.userIds attributes:attributes],
+                                      [OPTLYBucketingSimulator distributionOfVariations:decisions]);
+            }
+        }
+    }
+}
+
+- (void)testDistribution {
+    OPTLYProjectConfig *config = [self configs][1];
+    OPTLYBucketingSimulator *simulator = [[OPTLYBucketingSimulator alloc] initWithConfig:config];
+    OPTLYExperiment *experiment = config.experiments[0];
+    NSDictionary<NSString *, NSNumber *> *distribution = [simulator distributionForExperiment:experiment userIds:self.userIds attributes:@{}];
+    
+    NSUInteger total = 0;
+    for (NSString *key in distribution) {
+        XCTAssertTrue([key isEqualToString:OPTLYBucketingSimulatorNoVariation] || [experiment getVariationForVariationKey:key] != nil);
+        total += distribution[key].unsignedIntegerValue;
+    }
+    XCTAssertEqual(total, self.userIds.count);
+    XCTAssertEqualObjects([simulator distributionForExperiment:experiment userIds:@[] attributes:nil], @{});
+}
+
+- (void)testUserIdsWithContentsOfFile {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"OPTLYBucketingSimulatorTest.txt"];
+    [@"user1\r\nuser2\n\nユーザー3\n" writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    NSError *error = nil;
+    NSArray *userIds = [OPTLYBucketingSimulator userIdsWithContentsOfFile:path error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(userIds, (@[@"user1", @"user2", @"ユーザー3"]));
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    
+    XCTAssertNil([OPTLYBucketingSimulator userIdsWithContentsOfFile:path error:&error]);
+    XCTAssertNotNil(error);
+}
+
+@end
@@ -0,0 +1,102 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ This class generates valid v4 datafiles of any size for scale tests and benchmarks.
+ Set the counts of each entity, then read datafile (or datafileDictionary). The same settings
+ and seed always produce the same datafile.
+ Generated audiences reference the attributes attr_0, attr_1, ...; userAttributes returns
+ values that satisfy every audience, so audience trees are evaluated in full.
+ */
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYDatafileGenerator : NSObject
+
+/// Number of experiments outside of groups (defaults to 100)
+@property (nonatomic, assign) NSUInteger numberOfExperiments;
+/// Number of variations of every experiment (defaults to 2)
+@property (nonatomic, assign) NSUInteger numberOfVariations;
+/// Number of mutually exclusive groups (defaults to 5)
+@property (nonatomic, assign) NSUInteger numberOfGroups;
+/// Number of experiments in every group, in addition to numberOfExperiments (defaults to 4)
+@property (nonatomic, assign) NSUInteger numberOfExperimentsPerGroup;
+/// Number of feature flags, each tested by one experiment and with its own rollout (defaults to 20)
+@property (nonatomic, assign) NSUInteger numberOfFeatureFlags;
+/// Number of variables of every feature flag (defaults to 4)
+@property (nonatomic, assign) NSUInteger numberOfVariablesPerFeatureFlag;
+/// Number of targeted rules of every rollout; an "everyone else" rule is added to each (defaults to 5)
+@property (nonatomic, assign) NSUInteger numberOfRulesPerRollout;
+/// Number of audiences, each with a legacy and a typed version (defaults to 20)
+@property (nonatomic, assign) NSUInteger numberOfAudiences;
+/// Depth of the typed audience condition trees (defaults to 3)
+@property (nonatomic, assign) NSUInteger audienceDepth;
+/// Number of children of every and/or node of the typed audience condition trees (defaults to 3)
+@property (nonatomic, assign) NSUInteger audienceBreadth;
+/// Number of audiences of every experiment and rollout rule (defaults to 2)
+@property (nonatomic, assign) NSUInteger numberOfAudiencesPerExperiment;
+/// Number of attributes (defaults to 10)
+@property (nonatomic, assign) NSUInteger numberOfAttributes;
+/// Number of events (defaults to 50)
+@property (nonatomic, assign) NSUInteger numberOfEvents;
+/// Number of experiments of every event (defaults to 5)
+@property (nonatomic, assign) NSUInteger numberOfExperimentsPerEvent;
+/// Number of forced (whitelisted) users of every experiment (defaults to 10)
+@property (nonatomic, assign) NSUInteger numberOfWhitelistedUsersPerExperiment;
+/// Seed of the pseudo-random choices (defaults to 1)
+@property (nonatomic, assign) uint32_t seed;
+
+/**
+ * Returns the generator with the counts set in the block.
+ */
++ (instancetype)generatorWithBlock:(void (^)(OPTLYDatafileGenerator *generator))block;
+
+/**
+ * Generates the datafile as a JSON object.
+ */
+- (NSDictionary<NSString *, id> *)datafileDictionary;
+
+/**
+ * Generates the datafile as JSON data.
+ */
+- (NSData *)datafile;
+
+/**
+ * Returns the key of the nth experiment outside of groups (experiment_0, experiment_1, ...).
+ */
+- (NSString *)experimentKeyAtIndex:(NSUInteger)index;
+
+/**
+ * Returns the key of the nth feature flag (feature_0, feature_1, ...).
+ */
+- (NSString *)featureFlagKeyAtIndex:(NSUInteger)index;
+
+/**
+ * Returns the key of the nth event (event_0, event_1, ...).
+ */
+- (NSString *)eventKeyAtIndex:(NSUInteger)index;
+
+/**
+ * Returns user attributes that satisfy every generated audience.
+ */
+- (NSDictionary<NSString *, id> *)userAttributes;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,371 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+// framework imports, since the event dispatcher load tests compile this file too
+#import <OptimizelySDKCore/OPTLYDatafileKeys.h>
+#import <OptimizelySDKCore/OPTLYFeatureVariable.h>
+#import "OPTLYDatafileGenerator.h"
+
+static NSString * const kFeatureFlagsKey = @"featureFlags";
+static NSString * const kRolloutsKey = @"rollouts";
+static NSString * const kTypedAudiencesKey = @"typedAudiences";
+static NSString * const kAnonymizeIPKey = @"anonymizeIP";
+static NSString * const kBotFilteringKey = @"botFiltering";
+static NSString * const kStatusRunning = @"Running";
+static NSString * const kGroupPolicyRandom = @"random";
+static NSInteger const kMaxEndOfRange = 10000;
+static long long const kFirstEntityId = 10000000;
+
+@interface OPTLYDatafileGenerator()
+@property (nonatomic, assign) long long nextEntityId;
+@property (nonatomic, assign) uint32_t randomState;
+@property (nonatomic, strong) NSArray<NSString *> *audienceIds;
+@end
+
+@implementation OPTLYDatafileGenerator
+
++ (instancetype)generatorWithBlock:(void (^)(OPTLYDatafileGenerator *generator))block {
+    OPTLYDatafileGenerator *generator = [self new];
+    block(generator);
+    return generator;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self != nil) {
+        _numberOfExperiments = 100;
+        _numberOfVariations = 2;
+        _numberOfGroups = 5;
+        _numberOfExperimentsPerGroup = 4;
+        _numberOfFeatureFlags = 20;
+        _numberOfVariablesPerFeatureFlag = 4;
+        _numberOfRulesPerRollout = 5;
+        _numberOfAudiences = 20;
+        _audienceDepth = 3;
+        _audienceBreadth = 3;
+        _numberOfAudiencesPerExperiment = 2;
+        _numberOfAttributes = 10;
+        _numberOfEvents = 50;
+        _numberOfExperimentsPerEvent = 5;
+        _numberOfWhitelistedUsersPerExperiment = 10;
+        _seed = 1;
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *, id> *)datafileDictionary {
+    self.nextEntityId = kFirstEntityId;
+    self.randomState = self.seed;
+    
+    NSMutableArray *attributes = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfAttributes; i++) {
+        [attributes addObject:@{ OPTLYDatafileKeysAttributeId : [self newEntityId],
+                                 OPTLYDatafileKeysAttributeKey : [self attributeKeyAtIndex:i] }];
+    }
+    
+    NSMutableArray *audiences = [NSMutableArray new];
+    NSMutableArray *typedAudiences = [NSMutableArray new];
+    NSMutableArray *audienceIds = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfAudiences; i++) {
+        NSString *audienceId = [self newEntityId];
+        NSString *name = [NSString stringWithFormat:@"audience_%lu", (unsigned long)i];
+        [audienceIds addObject:audienceId];
+        // the legacy audience is a single exact match; the typed one replaces it with a deep tree
+        NSArray *legacyConditions = @[OPTLYDatafileKeysAndCondition, @[OPTLYDatafileKeysOrCondition, @[OPTLYDatafileKeysOrCondition, [self leafConditionForAttributeAtIndex:0 match:nil]]]];
+        [audiences addObject:@{ OPTLYDatafileKeysAudienceId : audienceId,
+                                OPTLYDatafileKeysAudienceName : name,
+                                OPTLYDatafileKeysAudienceConditions : [self JSONStringWithObject:legacyConditions] }];
+        [typedAudiences addObject:@{ OPTLYDatafileKeysAudienceId : audienceId,
+                                     OPTLYDatafileKeysAudienceName : name,
+                                     OPTLYDatafileKeysAudienceConditions : [self conditionTreeWithDepth:self.audienceDepth] }];
+    }
+    self.audienceIds = audienceIds;
+    
+    NSMutableArray *experiments = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfExperiments; i++) {
+        [experiments addObject:[self experimentWithKey:[self experimentKeyAtIndex:i] layerId:[self newEntityId] variables:nil]];
+    }
+    
+    NSMutableArray *groups = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfGroups; i++) {
+        NSMutableArray *groupExperiments = [NSMutableArray new];
+        NSMutableArray *experimentIds = [NSMutableArray new];
+        for (NSUInteger j = 0; j < self.numberOfExperimentsPerGroup; j++) {
+            NSString *key = [NSString stringWithFormat:@"group_%lu_experiment_%lu", (unsigned long)i, (unsigned long)j];
+            NSDictionary *experiment = [self experimentWithKey:key layerId:[self newEntityId] variables:nil];
+            [groupExperiments addObject:experiment];
+            [experimentIds addObject:experiment[OPTLYDatafileKeysExperimentId]];
+        }
+        [groups addObject:@{ OPTLYDatafileKeysGroupId : [self newEntityId],
+                             OPTLYDatafileKeysGroupPolicy : kGroupPolicyRandom,
+                             OPTLYDatafileKeysGroupTrafficAllocation : [self trafficAllocationForEntityIds:experimentIds],
+                             OPTLYDatafileKeysGroupExperiments : groupExperiments }];
+    }
+    
+    NSMutableArray *featureFlags = [NSMutableArray new];
+    NSMutableArray *rollouts = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfFeatureFlags; i++) {
+        NSMutableArray *variables = [NSMutableArray new];
+        for (NSUInteger j = 0; j < self.numberOfVariablesPerFeatureFlag; j++) {
+            NSString *type = [self variableTypeAtIndex:j];
+            [variables addObject:@{ OPTLYDatafileKeysFeatureVariableId : [self newEntityId],
+                                    OPTLYDatafileKeysFeatureVariableKey : [NSString stringWithFormat:@"variable_%lu", (unsigned long)j],
+                                    OPTLYDatafileKeysFeatureVariableType : type,
+                                    OPTLYDatafileKeysFeatureVariableDefaultValue : [self variableValueOfType:type index:0] }];
+        }
+        
+        // every feature flag is tested by a top level experiment, if there is one left
+        NSMutableArray *experimentIds = [NSMutableArray new];
+        if (i < experiments.count) {
+            NSString *layerId = experiments[i][OPTLYDatafileKeysExperimentLayerId];
+            experiments[i] = [self experimentWithKey:[self experimentKeyAtIndex:i] layerId:layerId variables:variables];
+            [experimentIds addObject:experiments[i][OPTLYDatafileKeysExperimentId]];
+        }
+        
+        NSString *rolloutId = [self newEntityId];
+        NSMutableArray *rules = [NSMutableArray new];
+        for (NSUInteger j = 0; j <= self.numberOfRulesPerRollout; j++) {
+            NSString *key = [NSString stringWithFormat:@"feature_%lu_rule_%lu", (unsigned long)i, (unsigned long)j];
+            NSMutableDictionary *rule = [[self experimentWithKey:key layerId:rolloutId variables:variables] mutableCopy];
+            // rollout rules have a single variation and no whitelisted users
+            NSArray *ruleVariations = @[rule[OPTLYDatafileKeysExperimentVariations][0]];
+            rule[OPTLYDatafileKeysExperimentVariations] = ruleVariations;
+            rule[OPTLYDatafileKeysExperimentTrafficAllocation] = [self trafficAllocationForEntityIds:@[ruleVariations[0][OPTLYDatafileKeysVariationId]]];
+            rule[OPTLYDatafileKeysExperimentForcedVariations] = @{};
+            if (j == self.numberOfRulesPerRollout) {
+                // everyone else
+                rule[OPTLYDatafileKeysExperimentAudienceIds] = @[];
+            }
+            [rules addObject:rule];
+        }
+        [rollouts addObject:@{ OPTLYDatafileKeysRolloutId : rolloutId,
+                               OPTLYDatafileKeysRolloutExperiments : rules }];
+        
+        [featureFlags addObject:@{ OPTLYDatafileKeysFeatureFlagId : [self newEntityId],
+                                   OPTLYDatafileKeysFeatureFlagKey : [self featureFlagKeyAtIndex:i],
+                                   OPTLYDatafileKeysFeatureFlagRolloutId : rolloutId,
+                                   OPTLYDatafileKeysFeatureFlagExperimentIds : experimentIds,
+                                   OPTLYDatafileKeysFeatureFlagVariables : variables }];
+    }
+    
+    NSMutableArray *events = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfEvents; i++) {
+        NSMutableArray *experimentIds = [NSMutableArray new];
+        for (NSUInteger j = 0; j < self.numberOfExperimentsPerEvent && experiments.count > 0; j++) {
+            NSString *experimentId = experiments[[self randomNumberBelow:(uint32_t)experiments.count]][OPTLYDatafileKeysExperimentId];
+            if (![experimentIds containsObject:experimentId]) {
+                [experimentIds addObject:experimentId];
+            }
+        }
+        [events addObject:@{ OPTLYDatafileKeysEventId : [self newEntityId],
+                             OPTLYDatafileKeysEventKey : [self eventKeyAtIndex:i],
+                             OPTLYDatafileKeysEventExperimentIds : experimentIds }];
+    }
+    
+    return @{ OPTLYDatafileKeysVersion : @"4",
+              OPTLYDatafileKeysProjectId : @"1000",
+              OPTLYDatafileKeysAccountId : @"1001",
+              OPTLYDatafileKeysRevision : @"1",
+              kAnonymizeIPKey : @YES,
+              kBotFilteringKey : @NO,
+              OPTLYDatafileKeysAttributes : attributes,
+              OPTLYDatafileKeysAudiences : audiences,
+              kTypedAudiencesKey : typedAudiences,
+              OPTLYDatafileKeysExperiments : experiments,
+              OPTLYDatafileKeysGroups : groups,
+              kFeatureFlagsKey : featureFlags,
+              kRolloutsKey : rollouts,
+              OPTLYDatafileKeysEvents : events };
+}
+
+- (NSData *)datafile {
+    return [NSJSONSerialization dataWithJSONObject:[self datafileDictionary] options:kNilOptions error:nil];
+}
+
+- (NSString *)experimentKeyAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"experiment_%lu", (unsigned long)index];
+}
+
+- (NSString *)featureFlagKeyAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"feature_%lu", (unsigned long)index];
+}
+
+- (NSString *)eventKeyAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"event_%lu", (unsigned long)index];
+}
+
+- (NSDictionary<NSString *, id> *)userAttributes {
+    NSMutableDictionary *attributes = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < self.numberOfAttributes; i++) {
+        attributes[[self attributeKeyAtIndex:i]] = [self attributeValueAtIndex:i];
+    }
+    return attributes;
+}
+
+#pragma mark - Helper Methods
+
+- (NSString *)newEntityId {
+    return [NSString stringWithFormat:@"%lld", self.nextEntityId++];
+}
+
+// xorshift32, so every platform generates the same datafile
+- (uint32_t)randomNumberBelow:(uint32_t)bound {
+    uint32_t x = self.randomState ? : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    self.randomState = x;
+    return bound > 0 ? x % bound : 0;
+}
+
+- (NSString *)attributeKeyAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"attr_%lu", (unsigned long)index];
+}
+
+// even attributes are strings, odd attributes are numbers
+- (id)attributeValueAtIndex:(NSUInteger)index {
+    if (index % 2 == 0) {
+        return [NSString stringWithFormat:@"value_%lu", (unsigned long)index];
+    }
+    return @(index);
+}
+
+- (NSDictionary *)leafConditionForAttributeAtIndex:(NSUInteger)index match:(nullable NSString *)match {
+    NSMutableDictionary *condition = [@{ OPTLYDatafileKeysConditionName : [self attributeKeyAtIndex:index],
+                                         OPTLYDatafileKeysConditionType : OPTLYDatafileKeysCustomAttributeConditionType } mutableCopy];
+    id value = [self attributeValueAtIndex:index];
+    if ([match isEqualToString:OPTLYDatafileKeysMatchTypeSubstring]) {
+        value = @"value_";
+    } else if ([match isEqualToString:OPTLYDatafileKeysMatchTypeGreaterThan]) {
+        value = @([value integerValue] - 1);
+    } else if ([match isEqualToString:OPTLYDatafileKeysMatchTypeLessThan]) {
+        value = @([value integerValue] + 1);
+    }
+    if (match) {
+        condition[OPTLYDatafileKeysConditionMatch] = match;
+    }
+    if (![match isEqualToString:OPTLYDatafileKeysMatchTypeExists]) {
+        condition[OPTLYDatafileKeysConditionValue] = value;
+    }
+    return condition;
+}
+
+- (NSDictionary *)randomLeafCondition {
+    if (self.numberOfAttributes == 0) {
+        return @{};
+    }
+    NSUInteger index = [self randomNumberBelow:(uint32_t)self.numberOfAttributes];
+    NSArray *matches = index % 2 == 0
+        ? @[OPTLYDatafileKeysMatchTypeExact, OPTLYDatafileKeysMatchTypeSubstring, OPTLYDatafileKeysMatchTypeExists]
+        : @[OPTLYDatafileKeysMatchTypeExact, OPTLYDatafileKeysMatchTypeGreaterThan, OPTLYDatafileKeysMatchTypeLessThan];
+    return [self leafConditionForAttributeAtIndex:index match:matches[[self randomNumberBelow:(uint32_t)matches.count]]];
+}
+
+// "and" at the root, then alternating "or" and "and" nodes, with leaves at the given depth
+- (id)conditionTreeWithDepth:(NSUInteger)depth {
+    return [self conditionTreeWithDepth:depth operator:OPTLYDatafileKeysAndCondition];
+}
+
+- (id)conditionTreeWithDepth:(NSUInteger)depth operator:(NSString *)operator {
+    if (depth == 0) {
+        return [self randomLeafCondition];
+    }
+    NSString *childOperator = [operator isEqualToString:OPTLYDatafileKeysAndCondition] ? OPTLYDatafileKeysOrCondition : OPTLYDatafileKeysAndCondition;
+    NSMutableArray *node = [NSMutableArray arrayWithObject:operator];
+    for (NSUInteger i = 0; i < MAX(self.audienceBreadth, 1); i++) {
+        [node addObject:[self conditionTreeWithDepth:depth - 1 operator:childOperator]];
+    }
+    return node;
+}
+
+- (NSArray *)trafficAllocationForEntityIds:(NSArray<NSString *> *)entityIds {
+    NSMutableArray *trafficAllocation = [NSMutableArray new];
+    for (NSUInteger i = 0; i < entityIds.count; i++) {
+        [trafficAllocation addObject:@{ OPTLYDatafileKeysTrafficAllocationEntityId : entityIds[i],
+                                        OPTLYDatafileKeysTrafficAllocationEndOfRange : @(kMaxEndOfRange * (i + 1) / entityIds.count) }];
+    }
+    return trafficAllocation;
+}
+
+- (NSArray<NSString *> *)randomAudienceIds {
+    NSMutableArray *audienceIds = [NSMutableArray new];
+    for (NSUInteger i = 0; i < self.numberOfAudiencesPerExperiment && self.audienceIds.count > 0; i++) {
+        NSString *audienceId = self.audienceIds[[self randomNumberBelow:(uint32_t)self.audienceIds.count]];
+        if (![audienceIds containsObject:audienceId]) {
+            [audienceIds addObject:audienceId];
+        }
+    }
+    return audienceIds;
+}
+
+- (NSString *)variableTypeAtIndex:(NSUInteger)index {
+    NSArray *types = @[FeatureVariableTypeString, FeatureVariableTypeInteger, FeatureVariableTypeDouble, FeatureVariableTypeBoolean];
+    return types[index % types.count];
+}
+
+- (NSString *)variableValueOfType:(NSString *)type index:(NSUInteger)index {
+    if ([type isEqualToString:FeatureVariableTypeInteger]) {
+        return [NSString stringWithFormat:@"%lu", (unsigned long)index];
+    } else if ([type isEqualToString:FeatureVariableTypeDouble]) {
+        return [NSString stringWithFormat:@"%lu.5", (unsigned long)index];
+    } else if ([type isEqualToString:FeatureVariableTypeBoolean]) {
+        return index % 2 == 0 ? @"false" : @"true";
+    }
+    return [NSString stringWithFormat:@"value_%lu", (unsigned long)index];
+}
+
+- (NSDictionary *)experimentWithKey:(NSString *)key layerId:(NSString *)layerId variables:(nullable NSArray<NSDictionary *> *)variables {
+    NSString *experimentId = [self newEntityId];
+    NSMutableArray *variations = [NSMutableArray new];
+    NSMutableArray *variationIds = [NSMutableArray new];
+    for (NSUInteger i = 0; i < MAX(self.numberOfVariations, 1); i++) {
+        NSString *variationId = [self newEntityId];
+        NSMutableArray *variableUsages = [NSMutableArray new];
+        for (NSDictionary *variable in variables) {
+            NSString *value = [self variableValueOfType:variable[OPTLYDatafileKeysFeatureVariableType] index:i + 1];
+            [variableUsages addObject:@{ OPTLYDatafileKeysVariableUsageId : variable[OPTLYDatafileKeysFeatureVariableId],
+                                         OPTLYDatafileKeysVariableUsageValue : value }];
+        }
+        [variations addObject:@{ OPTLYDatafileKeysVariationId : variationId,
+                                 OPTLYDatafileKeysVariationKey : [NSString stringWithFormat:@"variation_%lu", (unsigned long)i],
+                                 OPTLYDatafileKeysVariationFeatureEnabled : @(variables != nil),
+                                 OPTLYDatafileKeysVariationVariables : variableUsages }];
+        [variationIds addObject:variationId];
+    }
+    
+    NSMutableDictionary *forcedVariations = [NSMutableDictionary new];
+    for (NSUInteger i = 0; i < self.numberOfWhitelistedUsersPerExperiment; i++) {
+        NSString *userId = [NSString stringWithFormat:@"%@_user_%lu", key, (unsigned long)i];
+        forcedVariations[userId] = variations[i % variations.count][OPTLYDatafileKeysVariationKey];
+    }
+    
+    return @{ OPTLYDatafileKeysExperimentId : experimentId,
+              OPTLYDatafileKeysExperimentKey : key,
+              OPTLYDatafileKeysExperimentLayerId : layerId,
+              OPTLYDatafileKeysExperimentStatus : kStatusRunning,
+              OPTLYDatafileKeysExperimentAudienceIds : [self randomAudienceIds],
+              OPTLYDatafileKeysExperimentVariations : variations,
+              OPTLYDatafileKeysExperimentTrafficAllocation : [self trafficAllocationForEntityIds:variationIds],
+              OPTLYDatafileKeysExperimentForcedVariations : forcedVariations };
+}
+
+- (NSString *)JSONStringWithObject:(id)object {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:object options:kNilOptions error:nil];
+    return [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+}
+
+@end
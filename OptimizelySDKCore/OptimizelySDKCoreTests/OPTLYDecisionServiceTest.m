@@ -1003,4 +1003,90 @@ static NSString * const kFeatureFlagNoBucketedRuleRolloutKey = @"booleanSingleVa
     XCTAssertEqualObjects(expectedFeatureDecision.source, featureDecision.source);
 }
 
+#pragma mark - Decision Tracing
+
+// no decision should be traced when the sample rate is 0
+- (void)testDecisionTraceIsOffByDefault {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"no trace"];
+    expectation.inverted = YES;
+    self.decisionService.decisionTraceHandler = ^(OPTLYDecisionTrace *trace) {
+        [expectation fulfill];
+    };
+    OPTLYExperiment *experiment = [self.config getExperimentForKey:kExperimentNoAudienceKey];
+    XCTAssertNotNil([self.decisionService getVariation:kUserId experiment:experiment attributes:nil]);
+    [self waitForExpectationsWithTimeout:0.2 handler:nil];
+}
+
+// a traced decision should record the steps it went through and their outcomes
+- (void)testDecisionTraceRecordsSteps {
+    OPTLYExperiment *experiment = [self.config getExperimentForKey:kExperimentNoAudienceKey];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"trace"];
+    __block NSDictionary *steps = nil;
+    __block NSString *key = nil;
+    __block NSString *variationKey = nil;
+    __block BOOL isFeature = YES;
+    self.decisionService.decisionTraceSampleRate = 1;
+    self.decisionService.decisionTraceHandler = ^(OPTLYDecisionTrace *trace) {
+        // the trace is reused after the handler returns
+        steps = [trace steps];
+        key = trace.key;
+        variationKey = trace.variationKey;
+        isFeature = trace.isFeature;
+        [expectation fulfill];
+    };
+    
+    OPTLYVariation *variation = [self.decisionService getVariation:kUserId experiment:experiment attributes:nil];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    XCTAssertEqualObjects(key, kExperimentNoAudienceKey);
+    XCTAssertEqualObjects(variationKey, variation.variationKey);
+    XCTAssertFalse(isFeature);
+    NSString *noMatch = [OPTLYDecisionTrace nameOfOutcome:OPTLYDecisionTraceOutcomeNoMatch];
+    NSString *match = [OPTLYDecisionTrace nameOfOutcome:OPTLYDecisionTraceOutcomeMatch];
+    XCTAssertEqualObjects(steps[[OPTLYDecisionTrace nameOfStep:OPTLYDecisionTraceStepForcedVariation]][OPTLYDecisionTraceOutcomeKey], noMatch);
+    XCTAssertEqualObjects(steps[[OPTLYDecisionTrace nameOfStep:OPTLYDecisionTraceStepWhitelist]][OPTLYDecisionTraceOutcomeKey], noMatch);
+    XCTAssertEqualObjects(steps[[OPTLYDecisionTrace nameOfStep:OPTLYDecisionTraceStepAudienceEvaluation]][OPTLYDecisionTraceOutcomeKey], match);
+    XCTAssertEqualObjects(steps[[OPTLYDecisionTrace nameOfStep:OPTLYDecisionTraceStepBucketing]][OPTLYDecisionTraceOutcomeKey], match);
+    XCTAssertNil(steps[[OPTLYDecisionTrace nameOfStep:OPTLYDecisionTraceStepRolloutRules]]);
+}
+
+// 1 in decisionTraceSampleRate decisions should be traced
+- (void)testDecisionTraceSampleRate {
+    OPTLYExperiment *experiment = [self.config getExperimentForKey:kExperimentNoAudienceKey];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"traces"];
+    expectation.expectedFulfillmentCount = 2;
+    expectation.assertForOverFulfill = YES;
+    self.decisionService.decisionTraceSampleRate = 3;
+    self.decisionService.decisionTraceHandler = ^(OPTLYDecisionTrace *trace) {
+        [expectation fulfill];
+    };
+    for (NSUInteger i = 0; i < 6; i++) {
+        [self.decisionService getVariation:kUserId experiment:experiment attributes:nil];
+    }
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+}
+
+// a feature decision should be traced once, including the rollout rule walk
+- (void)testDecisionTraceOfFeatureRollout {
+    OPTLYFeatureFlag *featureFlag = [self.config getFeatureFlagForKey:kFeatureFlagNoBucketedRuleRolloutKey];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"trace"];
+    expectation.assertForOverFulfill = YES;
+    __block NSUInteger rolloutRulesCount = 0;
+    __block NSUInteger audienceEvaluationCount = 0;
+    __block BOOL isFeature = NO;
+    self.decisionService.decisionTraceSampleRate = 1;
+    self.decisionService.decisionTraceHandler = ^(OPTLYDecisionTrace *trace) {
+        rolloutRulesCount = [trace countOfStep:OPTLYDecisionTraceStepRolloutRules];
+        audienceEvaluationCount = [trace countOfStep:OPTLYDecisionTraceStepAudienceEvaluation];
+        isFeature = trace.isFeature;
+        [expectation fulfill];
+    };
+    [self.decisionService getVariationForFeature:featureFlag userId:kUserId attributes:@{ kAttributeKey: kAttributeValueChrome }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    XCTAssertTrue(isFeature);
+    XCTAssertEqual(rolloutRulesCount, 1);
+    XCTAssertGreaterThan(audienceEvaluationCount, 0);
+}
+
 @end
@@ -1,5 +1,5 @@
 /****************************************************************************
- * Copyright 2016,2018-2019, Optimizely, Inc. and contributors              *
+ * Copyright 2016,2018-2020, Optimizely, Inc. and contributors              *
  *                                                                          *
  * Licensed under the Apache License, Version 2.0 (the "License");          *
  * you may not use this file except in compliance with the License.         *
@@ -19,6 +19,8 @@
 #import "OPTLYProjectConfig.h"
 #import "OPTLYEventBuilder.h"
 #import "OPTLYEventParameterKeys.h"
+#import "OPTLYEventPayload.h"
+#import "OPTLYEventDispatcherBasic.h"
 #import "OPTLYDecisionEventTicket.h"
 #import "OPTLYDecisionService.h"
 #import "OPTLYBucketer.h"
@@ -41,6 +43,8 @@ static NSString * const kRevision = @"83";
 static NSString * const kLayerId = @"1234";
 static NSInteger kEventRevenue = 88;
 static double kEventValue = 123.456;
+static NSUInteger const kEventBenchmarkIterations = 1000;
+static NSUInteger const kTrackEventsBurstSize = 10;
 static NSString * const kTotalRevenueId = @"6316734272";
 static NSString * const kAttributeKeyBrowserType = @"browser_type";
 static NSString * const kAttributeValueFirefox = @"firefox";
@@ -99,6 +103,7 @@ typedef enum : NSUInteger {
 - (NSString *)sdkVersion;
 - (NSArray *)createUserFeatures:(OPTLYProjectConfig *)config
                      attributes:(NSDictionary *)attributes;
+- (id)envelope;
 @end
 
 @interface OPTLYEventBuilderTest : XCTestCase
@@ -1032,6 +1037,66 @@ typedef enum : NSUInteger {
              bucketer:nil userId:kUserId];
 }
 
+// one visitor snapshot carries every conversion event, each with its own tags
+- (void)testBuildConversionEventTicketWithMultipleEvents {
+    NSDictionary *eventTags = @{ OPTLYEventMetricNameRevenue : @(kEventRevenue) };
+    NSDictionary *params = [self.eventBuilder buildConversionEventForUser:kUserId
+                                                                   events:@[eventWithAudience, eventWithoutAudience, eventWithAudience]
+                                                                eventTags:@[eventTags, [NSNull null], [NSNull null]]
+                                                               attributes:self.attributes];
+    [self.attributes addEntriesFromDictionary:self.reservedAttributes];
+    [self checkCommonParams:params withAttributes:self.attributes];
+    
+    NSArray *visitors = params[OPTLYEventParameterKeysVisitors];
+    XCTAssertEqual(visitors.count, 1);
+    NSArray *snapshots = visitors[0][OPTLYEventParameterKeysSnapshots];
+    XCTAssertEqual(snapshots.count, 1);
+    NSArray *events = snapshots[0][OPTLYEventParameterKeysEvents];
+    XCTAssertEqual(events.count, 3);
+    [self checkConversion:events[0] entityId:kEventWithAudienceId eventKey:kEventWithAudienceName uuid:@"" eventTags:eventTags tags:eventTags];
+    [self checkConversion:events[1] entityId:kEventWithoutAudienceId eventKey:kEventWithoutAudienceName uuid:@"" eventTags:nil tags:nil];
+    XCTAssertNil(events[2][OPTLYEventMetricNameRevenue]);
+    
+    XCTAssertNil([self.eventBuilder buildConversionEventForUser:kUserId events:@[eventWithAudience] eventTags:@[] attributes:self.attributes]);
+}
+
+// one visitor snapshot carries a decision and an activation event per experiment
+- (void)testBuildImpressionEventTicketWithMultipleExperiments {
+    OPTLYExperiment *experiment = [self.config getExperimentForKey:kExperimentWithoutAudienceKey];
+    OPTLYVariation *variation = [self.config getVariationForExperiment:kExperimentWithoutAudienceKey
+                                                                userId:kUserId attributes:self.attributes bucketer:self.bucketer];
+    OPTLYVariation *variationWithAudience = [self.config getVariationForExperiment:kExperimentWithAudienceKey
+                                                                            userId:kUserId attributes:self.attributes bucketer:self.bucketer];
+    XCTAssertNotNil(variation);
+    XCTAssertNotNil(variationWithAudience);
+    NSDictionary *params = [self.eventBuilder buildImpressionEventForUser:kUserId
+                                                              experiments:@[experiment, experimentWithAudience]
+                                                               variations:@[variation, variationWithAudience]
+                                                               attributes:self.attributes];
+    [self.attributes addEntriesFromDictionary:self.reservedAttributes];
+    [self checkCommonParams:params withAttributes:self.attributes];
+    
+    NSArray *visitors = params[OPTLYEventParameterKeysVisitors];
+    XCTAssertEqual(visitors.count, 1);
+    NSArray *snapshots = visitors[0][OPTLYEventParameterKeysSnapshots];
+    XCTAssertEqual(snapshots.count, 1);
+    NSArray *decisions = snapshots[0][OPTLYEventParameterKeysDecisions];
+    NSArray *events = snapshots[0][OPTLYEventParameterKeysEvents];
+    XCTAssertEqual(decisions.count, 2);
+    XCTAssertEqual(events.count, 2);
+    [self checkDecision:decisions[0] campaignId:experiment.layerId experimentId:experiment.experimentId variationId:variation.variationId];
+    [self checkDecision:decisions[1] campaignId:experimentWithAudience.layerId experimentId:experimentWithAudience.experimentId variationId:variationWithAudience.variationId];
+    [self checkImpression:events[0] entityId:experiment.layerId eventKey:OptimizelyActivateEventKey uuid:@""];
+    [self checkImpression:events[1] entityId:experimentWithAudience.layerId eventKey:OptimizelyActivateEventKey uuid:@""];
+    XCTAssertNotEqualObjects(events[0][OPTLYEventParameterKeysUUID], events[1][OPTLYEventParameterKeysUUID]);
+}
+
+- (void)testBuildImpressionEventTicketWithMismatchedExperiments {
+    OPTLYExperiment *experiment = [self.config getExperimentForKey:kExperimentWithoutAudienceKey];
+    XCTAssertNil([self.eventBuilder buildImpressionEventForUser:kUserId experiments:@[] variations:@[] attributes:self.attributes]);
+    XCTAssertNil([self.eventBuilder buildImpressionEventForUser:kUserId experiments:@[experiment] variations:@[] attributes:self.attributes]);
+}
+
 - (void)testBuildImpressionTicketWithAnonymizeIPFalse {
     OPTLYProjectConfig *config = [self setUpForAnonymizeIPFalse];
     OPTLYEventBuilderDefault *eventBuilder = [[OPTLYEventBuilderDefault alloc] initWithConfig:config];
@@ -1085,6 +1150,105 @@ typedef enum : NSUInteger {
              eventKey:nil eventTags:nil tags:nil bucketer:nil userId:kUserId];
 }
 
+#pragma mark - Test Payload Encoding
+
+- (void)testBuiltEventIsEncodedPayload {
+    NSDictionary *params = [self.eventBuilder buildConversionEventForUser:kUserId
+                                                                    event:eventWithAudience
+                                                                eventTags:@{ OPTLYEventMetricNameRevenue : @(kEventRevenue),
+                                                                             OPTLYEventMetricNameValue : @(kEventValue),
+                                                                             @"tag" : @"quote \" tag" }
+                                                               attributes:self.attributes];
+    XCTAssert([params isKindOfClass:[OPTLYEventPayload class]], @"Event should be returned already encoded.");
+    
+    NSData *data = ((OPTLYEventPayload *)params).JSONData;
+    NSDictionary *decoded = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    XCTAssertEqualObjects(decoded, params);
+    XCTAssertEqual(decoded.count, params.count);
+    NSDictionary *event = decoded[OPTLYEventParameterKeysVisitors][0][OPTLYEventParameterKeysSnapshots][0][OPTLYEventParameterKeysEvents][0];
+    XCTAssertEqualObjects(event[OPTLYEventMetricNameRevenue], @(kEventRevenue));
+    XCTAssertEqualObjects(event[OPTLYEventMetricNameValue], @(kEventValue));
+    XCTAssertEqualObjects(event[OPTLYEventParameterKeysTags][@"tag"], @"quote \" tag");
+}
+
+- (void)testEnvelopeIsEncodedOncePerRevision {
+    NSDictionary *impression = [self.eventBuilder buildImpressionEventForUser:kUserId
+                                                                   experiment:experimentWithAudience
+                                                                    variation:experimentWithAudience.variations[0]
+                                                                   attributes:self.attributes];
+    id envelope = [self.eventBuilder envelope];
+    XCTAssertNotNil(envelope);
+    NSDictionary *conversion = [self.eventBuilder buildConversionEventForUser:kUserId
+                                                                       event:eventWithAudience
+                                                                   eventTags:nil
+                                                                  attributes:nil];
+    XCTAssertEqual([self.eventBuilder envelope], envelope);
+    
+    NSMutableDictionary *impressionEnvelope = [impression mutableCopy];
+    NSMutableDictionary *conversionEnvelope = [conversion mutableCopy];
+    [impressionEnvelope removeObjectForKey:OPTLYEventParameterKeysVisitors];
+    [conversionEnvelope removeObjectForKey:OPTLYEventParameterKeysVisitors];
+    XCTAssertEqualObjects(impressionEnvelope, conversionEnvelope);
+    XCTAssertEqual(impression.count, conversionEnvelope.count + 1);
+    XCTAssertEqualObjects(conversion[OPTLYEventParameterKeysRevision], kRevision);
+    
+    // the cached bot filtering feature is still appended to the user features
+    NSArray *features = conversion[OPTLYEventParameterKeysVisitors][0][OPTLYEventParameterKeysAttributes];
+    XCTAssertEqualObjects([features lastObject][OPTLYEventParameterKeysFeaturesKey], OptimizelyBotFiltering);
+}
+
+#pragma mark - Benchmarks
+
+- (void)testBuildConversionEventPerformance {
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kEventBenchmarkIterations; i++) {
+            @autoreleasepool {
+                [self.eventBuilder buildConversionEventForUser:kUserId
+                                                         event:eventWithAudience
+                                                     eventTags:@{ OPTLYEventMetricNameRevenue : @(kEventRevenue) }
+                                                    attributes:self.attributes];
+            }
+        }
+    }];
+}
+
+- (void)testTrackPerformance {
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDatafileName];
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = [OPTLYEventDispatcherNoOp new];
+    }]];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kEventBenchmarkIterations; i++) {
+            @autoreleasepool {
+                [optimizely track:kEventWithAudienceName userId:kUserId attributes:self.attributes];
+            }
+        }
+    }];
+}
+
+// Tracks the same kEventBenchmarkIterations events as testTrackPerformance, kTrackEventsBurstSize events per call.
+- (void)testTrackEventsPerformance {
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDatafileName];
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = [OPTLYEventDispatcherNoOp new];
+    }]];
+    NSMutableArray *events = [NSMutableArray new];
+    for (NSUInteger i = 0; i < kTrackEventsBurstSize; i++) {
+        [events addObject:@{ OPTLYTrackEventKey : kEventWithAudienceName }];
+    }
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < kEventBenchmarkIterations / kTrackEventsBurstSize; i++) {
+            @autoreleasepool {
+                [optimizely trackEvents:events userId:kUserId attributes:self.attributes];
+            }
+        }
+    }];
+}
+
 #pragma mark - Helper Methods
 
 - (void)commonBuildConversionTicketTest:(NSDictionary*)eventTags
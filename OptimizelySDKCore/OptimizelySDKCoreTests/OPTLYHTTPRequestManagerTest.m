@@ -18,7 +18,9 @@
 #import <OHHTTPStubs/OHHTTPStubs.h>
 #import <OCMock/OCMock.h>
 #import "OPTLYHTTPRequestManager.h"
+#import "OPTLYRequestThrottle.h"
 #import "OPTLYTestHelper.h"
+#import "OPTLYTestHTTPServer.h"
 
 static NSString * const kTestURLString = @"testURL";
 static NSString * const kLastModifiedDate = @"Mon, 28 Nov 2016 06:10:59 GMT";
@@ -189,9 +191,58 @@ static NSInteger const kBackoffRetryInterval = 1;
     }];
 }
 
+- (void)testPOSTWithCompressionSendsGzipBody
+{
+    OPTLYTestHTTPServer *server = [OPTLYTestHTTPServer new];
+    XCTAssertTrue([server start]);
+    NSDictionary *parameters = [self largeParameters];
+    
+    OPTLYHTTPRequestManager *requestManager = [OPTLYHTTPRequestManager new];
+    requestManager.compressionEnabled = YES;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for compressed POST."];
+    [requestManager POSTWithParameters:parameters url:[server.URL URLByAppendingPathComponent:@"v1/events"] completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    [server stop];
+    
+    OPTLYTestHTTPRequest *request = server.requests.firstObject;
+    XCTAssertEqualObjects(request.method, @"POST");
+    XCTAssertEqualObjects(request.path, @"/v1/events");
+    XCTAssertEqualObjects(request.headers[@"content-encoding"], @"gzip");
+    NSData *uncompressedBody = [NSJSONSerialization dataWithJSONObject:parameters options:0 error:nil];
+    XCTAssertLessThan(request.body.length, uncompressedBody.length / 2);
+    NSDictionary *received = [NSJSONSerialization JSONObjectWithData:request.decodedBody options:0 error:nil];
+    XCTAssertEqualObjects(received, parameters);
+}
+
+- (void)testPOSTWithCompressionBelowThresholdIsNotCompressed
+{
+    OPTLYTestHTTPServer *server = [OPTLYTestHTTPServer new];
+    XCTAssertTrue([server start]);
+    
+    OPTLYHTTPRequestManager *requestManager = [OPTLYHTTPRequestManager new];
+    requestManager.compressionEnabled = YES;
+    requestManager.compressionThreshold = OPTLYHTTPRequestManagerDefaultCompressionThreshold;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for uncompressed POST."];
+    [requestManager POSTWithParameters:self.parameters url:server.URL completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    [server stop];
+    
+    OPTLYTestHTTPRequest *request = server.requests.firstObject;
+    XCTAssertNil(request.headers[@"content-encoding"]);
+    NSDictionary *received = [NSJSONSerialization JSONObjectWithData:request.body options:0 error:nil];
+    XCTAssertEqualObjects(received, self.parameters);
+}
+
 // Tests the following for the POST with backoff retry:
 // 1. correct number of recursive calls
-// 2. the right delays are set at each retry attempt
+// 2. the jittered delays are within bounds at each retry attempt
 - (void)testPOSTWithParametersBackoffRetryFailure
 {
     [OPTLYTestHelper stubFailureResponse];
@@ -202,7 +253,7 @@ static NSInteger const kBackoffRetryInterval = 1;
                   backoffRetryInterval:kBackoffRetryInterval
                                retries:kRetryAttempts
                      completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-        [self checkMaxRetries:requestManager];
+        [self checkJitteredRetries:requestManager];
         [expectation fulfill];
         NSAssert(error != nil, @"Network service POSTWithParameters does not return error as expected.");
     }];
@@ -237,6 +288,122 @@ static NSInteger const kBackoffRetryInterval = 1;
         }
     }];
 }
+- (void)testPOSTWithServerErrorIsRetried
+{
+    OPTLYTestHTTPServer *server = [OPTLYTestHTTPServer new];
+    server.responseStatusCode = 503;
+    XCTAssertTrue([server start]);
+    
+    OPTLYHTTPRequestManager *requestManager = [OPTLYHTTPRequestManager new];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for POST retries."];
+    [requestManager POSTWithParameters:self.parameters
+                                   url:server.URL
+                  backoffRetryInterval:kBackoffRetryInterval
+                               retries:kRetryAttempts
+                     completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    [server stop];
+    
+    XCTAssertEqual((NSInteger)server.requests.count, kRetryAttempts+1);
+}
+
+- (void)testPOSTRetriesAreLimitedByRetryBudget
+{
+    OPTLYTestHTTPServer *server = [OPTLYTestHTTPServer new];
+    server.responseStatusCode = 500;
+    XCTAssertTrue([server start]);
+    
+    OPTLYHTTPRequestManager *requestManager = [OPTLYHTTPRequestManager new];
+    requestManager.throttle = [[OPTLYRequestThrottle alloc] initWithMaxRetryTokens:2 failureThreshold:100 openInterval:60];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for POST retries."];
+    [requestManager POSTWithParameters:self.parameters
+                                   url:server.URL
+                  backoffRetryInterval:kBackoffRetryInterval
+                               retries:10
+                     completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    [server stop];
+    
+    // the first attempt plus one retry per token
+    XCTAssertEqual(server.requests.count, 3);
+    XCTAssertEqual(requestManager.throttle.retryTokens, 0);
+}
+
+// Tests the following against a failing and then slow server:
+// 1. consecutive failures open the circuit and later POSTs are not sent
+// 2. after the open interval a single probe is sent while concurrent POSTs are rejected
+// 3. a successful probe closes the circuit
+- (void)testPOSTCircuitBreakerOpensAndProbes
+{
+    OPTLYTestHTTPServer *server = [OPTLYTestHTTPServer new];
+    server.responseStatusCode = 500;
+    XCTAssertTrue([server start]);
+    
+    OPTLYHTTPRequestManager *requestManager = [OPTLYHTTPRequestManager new];
+    requestManager.throttle = [[OPTLYRequestThrottle alloc] initWithMaxRetryTokens:10 failureThreshold:3 openInterval:0.5];
+    
+    for (NSInteger i = 0; i < 3; i++) {
+        [self POSTWithRequestManager:requestManager url:server.URL];
+    }
+    XCTAssertEqual(requestManager.throttle.circuitState, OPTLYCircuitStateOpen);
+    
+    NSError *error = [self POSTWithRequestManager:requestManager url:server.URL];
+    XCTAssertEqual(error.code, OPTLYErrorTypesHTTPRequestManager);
+    XCTAssertEqual(server.requests.count, 3);
+    
+    // the endpoint recovers, but slowly
+    server.responseStatusCode = 200;
+    server.requestHandler = ^(OPTLYTestHTTPRequest *request) {
+        [NSThread sleepForTimeInterval:0.5];
+    };
+    [NSThread sleepForTimeInterval:0.6];
+    
+    __block BOOL probeSucceeded = NO;
+    XCTestExpectation *probeExpectation = [self expectationWithDescription:@"Wait for probe."];
+    [requestManager POSTWithParameters:self.parameters url:server.URL completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        probeSucceeded = (error == nil);
+        [probeExpectation fulfill];
+    }];
+    XCTAssertEqual(requestManager.throttle.circuitState, OPTLYCircuitStateHalfOpen);
+    error = [self POSTWithRequestManager:requestManager url:server.URL];
+    XCTAssertNotNil(error);
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    
+    XCTAssertTrue(probeSucceeded);
+    XCTAssertEqual(requestManager.throttle.circuitState, OPTLYCircuitStateClosed);
+    server.requestHandler = nil;
+    XCTAssertNil([self POSTWithRequestManager:requestManager url:server.URL]);
+    [server stop];
+    XCTAssertEqual(server.requests.count, 5);
+}
+
+- (void)testPOSTIsNotRetriedWhileCircuitIsOpen
+{
+    [OPTLYTestHelper stubFailureResponse];
+    OPTLYHTTPRequestManager *requestManager = [OPTLYHTTPRequestManager new];
+    requestManager.throttle = [[OPTLYRequestThrottle alloc] initWithMaxRetryTokens:10 failureThreshold:2 openInterval:60];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for POST retries."];
+    [requestManager POSTWithParameters:self.parameters
+                                   url:self.testURL
+                  backoffRetryInterval:kBackoffRetryInterval
+                               retries:kRetryAttempts
+                     completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        XCTAssertNotNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:3.0 handler:nil];
+    
+    // the second failure opened the circuit, so no further retry was made
+    XCTAssertEqual(requestManager.retryAttemptTest, 1);
+    XCTAssertEqual(requestManager.throttle.retryTokens, 9);
+}
+
 - (void)testGETRetryFailure
 {
     [OPTLYTestHelper stubFailureResponse];
@@ -369,6 +536,29 @@ static NSInteger const kBackoffRetryInterval = 1;
 
 #pragma mark - Helper Methods
 
+// an event-like payload with repeated visitors, well above the compression threshold
+- (NSDictionary *)largeParameters {
+    NSMutableArray *visitors = [NSMutableArray new];
+    for (NSInteger i = 0; i < 50; i++) {
+        [visitors addObject:@{ @"visitor_id" : [NSString stringWithFormat:@"user_%ld", (long)i],
+                               @"attributes" : @[ @{ @"entity_id" : @"6359881003", @"key" : @"browser_type", @"type" : @"custom", @"value" : @"firefox" } ],
+                               @"snapshots" : @[ @{ @"events" : @[ @{ @"entity_id" : @"6372590948", @"key" : @"testEvent", @"uuid" : [[NSUUID UUID] UUIDString] } ] } ] }];
+    }
+    return @{ @"visitors" : visitors, @"project_id" : @"6377970066", @"account_id" : @"6365361536", @"anonymize_ip" : @YES };
+}
+
+// sends a single POST and waits for it to complete
+- (NSError *)POSTWithRequestManager:(OPTLYHTTPRequestManager *)requestManager url:(NSURL *)url {
+    __block NSError *POSTError = nil;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for POST."];
+    [requestManager POSTWithParameters:self.parameters url:url completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        POSTError = error;
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:5.0 handler:nil];
+    return POSTError;
+}
+
 - (void)checkNoRetries:(OPTLYHTTPRequestManager *)requestManager {
     XCTAssertTrue(requestManager.retryAttemptTest == 0, @"Invalid number of retries.");
     XCTAssertTrue([requestManager.delaysTest isEqualToArray:@[]], @"Invalid delays set for backoff retry.");
@@ -378,6 +568,19 @@ static NSInteger const kBackoffRetryInterval = 1;
     XCTAssertTrue(requestManager.retryAttemptTest == kRetryAttempts+1, @"Invalid number of retries.");
     XCTAssertTrue([requestManager.delaysTest isEqualToArray:self.expectedDelays], @"Invalid delays set for backoff retry.");
 }
+
+// the last failed attempt is reported without a delay
+- (void)checkJitteredRetries:(OPTLYHTTPRequestManager *)requestManager {
+    XCTAssertTrue(requestManager.retryAttemptTest == kRetryAttempts+1, @"Invalid number of retries.");
+    XCTAssertEqual((NSInteger)requestManager.delaysTest.count, kRetryAttempts);
+    uint64_t previousDelay_ns = kBackoffRetryInterval * NSEC_PER_MSEC;
+    for (NSNumber *delay in requestManager.delaysTest) {
+        uint64_t delay_ns = [delay unsignedLongLongValue];
+        XCTAssertGreaterThanOrEqual(delay_ns, kBackoffRetryInterval * NSEC_PER_MSEC);
+        XCTAssertLessThanOrEqual(delay_ns, previousDelay_ns * 3);
+        previousDelay_ns = delay_ns;
+    }
+}
 - (void)swizzleConfig {
     Method method = class_getClassMethod(NSURLSessionConfiguration.class, @selector(ephemeralSessionConfiguration));
     Method swizzle_method = class_getClassMethod(NSURLSessionConfiguration.class, @selector(getEphemeral));
@@ -0,0 +1,141 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <XCTest/XCTest.h>
+#import "OPTLYImpressionDeduplicator.h"
+
+static NSString * const kUserId = @"userId";
+static NSString * const kExperimentId = @"experimentId";
+static NSString * const kVariationId = @"variationId";
+static const NSTimeInterval kWindow = 0.2;
+
+// a deduplicator whose clock is set by the test
+@interface OPTLYTestImpressionDeduplicator : OPTLYImpressionDeduplicator
+@property (atomic, assign) NSTimeInterval currentTime;
+@end
+
+@implementation OPTLYTestImpressionDeduplicator
+- (NSTimeInterval)now {
+    return self.currentTime;
+}
+@end
+
+@interface OPTLYImpressionDeduplicatorTest : XCTestCase
+@property (nonatomic, strong) OPTLYImpressionDeduplicator *deduplicator;
+@end
+
+@implementation OPTLYImpressionDeduplicatorTest
+
+- (void)setUp {
+    [super setUp];
+    self.deduplicator = [[OPTLYImpressionDeduplicator alloc] initWithWindow:kWindow maxEntries:100];
+}
+
+- (void)tearDown {
+    self.deduplicator = nil;
+    [super tearDown];
+}
+
+- (void)testDefaultInit {
+    OPTLYImpressionDeduplicator *deduplicator = [OPTLYImpressionDeduplicator new];
+    XCTAssertEqual(deduplicator.window, OPTLYImpressionDeduplicatorDefaultWindow);
+    XCTAssertEqual(deduplicator.maxEntries, OPTLYImpressionDeduplicatorDefaultMaxEntries);
+    XCTAssertEqual(deduplicator.numberOfSentImpressions, 0);
+    XCTAssertEqual(deduplicator.numberOfSuppressedImpressions, 0);
+}
+
+- (void)testDuplicateImpressionIsSuppressed {
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertFalse([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertFalse([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertEqual(self.deduplicator.numberOfSentImpressions, 1);
+    XCTAssertEqual(self.deduplicator.numberOfSuppressedImpressions, 2);
+}
+
+// an impression that could not be sent is let through again
+- (void)testCancelledImpressionIsSentAgain {
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    [self.deduplicator cancelImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId];
+    XCTAssertEqual(self.deduplicator.numberOfSentImpressions, 0);
+    // cancelling an impression that is not remembered does nothing
+    [self.deduplicator cancelImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId];
+    XCTAssertEqual(self.deduplicator.numberOfSentImpressions, 0);
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertFalse([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertEqual(self.deduplicator.numberOfSentImpressions, 1);
+    XCTAssertEqual(self.deduplicator.numberOfSuppressedImpressions, 1);
+}
+
+// concurrent sends of the same impression let exactly one through
+- (void)testConcurrentImpressionsAreLetThroughOnce {
+    NSUInteger const numberOfSends = 100;
+    dispatch_apply(numberOfSends, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        [self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId];
+    });
+    XCTAssertEqual(self.deduplicator.numberOfSentImpressions, 1);
+    XCTAssertEqual(self.deduplicator.numberOfSuppressedImpressions, numberOfSends - 1);
+}
+
+- (void)testImpressionsAreDistinguishedByEveryId {
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:@"otherUserId" experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:@"otherExperimentId" variationId:kVariationId]);
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:@"otherVariationId"]);
+    // the ids are not simply concatenated
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:@"ab" experimentId:@"c" variationId:kVariationId]);
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:@"a" experimentId:@"bc" variationId:kVariationId]);
+    XCTAssertEqual(self.deduplicator.numberOfSuppressedImpressions, 0);
+}
+
+// an impression is remembered for at least one window, then it is forgotten
+- (void)testImpressionIsSentAgainAfterWindow {
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    [NSThread sleepForTimeInterval:kWindow * 1.5];
+    XCTAssertFalse([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    [NSThread sleepForTimeInterval:kWindow * 2.5];
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+}
+
+// after an idle gap of several windows, nothing is remembered
+- (void)testImpressionIsSentAgainAfterIdleGap {
+    OPTLYTestImpressionDeduplicator *deduplicator = [[OPTLYTestImpressionDeduplicator alloc] initWithWindow:10 maxEntries:100];
+    XCTAssertTrue([deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    deduplicator.currentTime += 5;
+    XCTAssertFalse([deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    deduplicator.currentTime += 50;
+    XCTAssertTrue([deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+}
+
+// at most maxEntries impressions are remembered; the oldest are forgotten first
+- (void)testNumberOfImpressionsIsBounded {
+    OPTLYImpressionDeduplicator *deduplicator = [[OPTLYImpressionDeduplicator alloc] initWithWindow:60 maxEntries:10];
+    for (NSInteger i = 0; i < 20; i++) {
+        NSString *userId = [NSString stringWithFormat:@"user%ld", (long)i];
+        XCTAssertTrue([deduplicator shouldSendImpressionForUser:userId experimentId:kExperimentId variationId:kVariationId]);
+    }
+    XCTAssertTrue([deduplicator shouldSendImpressionForUser:@"user0" experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertFalse([deduplicator shouldSendImpressionForUser:@"user19" experimentId:kExperimentId variationId:kVariationId]);
+}
+
+- (void)testReset {
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    [self.deduplicator reset];
+    XCTAssertTrue([self.deduplicator shouldSendImpressionForUser:kUserId experimentId:kExperimentId variationId:kVariationId]);
+    XCTAssertEqual(self.deduplicator.numberOfSentImpressions, 2);
+}
+
+@end
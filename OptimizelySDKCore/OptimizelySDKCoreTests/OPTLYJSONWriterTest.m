@@ -0,0 +1,139 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <XCTest/XCTest.h>
+#import "OPTLYEventPayload.h"
+#import "OPTLYJSONWriter.h"
+
+@interface OPTLYJSONWriterTest : XCTestCase
+@end
+
+@implementation OPTLYJSONWriterTest
+
+- (void)testWriterOutputMatchesFoundation {
+    NSDictionary *object = @{ @"string" : @"value",
+                              @"escaped" : @"quote \" backslash \\ slash / newline \n tab \t control \x01",
+                              @"unicode" : @"café \U0001F600",
+                              @"integer" : @(106),
+                              @"negative" : @(-42),
+                              @"longLong" : @(LLONG_MAX),
+                              @"double" : @(68.1),
+                              @"largeDouble" : @(1e300),
+                              @"true" : @YES,
+                              @"false" : @NO,
+                              @"null" : [NSNull null],
+                              @"array" : @[ @1, @"two", @[], @{} ],
+                              @"nested" : @{ @"key" : @[ @{ @"deep" : @(3.5) } ] } };
+    
+    NSData *data = [OPTLYJSONWriter dataWithJSONObject:object error:nil];
+    XCTAssertNotNil(data);
+    id decoded = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    XCTAssertEqualObjects(decoded, object);
+    
+    NSData *foundationData = [NSJSONSerialization dataWithJSONObject:object options:0 error:nil];
+    id foundationDecoded = [NSJSONSerialization JSONObjectWithData:foundationData options:0 error:nil];
+    XCTAssertEqualObjects(decoded, foundationDecoded);
+}
+
+- (void)testWriterIsCompact {
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [writer beginObject];
+    [writer writeKey:@"a"];
+    [writer beginArray];
+    [writer writeLongLong:1];
+    [writer writeBool:YES];
+    [writer writeNull];
+    [writer endArray];
+    [writer writeKey:@"b"];
+    [writer writeString:@"c"];
+    [writer writeKey:@"d"];
+    [writer writeNumber:[NSDecimalNumber decimalNumberWithString:@"123.456"]];
+    [writer writeKey:@"e"];
+    [writer writeNumber:@(0.1 + 0.2)];
+    [writer endObject];
+    
+    NSString *json = [[NSString alloc] initWithData:[writer copyData] encoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects(json, @"{\"a\":[1,true,null],\"b\":\"c\",\"d\":123.456,\"e\":0.30000000000000004}");
+    XCTAssertEqual(writer.rootKeyCount, 4);
+}
+
+- (void)testWriterRejectsInvalidValues {
+    NSError *error = nil;
+    XCTAssertNil([OPTLYJSONWriter dataWithJSONObject:@{ @"nan" : @(NAN) } error:&error]);
+    XCTAssertNotNil(error);
+    XCTAssertNil([OPTLYJSONWriter dataWithJSONObject:@{ @"infinity" : @(INFINITY) } error:nil]);
+    XCTAssertNil([OPTLYJSONWriter dataWithJSONObject:@{ @"date" : [NSDate date] } error:nil]);
+    XCTAssertNil([OPTLYJSONWriter dataWithJSONObject:@{ @1 : @"non-string key" } error:nil]);
+}
+
+- (void)testWriterRejectsUnbalancedContainers {
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [writer beginObject];
+    [writer writeKey:@"a"];
+    XCTAssertNil([writer copyData]);
+    
+    [writer reset];
+    [writer beginArray];
+    [writer endObject];
+    XCTAssertTrue(writer.failed);
+    XCTAssertNil([writer copyData]);
+    
+    [writer reset];
+    [writer beginObject];
+    [writer writeString:@"value without a key"];
+    XCTAssertTrue(writer.failed);
+}
+
+- (void)testResetReusesWriter {
+    OPTLYJSONWriter *writer = [OPTLYJSONWriter threadLocalWriter];
+    [writer writeValue:@{ @"first" : @1 }];
+    XCTAssertNotNil([writer copyData]);
+    
+    writer = [OPTLYJSONWriter threadLocalWriter];
+    XCTAssertEqual(writer.buffer.length, 0);
+    XCTAssertEqual(writer.rootKeyCount, 0);
+    [writer writeValue:@[ @2 ]];
+    XCTAssertEqualObjects([[NSString alloc] initWithData:[writer copyData] encoding:NSUTF8StringEncoding], @"[2]");
+}
+
+- (void)testPayloadDecodesLazily {
+    NSDictionary *object = @{ @"visitors" : @[ @{ @"visitor_id" : @"user" } ], @"anonymize_ip" : @YES };
+    NSData *data = [OPTLYJSONWriter dataWithJSONObject:object error:nil];
+    OPTLYEventPayload *payload = [[OPTLYEventPayload alloc] initWithJSONData:data count:object.count];
+    
+    XCTAssertEqual(payload.count, 2);
+    XCTAssertEqualObjects(payload, object);
+    XCTAssertEqualObjects(object, payload);
+    XCTAssertEqualObjects(payload[@"visitors"][0][@"visitor_id"], @"user");
+    
+    // already encoded payloads are passed through as they are
+    XCTAssertEqual([OPTLYJSONWriter dataWithJSONObject:payload error:nil], payload.JSONData);
+    NSData *wrapped = [OPTLYJSONWriter dataWithJSONObject:@{ @"json" : payload } error:nil];
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:wrapped options:0 error:nil], @{ @"json" : object });
+}
+
+- (void)testPayloadFromStoredData {
+    NSData *compact = [OPTLYJSONWriter dataWithJSONObject:@{ @"key" : @"value" } error:nil];
+    OPTLYEventPayload *payload = [OPTLYEventPayload payloadWithStoredJSONData:compact];
+    XCTAssertNotNil(payload);
+    XCTAssertEqualObjects(payload, (@{ @"key" : @"value" }));
+    
+    NSData *prettyPrinted = [NSJSONSerialization dataWithJSONObject:@{ @"key" : @"value" } options:NSJSONWritingPrettyPrinted error:nil];
+    XCTAssertNil([OPTLYEventPayload payloadWithStoredJSONData:prettyPrinted]);
+    XCTAssertNil([OPTLYEventPayload payloadWithStoredJSONData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]]);
+}
+
+@end
@@ -15,6 +15,8 @@
  ***************************************************************************/
 
 #import <XCTest/XCTest.h>
+#import <OCMock/OCMock.h>
+#import "OPTLYLog.h"
 #import "OPTLYLogger.h"
 
 @interface OPTLYLoggerTest : XCTestCase
@@ -47,5 +49,25 @@
     }
 }
 
+// the logger can be replaced while other threads are logging
+- (void)testOPTLYLogWritesToItsLoggerWhileItIsReplaced
+{
+    id<OPTLYLogger> logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+    OPTLYLog.logger = logger;
+    XCTAssertEqual(OPTLYLog.logger, logger);
+    dispatch_apply(1000, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+        if (i % 100 == 0) {
+            OPTLYLog.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        }
+        optlyLog(@"OPTLYLogInfo", __FILE__, __LINE__, __PRETTY_FUNCTION__, @"message %zu", i);
+    });
+    
+    id loggerMock = OCMProtocolMock(@protocol(OPTLYLogger));
+    OPTLYLog.logger = loggerMock;
+    optlyLog(@"OPTLYLogError", __FILE__, __LINE__, __PRETTY_FUNCTION__, @"message");
+    OCMVerify([loggerMock logMessage:[OCMArg any] withLevel:OptimizelyLogLevelError]);
+    OPTLYLog.logger = nil;
+    XCTAssertNil(OPTLYLog.logger);
+}
 
 @end
@@ -0,0 +1,103 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+
+#import <XCTest/XCTest.h>
+#import "OPTLYMetrics.h"
+
+@interface OPTLYMetricsTest : XCTestCase
+@end
+
+@implementation OPTLYMetricsTest
+
+- (void)setUp {
+    [super setUp];
+    [OPTLYMetrics reset];
+    OPTLYMetrics.enabled = YES;
+}
+
+- (void)tearDown {
+    OPTLYMetrics.enabled = NO;
+    [OPTLYMetrics reset];
+    [super tearDown];
+}
+
+- (void)testNothingIsRecordedWhenDisabled {
+    OPTLYMetrics.enabled = NO;
+    [OPTLYMetrics incrementCounter:OPTLYMetricCounterFlushes by:1];
+    [OPTLYMetrics setGauge:OPTLYMetricGaugeSavedEvents value:5];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyTrack duration:0.01];
+    XCTAssertEqual([OPTLYMetrics startTime], 0);
+    XCTAssertEqual([OPTLYMetrics valueOfCounter:OPTLYMetricCounterFlushes], 0);
+    XCTAssertEqual([OPTLYMetrics valueOfGauge:OPTLYMetricGaugeSavedEvents], 0);
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyTrack], 0);
+}
+
+- (void)testCountersAndGauges {
+    [OPTLYMetrics incrementCounter:OPTLYMetricCounterEventsDispatched by:2];
+    [OPTLYMetrics incrementCounter:OPTLYMetricCounterEventsDispatched by:3];
+    [OPTLYMetrics setGauge:OPTLYMetricGaugeSavedEvents value:7];
+    [OPTLYMetrics setGauge:OPTLYMetricGaugeSavedEvents value:4];
+    XCTAssertEqual([OPTLYMetrics valueOfCounter:OPTLYMetricCounterEventsDispatched], 5);
+    XCTAssertEqual([OPTLYMetrics valueOfGauge:OPTLYMetricGaugeSavedEvents], 4);
+    
+    [OPTLYMetrics reset];
+    XCTAssertEqual([OPTLYMetrics valueOfCounter:OPTLYMetricCounterEventsDispatched], 0);
+    XCTAssertEqual([OPTLYMetrics valueOfGauge:OPTLYMetricGaugeSavedEvents], 0);
+}
+
+- (void)testLatenciesAreBucketed {
+    // 5 µs, 2 ms and 2 s
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyActivate duration:0.000005];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyActivate duration:0.002];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyActivate duration:2];
+    
+    NSDictionary *histogram = [OPTLYMetrics snapshot][OPTLYMetricsSnapshotLatenciesKey][[OPTLYMetrics nameOfLatency:OPTLYMetricLatencyActivate]];
+    XCTAssertEqualObjects(histogram[OPTLYMetricsSnapshotLatencyCountKey], @3);
+    XCTAssertEqualObjects(histogram[OPTLYMetricsSnapshotLatencyTotalKey], @(2002005));
+    NSArray *buckets = histogram[OPTLYMetricsSnapshotLatencyBucketsKey];
+    XCTAssertEqual(buckets.count, OPTLYMetricsLatencyBucketCount);
+    XCTAssertEqualObjects(buckets[0], @1);
+    XCTAssertEqualObjects(buckets[5], @1);
+    XCTAssertEqualObjects(buckets[OPTLYMetricsLatencyBucketCount - 1], @1);
+}
+
+- (void)testRecordLatencySinceStartTime {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    XCTAssertNotEqual(startTime, 0);
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyDecision since:startTime];
+    [OPTLYMetrics recordLatency:OPTLYMetricLatencyDecision since:0];
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyDecision], 1);
+}
+
+- (void)testSnapshotContainsEveryMetric {
+    NSDictionary *snapshot = [OPTLYMetrics snapshot];
+    XCTAssertEqual([snapshot[OPTLYMetricsSnapshotCountersKey] count], OPTLYMetricCounterCOUNT);
+    XCTAssertEqual([snapshot[OPTLYMetricsSnapshotGaugesKey] count], OPTLYMetricGaugeCOUNT);
+    XCTAssertEqual([snapshot[OPTLYMetricsSnapshotLatenciesKey] count], OPTLYMetricLatencyCOUNT);
+}
+
+- (void)testConcurrentUpdates {
+    dispatch_apply(1000, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+        [OPTLYMetrics incrementCounter:OPTLYMetricCounterFlushes by:1];
+        [OPTLYMetrics recordLatency:OPTLYMetricLatencyTrack duration:0.0001];
+    });
+    XCTAssertEqual([OPTLYMetrics valueOfCounter:OPTLYMetricCounterFlushes], 1000);
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyTrack], 1000);
+}
+
+@end
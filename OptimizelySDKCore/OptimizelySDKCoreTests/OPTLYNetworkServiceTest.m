@@ -19,6 +19,7 @@
 #import <OptimizelySDKShared/OPTLYDatafileConfig.h>
 #import "OPTLYNetworkService.h"
 #import "OPTLYTestHelper.h"
+#import "OPTLYTestHTTPServer.h"
 
 static NSString *const kDatafileVersion = @"3";
 
@@ -99,6 +100,64 @@ static NSDictionary *kCDNResponseHeaders = nil;
     [self waitForExpectationsWithTimeout:2 handler:nil];
 }
 
+// Tests the following against slow event and datafile servers:
+// 1. no more than maxConcurrentEventUploads events are uploaded at the same time, the rest are queued
+// 2. a datafile download doesn't wait behind the queued events
+- (void)testEventUploadsAreBoundedAndDatafileHasSeparateLane {
+    __block NSInteger concurrentUploads = 0;
+    __block NSInteger maxConcurrentUploads = 0;
+    NSObject *lockObject = [NSObject new];
+    OPTLYTestHTTPServer *eventServer = [OPTLYTestHTTPServer new];
+    eventServer.requestHandler = ^(OPTLYTestHTTPRequest *request) {
+        @synchronized (lockObject) {
+            concurrentUploads++;
+            maxConcurrentUploads = MAX(maxConcurrentUploads, concurrentUploads);
+        }
+        [NSThread sleepForTimeInterval:0.3];
+        @synchronized (lockObject) {
+            concurrentUploads--;
+        }
+    };
+    OPTLYTestHTTPServer *datafileServer = [OPTLYTestHTTPServer new];
+    XCTAssertTrue([eventServer start]);
+    XCTAssertTrue([datafileServer start]);
+    
+    NSInteger numberOfEvents = 6;
+    self.network.maxConcurrentEventUploads = 2;
+    XCTestExpectation *eventsExpectation = [self expectationWithDescription:@"Wait for events."];
+    eventsExpectation.expectedFulfillmentCount = numberOfEvents;
+    for (NSInteger i = 0; i < numberOfEvents; i++) {
+        [self.network dispatchEvent:@{ @"event" : @(i) }
+                       backoffRetry:NO
+                              toURL:eventServer.URL
+                  completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                      XCTAssertNil(error);
+                      [eventsExpectation fulfill];
+                  }];
+    }
+    
+    __block NSUInteger eventsQueuedAtDownload = 0;
+    XCTestExpectation *datafileExpectation = [self expectationWithDescription:@"Wait for datafile."];
+    [self.network downloadProjectConfig:datafileServer.URL
+                           backoffRetry:NO
+                      completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                          XCTAssertNil(error);
+                          eventsQueuedAtDownload = self.network.eventUploadsQueued;
+                          [datafileExpectation fulfill];
+                      }];
+    [self waitForExpectations:@[datafileExpectation] timeout:2];
+    XCTAssertGreaterThan(eventsQueuedAtDownload, 0);
+    XCTAssertEqual(self.network.eventUploadsInFlight, 2);
+    
+    [self waitForExpectations:@[eventsExpectation] timeout:5];
+    [eventServer stop];
+    [datafileServer stop];
+    XCTAssertEqual(maxConcurrentUploads, 2);
+    XCTAssertEqual((NSInteger)eventServer.requests.count, numberOfEvents);
+    XCTAssertEqual(self.network.eventUploadsQueued, 0);
+    XCTAssertEqual(self.network.datafileDownloadsInFlight, 0);
+}
+
 # pragma mark - Helper Methods
 - (id<OHHTTPStubsDescriptor>)stub200Response {
     NSString *filePath = [OPTLYDatafileConfig defaultProjectIdCdnPath:kProjectId];
@@ -23,6 +23,7 @@
 #import "OPTLYEvent.h"
 #import "OPTLYExperiment.h"
 #import "OPTLYGroup.h"
+#import "OPTLYLazyEntityMap.h"
 #import "OPTLYLogger.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYUserProfileServiceBasic.h"
@@ -189,6 +190,130 @@ static NSString * const kUnsupportedVersionDatafileName = @"UnsupportedVersionDa
     XCTAssertNil(projectConfig.botFiltering, @"Shouldn't find Bot Filtering node in datafile");
 }
 
+#pragma mark - Test lazyDatafileParsing
+
+- (void)testLazyDatafileParsingMatchesEagerParsing
+{
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDataModelDatafileName];
+    OPTLYProjectConfig *projectConfig = [[OPTLYProjectConfig alloc] initWithBuilder:[OPTLYProjectConfigBuilder builderWithBlock:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.lazyDatafileParsing = YES;
+    }]];
+    XCTAssertNotNil(projectConfig, @"project config should not be nil.");
+    
+    OPTLYExperiment *experiment = [projectConfig getExperimentForKey:@"testExperiment31"];
+    XCTAssertEqualObjects(experiment.experimentId, [self.projectConfig getExperimentForKey:@"testExperiment31"].experimentId);
+    XCTAssertEqualObjects([projectConfig getExperimentIdForKey:@"testExperiment31"], @"6313973431");
+    XCTAssertEqualObjects([projectConfig getAudienceForId:@"6373742627"].audienceId, @"6373742627");
+    XCTAssertEqualObjects([projectConfig getEventForKey:@"testEvent"].eventKey, [self.projectConfig getEventForKey:@"testEvent"].eventKey);
+    XCTAssertNil([projectConfig getExperimentForId:@"66666666666"]);
+    
+    // group experiments are shared with their group
+    OPTLYGroup *group = [projectConfig getGroupForGroupId:@"6455220163"];
+    OPTLYExperiment *groupExperiment = [group.experiments firstObject];
+    XCTAssertEqual([projectConfig getExperimentForId:groupExperiment.experimentId], groupExperiment);
+    
+    // materializing the full sections gives the same counts as eager parsing
+    [self checkProjectConfigProperties:projectConfig];
+}
+
+- (void)testLazyDatafileParsingMaterializesEntitiesOnce
+{
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDataModelDatafileName];
+    OPTLYProjectConfig *projectConfig = [[OPTLYProjectConfig alloc] initWithBuilder:[OPTLYProjectConfigBuilder builderWithBlock:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.lazyDatafileParsing = YES;
+    }]];
+    OPTLYLazyEntityMap *lazyExperiments = [projectConfig valueForKey:@"lazyExperiments"];
+    XCTAssertEqual([lazyExperiments materializedCount], 0);
+    
+    NSMutableArray *experiments = [NSMutableArray new];
+    dispatch_apply(50, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t iteration) {
+        OPTLYExperiment *experiment = [projectConfig getExperimentForKey:@"testExperiment31"];
+        @synchronized (experiments) {
+            [experiments addObject:experiment];
+        }
+    });
+    XCTAssertEqual([lazyExperiments materializedCount], 1);
+    for (OPTLYExperiment *experiment in experiments) {
+        XCTAssertEqual(experiment, experiments.firstObject, @"every caller should get the same materialized experiment");
+    }
+}
+
+- (void)testLazyDatafileParsingReportsInvalidExperimentOnce
+{
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDataModelDatafileName];
+    NSMutableDictionary *datafileDictionary = [[NSJSONSerialization JSONObjectWithData:datafile options:NSJSONReadingMutableContainers error:nil] mutableCopy];
+    for (NSMutableDictionary *experiment in datafileDictionary[@"experiments"]) {
+        if ([experiment[@"key"] isEqualToString:@"testExperiment31"]) {
+            [experiment removeObjectForKey:@"variations"];
+            [experiment removeObjectForKey:@"trafficAllocation"];
+        }
+    }
+    NSData *invalidDatafile = [NSJSONSerialization dataWithJSONObject:datafileDictionary options:0 error:nil];
+    
+    __block NSInteger numberOfErrors = 0;
+    id<OPTLYErrorHandler> errorHandler = OCMProtocolMock(@protocol(OPTLYErrorHandler));
+    OCMStub([errorHandler handleError:[OCMArg any]]).andDo(^(NSInvocation *invocation) {
+        numberOfErrors++;
+    });
+    id<OPTLYLogger> logger = OCMProtocolMock(@protocol(OPTLYLogger));
+    OPTLYProjectConfig *projectConfig = [[OPTLYProjectConfig alloc] initWithBuilder:[OPTLYProjectConfigBuilder builderWithBlock:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = invalidDatafile;
+        builder.lazyDatafileParsing = YES;
+        builder.errorHandler = errorHandler;
+        builder.logger = logger;
+    }]];
+    XCTAssertNotNil(projectConfig, @"the invalid experiment is only found on first access");
+    XCTAssertEqual(numberOfErrors, 0);
+    
+    XCTAssertNil([projectConfig getExperimentForKey:@"testExperiment31"]);
+    XCTAssertEqual(numberOfErrors, 1);
+    OCMVerify([logger logMessage:[OCMArg checkWithBlock:^BOOL(NSString *logMessage) {
+        return [logMessage containsString:@"6313973431"];
+    }] withLevel:OptimizelyLogLevelError]);
+    
+    // the entry is reported once, then looked up as a missing experiment
+    XCTAssertNil([projectConfig getExperimentForId:@"6313973431"]);
+    XCTAssertEqual(numberOfErrors, 1);
+    XCTAssertNotNil([projectConfig getExperimentForKey:@"testExperiment15"]);
+    XCTAssertEqual(numberOfErrors, 1);
+}
+
+// listing all experiments reports the invalid one without holding the lock of the lazy map
+- (void)testLazyDatafileParsingReportsInvalidExperimentOutsideOfLock
+{
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDataModelDatafileName];
+    NSMutableDictionary *datafileDictionary = [[NSJSONSerialization JSONObjectWithData:datafile options:NSJSONReadingMutableContainers error:nil] mutableCopy];
+    for (NSMutableDictionary *experiment in datafileDictionary[@"experiments"]) {
+        if ([experiment[@"key"] isEqualToString:@"testExperiment31"]) {
+            [experiment removeObjectForKey:@"variations"];
+        }
+    }
+    NSData *invalidDatafile = [NSJSONSerialization dataWithJSONObject:datafileDictionary options:0 error:nil];
+    
+    __block OPTLYProjectConfig *projectConfig = nil;
+    __block OPTLYExperiment *experimentFoundByErrorHandler = nil;
+    id<OPTLYErrorHandler> errorHandler = OCMProtocolMock(@protocol(OPTLYErrorHandler));
+    OCMStub([errorHandler handleError:[OCMArg any]]).andDo(^(NSInvocation *invocation) {
+        // waits on another thread that uses the same map
+        dispatch_sync(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            experimentFoundByErrorHandler = [projectConfig getExperimentForKey:@"testExperiment15"];
+        });
+    });
+    projectConfig = [[OPTLYProjectConfig alloc] initWithBuilder:[OPTLYProjectConfigBuilder builderWithBlock:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = invalidDatafile;
+        builder.lazyDatafileParsing = YES;
+        builder.errorHandler = errorHandler;
+    }]];
+    
+    NSArray *experiments = projectConfig.experiments;
+    XCTAssertNotNil(experimentFoundByErrorHandler);
+    XCTAssertGreaterThan(experiments.count, 0);
+    XCTAssertFalse([[experiments valueForKey:@"experimentId"] containsObject:@"6313973431"]);
+    XCTAssertEqual(projectConfig.experiments, experiments);
+}
+
 #pragma mark - Test getExperimentForKey:
 
 - (void)testGetExperimentForKey
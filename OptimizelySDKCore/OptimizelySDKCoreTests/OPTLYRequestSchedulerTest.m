@@ -0,0 +1,177 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <XCTest/XCTest.h>
+#import "OPTLYRequestScheduler.h"
+
+static const NSUInteger kMaxConcurrentRequests = 2;
+
+@interface OPTLYRequestSchedulerTest : XCTestCase
+@property (nonatomic, strong) OPTLYRequestScheduler *scheduler;
+/// done blocks of the requests that have started, in start order
+@property (nonatomic, strong) NSMutableArray<dispatch_block_t> *startedRequests;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *startOrder;
+@end
+
+@implementation OPTLYRequestSchedulerTest
+
+- (void)setUp {
+    [super setUp];
+    self.scheduler = [[OPTLYRequestScheduler alloc] initWithName:@"test" maxConcurrentRequests:kMaxConcurrentRequests];
+    self.startedRequests = [NSMutableArray new];
+    self.startOrder = [NSMutableArray new];
+}
+
+- (void)tearDown {
+    self.scheduler = nil;
+    self.startedRequests = nil;
+    self.startOrder = nil;
+    [super tearDown];
+}
+
+- (void)testInitClampsMaxConcurrentRequests {
+    OPTLYRequestScheduler *scheduler = [[OPTLYRequestScheduler alloc] initWithName:@"test" maxConcurrentRequests:0];
+    XCTAssertEqual(scheduler.maxConcurrentRequests, 1);
+    XCTAssertEqualObjects(scheduler.name, @"test");
+}
+
+- (void)testRequestsAreBoundedAndQueued {
+    for (NSInteger i = 0; i < 5; i++) {
+        [self scheduleRequest:i priority:OPTLYRequestPriorityDefault];
+    }
+    [self waitForStartedCount:kMaxConcurrentRequests];
+    XCTAssertEqual(self.scheduler.inFlightCount, kMaxConcurrentRequests);
+    XCTAssertEqual(self.scheduler.queuedCount, 3);
+    
+    // each completed request lets the next one start
+    [self finishRequestAtIndex:0];
+    [self waitForStartedCount:kMaxConcurrentRequests + 1];
+    XCTAssertEqual(self.scheduler.queuedCount, 2);
+    
+    [self finishRequestAtIndex:1];
+    [self finishRequestAtIndex:2];
+    [self waitForStartedCount:5];
+    for (NSUInteger i = 3; i < 5; i++) {
+        [self finishRequestAtIndex:i];
+    }
+    [self waitForInFlightCount:0];
+    XCTAssertEqual(self.scheduler.queuedCount, 0);
+    XCTAssertEqualObjects([self sortedStartOrderInRange:NSMakeRange(0, 2)], (@[@0, @1]));
+    XCTAssertEqualObjects(self.startOrder[2], @2);
+    XCTAssertEqualObjects([self sortedStartOrderInRange:NSMakeRange(3, 2)], (@[@3, @4]));
+}
+
+- (void)testHigherPriorityStartsFirst {
+    // fill the slots so everything after is queued
+    [self scheduleRequest:0 priority:OPTLYRequestPriorityDefault];
+    [self scheduleRequest:1 priority:OPTLYRequestPriorityDefault];
+    [self waitForStartedCount:kMaxConcurrentRequests];
+    
+    [self scheduleRequest:2 priority:OPTLYRequestPriorityLow];
+    [self scheduleRequest:3 priority:OPTLYRequestPriorityDefault];
+    [self scheduleRequest:4 priority:OPTLYRequestPriorityHigh];
+    [self scheduleRequest:5 priority:OPTLYRequestPriorityHigh];
+    [self waitForQueuedCount:4];
+    
+    self.scheduler.maxConcurrentRequests = 1;
+    [self finishRequestAtIndex:0];
+    [self finishRequestAtIndex:1];
+    for (NSUInteger i = kMaxConcurrentRequests; i < 6; i++) {
+        [self waitForStartedCount:i + 1];
+        [self finishRequestAtIndex:i];
+    }
+    XCTAssertEqualObjects([self.startOrder subarrayWithRange:NSMakeRange(kMaxConcurrentRequests, 4)], (@[@4, @5, @3, @2]));
+}
+
+- (void)testRaisingLimitStartsQueuedRequests {
+    for (NSInteger i = 0; i < 4; i++) {
+        [self scheduleRequest:i priority:OPTLYRequestPriorityDefault];
+    }
+    [self waitForStartedCount:kMaxConcurrentRequests];
+    self.scheduler.maxConcurrentRequests = 4;
+    [self waitForStartedCount:4];
+    XCTAssertEqual(self.scheduler.queuedCount, 0);
+}
+
+- (void)testDoneIsIdempotent {
+    [self scheduleRequest:0 priority:OPTLYRequestPriorityDefault];
+    [self waitForStartedCount:1];
+    [self finishRequestAtIndex:0];
+    [self finishRequestAtIndex:0];
+    [self waitForInFlightCount:0];
+    
+    for (NSInteger i = 1; i < 4; i++) {
+        [self scheduleRequest:i priority:OPTLYRequestPriorityDefault];
+    }
+    [self waitForStartedCount:1 + kMaxConcurrentRequests];
+    XCTAssertEqual(self.scheduler.inFlightCount, kMaxConcurrentRequests);
+}
+
+#pragma mark - Helper Methods
+
+- (void)scheduleRequest:(NSInteger)requestNumber priority:(OPTLYRequestPriority)priority {
+    [self.scheduler scheduleRequest:^(dispatch_block_t done) {
+        @synchronized (self) {
+            [self.startedRequests addObject:done];
+            [self.startOrder addObject:@(requestNumber)];
+        }
+    } priority:priority];
+}
+
+- (void)finishRequestAtIndex:(NSUInteger)index {
+    dispatch_block_t done = nil;
+    @synchronized (self) {
+        done = self.startedRequests[index];
+    }
+    done();
+}
+
+// requests that start together run on different threads, so their relative order is not fixed
+- (NSArray *)sortedStartOrderInRange:(NSRange)range {
+    @synchronized (self) {
+        return [[self.startOrder subarrayWithRange:range] sortedArrayUsingSelector:@selector(compare:)];
+    }
+}
+
+- (void)waitForStartedCount:(NSUInteger)count {
+    [self waitForCondition:^BOOL{
+        @synchronized (self) {
+            return self.startedRequests.count == count;
+        }
+    }];
+}
+
+- (void)waitForQueuedCount:(NSUInteger)count {
+    [self waitForCondition:^BOOL{
+        return self.scheduler.queuedCount == count;
+    }];
+}
+
+- (void)waitForInFlightCount:(NSUInteger)count {
+    [self waitForCondition:^BOOL{
+        return self.scheduler.inFlightCount == count;
+    }];
+}
+
+- (void)waitForCondition:(BOOL (^)(void))condition {
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:2];
+    while (!condition() && [timeout timeIntervalSinceNow] > 0) {
+        [NSThread sleepForTimeInterval:0.01];
+    }
+    XCTAssertTrue(condition());
+}
+
+@end
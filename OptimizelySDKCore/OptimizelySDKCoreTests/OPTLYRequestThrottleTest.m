@@ -0,0 +1,135 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <XCTest/XCTest.h>
+#import "OPTLYRequestThrottle.h"
+
+static const NSUInteger kFailureThreshold = 3;
+static const NSTimeInterval kOpenInterval = 0.2;
+
+@interface OPTLYRequestThrottleTest : XCTestCase
+@property (nonatomic, strong) OPTLYRequestThrottle *throttle;
+@end
+
+@implementation OPTLYRequestThrottleTest
+
+- (void)setUp {
+    [super setUp];
+    self.throttle = [[OPTLYRequestThrottle alloc] initWithMaxRetryTokens:2
+                                                        failureThreshold:kFailureThreshold
+                                                            openInterval:kOpenInterval];
+}
+
+- (void)tearDown {
+    self.throttle = nil;
+    [super tearDown];
+}
+
+- (void)testDefaultInit {
+    OPTLYRequestThrottle *throttle = [OPTLYRequestThrottle new];
+    XCTAssertEqual(throttle.maxRetryTokens, OPTLYRequestThrottleDefaultMaxRetryTokens);
+    XCTAssertEqual(throttle.retryTokens, OPTLYRequestThrottleDefaultMaxRetryTokens);
+    XCTAssertEqual(throttle.failureThreshold, OPTLYRequestThrottleDefaultFailureThreshold);
+    XCTAssertEqual(throttle.openInterval, OPTLYRequestThrottleDefaultOpenInterval);
+    XCTAssertEqual(throttle.circuitState, OPTLYCircuitStateClosed);
+}
+
+// each success refunds a fraction of a token, up to the budget size
+- (void)testRetryBudget {
+    XCTAssertTrue([self.throttle acquireRetryToken]);
+    XCTAssertTrue([self.throttle acquireRetryToken]);
+    XCTAssertFalse([self.throttle acquireRetryToken]);
+    
+    for (NSInteger i = 0; i < 4; i++) {
+        [self.throttle recordSuccess];
+    }
+    XCTAssertFalse([self.throttle acquireRetryToken]);
+    [self.throttle recordSuccess];
+    XCTAssertTrue([self.throttle acquireRetryToken]);
+    
+    for (NSInteger i = 0; i < 100; i++) {
+        [self.throttle recordSuccess];
+    }
+    XCTAssertEqual(self.throttle.retryTokens, 2);
+}
+
+- (void)testCircuitOpensAfterConsecutiveFailures {
+    for (NSUInteger i = 0; i < kFailureThreshold - 1; i++) {
+        XCTAssertTrue([self.throttle beginRequest]);
+        [self.throttle recordFailure];
+    }
+    // a success resets the count
+    [self.throttle recordSuccess];
+    for (NSUInteger i = 0; i < kFailureThreshold - 1; i++) {
+        [self.throttle recordFailure];
+    }
+    XCTAssertEqual(self.throttle.circuitState, OPTLYCircuitStateClosed);
+    
+    [self.throttle recordFailure];
+    XCTAssertEqual(self.throttle.circuitState, OPTLYCircuitStateOpen);
+    XCTAssertFalse([self.throttle beginRequest]);
+}
+
+- (void)testHalfOpenAllowsSingleProbe {
+    [self openCircuit];
+    [NSThread sleepForTimeInterval:kOpenInterval + 0.05];
+    
+    XCTAssertTrue([self.throttle beginRequest]);
+    XCTAssertEqual(self.throttle.circuitState, OPTLYCircuitStateHalfOpen);
+    XCTAssertFalse([self.throttle beginRequest]);
+    
+    [self.throttle recordSuccess];
+    XCTAssertEqual(self.throttle.circuitState, OPTLYCircuitStateClosed);
+    XCTAssertTrue([self.throttle beginRequest]);
+}
+
+- (void)testFailedProbeReopensCircuit {
+    [self openCircuit];
+    [NSThread sleepForTimeInterval:kOpenInterval + 0.05];
+    
+    XCTAssertTrue([self.throttle beginRequest]);
+    [self.throttle recordFailure];
+    XCTAssertEqual(self.throttle.circuitState, OPTLYCircuitStateOpen);
+    XCTAssertFalse([self.throttle beginRequest]);
+}
+
+- (void)testConcurrentProbes {
+    [self openCircuit];
+    [NSThread sleepForTimeInterval:kOpenInterval + 0.05];
+    
+    __block NSUInteger allowed = 0;
+    NSObject *lockObject = [NSObject new];
+    dispatch_apply(50, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+        if ([self.throttle beginRequest]) {
+            @synchronized (lockObject) {
+                allowed++;
+            }
+        }
+    });
+    XCTAssertEqual(allowed, 1);
+}
+
+#pragma mark - Helper Methods
+
+- (void)openCircuit {
+    for (NSUInteger i = 0; i < kFailureThreshold; i++) {
+        [self.throttle beginRequest];
+        [self.throttle recordFailure];
+    }
+    XCTAssertEqual(self.throttle.circuitState, OPTLYCircuitStateOpen);
+}
+
+@end
@@ -0,0 +1,125 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <XCTest/XCTest.h>
+#import "OPTLYMetrics.h"
+#import "OPTLYProjectConfig.h"
+#import "OPTLYStartupReport.h"
+#import "OPTLYTestHelper.h"
+
+static NSString * const kDatafileName = @"optimizely_6372300739_v4";
+
+@interface OPTLYStartupReportTest : XCTestCase
+@end
+
+@implementation OPTLYStartupReportTest
+
+- (void)setUp {
+    [super setUp];
+    [OPTLYStartupReport reset];
+}
+
+- (void)tearDown {
+    [OPTLYStartupReport reset];
+    [super tearDown];
+}
+
+- (void)testRecordPhase {
+    uint64_t startTime = [OPTLYStartupReport startTime];
+    [NSThread sleepForTimeInterval:0.01];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileRead since:startTime];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileRead since:[OPTLYStartupReport startTime]];
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileRead], 2);
+    XCTAssertGreaterThanOrEqual([OPTLYStartupReport durationOfPhase:OPTLYStartupPhaseDatafileRead], 0.01);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseTimerSetup], 0);
+    
+    [OPTLYStartupReport reset];
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileRead], 0);
+    XCTAssertEqual([OPTLYStartupReport durationOfPhase:OPTLYStartupPhaseDatafileRead], 0);
+    XCTAssertEqual([OPTLYStartupReport report].count, 0);
+}
+
+- (void)testReportIsKeyedByPhaseNameAndOrderedByOffset {
+    uint64_t managerStartTime = [OPTLYStartupReport startTime];
+    [NSThread sleepForTimeInterval:0.005];
+    uint64_t readStartTime = [OPTLYStartupReport startTime];
+    [NSThread sleepForTimeInterval:0.005];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileRead since:readStartTime];
+    // the outer phase is recorded last but started first
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseManagerInitialization since:managerStartTime];
+    
+    NSDictionary *report = [OPTLYStartupReport report];
+    XCTAssertEqual(report.count, 2);
+    NSDictionary *manager = report[[OPTLYStartupReport nameOfPhase:OPTLYStartupPhaseManagerInitialization]];
+    NSDictionary *read = report[@"datafile_read"];
+    XCTAssertEqualObjects(manager[OPTLYStartupReportCountKey], @1);
+    XCTAssertEqualObjects(manager[OPTLYStartupReportOffsetKey], @0);
+    XCTAssertGreaterThanOrEqual([read[OPTLYStartupReportOffsetKey] longLongValue], 5000);
+    XCTAssertGreaterThanOrEqual([manager[OPTLYStartupReportTotalKey] longLongValue], [read[OPTLYStartupReportTotalKey] longLongValue]);
+}
+
+- (void)testParsingADatafileRecordsItsPhases {
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDatafileName];
+    OPTLYProjectConfig *projectConfig = [[OPTLYProjectConfig alloc] initWithBuilder:[OPTLYProjectConfigBuilder builderWithBlock:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+    }]];
+    XCTAssertNotNil(projectConfig);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileJSONParse], 1);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseModelMaterialization], 1);
+    
+    // the indexes are built when first used
+    [projectConfig getExperimentForKey:@"testExperiment31"];
+    XCTAssertGreaterThan([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseIndexConstruction], 0);
+}
+
+- (void)testParsingADatafileLazilyRecordsItsPhases {
+    NSData *datafile = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDatafileName];
+    OPTLYProjectConfig *projectConfig = [[OPTLYProjectConfig alloc] initWithBuilder:[OPTLYProjectConfigBuilder builderWithBlock:^(OPTLYProjectConfigBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.lazyDatafileParsing = YES;
+    }]];
+    XCTAssertNotNil(projectConfig);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileJSONParse], 1);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseModelMaterialization], 1);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseIndexConstruction], 1);
+}
+
+- (void)testSealedReportIgnoresLaterPhases {
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileRead since:[OPTLYStartupReport startTime]];
+    XCTAssertFalse([OPTLYStartupReport isSealed]);
+    XCTAssertTrue([OPTLYStartupReport seal]);
+    XCTAssertFalse([OPTLYStartupReport seal]);
+    XCTAssertTrue([OPTLYStartupReport isSealed]);
+    NSDictionary *report = [OPTLYStartupReport report];
+    
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileRead since:[OPTLYStartupReport startTime]];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseTimerSetup since:[OPTLYStartupReport startTime]];
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileRead], 1);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseTimerSetup], 0);
+    XCTAssertEqualObjects([OPTLYStartupReport report], report);
+    
+    [OPTLYStartupReport reset];
+    XCTAssertFalse([OPTLYStartupReport isSealed]);
+}
+
+- (void)testMetricsSnapshotIncludesTheReport {
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseTimerSetup since:[OPTLYStartupReport startTime]];
+    NSDictionary *startup = [OPTLYMetrics snapshot][OPTLYMetricsSnapshotStartupKey];
+    XCTAssertEqualObjects(startup[@"timer_setup"][OPTLYStartupReportCountKey], @1);
+}
+
+@end
@@ -0,0 +1,68 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <Foundation/Foundation.h>
+
+/*
+ A minimal HTTP/1.1 server on 127.0.0.1 for tests that need to inspect what actually
+ goes over the wire (headers and raw body), which URL protocol stubs can't see for upload tasks.
+ Every connection serves a single request and is then closed.
+ For load tests it can also stand in for a slow or failing backend: responses can be delayed,
+ a fraction of them can fail, and during an outage connections are dropped without a response.
+ */
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface OPTLYTestHTTPRequest : NSObject
+@property (nonatomic, strong, readonly) NSString *method;
+@property (nonatomic, strong, readonly) NSString *path;
+/// header names are lowercased
+@property (nonatomic, strong, readonly) NSDictionary<NSString *, NSString *> *headers;
+/// the body as received
+@property (nonatomic, strong, readonly) NSData *body;
+/// the body after undoing a gzip Content-Encoding, or nil if it can not be decompressed
+@property (nonatomic, strong, readonly, nullable) NSData *decodedBody;
+/// the status code the server answers with, or 0 if the connection is dropped
+@property (nonatomic, assign, readonly) NSInteger responseStatusCode;
+@end
+
+@interface OPTLYTestHTTPServer : NSObject
+
+/// The base URL of the server, available after start.
+@property (nonatomic, strong, readonly, nullable) NSURL *URL;
+/// The status code of every response. Defaults to 200.
+@property (atomic, assign) NSInteger responseStatusCode;
+/// Delay (in s) before every response. Defaults to 0.
+@property (atomic, assign) NSTimeInterval responseLatency;
+/// Fraction (from 0 to 1) of the requests answered with 503 instead of responseStatusCode. Defaults to 0.
+@property (atomic, assign) double errorRate;
+/// While YES, requests are read and then the connection is closed without a response. Defaults to NO.
+@property (atomic, assign, getter=isUnavailable) BOOL unavailable;
+/// Called on a server queue for every request received.
+@property (atomic, copy, nullable) void (^requestHandler)(OPTLYTestHTTPRequest *request);
+/// All requests received so far.
+@property (atomic, strong, readonly) NSArray<OPTLYTestHTTPRequest *> *requests;
+
+/// Starts listening on a free port. Returns NO if the socket can not be opened.
+- (BOOL)start;
+- (void)stop;
+
+/// Inflates gzip or zlib data.
++ (nullable NSData *)inflateData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
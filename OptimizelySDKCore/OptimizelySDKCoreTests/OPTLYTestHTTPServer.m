@@ -0,0 +1,232 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+#import "OPTLYTestHTTPServer.h"
+
+static NSUInteger const kMaxHeaderLength = 64 * 1024;
+static NSInteger const kErrorStatusCode = 503;
+
+@interface OPTLYTestHTTPRequest()
+@property (nonatomic, strong, readwrite) NSString *method;
+@property (nonatomic, strong, readwrite) NSString *path;
+@property (nonatomic, strong, readwrite) NSDictionary<NSString *, NSString *> *headers;
+@property (nonatomic, strong, readwrite) NSData *body;
+@property (nonatomic, assign, readwrite) NSInteger responseStatusCode;
+@end
+
+@implementation OPTLYTestHTTPRequest
+
+- (NSData *)decodedBody {
+    if ([[self.headers[@"content-encoding"] lowercaseString] isEqualToString:@"gzip"]) {
+        return [OPTLYTestHTTPServer inflateData:self.body];
+    }
+    return self.body;
+}
+
+@end
+
+@interface OPTLYTestHTTPServer() {
+    int _listenSocket;
+    NSMutableArray<OPTLYTestHTTPRequest *> *_requests;
+}
+@property (nonatomic, strong, readwrite) NSURL *URL;
+@property (nonatomic, strong) dispatch_queue_t connectionQueue;
+@end
+
+@implementation OPTLYTestHTTPServer
+
+- (instancetype)init {
+    self = [super init];
+    if (self != nil) {
+        _listenSocket = -1;
+        _requests = [NSMutableArray new];
+        _responseStatusCode = 200;
+        _connectionQueue = dispatch_queue_create("com.Optimizely.testHTTPServer.connections", DISPATCH_QUEUE_CONCURRENT);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self stop];
+}
+
+- (NSArray<OPTLYTestHTTPRequest *> *)requests {
+    @synchronized (self) {
+        return [_requests copy];
+    }
+}
+
+- (BOOL)start {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return NO;
+    }
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0
+        || listen(listenSocket, 64) != 0
+        || getsockname(listenSocket, (struct sockaddr *)&address, &length) != 0) {
+        close(listenSocket);
+        return NO;
+    }
+    
+    _listenSocket = listenSocket;
+    self.URL = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%d", ntohs(address.sin_port)]];
+    
+    dispatch_queue_t connectionQueue = self.connectionQueue;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        while (YES) {
+            int connection = accept(listenSocket, NULL, NULL);
+            if (connection < 0) {
+                // the listening socket was closed by stop
+                return;
+            }
+            int noSigPipe = 1;
+            setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+            dispatch_async(connectionQueue, ^{
+                [weakSelf serveConnection:connection];
+                close(connection);
+            });
+        }
+    });
+    return YES;
+}
+
+- (void)stop {
+    if (_listenSocket >= 0) {
+        shutdown(_listenSocket, SHUT_RDWR);
+        close(_listenSocket);
+        _listenSocket = -1;
+    }
+}
+
++ (NSData *)inflateData:(NSData *)data {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 32 enables automatic gzip/zlib header detection
+    if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
+        return nil;
+    }
+    NSMutableData *inflated = [NSMutableData dataWithLength:MAX(data.length * 4, 1024)];
+    stream.next_in = (Bytef *)data.bytes;
+    stream.avail_in = (uInt)data.length;
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out >= inflated.length) {
+            inflated.length *= 2;
+        }
+        stream.next_out = (Bytef *)inflated.mutableBytes + stream.total_out;
+        stream.avail_out = (uInt)(inflated.length - stream.total_out);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+    inflated.length = stream.total_out;
+    return inflated;
+}
+
+# pragma mark - Helper Methods
+
+- (void)serveConnection:(int)connection {
+    NSMutableData *received = [NSMutableData new];
+    NSData *separator = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    NSRange headerEnd = NSMakeRange(NSNotFound, 0);
+    uint8_t buffer[4096];
+    
+    while (headerEnd.location == NSNotFound) {
+        ssize_t count = recv(connection, buffer, sizeof(buffer), 0);
+        if (count <= 0 || received.length > kMaxHeaderLength) {
+            return;
+        }
+        [received appendBytes:buffer length:count];
+        headerEnd = [received rangeOfData:separator options:0 range:NSMakeRange(0, received.length)];
+    }
+    
+    NSString *head = [[NSString alloc] initWithData:[received subdataWithRange:NSMakeRange(0, headerEnd.location)]
+                                           encoding:NSUTF8StringEncoding];
+    NSArray<NSString *> *lines = [head componentsSeparatedByString:@"\r\n"];
+    NSArray<NSString *> *requestLine = [lines.firstObject componentsSeparatedByString:@" "];
+    NSMutableDictionary *headers = [NSMutableDictionary new];
+    for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, lines.count - 1)]) {
+        NSRange colon = [line rangeOfString:@":"];
+        if (colon.location != NSNotFound) {
+            NSString *name = [[line substringToIndex:colon.location] lowercaseString];
+            headers[name] = [[line substringFromIndex:colon.location + 1] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        }
+    }
+    
+    NSUInteger bodyStart = NSMaxRange(headerEnd);
+    NSUInteger contentLength = (NSUInteger)[headers[@"content-length"] integerValue];
+    while (received.length < bodyStart + contentLength) {
+        ssize_t count = recv(connection, buffer, sizeof(buffer), 0);
+        if (count <= 0) {
+            return;
+        }
+        [received appendBytes:buffer length:count];
+    }
+    
+    OPTLYTestHTTPRequest *request = [OPTLYTestHTTPRequest new];
+    request.method = requestLine.count > 0 ? requestLine[0] : @"";
+    request.path = requestLine.count > 1 ? requestLine[1] : @"";
+    request.headers = [headers copy];
+    request.body = [received subdataWithRange:NSMakeRange(bodyStart, contentLength)];
+    if (self.isUnavailable) {
+        request.responseStatusCode = 0;
+    } else if (self.errorRate > 0 && arc4random_uniform(10000) < self.errorRate * 10000) {
+        request.responseStatusCode = kErrorStatusCode;
+    } else {
+        request.responseStatusCode = self.responseStatusCode;
+    }
+    @synchronized (self) {
+        [_requests addObject:request];
+    }
+    
+    void (^requestHandler)(OPTLYTestHTTPRequest *) = self.requestHandler;
+    if (requestHandler) {
+        requestHandler(request);
+    }
+    
+    if (request.responseStatusCode == 0) {
+        return;
+    }
+    NSTimeInterval responseLatency = self.responseLatency;
+    if (responseLatency > 0) {
+        [NSThread sleepForTimeInterval:responseLatency];
+    }
+    NSString *response = [NSString stringWithFormat:@"HTTP/1.1 %ld %@\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                          (long)request.responseStatusCode,
+                          [NSHTTPURLResponse localizedStringForStatusCode:request.responseStatusCode]];
+    NSData *responseData = [response dataUsingEncoding:NSASCIIStringEncoding];
+    send(connection, responseData.bytes, responseData.length, 0);
+}
+
+@end
@@ -0,0 +1,115 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+#import <XCTest/XCTest.h>
+#import "OPTLYTimer.h"
+
+static const NSTimeInterval kTimerInterval = 0.05;
+
+@interface OPTLYTimerTest : XCTestCase
+@end
+
+@implementation OPTLYTimerTest
+
+- (void)testTimerIsCreatedSuspended {
+    __block NSInteger firings = 0;
+    OPTLYTimer *timer = [[OPTLYTimer alloc] initWithName:@"test" timeInterval:kTimerInterval tolerance:-1 handler:^{
+        firings++;
+    }];
+    XCTAssertTrue(timer.valid);
+    XCTAssertTrue(timer.suspended);
+    XCTAssertEqual(timer.timeInterval, kTimerInterval);
+    XCTAssertEqualWithAccuracy(timer.tolerance, kTimerInterval * OPTLYTimerDefaultToleranceRatio, 1e-9);
+    
+    [NSThread sleepForTimeInterval:kTimerInterval * 4];
+    XCTAssertEqual(firings, 0);
+    [timer invalidate];
+}
+
+// the timer fires on its own queue while this thread blocks without running a run loop
+- (void)testTimerFiresWithoutRunLoop {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block BOOL firedOnMainThread = NO;
+    OPTLYTimer *timer = [[OPTLYTimer alloc] initWithName:@"test" timeInterval:kTimerInterval tolerance:0 handler:^{
+        firedOnMainThread = firedOnMainThread || [NSThread isMainThread];
+        dispatch_semaphore_signal(semaphore);
+    }];
+    [timer resume];
+    
+    for (NSInteger i = 0; i < 3; i++) {
+        long result = dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC)));
+        XCTAssertEqual(result, 0, @"Timer did not fire.");
+    }
+    XCTAssertFalse(firedOnMainThread);
+    [timer invalidate];
+}
+
+- (void)testSuspendAndResume {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    OPTLYTimer *timer = [[OPTLYTimer alloc] initWithName:@"test" timeInterval:kTimerInterval tolerance:0 handler:^{
+        dispatch_semaphore_signal(semaphore);
+    }];
+    [timer resume];
+    [timer resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC))), 0);
+    
+    [timer suspend];
+    [timer suspend];
+    XCTAssertTrue(timer.suspended);
+    // drop a firing that was already queued when the timer was suspended
+    dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kTimerInterval * NSEC_PER_SEC)));
+    XCTAssertNotEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kTimerInterval * 4 * NSEC_PER_SEC))), 0, @"Suspended timer fired.");
+    
+    [timer resume];
+    XCTAssertFalse(timer.suspended);
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC))), 0);
+    [timer invalidate];
+}
+
+- (void)testInvalidate {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    OPTLYTimer *timer = [[OPTLYTimer alloc] initWithName:@"test" timeInterval:kTimerInterval tolerance:0 handler:^{
+        dispatch_semaphore_signal(semaphore);
+    }];
+    [timer resume];
+    XCTAssertEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC))), 0);
+    
+    [timer invalidate];
+    XCTAssertFalse(timer.valid);
+    // resume and suspend are no-ops once invalidated
+    [timer resume];
+    [timer suspend];
+    dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kTimerInterval * NSEC_PER_SEC)));
+    XCTAssertNotEqual(dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kTimerInterval * 4 * NSEC_PER_SEC))), 0, @"Invalidated timer fired.");
+}
+
+// a suspended timer must be releasable
+- (void)testInvalidateSuspendedTimer {
+    OPTLYTimer *timer = [[OPTLYTimer alloc] initWithName:@"test" timeInterval:kTimerInterval tolerance:-1 handler:^{}];
+    [timer invalidate];
+    XCTAssertFalse(timer.valid);
+    
+    __weak OPTLYTimer *weakTimer = nil;
+    @autoreleasepool {
+        OPTLYTimer *releasedTimer = [[OPTLYTimer alloc] initWithName:@"test" timeInterval:kTimerInterval tolerance:-1 handler:^{}];
+        [releasedTimer resume];
+        [releasedTimer suspend];
+        weakTimer = releasedTimer;
+    }
+    XCTAssertNil(weakTimer);
+}
+
+@end
@@ -21,6 +21,7 @@
 #import "OPTLYErrorHandler.h"
 #import "OPTLYExperiment.h"
 #import "OPTLYLogger.h"
+#import "OPTLYMetrics.h"
 #import "OPTLYProjectConfig.h"
 #import "OPTLYTestHelper.h"
 #import "OPTLYVariation.h"
@@ -437,6 +438,183 @@ static NSString * const kAttributeKeyBrowserIsDefault = @"browser_is_default";
     [self waitForExpectationsWithTimeout:2 handler:nil];
 }
 
+// several conversion events share a single dispatch and a single notification pass
+- (void)testOptimizelyTrackEventsSendsOneConversion {
+    id eventDispatcherMock = OCMProtocolMock(@protocol(OPTLYEventDispatcher));
+    __block NSDictionary *conversionEventParams = nil;
+    __block NSInteger numberOfDispatchedConversions = 0;
+    OCMStub([eventDispatcherMock dispatchConversionEvent:[OCMArg any] callback:[OCMArg any]]).andDo(^(NSInvocation *invocation) {
+        __unsafe_unretained NSDictionary *params = nil;
+        [invocation getArgument:&params atIndex:2];
+        conversionEventParams = params;
+        numberOfDispatchedConversions++;
+    });
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcherMock;
+    }]];
+    NSMutableArray<NSString *> *notifiedEventKeys = [NSMutableArray new];
+    [optimizely.notificationCenter addTrackNotificationListener:^(NSString *eventKey, NSString *userId, NSDictionary<NSString *, id> *attributes, NSDictionary *eventTags, NSDictionary<NSString *,id> *event) {
+        [notifiedEventKeys addObject:eventKey];
+    }];
+    
+    NSArray *events = @[@{ OPTLYTrackEventKey : kEventNameWithMultipleExperiments, OPTLYTrackEventTagsKey : @{ @"revenue" : @(100) } },
+                        @{ OPTLYTrackEventKey : @"invalidEventKey" },
+                        @{ OPTLYTrackEventKey : kEventNameWithMultipleExperiments }];
+    [optimizely trackEvents:events userId:kUserId attributes:self.attributes];
+    
+    XCTAssertEqual(numberOfDispatchedConversions, 1);
+    NSArray *expectedEventKeys = @[kEventNameWithMultipleExperiments, kEventNameWithMultipleExperiments];
+    XCTAssertEqualObjects(notifiedEventKeys, expectedEventKeys);
+    NSDictionary *snapshot = conversionEventParams[OPTLYEventParameterKeysVisitors][0][OPTLYEventParameterKeysSnapshots][0];
+    NSArray *sentEvents = snapshot[OPTLYEventParameterKeysEvents];
+    XCTAssertEqual(sentEvents.count, 2);
+    XCTAssertEqualObjects(sentEvents[0][OPTLYEventMetricNameRevenue], @(100));
+    XCTAssertNil(sentEvents[1][OPTLYEventMetricNameRevenue]);
+}
+
+- (void)testOptimizelyRecordsMetricsWhenEnabled {
+    [OPTLYMetrics reset];
+    OPTLYMetrics.enabled = YES;
+    id eventDispatcherMock = OCMProtocolMock(@protocol(OPTLYEventDispatcher));
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcherMock;
+    }]];
+    
+    [optimizely activate:kExperimentKeyForWhitelisting userId:kUserId];
+    [optimizely track:kEventNameWithMultipleExperiments userId:kUserId];
+    OPTLYMetrics.enabled = NO;
+    [optimizely track:kEventNameWithMultipleExperiments userId:kUserId];
+    
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyDatafileParse], 1);
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyActivate], 1);
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyDecision], 1);
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyTrack], 1);
+    XCTAssertEqual([OPTLYMetrics valueOfCounter:OPTLYMetricCounterConversionEvents], 1);
+    [OPTLYMetrics reset];
+}
+
+// a burst of events has its own latency but counts every conversion event
+- (void)testOptimizelyTrackEventsRecordsMetricsWhenEnabled {
+    [OPTLYMetrics reset];
+    OPTLYMetrics.enabled = YES;
+    id eventDispatcherMock = OCMProtocolMock(@protocol(OPTLYEventDispatcher));
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcherMock;
+    }]];
+    
+    NSArray *events = @[@{ OPTLYTrackEventKey : kEventNameWithMultipleExperiments },
+                        @{ OPTLYTrackEventKey : @"invalidEventKey" },
+                        @{ OPTLYTrackEventKey : kEventNameWithMultipleExperiments }];
+    [optimizely trackEvents:events userId:kUserId attributes:self.attributes];
+    OPTLYMetrics.enabled = NO;
+    
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyTrackEvents], 1);
+    XCTAssertEqual([OPTLYMetrics countOfLatency:OPTLYMetricLatencyTrack], 0);
+    XCTAssertEqual([OPTLYMetrics valueOfCounter:OPTLYMetricCounterConversionEvents], 2);
+    [OPTLYMetrics reset];
+}
+
+// several experiments share a single impression event
+- (void)testOptimizelyActivateExperimentsSendsOneImpression {
+    id eventDispatcherMock = OCMProtocolMock(@protocol(OPTLYEventDispatcher));
+    __block NSDictionary *impressionEventParams = nil;
+    __block NSInteger numberOfDispatchedImpressions = 0;
+    OCMStub([eventDispatcherMock dispatchImpressionEvent:[OCMArg any] callback:[OCMArg any]]).andDo(^(NSInvocation *invocation) {
+        __unsafe_unretained NSDictionary *params = nil;
+        [invocation getArgument:&params atIndex:2];
+        impressionEventParams = params;
+        numberOfDispatchedImpressions++;
+    });
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcherMock;
+    }]];
+    __block NSInteger numberOfActivateNotifications = 0;
+    [optimizely.notificationCenter addActivateNotificationListener:^(OPTLYExperiment *experiment, NSString *userId, NSDictionary<NSString *, id> *attributes, OPTLYVariation *variation, NSDictionary<NSString *,NSString *> *event) {
+        numberOfActivateNotifications++;
+    }];
+    
+    NSArray *experimentKeys = @[@"testExperiment1", @"testExperiment2", kExperimentKey, @"invalidExperimentKey"];
+    NSDictionary<NSString *, OPTLYVariation *> *variations = [optimizely activateExperiments:experimentKeys
+                                                                                     userId:kUserId
+                                                                                 attributes:nil];
+    // the user doesn't qualify for the audience of kExperimentKey
+    XCTAssertEqual(variations.count, 2);
+    XCTAssertEqualObjects(variations[@"testExperiment1"].variationKey, [optimizely variation:@"testExperiment1" userId:kUserId].variationKey);
+    XCTAssertNil(variations[kExperimentKey]);
+    
+    XCTAssertEqual(numberOfDispatchedImpressions, 1);
+    XCTAssertEqual(numberOfActivateNotifications, 2);
+    NSDictionary *snapshot = impressionEventParams[OPTLYEventParameterKeysVisitors][0][OPTLYEventParameterKeysSnapshots][0];
+    XCTAssertEqual([snapshot[OPTLYEventParameterKeysDecisions] count], 2);
+    XCTAssertEqual([snapshot[OPTLYEventParameterKeysEvents] count], 2);
+}
+
+// a repeated impression never reaches the event builder or the event dispatcher
+- (void)testOptimizelyActivateSuppressesDuplicateImpressions {
+    id eventDispatcherMock = OCMProtocolMock(@protocol(OPTLYEventDispatcher));
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcherMock;
+        builder.impressionDeduplicationWindow = 60;
+    }]];
+    XCTAssertNotNil(optimizely.impressionDeduplicator);
+    __block NSInteger numberOfDispatchedImpressions = 0;
+    OCMStub([eventDispatcherMock dispatchImpressionEvent:[OCMArg any] callback:[OCMArg any]]).andDo(^(NSInvocation *invocation) {
+        numberOfDispatchedImpressions++;
+    });
+    id eventBuilderMock = OCMPartialMock((NSObject *)optimizely.eventBuilder);
+    
+    OPTLYVariation *variation = [optimizely activate:kExperimentKeyForWhitelisting userId:kUserId];
+    XCTAssertNotNil(variation);
+    OCMReject([eventBuilderMock buildImpressionEventForUser:[OCMArg any] experiment:[OCMArg any] variation:[OCMArg any] attributes:[OCMArg any]]);
+    OPTLYVariation *duplicateVariation = [optimizely activate:kExperimentKeyForWhitelisting userId:kUserId];
+    XCTAssertEqualObjects(variation.variationId, duplicateVariation.variationId);
+    
+    XCTAssertEqual(numberOfDispatchedImpressions, 1);
+    XCTAssertEqual(optimizely.impressionDeduplicator.numberOfSentImpressions, 1);
+    XCTAssertEqual(optimizely.impressionDeduplicator.numberOfSuppressedImpressions, 1);
+    
+    // impressions are only deduplicated when asked for
+    XCTAssertNil(self.optimizely.impressionDeduplicator);
+    [eventBuilderMock stopMocking];
+}
+
+// an impression that failed to build is sent when activate is retried within the window
+- (void)testOptimizelyActivateRetriesImpressionThatFailedToBuild {
+    id eventDispatcherMock = OCMProtocolMock(@protocol(OPTLYEventDispatcher));
+    Optimizely *optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = self.datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcherMock;
+        builder.impressionDeduplicationWindow = 60;
+    }]];
+    __block NSInteger numberOfDispatchedImpressions = 0;
+    OCMStub([eventDispatcherMock dispatchImpressionEvent:[OCMArg any] callback:[OCMArg any]]).andDo(^(NSInvocation *invocation) {
+        numberOfDispatchedImpressions++;
+    });
+    id eventBuilderMock = OCMPartialMock((NSObject *)optimizely.eventBuilder);
+    OCMStub([eventBuilderMock buildImpressionEventForUser:[OCMArg any] experiment:[OCMArg any] variation:[OCMArg any] attributes:[OCMArg any]]).andReturn(nil);
+    
+    XCTAssertNil([optimizely activate:kExperimentKeyForWhitelisting userId:kUserId]);
+    XCTAssertEqual(numberOfDispatchedImpressions, 0);
+    XCTAssertEqual(optimizely.impressionDeduplicator.numberOfSentImpressions, 0);
+    
+    [eventBuilderMock stopMocking];
+    XCTAssertNotNil([optimizely activate:kExperimentKeyForWhitelisting userId:kUserId]);
+    XCTAssertEqual(numberOfDispatchedImpressions, 1);
+    XCTAssertEqual(optimizely.impressionDeduplicator.numberOfSentImpressions, 1);
+    XCTAssertEqual(optimizely.impressionDeduplicator.numberOfSuppressedImpressions, 0);
+}
+
 - (void)testOptimizelyPostsActivateExperimentNotification {
     
     OPTLYExperiment *experiment = [self.optimizely.config getExperimentForKey:kExperimentKeyForWhitelisting];
@@ -19,24 +19,33 @@
     #import "OPTLYErrorHandler.h"
     #import "OPTLYLog.h"
     #import "OPTLYLogger.h"
-    #import "OPTLYNetworkService.h"
+    #import "OPTLYMetrics.h"
+    #import "OPTLYStartupReport.h"
+    #import "OPTLYTimer.h"
     #import "OPTLYDataStore.h"
+    #import "OPTLYDatafileFetchCoordinator.h"
 #else
     #import <OptimizelySDKCore/OPTLYErrorHandler.h>
     #import <OptimizelySDKCore/OPTLYLog.h>
     #import <OptimizelySDKCore/OPTLYLogger.h>
-    #import <OptimizelySDKCore/OPTLYNetworkService.h>
+    #import <OptimizelySDKCore/OPTLYMetrics.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
+    #import <OptimizelySDKCore/OPTLYTimer.h>
     #import <OptimizelySDKShared/OPTLYDataStore.h>
+    #import <OptimizelySDKShared/OPTLYDatafileFetchCoordinator.h>
 #endif
 #import "OPTLYDatafileManager.h"
 
 // default datafile download interval is 2 minutes
 NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
+// suffixes of the keys the ETag and the content hash of a datafile are saved under, next to its last modified date
+static NSString * const kEntityTagKeySuffix = @"-etag";
+static NSString * const kContentHashKeySuffix = @"-contentHash";
 
-@interface OPTLYDatafileManagerDefault ()
+@interface OPTLYDatafileManagerDefault () <OPTLYDatafileFetchSubscriber>
 @property (nonatomic, strong) OPTLYDataStore *dataStore;
-@property (nonatomic, strong) OPTLYNetworkService *networkService;
-@property (nonatomic, strong) NSTimer *datafileDownloadTimer;
+// the poll timer shared with the other datafile managers of the same datafile URL, nil if not polling
+@property (atomic, readonly) OPTLYTimer *datafileDownloadTimer;
 @end
 
 @implementation OPTLYDatafileManagerDefault
@@ -54,11 +63,11 @@ NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
             _datafileConfig = builder.datafileConfig;
             _errorHandler = builder.errorHandler;
             _logger = builder.logger;
-            _networkService = [OPTLYNetworkService new];
             _dataStore = [OPTLYDataStore dataStore];
             _dataStore.logger = _logger;
             
             // download datafile when we start the datafile manager
+            // (joining the download of another datafile manager of the same datafile URL in flight)
             [self downloadDatafile:self.datafileConfig completionHandler:nil];
             [self setupNetworkTimer];
             [self setupApplicationNotificationHandlers];
@@ -77,38 +86,55 @@ NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
     NSString *lastSavedModifiedDate = [self getLastModifiedDate:[datafileConfig key]];
     logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerLastModifiedDate, lastSavedModifiedDate];
     [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
+    NSString *lastSavedEntityTag = [self getEntityTag:[datafileConfig key]];
     
     // if datafile polling is enabled, then no need for the backoff retry
     BOOL enableBackoffRetry = self.datafileFetchInterval > 0 ? NO : YES;
     
-    [self.networkService downloadProjectConfig:[datafileConfig URLForKey]
-                                  backoffRetry:enableBackoffRetry
-                                  lastModified:lastSavedModifiedDate
-                             completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+    uint64_t startTime = [OPTLYMetrics startTime];
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] downloadDatafile:[datafileConfig URLForKey]
+                                                           backoffRetry:enableBackoffRetry
+                                                           lastModified:lastSavedModifiedDate
+                                                              entityTag:lastSavedEntityTag
+                                                      completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
                                  NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
                                  NSInteger statusCode = [httpResponse statusCode];
                                  NSString *logMessage = @"";
+                                 [OPTLYMetrics recordLatency:OPTLYMetricLatencyDatafileDownload since:startTime];
+                                 [OPTLYMetrics incrementCounter:OPTLYMetricCounterDatafileDownloads by:1];
                                  if (error != nil) {
+                                     [OPTLYMetrics incrementCounter:OPTLYMetricCounterDatafileDownloadFailures by:1];
                                      [self.errorHandler handleError:error];
                                      logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedError, [datafileConfig key], error];
                                      [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
                                  }
                                  else if (statusCode == 200) { // got datafile OK
-                                     [self saveDatafile:data];
+                                     // a datafile with the same content as the saved one is not written again
+                                     NSString *contentHash = [OPTLYDatafileManagerUtility contentHashOfDatafile:data];
+                                     BOOL unchanged = [contentHash isEqualToString:[self getContentHash:[datafileConfig key]]] && [self isDatafileCached];
+                                     if (!unchanged) {
+                                         [self saveDatafile:data contentHash:contentHash];
+                                     }
                                      
-                                     // save the last modified date
-                                     NSDictionary *dictionary = [httpResponse allHeaderFields];
-                                     NSString *lastModifiedDate = [dictionary valueForKey:@"Last-Modified"];
+                                     // save the last modified date and the ETag
+                                     NSString *lastModifiedDate = [self valueOfHeaderField:@"Last-Modified" response:httpResponse];
                                      [self saveLastModifiedDate:lastModifiedDate project:[datafileConfig key]];
+                                     [self saveEntityTag:[self valueOfHeaderField:@"ETag" response:httpResponse] project:[datafileConfig key]];
                                      
-                                     logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileDownloaded, [datafileConfig key], lastModifiedDate];
-                                     [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
+                                     if (unchanged) {
+                                         logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileUnchanged, [datafileConfig key]];
+                                         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
+                                     } else {
+                                         logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileDownloaded, [datafileConfig key], lastModifiedDate];
+                                         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
+                                     }
                                  }
                                  else if (statusCode == 304) {
                                      logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedNoChanges, [datafileConfig key]];
                                      [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
                                  }
                                  else { // no error, but invalid status code
+                                     [OPTLYMetrics incrementCounter:OPTLYMetricCounterDatafileDownloadFailures by:1];
                                      logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileNotDownloadedInvalidStatusCode, [datafileConfig key], statusCode];
                                      [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
                                  }
@@ -125,6 +151,10 @@ NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
 }
 
 - (void)saveDatafile:(NSData *)datafile {
+    [self saveDatafile:datafile contentHash:[OPTLYDatafileManagerUtility contentHashOfDatafile:datafile]];
+}
+
+- (void)saveDatafile:(NSData *)datafile contentHash:(NSString *)contentHash {
     NSError *error;
     [self.dataStore saveFile:[self.datafileConfig key]
                         data:datafile
@@ -132,16 +162,20 @@ NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
                        error:&error];
     if (error != nil) {
         [self.errorHandler handleError:error];
+        [self saveDatafileValue:nil forKey:[[self.datafileConfig key] stringByAppendingString:kContentHashKeySuffix]];
     } else {
+        [self saveDatafileValue:contentHash forKey:[[self.datafileConfig key] stringByAppendingString:kContentHashKeySuffix]];
         NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDatafileManagerDatafileSaved, [self.datafileConfig key]];
         [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelInfo];
     }
 }
 
 - (NSData * _Nullable)getSavedDatafile:(out NSError * _Nullable __autoreleasing * _Nullable)error NS_SWIFT_NOTHROW {
+    uint64_t startTime = [OPTLYStartupReport startTime];
     NSData *datafile = [self.dataStore getFile:[self.datafileConfig key]
                                           type:OPTLYDataStoreDataTypeDatafile
                                          error:error];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatafileRead since:startTime];
     if (error && *error) {
         [self.errorHandler handleError:*error];
     }
@@ -153,17 +187,49 @@ NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
     return isCached;
 }
 
-# pragma mark - Persistence for Last Modified Date
-- (void)saveLastModifiedDate:(nonnull NSString *)lastModifiedDate
-                     project:(nonnull NSString *)projectKey {
-    
+# pragma mark - Persistence for Last Modified Date, ETag and Content Hash
+- (void)saveDatafileValue:(nullable NSString *)value forKey:(nonnull NSString *)key {
     NSDictionary *userProfileData = [self.dataStore getUserDataForType:OPTLYDataStoreDataTypeDatafile];
+    if ((value == nil && userProfileData[key] == nil) || [userProfileData[key] isEqual:value]) {
+        return;
+    }
     NSMutableDictionary *userProfileDataMutable = userProfileData ? [userProfileData mutableCopy] : [NSMutableDictionary new];
-    userProfileDataMutable[projectKey] = lastModifiedDate;
+    userProfileDataMutable[key] = value;
     [self.dataStore saveUserData:userProfileDataMutable
                             type:OPTLYDataStoreDataTypeDatafile];
 }
 
+- (void)saveLastModifiedDate:(nonnull NSString *)lastModifiedDate
+                     project:(nonnull NSString *)projectKey {
+    [self saveDatafileValue:lastModifiedDate forKey:projectKey];
+}
+
+- (void)saveEntityTag:(nullable NSString *)entityTag
+              project:(nonnull NSString *)projectKey {
+    [self saveDatafileValue:entityTag forKey:[projectKey stringByAppendingString:kEntityTagKeySuffix]];
+}
+
+- (nullable NSString *)getEntityTag:(nonnull NSString *)projectKey {
+    NSDictionary *userData = [self.dataStore getUserDataForType:OPTLYDataStoreDataTypeDatafile];
+    return userData[[projectKey stringByAppendingString:kEntityTagKeySuffix]];
+}
+
+- (nullable NSString *)getContentHash:(nonnull NSString *)projectKey {
+    NSDictionary *userData = [self.dataStore getUserDataForType:OPTLYDataStoreDataTypeDatafile];
+    return userData[[projectKey stringByAppendingString:kContentHashKeySuffix]];
+}
+
+// Header field names are case-insensitive
+- (nullable NSString *)valueOfHeaderField:(nonnull NSString *)field response:(nonnull NSHTTPURLResponse *)response {
+    NSDictionary *headerFields = [response allHeaderFields];
+    for (NSString *key in headerFields) {
+        if ([key caseInsensitiveCompare:field] == NSOrderedSame) {
+            return headerFields[key];
+        }
+    }
+    return nil;
+}
+
 - (nullable NSString *)getLastModifiedDate:(nonnull NSString *)projectId {
     NSDictionary *userData = [self.dataStore getUserDataForType:OPTLYDataStoreDataTypeDatafile];
     NSString *lastModifiedDate = [userData objectForKey:projectId];
@@ -215,36 +281,43 @@ NSTimeInterval const kDefaultDatafileFetchInterval_s = 120;
 }
 
 - (void)applicationDidEnterBackground:(id)notification {
-    [self disableNetworkTimer];
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] suspendPollingDatafileURL:[self.datafileConfig URLForKey]];
     OPTLYLogInfo(@"applicationDidEnterBackground");
 }
 
 - (void)applicationWillTerminate:(id)notification {
-    [self disableNetworkTimer];
+    // the app is terminating, so the shared timer is stopped even if other datafile managers subscribe to it
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] stopPollingDatafileURL:[self.datafileConfig URLForKey]];
     OPTLYLogInfo(@"applicationWillTerminate");
 }
 
 - (void)dealloc {
     [[NSNotificationCenter defaultCenter] removeObserver:self];
-    [self disableNetworkTimer];
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] unsubscribe:self fromDatafileURL:[_datafileConfig URLForKey]];
 }
 
 # pragma mark - Network Timer
-// The timer must be dispatched on the main thread.
+// The timer is owned by the fetch coordinator and shared by the datafile managers of the same datafile URL.
+// It fires on its own background queue, so no run loop is needed.
+// A suspended timer (e.g. after the app entered the background) is resumed.
 - (void)setupNetworkTimer
 {
-    if (self.datafileFetchInterval > 0 && ![self.datafileDownloadTimer isValid]) {
-        self.datafileDownloadTimer = [NSTimer timerWithTimeInterval:self.datafileFetchInterval
-                                                             target:self
-                                                           selector:@selector(downloadDatafile)
-                                                           userInfo:nil
-                                                            repeats:YES];
-        [[NSRunLoop mainRunLoop] addTimer:self.datafileDownloadTimer forMode:NSRunLoopCommonModes];
+    if (self.datafileFetchInterval <= 0) {
+        return;
     }
+    uint64_t startTime = [OPTLYStartupReport startTime];
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] subscribe:self
+                                                   toDatafileURL:[self.datafileConfig URLForKey]
+                                                        interval:self.datafileFetchInterval];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseTimerSetup since:startTime];
+}
+
+- (OPTLYTimer *)datafileDownloadTimer {
+    return [[OPTLYDatafileFetchCoordinator sharedCoordinator] pollTimerForSubscriber:self datafileURL:[self.datafileConfig URLForKey]];
 }
 
 - (void)disableNetworkTimer {
-    [self.datafileDownloadTimer invalidate];
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] unsubscribe:self fromDatafileURL:[self.datafileConfig URLForKey]];
 }
 
 @end
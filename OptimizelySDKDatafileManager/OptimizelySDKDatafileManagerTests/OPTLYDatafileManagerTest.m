@@ -18,6 +18,7 @@
 #import <OHHTTPStubs/OHHTTPStubs.h>
 #import <OptimizelySDKCore/OPTLYProjectConfig.h>
 #import <OptimizelySDKCore/OPTLYNetworkService.h>
+#import <OptimizelySDKCore/OPTLYTimer.h>
 #import <OptimizelySDKShared/OptimizelySDKShared.h>
 #import "OPTLYDatafileManager.h"
 #import "OPTLYTestHelper.h"
@@ -26,19 +27,26 @@ static NSString *const kProjectId = @"6372300739";
 static NSString *const kDatamodelDatafileName = @"optimizely_6372300739";
 static NSTimeInterval kDatafileDownloadInteval = 5; // in seconds
 static NSString *const kLastModifiedDate = @"Mon, 28 Nov 2016 06:10:59 GMT";
+static NSString *const kEntityTag = @"\"5d8c2a7e1f\"";
 static NSData *kDatafileData;
 static NSDictionary *kCDNResponseHeaders = nil;
 
 @interface OPTLYDatafileManagerDefault(test)
-@property (nonatomic, strong) NSTimer *datafileDownloadTimer;
+@property (atomic, readonly) OPTLYTimer *datafileDownloadTimer;
 - (void)saveDatafile:(NSData *)datafile;
 - (nullable NSString *)getLastModifiedDate:(nonnull NSString *)projectId;
+- (nullable NSString *)getEntityTag:(nonnull NSString *)projectKey;
 - (void)downloadDatafile:(OPTLYDatafileConfig *)datafileConfig completionHandler:(OPTLYHTTPRequestManagerResponse)completion;
+- (void)applicationDidBecomeActive:(id)notificaton;
+- (void)applicationDidEnterBackground:(id)notification;
+- (void)applicationWillTerminate:(id)notification;
+- (void)disableNetworkTimer;
 @end
 
 @interface OPTLYDatafileManagerTest : XCTestCase
 @property (nonatomic, strong) OPTLYDatafileManagerDefault *datafileManager;
 @property (nonatomic, strong) OPTLYDataStore *dataStore;
+@property (nonatomic, strong) id<OHHTTPStubsDescriptor> defaultStub;
 @end
 
 @implementation OPTLYDatafileManagerTest
@@ -47,7 +55,8 @@ static NSDictionary *kCDNResponseHeaders = nil;
     [super setUp];
     
     kCDNResponseHeaders = @{@"Content-Type":@"application/json",
-                            @"Last-Modified":kLastModifiedDate};
+                            @"Last-Modified":kLastModifiedDate,
+                            @"ETag":kEntityTag};
     kDatafileData = [OPTLYTestHelper loadJSONDatafileIntoDataObject:kDatamodelDatafileName];
 }
 
@@ -59,15 +68,36 @@ static NSDictionary *kCDNResponseHeaders = nil;
 
 - (void)setUp {
     [super setUp];
+    // downloads of the same datafile in flight are shared, so every download is answered
+    // to leave none in flight for the next test to join
+    self.defaultStub = [OHHTTPStubs stubRequestsPassingTest:^BOOL (NSURLRequest *request) {
+        return YES;
+    } withStubResponse:^OHHTTPStubsResponse *(NSURLRequest *request) {
+        return [OHHTTPStubsResponse responseWithData:kDatafileData
+                                          statusCode:200
+                                             headers:kCDNResponseHeaders];
+    }];
     self.dataStore = [OPTLYDataStore new];
     [self.dataStore removeAll:nil];
     self.datafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
         builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
     }]];
+    
+    // wait for the download the datafile manager starts with, the ETag is the last value it saves
+    NSURL *datafileURL = [self.datafileManager.datafileConfig URLForKey];
+    NSString *datafileKey = [self.datafileManager.datafileConfig key];
+    NSPredicate *downloaded = [NSPredicate predicateWithBlock:^BOOL(OPTLYDatafileManagerDefault *datafileManager, NSDictionary *bindings) {
+        return [[OPTLYDatafileFetchCoordinator sharedCoordinator] numberOfDownloadsInFlightForDatafileURL:datafileURL] == 0
+            && [datafileManager getEntityTag:datafileKey] != nil;
+    }];
+    [self expectationForPredicate:downloaded evaluatedWithObject:self.datafileManager handler:nil];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    [self.dataStore removeAll:nil];
 }
 
 - (void)tearDown {
     [super tearDown];
+    [OHHTTPStubs removeStub:self.defaultStub];
     [self.dataStore removeAll:nil];
     self.dataStore = nil;
     self.datafileManager = nil;
@@ -181,6 +211,28 @@ static NSDictionary *kCDNResponseHeaders = nil;
     XCTAssertFalse(datafileManager.datafileDownloadTimer.valid, @"Timer should not be valid.");
 }
 
+// the timer is suspended in the background and restarted when the app becomes active
+- (void)testNetworkTimerIsSuspendedInBackground
+{
+    OPTLYDatafileManagerDefault *datafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
+        builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
+        builder.datafileFetchInterval = kDatafileDownloadInteval;
+    }]];
+    OPTLYTimer *timer = datafileManager.datafileDownloadTimer;
+    XCTAssertFalse(timer.suspended);
+    
+    [datafileManager applicationDidEnterBackground:nil];
+    XCTAssertTrue(timer.valid);
+    XCTAssertTrue(timer.suspended);
+    
+    [datafileManager applicationDidBecomeActive:nil];
+    XCTAssertEqual(datafileManager.datafileDownloadTimer, timer, @"The suspended timer should be reused.");
+    XCTAssertFalse(timer.suspended);
+    
+    [datafileManager applicationWillTerminate:nil];
+    XCTAssertFalse(timer.valid);
+}
+
 - (void)testIsDatafileCachedFlag
 {
     XCTAssertFalse(self.datafileManager.isDatafileCached, @"Datafile cached flag should be false.");
@@ -256,6 +308,186 @@ static NSDictionary *kCDNResponseHeaders = nil;
     [OHHTTPStubs removeStub:stub304];
 }
 
+// the ETag of the saved datafile is sent back in If-None-Match
+- (void)testDownloadDatafileSendsSavedEntityTag
+{
+    id<OHHTTPStubsDescriptor> stub200 = [self stub200Response];
+    __weak XCTestExpectation *expect200 = [self expectationWithDescription:@"should get a 200 on first try"];
+    [self.datafileManager downloadDatafile:self.datafileManager.datafileConfig
+                         completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                             [expect200 fulfill];
+                         }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    [OHHTTPStubs removeStub:stub200];
+    XCTAssertEqualObjects([self.datafileManager getEntityTag:[self.datafileManager.datafileConfig key]], kEntityTag);
+    
+    NSString *hostName = [[self.datafileManager.datafileConfig URLForKey] host];
+    __block NSString *sentEntityTag = nil;
+    id<OHHTTPStubsDescriptor> stub304 = [OHHTTPStubs stubRequestsPassingTest:^BOOL (NSURLRequest *request) {
+        return [request.URL.host isEqualToString:hostName];
+    } withStubResponse:^OHHTTPStubsResponse *(NSURLRequest *request) {
+        sentEntityTag = [request.allHTTPHeaderFields objectForKey:@"If-None-Match"];
+        return [OHHTTPStubsResponse responseWithData:[NSData data]
+                                          statusCode:304
+                                             headers:kCDNResponseHeaders];
+    }];
+    __weak XCTestExpectation *expect304 = [self expectationWithDescription:@"should get a 304 on second try"];
+    [self.datafileManager downloadDatafile:self.datafileManager.datafileConfig
+                         completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                             XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 304);
+                             [expect304 fulfill];
+                         }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(sentEntityTag, kEntityTag);
+    
+    [OHHTTPStubs removeStub:stub304];
+}
+
+// a 200 response with the same content as the saved datafile does not write the datafile again
+- (void)testUnchangedDatafileIsNotSavedAgain
+{
+    id<OHHTTPStubsDescriptor> stub200 = [self stub200Response];
+    __weak XCTestExpectation *expectFirst = [self expectationWithDescription:@"first download"];
+    [self.datafileManager downloadDatafile:self.datafileManager.datafileConfig
+                         completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                             [expectFirst fulfill];
+                         }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    // replace the saved file behind the datafile manager's back, a rewrite would restore it
+    NSData *marker = [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+    [self.dataStore saveFile:kProjectId data:marker type:OPTLYDataStoreDataTypeDatafile error:nil];
+    
+    __weak XCTestExpectation *expectSecond = [self expectationWithDescription:@"second download"];
+    [self.datafileManager downloadDatafile:self.datafileManager.datafileConfig
+                         completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                             XCTAssertEqual(((NSHTTPURLResponse *)response).statusCode, 200);
+                             XCTAssertEqualObjects(data, kDatafileData);
+                             [expectSecond fulfill];
+                         }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    NSData *savedData = [self.dataStore getFile:kProjectId type:OPTLYDataStoreDataTypeDatafile error:nil];
+    XCTAssertEqualObjects(savedData, marker, @"an unchanged datafile should not have been saved again");
+    
+    [OHHTTPStubs removeStub:stub200];
+}
+
+// the downloads of the same datafile in flight send one request and hand the same data to every datafile manager
+- (void)testConcurrentDownloadsOfTheSameDatafileAreCoalesced
+{
+    NSString *hostName = [[self.datafileManager.datafileConfig URLForKey] host];
+    __block NSInteger requestCount = 0;
+    id<OHHTTPStubsDescriptor> stub = [OHHTTPStubs stubRequestsPassingTest:^BOOL (NSURLRequest *request) {
+        return [request.URL.host isEqualToString:hostName];
+    } withStubResponse:^OHHTTPStubsResponse *(NSURLRequest *request) {
+        @synchronized (self) {
+            requestCount++;
+        }
+        return [[OHHTTPStubsResponse responseWithData:kDatafileData
+                                           statusCode:200
+                                              headers:kCDNResponseHeaders] requestTime:0.5 responseTime:0];
+    }];
+    
+    // starts a download too
+    OPTLYDatafileManagerDefault *otherDatafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
+        builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
+    }]];
+    
+    __block NSData *datafile = nil;
+    __block NSData *otherDatafile = nil;
+    __weak XCTestExpectation *expectDownload = [self expectationWithDescription:@"download"];
+    __weak XCTestExpectation *expectOtherDownload = [self expectationWithDescription:@"other download"];
+    [self.datafileManager downloadDatafile:self.datafileManager.datafileConfig
+                         completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                             datafile = data;
+                             [expectDownload fulfill];
+                         }];
+    [otherDatafileManager downloadDatafile:otherDatafileManager.datafileConfig
+                         completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                             otherDatafile = data;
+                             [expectOtherDownload fulfill];
+                         }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    XCTAssertEqual(requestCount, 1);
+    XCTAssertEqualObjects(datafile, kDatafileData);
+    XCTAssertEqual(datafile, otherDatafile, @"Both datafile managers should be handed the same datafile.");
+    
+    [OHHTTPStubs removeStub:stub];
+}
+
+// the datafile managers of the same datafile share one poll timer firing at the smallest interval
+- (void)testDatafileManagersShareOnePollTimer
+{
+    OPTLYDatafileManagerDefault *slowDatafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
+        builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
+        builder.datafileFetchInterval = kDatafileDownloadInteval - 1;
+    }]];
+    OPTLYDatafileManagerDefault *fastDatafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
+        builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
+        builder.datafileFetchInterval = kDatafileDownloadInteval - 2;
+    }]];
+    
+    OPTLYTimer *timer = [[OPTLYDatafileFetchCoordinator sharedCoordinator] pollTimerForDatafileURL:[fastDatafileManager.datafileConfig URLForKey]];
+    XCTAssertEqual(fastDatafileManager.datafileDownloadTimer, timer);
+    XCTAssertEqual(slowDatafileManager.datafileDownloadTimer, timer, @"The slow datafile manager should see the timer of the fast one.");
+    XCTAssertEqual(timer.timeInterval, kDatafileDownloadInteval - 2);
+    XCTAssertTrue(timer.valid);
+    
+    // the slow datafile manager suspends the timer it shares
+    [slowDatafileManager applicationDidEnterBackground:nil];
+    XCTAssertTrue(timer.suspended);
+    [slowDatafileManager applicationDidBecomeActive:nil];
+    XCTAssertFalse(timer.suspended);
+    
+    // the timer goes back to the interval of the slow datafile manager once the fast one stops polling
+    [fastDatafileManager disableNetworkTimer];
+    XCTAssertNil(fastDatafileManager.datafileDownloadTimer);
+    XCTAssertFalse(timer.valid);
+    OPTLYTimer *slowTimer = slowDatafileManager.datafileDownloadTimer;
+    XCTAssertTrue(slowTimer.valid);
+    XCTAssertFalse(slowTimer.suspended);
+    XCTAssertEqual(slowTimer.timeInterval, kDatafileDownloadInteval - 1);
+    
+    [slowDatafileManager applicationWillTerminate:nil];
+    XCTAssertFalse(slowTimer.valid);
+    XCTAssertNil(slowDatafileManager.datafileDownloadTimer);
+}
+
+// the timer of a datafile manager that is gone is suspended by the datafile managers left
+- (void)testPollTimerOfDeallocatedDatafileManagerIsSuspendedInBackground
+{
+    OPTLYDatafileManagerDefault *slowDatafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
+        builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
+        builder.datafileFetchInterval = kDatafileDownloadInteval - 1;
+    }]];
+    __weak OPTLYDatafileManagerDefault *weakFastDatafileManager = nil;
+    @autoreleasepool {
+        OPTLYDatafileManagerDefault *fastDatafileManager = [[OPTLYDatafileManagerDefault alloc] initWithBuilder:[OPTLYDatafileManagerBuilder builderWithBlock:^(OPTLYDatafileManagerBuilder * _Nullable builder) {
+            builder.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:kProjectId withSDKKey:nil];
+            builder.datafileFetchInterval = kDatafileDownloadInteval - 2;
+        }]];
+        weakFastDatafileManager = fastDatafileManager;
+        XCTAssertEqual(slowDatafileManager.datafileDownloadTimer.timeInterval, kDatafileDownloadInteval - 2);
+    }
+    // the download the fast datafile manager started with holds it until it completes
+    NSPredicate *deallocated = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return weakFastDatafileManager == nil;
+    }];
+    [self expectationForPredicate:deallocated evaluatedWithObject:self handler:nil];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    
+    OPTLYTimer *timer = slowDatafileManager.datafileDownloadTimer;
+    XCTAssertEqual(timer.timeInterval, kDatafileDownloadInteval - 1);
+    [slowDatafileManager applicationDidEnterBackground:nil];
+    XCTAssertTrue(timer.suspended);
+    XCTAssertEqual([[OPTLYDatafileFetchCoordinator sharedCoordinator] pollTimerForDatafileURL:[slowDatafileManager.datafileConfig URLForKey]], timer);
+    
+    [slowDatafileManager applicationWillTerminate:nil];
+    XCTAssertFalse(timer.valid);
+}
+
 # pragma mark - Helper Methods
 - (id<OHHTTPStubsDescriptor>)stub200Response {
     NSURL *hostURL = [self.datafileManager.datafileConfig URLForKey];
@@ -34,16 +34,26 @@
  * The saved events will be dispatched again opportunistically in the following cases:
  *   - Another event dispatch is called
  *   - The app enters the background or foreground
+ * Conversion events have priority over impression events: they are flushed and uploaded
+ * first, and saved impression events are evicted first when the conversion queue overflows.
  */
 
 // Default dispatch interval if not set by users
 extern NSInteger const OPTLYEventDispatcherDefaultDispatchIntervalTime_s;
 // The max number of events that can be flushed at a time
 extern NSInteger const OPTLYEventDispatcherMaxDispatchEventBatchSize;
+// The max number of saved events dispatched by one flush, shared by the conversion and impression lanes
+extern NSInteger const OPTLYEventDispatcherMaxFlushEventCapacity;
 // The max number of times flush events are attempted
 extern NSInteger const OPTLYEventDispatcherMaxFlushEventAttempts;
 // Default max number of events to store before overwriting older events
 extern NSInteger const OPTLYEventDispatcherDefaultMaxNumberOfEventsToSave;
+// Default max total size (in bytes) of saved events
+extern NSInteger const OPTLYEventDispatcherDefaultMaxImpressionEventBytesToSave;
+extern NSInteger const OPTLYEventDispatcherDefaultMaxConversionEventBytesToSave;
+// Default max age (in s) of saved events
+extern NSTimeInterval const OPTLYEventDispatcherDefaultMaxImpressionEventAge_s;
+extern NSTimeInterval const OPTLYEventDispatcherDefaultMaxConversionEventAge_s;
 
 @protocol OPTLYEventDispatcher;
 
@@ -57,9 +67,33 @@ typedef void (^OPTLYEventDispatcherResponse)(NSData * _Nullable data, NSURLRespo
 /// Max number of events to store before overwriting older events (value must be greater than 1)
 @property (nonatomic, assign, readonly) NSInteger maxNumberOfEventsToSave;
 
+/// Max number of impression and conversion events to store together
+@property (nonatomic, assign, readonly) NSInteger maxTotalNumberOfEventsToSave;
+
+/// Max total size (in bytes) of saved impression events
+@property (nonatomic, assign, readonly) NSInteger maxImpressionEventBytesToSave;
+
+/// Max total size (in bytes) of saved conversion events
+@property (nonatomic, assign, readonly) NSInteger maxConversionEventBytesToSave;
+
+/// Max age (in s) of saved impression events
+@property (nonatomic, assign, readonly) NSTimeInterval maxImpressionEventAge;
+
+/// Max age (in s) of saved conversion events
+@property (nonatomic, assign, readonly) NSTimeInterval maxConversionEventAge;
+
 /// Logger provided by the user
 @property (nonatomic, strong, nullable) id<OPTLYLogger> logger;
 
+/// If YES, events of at least eventCompressionThreshold bytes are sent gzip compressed
+@property (nonatomic, assign, readonly) BOOL eventCompressionEnabled;
+
+/// The minimum encoded event size (in bytes) to compress
+@property (nonatomic, assign, readonly) NSInteger eventCompressionThreshold;
+
+/// The maximum number of event uploads in flight
+@property (nonatomic, assign, readonly) NSInteger maxConcurrentEventUploads;
+
 
 /**
  * Initializer for Optimizely Event Dispatcher object
@@ -100,4 +134,16 @@ __attribute((deprecated("Use OPTLYEventDispatcherDefault initWithBuilder method
  */
 - (void)flushEvents;
 
+/**
+ * Returns the number of saved events of a type that have not been delivered yet (the depth of its lane).
+ * @param eventType The event type of the lane
+ */
+- (NSInteger)numberOfSavedEvents:(OPTLYDataStoreEventType)eventType;
+
+/**
+ * Returns the number of events of a type being uploaded.
+ * @param eventType The event type of the lane
+ */
+- (NSInteger)numberOfInFlightEvents:(OPTLYDataStoreEventType)eventType;
+
 @end
@@ -14,9 +14,15 @@
  * limitations under the License.                                           *
  ***************************************************************************/
 #ifdef UNIVERSAL
+    #import "OPTLYEventPayload.h"
     #import "OPTLYNetworkService.h"
+    #import "OPTLYStartupReport.h"
+    #import "OPTLYTimer.h"
 #else
+    #import <OptimizelySDKCore/OPTLYEventPayload.h>
     #import <OptimizelySDKCore/OPTLYNetworkService.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
+    #import <OptimizelySDKCore/OPTLYTimer.h>
 #endif
 #import "OPTLYEventDispatcher.h"
 
@@ -32,17 +38,26 @@ NSString * const oldOPTLYEventDispatcherConversionEventURL   = @"https://logx.op
 const NSInteger OPTLYEventDispatcherDefaultDispatchIntervalTime_s = 0;
 // The max number of events that can be flushed at a time
 const NSInteger OPTLYEventDispatcherMaxDispatchEventBatchSize = 20;
+// The max number of saved events dispatched by one flush, shared by the conversion and impression lanes
+const NSInteger OPTLYEventDispatcherMaxFlushEventCapacity = 2 * OPTLYEventDispatcherMaxDispatchEventBatchSize;
 // The max number of times flush events are attempted
 const NSInteger OPTLYEventDispatcherMaxFlushEventAttempts = 10;
 // Default max number of events to store before overwriting older events
 const NSInteger OPTLYEventDispatcherDefaultMaxNumberOfEventsToSave = 1000;
+// Default max total size (in bytes) of saved events
+const NSInteger OPTLYEventDispatcherDefaultMaxImpressionEventBytesToSave = 512 * 1024;
+const NSInteger OPTLYEventDispatcherDefaultMaxConversionEventBytesToSave = 1024 * 1024;
+// Default max age (in s) of saved events; impressions go stale sooner than conversions
+const NSTimeInterval OPTLYEventDispatcherDefaultMaxImpressionEventAge_s = 24 * 60 * 60;
+const NSTimeInterval OPTLYEventDispatcherDefaultMaxConversionEventAge_s = 7 * 24 * 60 * 60;
 
 @interface OPTLYEventDispatcherDefault()
 @property (nonatomic, strong) OPTLYDataStore *dataStore;
-@property (nonatomic, strong) NSTimer *timer;
+@property (atomic, strong) OPTLYTimer *timer;
 @property (nonatomic, strong) OPTLYNetworkService *networkService;
+// keys of the events being dispatched (see dispatchKeyForEvent:eventType:)
 // keep this thread safe by performing actions in dispatchEventQueue
-@property (nonatomic, strong) NSMutableSet *pendingDispatchEvents;
+@property (nonatomic, strong) NSMutableSet<NSString *> *pendingDispatchEvents;
 @property (nonatomic, assign) NSInteger flushEventAttempts;
 @end
 
@@ -68,6 +83,20 @@ const NSInteger OPTLYEventDispatcherDefaultMaxNumberOfEventsToSave = 1000;
         if (builder.maxNumberOfEventsToSave > 0) {
             _maxNumberOfEventsToSave = builder.maxNumberOfEventsToSave;
         }
+        _maxTotalNumberOfEventsToSave = builder.maxTotalNumberOfEventsToSave > 0 ? builder.maxTotalNumberOfEventsToSave : 2 * _maxNumberOfEventsToSave;
+        _maxImpressionEventBytesToSave = builder.maxImpressionEventBytesToSave > 0 ? builder.maxImpressionEventBytesToSave : OPTLYEventDispatcherDefaultMaxImpressionEventBytesToSave;
+        _maxConversionEventBytesToSave = builder.maxConversionEventBytesToSave > 0 ? builder.maxConversionEventBytesToSave : OPTLYEventDispatcherDefaultMaxConversionEventBytesToSave;
+        _maxImpressionEventAge = builder.maxImpressionEventAge > 0 ? builder.maxImpressionEventAge : OPTLYEventDispatcherDefaultMaxImpressionEventAge_s;
+        _maxConversionEventAge = builder.maxConversionEventAge > 0 ? builder.maxConversionEventAge : OPTLYEventDispatcherDefaultMaxConversionEventAge_s;
+        _eventCompressionEnabled = builder.eventCompressionEnabled;
+        _eventCompressionThreshold = OPTLYHTTPRequestManagerDefaultCompressionThreshold;
+        if (builder.eventCompressionThreshold > 0) {
+            _eventCompressionThreshold = builder.eventCompressionThreshold;
+        }
+        _maxConcurrentEventUploads = OPTLYNetworkServiceDefaultMaxConcurrentEventUploads;
+        if (builder.maxConcurrentEventUploads > 0) {
+            _maxConcurrentEventUploads = builder.maxConcurrentEventUploads;
+        }
         
         if (builder.eventDispatcherDispatchInterval >= 0) {
             _eventDispatcherDispatchInterval = builder.eventDispatcherDispatchInterval;
@@ -119,6 +148,9 @@ dispatch_queue_t dispatchEventQueue()
 - (OPTLYNetworkService *)networkService {
     if (!_networkService) {
         _networkService = [OPTLYNetworkService new];
+        _networkService.eventCompressionEnabled = _eventCompressionEnabled;
+        _networkService.eventCompressionThreshold = _eventCompressionThreshold;
+        _networkService.maxConcurrentEventUploads = _maxConcurrentEventUploads;
     }
     return _networkService;
 }
@@ -128,36 +160,45 @@ dispatch_queue_t dispatchEventQueue()
         _dataStore = [OPTLYDataStore dataStore];
         _dataStore.logger = _logger;
         _dataStore.maxNumberOfEventsToSave = _maxNumberOfEventsToSave;
+        _dataStore.maxTotalNumberOfEventsToSave = _maxTotalNumberOfEventsToSave;
+        _dataStore.evictImpressionEventsFirst = YES;
+        [_dataStore setMaxBytesToSave:_maxImpressionEventBytesToSave
+                               maxAge:_maxImpressionEventAge
+                            eventType:OPTLYDataStoreEventTypeImpression];
+        [_dataStore setMaxBytesToSave:_maxConversionEventBytesToSave
+                               maxAge:_maxConversionEventAge
+                            eventType:OPTLYDataStoreEventTypeConversion];
     }
     return _dataStore;
 }
 
 # pragma mark - Network Timer
 // Set up the network timer when saved events are detected
-// The timer must be dispatched on the main thread.
+// The timer fires on its own background queue, so no run loop is needed.
 - (void)setupNetworkTimer:(void(^)(void))completion
 {
+    if (self.eventDispatcherDispatchInterval <= 0) {
+        return;
+    }
+    
+    uint64_t startTime = [OPTLYStartupReport startTime];
     __weak typeof(self) weakSelf = self;
-    dispatch_block_t block = ^{
-        typeof(self) strongSelf = weakSelf;
-        if (!strongSelf) return;
-        if (strongSelf.eventDispatcherDispatchInterval > 0) {
-            strongSelf.timer = [NSTimer scheduledTimerWithTimeInterval:self.eventDispatcherDispatchInterval
-                                                                target:self
-                                                              selector:@selector(flushEvents)
-                                                              userInfo:nil
-                                                               repeats:YES];
-            NSString *logMessage =  [NSString stringWithFormat: OPTLYLoggerMessagesEventDispatcherNetworkTimerEnabled, weakSelf.eventDispatcherDispatchInterval];
-            [strongSelf->_logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
-            if (completion) {
-                completion();
-            }
-        }
-    };
-    if ([NSThread isMainThread]) {
-        block();
-    } else {
-        dispatch_async(dispatch_get_main_queue(), block);
+    OPTLYTimer *timer = [[OPTLYTimer alloc] initWithName:@"eventDispatcher"
+                                            timeInterval:self.eventDispatcherDispatchInterval
+                                               tolerance:-1
+                                                 handler:^{
+                                                     [weakSelf flushEvents];
+                                                 }];
+    @synchronized (self) {
+        [self.timer invalidate];
+        self.timer = timer;
+        [timer resume];
+    }
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseTimerSetup since:startTime];
+    NSString *logMessage =  [NSString stringWithFormat: OPTLYLoggerMessagesEventDispatcherNetworkTimerEnabled, self.eventDispatcherDispatchInterval];
+    [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
+    if (completion) {
+        completion();
     }
 }
 
@@ -169,8 +210,10 @@ dispatch_queue_t dispatchEventQueue()
         return;
     }
     
-    [self.timer invalidate];
-    self.timer = nil;
+    @synchronized (self) {
+        [self.timer invalidate];
+        self.timer = nil;
+    }
     
     [self.logger logMessage:OPTLYLoggerMessagesEventDispatcherNetworkTimerDisabled withLevel:OptimizelyLogLevelDebug];
 }
@@ -225,12 +268,49 @@ dispatch_queue_t dispatchEventQueue()
 
 // A saved event has entityId and json in its dictionary so that it can be deleted by entityId
 - (bool)isSavedEvent:(nonnull NSDictionary *)event {
-    return event[@"json"] != nil;
+    return ![event isKindOfClass:[OPTLYEventPayload class]] && event[@"json"] != nil;
 }
 // It is an old single point event if it contains clientEngine. So, send it to the appropriate endpoint.
 // This may not be necessary but just in case there are some old events in the queue.
 - (bool)isOldEvent:(nonnull NSDictionary *)event {
-    return [self isSavedEvent:event] && event[@"json"][@"clientEngine"] != nil;
+    // payloads are only written by the current event builder; don't decode them to find out
+    if (![self isSavedEvent:event] || [event[@"json"] isKindOfClass:[OPTLYEventPayload class]]) {
+        return NO;
+    }
+    return event[@"json"][@"clientEngine"] != nil;
+}
+
+// Saved events are identified by their event type and row id, so the check doesn't hash or compare payloads.
+// Events that could not be saved have no id and are not tracked.
+- (nullable NSString *)dispatchKeyForEvent:(nonnull NSDictionary *)event
+                                 eventType:(OPTLYDataStoreEventType)eventType {
+    if (![self isSavedEvent:event]) {
+        return nil;
+    }
+    id entityId = event[@"entityId"];
+    if (![entityId isKindOfClass:[NSNumber class]]) {
+        return nil;
+    }
+    return [NSString stringWithFormat:@"%lu:%lld", (unsigned long)eventType, [entityId longLongValue]];
+}
+
+// Returns NO if an event with the key is already being dispatched. Must be called on dispatchEventQueue.
+- (BOOL)beginDispatchOfEventWithKey:(nullable NSString *)dispatchKey {
+    if (!dispatchKey) {
+        return YES;
+    }
+    if ([self.pendingDispatchEvents containsObject:dispatchKey]) {
+        return NO;
+    }
+    [self.pendingDispatchEvents addObject:dispatchKey];
+    return YES;
+}
+
+// Must be called on dispatchEventQueue.
+- (void)endDispatchOfEventWithKey:(nullable NSString *)dispatchKey {
+    if (dispatchKey) {
+        [self.pendingDispatchEvents removeObject:dispatchKey];
+    }
 }
 
 - (void)dispatchEvent:(nonnull NSDictionary *)event
@@ -246,13 +326,13 @@ dispatch_queue_t dispatchEventQueue()
     dispatch_async(dispatchEventQueue(), ^{
         
         // prevent the same event from getting dispatched multiple times
-        if ([self.pendingDispatchEvents containsObject:event]) {
-            logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherPendingEvent, event];
+        NSString *dispatchKey = [self dispatchKeyForEvent:event eventType:eventType];
+        if (![self beginDispatchOfEventWithKey:dispatchKey]) {
+            logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherPendingEvent, dispatchKey];
             [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
             return;
-        } else {
-            [self.pendingDispatchEvents addObject:event];
         }
+        [OPTLYMetrics setGauge:OPTLYMetricGaugeInFlightEvents value:self.pendingDispatchEvents.count];
         
         NSURL *url = [self isOldEvent:event] ? [self oldURLForEvent:eventType] : [self URLForEvent:eventType];
 
@@ -261,6 +341,7 @@ dispatch_queue_t dispatchEventQueue()
         __weak typeof(self) weakSelf = self;
         [self.networkService dispatchEvent:eventToSend
                               backoffRetry:backoffRetry
+                                  priority:[self priorityForEventType:eventType]
                                      toURL:url
                          completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
                             dispatch_async(dispatchEventQueue(), ^{
@@ -269,10 +350,13 @@ dispatch_queue_t dispatchEventQueue()
                                      NSError *removeEventError = nil;
                                      [weakSelf.dataStore removeEvent:event eventType:eventType error:&removeEventError];
                                      logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherRemovedEvent, eventName, event, removeEventError];
+                                     [OPTLYMetrics incrementCounter:OPTLYMetricCounterEventsDispatched by:1];
                                  } else {
                                      logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherDispatchFailed, eventName, error];
+                                     [OPTLYMetrics incrementCounter:OPTLYMetricCounterEventDispatchFailures by:1];
                                  }
-                                 [weakSelf.pendingDispatchEvents removeObject:event];
+                                 [weakSelf endDispatchOfEventWithKey:dispatchKey];
+                                 [OPTLYMetrics setGauge:OPTLYMetricGaugeInFlightEvents value:weakSelf.pendingDispatchEvents.count];
                                  [weakSelf.logger logMessage:logMessage withLevel:OptimizelyLogLevelDebug];
                                  if (callback) {
                                      callback(data, response, error);
@@ -308,6 +392,7 @@ dispatch_queue_t dispatchEventQueue()
         if ([self numberOfEvents] == 0) {
             [self.logger logMessage:OPTLYLoggerMessagesEventDispatcherFlushEventsNoEvents withLevel:OptimizelyLogLevelDebug];
             self.flushEventAttempts = 0;
+            [OPTLYMetrics setGauge:OPTLYMetricGaugeSavedEvents value:0];
             [self disableNetworkTimer];
             if (callback) {
                 callback();
@@ -321,20 +406,29 @@ dispatch_queue_t dispatchEventQueue()
         }
         
         self.flushEventAttempts++;
+        [OPTLYMetrics incrementCounter:OPTLYMetricCounterFlushes by:1];
+        if (OPTLYMetrics.enabled) {
+            [OPTLYMetrics setGauge:OPTLYMetricGaugeSavedEvents value:[self numberOfEvents]];
+        }
         
         // ---- For Testing ----
         // call the completion block when all impression and conversion events have returned
         // TODO: Wrap in TEST preprocessor
+        // conversions drain first; impressions take the capacity the conversions leave
         if (callback) {
             
             dispatch_group_t dispatchEventsGroup = dispatch_group_create();
             dispatch_group_enter(dispatchEventsGroup);
-            [self flushSavedEvents:OPTLYDataStoreEventTypeImpression callback:^{
+            NSInteger numberOfConversionEvents = [self flushSavedEvents:OPTLYDataStoreEventTypeConversion
+                                                      maxNumberOfEvents:OPTLYEventDispatcherMaxFlushEventCapacity
+                                                               callback:^{
                 dispatch_group_leave(dispatchEventsGroup);
             }];
             
             dispatch_group_enter(dispatchEventsGroup);
-            [self flushSavedEvents:OPTLYDataStoreEventTypeConversion callback:^{
+            [self flushSavedEvents:OPTLYDataStoreEventTypeImpression
+                 maxNumberOfEvents:OPTLYEventDispatcherMaxFlushEventCapacity - numberOfConversionEvents
+                          callback:^{
                 dispatch_group_leave(dispatchEventsGroup);
             }];
             
@@ -344,27 +438,42 @@ dispatch_queue_t dispatchEventQueue()
             return;
         }
         
-        [self flushSavedEvents:OPTLYDataStoreEventTypeImpression callback:nil];
-        [self flushSavedEvents:OPTLYDataStoreEventTypeConversion callback:nil];
+        NSInteger numberOfConversionEvents = [self flushSavedEvents:OPTLYDataStoreEventTypeConversion
+                                                  maxNumberOfEvents:OPTLYEventDispatcherMaxFlushEventCapacity
+                                                           callback:nil];
+        [self flushSavedEvents:OPTLYDataStoreEventTypeImpression
+             maxNumberOfEvents:OPTLYEventDispatcherMaxFlushEventCapacity - numberOfConversionEvents
+                      callback:nil];
         
     });
 }
 
-// The completion block is called when all dispatch event complete
 - (void)flushSavedEvents:(OPTLYDataStoreEventType)eventType callback:(void(^)(void))callback
+{
+    [self flushSavedEvents:eventType maxNumberOfEvents:OPTLYEventDispatcherMaxDispatchEventBatchSize callback:callback];
+}
+
+// Dispatches up to maxNumberOfEvents of the oldest saved events and returns how many were dispatched.
+// The completion block is called when all dispatch event complete
+- (NSInteger)flushSavedEvents:(OPTLYDataStoreEventType)eventType
+            maxNumberOfEvents:(NSInteger)maxNumberOfEvents
+                     callback:(void(^)(void))callback
 {
     NSString *eventName = [OPTLYDataStore stringForDataEventEnum:eventType];
     NSError *error = nil;
-    NSArray *events = [self.dataStore getFirstNEvents:OPTLYEventDispatcherMaxDispatchEventBatchSize
-                                            eventType:eventType
-                                                error:&error];
+    NSArray *events = nil;
+    if (maxNumberOfEvents > 0) {
+        events = [self.dataStore getFirstNEvents:maxNumberOfEvents
+                                       eventType:eventType
+                                           error:&error];
+    }
     NSInteger numberOfEvents = [events count];
     
     if (error) {
         if (callback) {
             callback();
         }
-        return;
+        return 0;
     }
     
     NSString *logMessage = @"";
@@ -374,7 +483,7 @@ dispatch_queue_t dispatchEventQueue()
         if (callback) {
             callback();
         }
-        return;
+        return 0;
     }
     
     logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesEventDispatcherFlushingSavedEvents, eventName, numberOfEvents];
@@ -398,7 +507,7 @@ dispatch_queue_t dispatchEventQueue()
         
         dispatch_group_wait(dispatchEventGroup, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(3.0 * NSEC_PER_SEC)));
         callback();
-        return;
+        return numberOfEvents;
     }
     
     // This will be batched in the near future...
@@ -406,6 +515,7 @@ dispatch_queue_t dispatchEventQueue()
         NSDictionary *event = events[i];
         [self dispatchEvent:event backoffRetry:YES eventType:eventType callback:nil];
     }
+    return numberOfEvents;
 }
 
 #pragma mark - Application Lifecycle Handlers
@@ -450,6 +560,7 @@ dispatch_queue_t dispatchEventQueue()
 }
 
 - (void)applicationDidBecomeActive:(id)notificaton {
+    [self.timer resume];
     [self flushEvents];
     OPTLYLogInfo(@"applicationDidBecomeActive");
 }
@@ -457,6 +568,8 @@ dispatch_queue_t dispatchEventQueue()
 - (void)applicationDidEnterBackground:(id)notification {
     // flush events is not guaranteed to finish before the app is suspended
     [self flushEvents];
+    // don't wake up in the background; the timer restarts when the app becomes active
+    [self.timer suspend];
     OPTLYLogInfo(@"applicationDidEnterBackground");
 }
 
@@ -475,6 +588,33 @@ dispatch_queue_t dispatchEventQueue()
 
 - (void)dealloc {
     [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [_timer invalidate];
+}
+
+# pragma mark - Priority Lanes
+// Conversions carry revenue, so they are uploaded ahead of impressions when upload slots are scarce.
+- (OPTLYRequestPriority)priorityForEventType:(OPTLYDataStoreEventType)eventType
+{
+    return eventType == OPTLYDataStoreEventTypeConversion ? OPTLYRequestPriorityHigh : OPTLYRequestPriorityLow;
+}
+
+- (NSInteger)numberOfSavedEvents:(OPTLYDataStoreEventType)eventType
+{
+    return [self numberOfEvents:eventType];
+}
+
+- (NSInteger)numberOfInFlightEvents:(OPTLYDataStoreEventType)eventType
+{
+    NSString *prefix = [NSString stringWithFormat:@"%lu:", (unsigned long)eventType];
+    __block NSInteger numberOfEvents = 0;
+    dispatch_sync(dispatchEventQueue(), ^{
+        for (NSString *dispatchKey in self.pendingDispatchEvents) {
+            if ([dispatchKey hasPrefix:prefix]) {
+                numberOfEvents++;
+            }
+        }
+    });
+    return numberOfEvents;
 }
 
 # pragma mark - Helper Methods
@@ -44,7 +44,24 @@ typedef void (^OPTLYEventDispatcherBuilderBlock)(OPTLYEventDispatcherBuilder * _
 @property (nonatomic, assign, readwrite) NSInteger eventDispatcherDispatchInterval;
 /// Max number of events to store before overwriting older events (value must be greater than 1)
 @property (nonatomic, assign) NSInteger maxNumberOfEventsToSave;
+/// Max number of impression and conversion events to store together; the oldest impression events make room for
+/// conversion events over it (value must be greater than 0; defaults to 2 * maxNumberOfEventsToSave)
+@property (nonatomic, assign) NSInteger maxTotalNumberOfEventsToSave;
+/// Max total size (in bytes) of saved impression events before the oldest are dropped (value must be greater than 0)
+@property (nonatomic, assign) NSInteger maxImpressionEventBytesToSave;
+/// Max total size (in bytes) of saved conversion events before the oldest are dropped (value must be greater than 0)
+@property (nonatomic, assign) NSInteger maxConversionEventBytesToSave;
+/// Max age (in s) of saved impression events before they are dropped (value must be greater than 0)
+@property (nonatomic, assign) NSTimeInterval maxImpressionEventAge;
+/// Max age (in s) of saved conversion events before they are dropped (value must be greater than 0)
+@property (nonatomic, assign) NSTimeInterval maxConversionEventAge;
 /// Logger provided by the user
 @property (nonatomic, strong, nullable) id<OPTLYLogger> logger;
+/// If YES, events are sent gzip compressed (Content-Encoding: gzip) once they reach eventCompressionThreshold
+@property (nonatomic, assign) BOOL eventCompressionEnabled;
+/// The minimum encoded event size (in bytes) to compress (value must be greater than 0; defaults to OPTLYHTTPRequestManagerDefaultCompressionThreshold)
+@property (nonatomic, assign) NSInteger eventCompressionThreshold;
+/// The maximum number of event uploads in flight (value must be greater than 0; defaults to OPTLYNetworkServiceDefaultMaxConcurrentEventUploads)
+@property (nonatomic, assign) NSInteger maxConcurrentEventUploads;
 
 @end
@@ -16,22 +16,30 @@
 #import <XCTest/XCTest.h>
 #import <OCMock/OCMock.h>
 #import <OHHTTPStubs/OHHTTPStubs.h>
+#import <OptimizelySDKCore/OPTLYTimer.h>
 #import <OptimizelySDKShared/OptimizelySDKShared.h>
 #import "OPTLYEventDispatcher.h"
 #import "OPTLYEventDispatcherBuilder.h"
 
 static NSInteger const kEventHandlerDispatchInterval = 3;
 static NSString * const kTestURLString = @"testURL";
+static NSUInteger const kPendingEventsBenchmarkCount = 1000;
 
 typedef void (^EventDispatchCallback)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error);
 
 @interface OPTLYEventDispatcherDefault(test)
 @property (nonatomic, strong) OPTLYDataStore *dataStore;
-@property (nonatomic, strong) NSTimer *timer;
+@property (nonatomic, strong) OPTLYNetworkService *networkService;
+@property (atomic, strong) OPTLYTimer *timer;
 @property (nonatomic, assign) NSInteger flushEventAttempts;
+@property (nonatomic, strong) NSMutableSet<NSString *> *pendingDispatchEvents;
+- (nullable NSString *)dispatchKeyForEvent:(nonnull NSDictionary *)event eventType:(OPTLYDataStoreEventType)eventType;
+- (BOOL)beginDispatchOfEventWithKey:(nullable NSString *)dispatchKey;
+- (void)endDispatchOfEventWithKey:(nullable NSString *)dispatchKey;
 - (NSURL *)URLForEvent:(OPTLYDataStoreEventType)eventType;
 - (void)flushEvents:(void(^)(void))callback;
 - (void)flushSavedEvents:(OPTLYDataStoreEventType)eventType callback:(void(^)(void))callback;
+- (OPTLYRequestPriority)priorityForEventType:(OPTLYDataStoreEventType)eventType;
 - (void)dispatchEvent:(nonnull NSDictionary *)params
          backoffRetry:(BOOL)backoffRetry
             eventType:(OPTLYDataStoreEventType)eventType
@@ -43,9 +51,17 @@ typedef void (^EventDispatchCallback)(NSData * _Nullable data, NSURLResponse * _
 - (BOOL)isTimerEnabled;
 - (void)setupNetworkTimer:(void(^)(void))completion;
 - (void)disableNetworkTimer;
+- (void)applicationDidEnterBackground:(id)notification;
 - (NSInteger )numberOfEvents:(OPTLYDataStoreEventType)eventType;
 @end
 
+@interface OPTLYDataStore(test)
+- (BOOL)saveEvent:(nonnull NSDictionary *)data
+        eventType:(OPTLYDataStoreEventType)eventType
+            error:(NSError * _Nullable __autoreleasing * _Nullable)error
+       completion:(void(^)(void))completion;
+@end
+
 @interface OPTLYEventDispatcherTest : XCTestCase
 @property (nonatomic, strong ) NSURL *testURL;
 @property (nonatomic, strong) NSDictionary *parameters;
@@ -91,11 +107,65 @@ typedef void (^EventDispatchCallback)(NSData * _Nullable data, NSURLResponse * _
     XCTAssertNil(eventDispatcher.logger);
 }
 
+- (void)testEventDispatcherInitWithEventCompression
+{
+    OPTLYEventDispatcherDefault *eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.eventCompressionEnabled = YES;
+        builder.eventCompressionThreshold = 256;
+    }]];
+    XCTAssertTrue(eventDispatcher.eventCompressionEnabled);
+    XCTAssertEqual(eventDispatcher.eventCompressionThreshold, 256);
+    XCTAssertTrue(eventDispatcher.networkService.eventCompressionEnabled);
+    XCTAssertEqual(eventDispatcher.networkService.eventCompressionThreshold, 256);
+    
+    // compression is off by default and an invalid threshold falls back to the default
+    eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.eventCompressionThreshold = -1;
+    }]];
+    XCTAssertFalse(eventDispatcher.eventCompressionEnabled);
+    XCTAssertEqual(eventDispatcher.eventCompressionThreshold, OPTLYHTTPRequestManagerDefaultCompressionThreshold);
+    XCTAssertFalse(eventDispatcher.networkService.eventCompressionEnabled);
+}
+
+- (void)testEventDispatcherInitWithMaxConcurrentEventUploads
+{
+    OPTLYEventDispatcherDefault *eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.maxConcurrentEventUploads = 1;
+    }]];
+    XCTAssertEqual(eventDispatcher.maxConcurrentEventUploads, 1);
+    XCTAssertEqual(eventDispatcher.networkService.maxConcurrentEventUploads, 1);
+    
+    eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.maxConcurrentEventUploads = 0;
+    }]];
+    XCTAssertEqual(eventDispatcher.maxConcurrentEventUploads, OPTLYNetworkServiceDefaultMaxConcurrentEventUploads);
+    XCTAssertEqual(eventDispatcher.networkService.maxConcurrentEventUploads, OPTLYNetworkServiceDefaultMaxConcurrentEventUploads);
+}
+
 #pragma mark - dispatchImpressionEvent and dispatchConversionEvent Test Scenarios
 
 // Test that a successful dispatch:
 //  - no events are persisted
 //  - flushEvents is called
+- (void)testEventDispatcherInitWithRetentionLimits
+{
+    OPTLYEventDispatcherDefault *eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.maxConversionEventBytesToSave = 2048;
+        builder.maxImpressionEventAge = 60;
+    }]];
+    XCTAssertEqual(eventDispatcher.maxImpressionEventBytesToSave, OPTLYEventDispatcherDefaultMaxImpressionEventBytesToSave);
+    XCTAssertEqual(eventDispatcher.maxConversionEventBytesToSave, 2048);
+    XCTAssertEqual(eventDispatcher.maxImpressionEventAge, 60);
+    XCTAssertEqual(eventDispatcher.maxConversionEventAge, OPTLYEventDispatcherDefaultMaxConversionEventAge_s);
+    
+    // the limits are applied to the data store per event type
+    OPTLYDataStore *dataStore = eventDispatcher.dataStore;
+    XCTAssertEqual([dataStore maxBytesToSave:OPTLYDataStoreEventTypeImpression], OPTLYEventDispatcherDefaultMaxImpressionEventBytesToSave);
+    XCTAssertEqual([dataStore maxBytesToSave:OPTLYDataStoreEventTypeConversion], 2048);
+    XCTAssertEqual([dataStore maxAgeOfEvents:OPTLYDataStoreEventTypeImpression], 60);
+    XCTAssertEqual([dataStore maxAgeOfEvents:OPTLYDataStoreEventTypeConversion], OPTLYEventDispatcherDefaultMaxConversionEventAge_s);
+}
+
 - (void)testDispatchImpressionEventSuccess {
     [self stubSuccessResponse];
     
@@ -429,9 +499,224 @@ typedef void (^EventDispatchCallback)(NSData * _Nullable data, NSURLResponse * _
     
     // make sure that the max value is set properly
     XCTAssert(eventDispatcher.maxNumberOfEventsToSave == maxNumberEvents, @"Invalid number of max events set: %lu", eventDispatcher.maxNumberOfEventsToSave);
+    // both event types keep their own room by default
+    XCTAssertEqual(eventDispatcher.maxTotalNumberOfEventsToSave, 2 * maxNumberEvents);
+    XCTAssertEqual(eventDispatcher.dataStore.maxTotalNumberOfEventsToSave, 2 * maxNumberEvents);
+}
+
+// the timer stops waking the app in the background
+- (void)testNetworkTimerIsSuspendedInBackground
+{
+    OPTLYEventDispatcherDefault *eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.eventDispatcherDispatchInterval = kEventHandlerDispatchInterval;
+    }]];
+    [eventDispatcher setupNetworkTimer:nil];
+    [self checkNetworkTimerIsEnabled:eventDispatcher timeInterval:kEventHandlerDispatchInterval];
+    OPTLYTimer *timer = eventDispatcher.timer;
+    XCTAssertFalse(timer.suspended);
+    
+    // the flush may disable the timer afterwards, but it never fires again in the background
+    [eventDispatcher applicationDidEnterBackground:nil];
+    XCTAssertTrue(timer.suspended);
+}
+
+// unlike NSTimer, a running timer does not keep the dispatcher alive
+- (void)testNetworkTimerDoesNotRetainDispatcher
+{
+    __weak OPTLYEventDispatcherDefault *weakEventDispatcher = nil;
+    @autoreleasepool {
+        OPTLYEventDispatcherDefault *eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+            builder.eventDispatcherDispatchInterval = kEventHandlerDispatchInterval;
+        }]];
+        [eventDispatcher setupNetworkTimer:nil];
+        weakEventDispatcher = eventDispatcher;
+    }
+    XCTAssertNil(weakEventDispatcher);
+}
+
+#pragma mark - Priority Lanes
+
+- (void)testConversionEventsHaveUploadPriority
+{
+    XCTAssertGreaterThan([self.eventDispatcher priorityForEventType:OPTLYDataStoreEventTypeConversion],
+                         [self.eventDispatcher priorityForEventType:OPTLYDataStoreEventTypeImpression]);
+}
+
+// conversions drain first; impressions only get the flush capacity the conversions leave
+- (void)testFlushEventsDrainsConversionsFirst
+{
+    [self stubSuccessResponse];
+    
+    NSInteger numberOfEventsOverCapacity = 5;
+    for (NSInteger i = 0; i < OPTLYEventDispatcherMaxFlushEventCapacity + numberOfEventsOverCapacity; ++i) {
+        [self.eventDispatcher.dataStore saveEvent:self.parameters
+                                        eventType:OPTLYDataStoreEventTypeConversion
+                                            error:nil];
+    }
+    for (NSInteger i = 0; i < numberOfEventsOverCapacity; ++i) {
+        [self.eventDispatcher.dataStore saveEvent:self.parameters
+                                        eventType:OPTLYDataStoreEventTypeImpression
+                                            error:nil];
+    }
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for testFlushEventsDrainsConversionsFirst."];
+    __weak typeof(self) weakSelf = self;
+    [self.eventDispatcher flushEvents:^{
+        XCTAssertEqual([weakSelf.eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeConversion], numberOfEventsOverCapacity);
+        XCTAssertEqual([weakSelf.eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeImpression], numberOfEventsOverCapacity);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithTimeout:10.0 handler:nil];
+}
+
+// conversions evict impressions from the room both lanes share, but not past their own max
+- (void)testConversionOverflowEvictsImpressionsFirst
+{
+    NSInteger maxNumberEvents = 10;
+    OPTLYEventDispatcherDefault *eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.maxNumberOfEventsToSave = maxNumberEvents;
+        builder.maxTotalNumberOfEventsToSave = maxNumberEvents;
+    }]];
+    OPTLYDataStore *dataStore = eventDispatcher.dataStore;
+    XCTAssertTrue(dataStore.evictImpressionEventsFirst);
+    XCTAssertEqual(dataStore.maxTotalNumberOfEventsToSave, maxNumberEvents);
+    [dataStore removeAll:nil];
+    
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression dataStore:dataStore];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression dataStore:dataStore];
+    for (NSInteger i = 0; i < maxNumberEvents - 2; ++i) {
+        [self saveEventAndWait:OPTLYDataStoreEventTypeConversion dataStore:dataStore];
+    }
+    XCTAssertEqual([eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeImpression], 2);
+    XCTAssertEqual([eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeConversion], maxNumberEvents - 2);
+    
+    // the next conversion only evicts the one impression over the shared room
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion dataStore:dataStore];
+    XCTAssertEqual([eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeImpression], 1);
+    XCTAssertEqual([eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeConversion], maxNumberEvents - 1);
+    
+    // once the conversion lane is full, its own oldest events are removed
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion dataStore:dataStore];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion dataStore:dataStore];
+    XCTAssertEqual([eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeImpression], 0);
+    XCTAssertEqual([eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeConversion], maxNumberEvents - 1);
+    XCTAssertEqual([dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeImpression reason:OPTLYDataStoreEventDropReasonOverflow], 2);
+    XCTAssertEqual([dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeConversion reason:OPTLYDataStoreEventDropReasonOverflow], 2);
+    [dataStore removeAll:nil];
+}
+
+- (void)saveEventAndWait:(OPTLYDataStoreEventType)eventType dataStore:(OPTLYDataStore *)dataStore
+{
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Wait for the events to be trimmed."];
+    [dataStore saveEvent:self.parameters eventType:eventType error:nil completion:^{
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:3.0 handler:nil];
+}
+
+- (void)testNumberOfInFlightEventsPerLane
+{
+    NSString *dispatchKey = [self.eventDispatcher dispatchKeyForEvent:@{ @"entityId" : @1, @"json" : self.parameters }
+                                                            eventType:OPTLYDataStoreEventTypeConversion];
+    XCTAssertEqual([self.eventDispatcher numberOfInFlightEvents:OPTLYDataStoreEventTypeConversion], 0);
+    [self.eventDispatcher beginDispatchOfEventWithKey:dispatchKey];
+    XCTAssertEqual([self.eventDispatcher numberOfInFlightEvents:OPTLYDataStoreEventTypeConversion], 1);
+    XCTAssertEqual([self.eventDispatcher numberOfInFlightEvents:OPTLYDataStoreEventTypeImpression], 0);
+    [self.eventDispatcher endDispatchOfEventWithKey:dispatchKey];
+    XCTAssertEqual([self.eventDispatcher numberOfInFlightEvents:OPTLYDataStoreEventTypeConversion], 0);
+}
+
+#pragma mark - In-flight Event Tracking
+
+- (void)testDispatchKeyForEvent
+{
+    NSDictionary *savedEvent = @{ @"entityId" : @12, @"json" : self.parameters };
+    NSString *impressionKey = [self.eventDispatcher dispatchKeyForEvent:savedEvent eventType:OPTLYDataStoreEventTypeImpression];
+    NSString *conversionKey = [self.eventDispatcher dispatchKeyForEvent:savedEvent eventType:OPTLYDataStoreEventTypeConversion];
+    XCTAssertNotNil(impressionKey);
+    XCTAssertNotEqualObjects(impressionKey, conversionKey, @"Row ids are per event type.");
+    
+    // the key only depends on the row id, not on the payload
+    NSDictionary *sameRow = @{ @"entityId" : @12, @"json" : @{ @"other" : @"payload" } };
+    XCTAssertEqualObjects([self.eventDispatcher dispatchKeyForEvent:sameRow eventType:OPTLYDataStoreEventTypeImpression], impressionKey);
+    
+    // events that were not saved are not tracked
+    XCTAssertNil([self.eventDispatcher dispatchKeyForEvent:self.parameters eventType:OPTLYDataStoreEventTypeImpression]);
+}
+
+- (void)testPendingEventIsNotDispatchedTwice
+{
+    NSString *dispatchKey = [self.eventDispatcher dispatchKeyForEvent:@{ @"entityId" : @1, @"json" : self.parameters }
+                                                            eventType:OPTLYDataStoreEventTypeImpression];
+    XCTAssertTrue([self.eventDispatcher beginDispatchOfEventWithKey:dispatchKey]);
+    XCTAssertFalse([self.eventDispatcher beginDispatchOfEventWithKey:dispatchKey]);
+    [self.eventDispatcher endDispatchOfEventWithKey:dispatchKey];
+    XCTAssertTrue([self.eventDispatcher beginDispatchOfEventWithKey:dispatchKey]);
+    
+    XCTAssertTrue([self.eventDispatcher beginDispatchOfEventWithKey:nil]);
+    XCTAssertTrue([self.eventDispatcher beginDispatchOfEventWithKey:nil]);
+    XCTAssertEqual(self.eventDispatcher.pendingDispatchEvents.count, 1);
+}
+
+// Tracks kPendingEventsBenchmarkCount pending events: add, duplicate check and remove.
+- (void)testPendingEventTrackingPerformance
+{
+    NSArray *events = [self pendingEventsForBenchmark];
+    OPTLYEventDispatcherDefault *eventDispatcher = self.eventDispatcher;
+    [self measureBlock:^{
+        for (NSDictionary *event in events) {
+            [eventDispatcher beginDispatchOfEventWithKey:[eventDispatcher dispatchKeyForEvent:event eventType:OPTLYDataStoreEventTypeImpression]];
+        }
+        for (NSDictionary *event in events) {
+            XCTAssertFalse([eventDispatcher beginDispatchOfEventWithKey:[eventDispatcher dispatchKeyForEvent:event eventType:OPTLYDataStoreEventTypeImpression]]);
+        }
+        for (NSDictionary *event in events) {
+            [eventDispatcher endDispatchOfEventWithKey:[eventDispatcher dispatchKeyForEvent:event eventType:OPTLYDataStoreEventTypeImpression]];
+        }
+    }];
+    XCTAssertEqual(eventDispatcher.pendingDispatchEvents.count, 0);
+}
+
+// The same work with a set of whole event dictionaries, for comparison.
+- (void)testPendingEventTrackingPerformanceWithDictionaries
+{
+    NSArray *events = [self pendingEventsForBenchmark];
+    NSMutableSet *pendingDispatchEvents = [NSMutableSet new];
+    [self measureBlock:^{
+        for (NSDictionary *event in events) {
+            [pendingDispatchEvents addObject:event];
+        }
+        for (NSDictionary *event in events) {
+            XCTAssertTrue([pendingDispatchEvents containsObject:event]);
+        }
+        for (NSDictionary *event in events) {
+            [pendingDispatchEvents removeObject:event];
+        }
+    }];
+    XCTAssertEqual(pendingDispatchEvents.count, 0);
 }
 
 #pragma mark - Helper Methods
+// saved events shaped like the ones read back from the data store
+- (NSArray *)pendingEventsForBenchmark
+{
+    NSMutableArray *events = [[NSMutableArray alloc] initWithCapacity:kPendingEventsBenchmarkCount];
+    for (NSUInteger i = 0; i < kPendingEventsBenchmarkCount; i++) {
+        NSDictionary *json = @{ @"account_id" : @"6365361536",
+                                @"project_id" : @"6377970066",
+                                @"visitors" : @[ @{ @"visitor_id" : [NSString stringWithFormat:@"user_%lu", (unsigned long)i],
+                                                    @"attributes" : @[ @{ @"entity_id" : @"6359881003", @"key" : @"browser_type", @"type" : @"custom", @"value" : @"firefox" } ],
+                                                    @"snapshots" : @[ @{ @"decisions" : @[ @{ @"campaign_id" : @"6361100001", @"experiment_id" : @"6358043286", @"variation_id" : @"6384330451" } ],
+                                                                         @"events" : @[ @{ @"entity_id" : @"6361100001", @"key" : @"campaign_activated", @"timestamp" : @1500000000000, @"uuid" : [[NSUUID UUID] UUIDString] } ] } ] } ],
+                                @"anonymize_ip" : @YES,
+                                @"client_name" : @"objective-c-sdk",
+                                @"client_version" : @"3.1.0" };
+        [events addObject:@{ @"entityId" : @(i + 1), @"json" : json }];
+    }
+    return events;
+}
+
 - (void)checkNetworkTimerIsEnabled:(OPTLYEventDispatcherDefault *)eventDispatcher timeInterval:(NSInteger)timeInterval
 {
     // check that the timer is set correctly
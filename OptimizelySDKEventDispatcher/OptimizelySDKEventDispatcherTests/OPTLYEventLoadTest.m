@@ -0,0 +1,309 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <XCTest/XCTest.h>
+#import <OCMock/OCMock.h>
+#import <sys/resource.h>
+#import <OptimizelySDKShared/OptimizelySDKShared.h>
+#import "OPTLYDatafileGenerator.h"
+#import "OPTLYEventDispatcher.h"
+#import "OPTLYTestHTTPServer.h"
+
+// Load tests of the event pipeline (Optimizely -> OPTLYEventDispatcherDefault -> OPTLYDataStore ->
+// OPTLYHTTPRequestManager) against a local stand-in for logx. Each test drives activate and track
+// from several threads at a target rate, waits until the saved events are delivered, and logs a
+// report on one "OPTLYLoadTest {json}" line: end-to-end delivery latency, loss, duplicate
+// deliveries, requests per event, the deepest queue and the CPU and memory used.
+
+static NSUInteger const kNumberOfThreads = 4;
+static double const kEventsPerSecond = 200;
+static NSTimeInterval const kLoadDuration = 3;
+static NSTimeInterval const kDrainTimeout = 60;
+static NSTimeInterval const kDrainInterval = 0.25;
+static NSTimeInterval const kQueueSampleInterval = 0.1;
+static NSTimeInterval const kServerLatency = 0.02;
+static NSInteger const kMaxNumberOfEventsToSave = 10000;
+
+static NSString * const kReportIssuedEventsKey = @"issued_events";
+static NSString * const kReportDeliveredEventsKey = @"delivered_events";
+static NSString * const kReportLostEventsKey = @"lost_events";
+static NSString * const kReportDuplicateDeliveriesKey = @"duplicate_deliveries";
+static NSString * const kReportRequestsKey = @"requests";
+static NSString * const kReportFailedRequestsKey = @"failed_requests";
+static NSString * const kReportMaxSavedEventsKey = @"max_saved_events";
+static NSString * const kReportMaxInFlightEventsKey = @"max_in_flight_events";
+
+@interface OPTLYEventDispatcherDefault(loadTest)
+@property (nonatomic, strong) OPTLYDataStore *dataStore;
+@property (nonatomic, assign) NSInteger flushEventAttempts;
+- (NSURL *)URLForEvent:(OPTLYDataStoreEventType)eventType;
+@end
+
+@interface OPTLYEventLoadTest : XCTestCase
+@property (nonatomic, strong) OPTLYTestHTTPServer *server;
+@property (nonatomic, strong) OPTLYEventDispatcherDefault *eventDispatcher;
+@property (nonatomic, strong) OPTLYDatafileGenerator *generator;
+@property (nonatomic, strong) Optimizely *optimizely;
+// delivery bookkeeping, guarded by @synchronized(self)
+@property (nonatomic, strong) NSMutableSet<NSString *> *deliveredEventUUIDs;
+@property (nonatomic, strong) NSMutableArray<NSNumber *> *deliveryLatencies;
+@property (nonatomic, assign) NSUInteger duplicateDeliveries;
+@property (nonatomic, assign) NSUInteger issuedEvents;
+@end
+
+@implementation OPTLYEventLoadTest
+
+- (void)setUp {
+    [super setUp];
+    self.server = [OPTLYTestHTTPServer new];
+    XCTAssertTrue([self.server start]);
+    self.server.responseLatency = kServerLatency;
+    __weak typeof(self) weakSelf = self;
+    self.server.requestHandler = ^(OPTLYTestHTTPRequest *request) {
+        [weakSelf recordDeliveryOfRequest:request];
+    };
+    
+    self.eventDispatcher = [[OPTLYEventDispatcherDefault alloc] initWithBuilder:[OPTLYEventDispatcherBuilder builderWithBlock:^(OPTLYEventDispatcherBuilder * _Nullable builder) {
+        builder.maxNumberOfEventsToSave = kMaxNumberOfEventsToSave;
+    }]];
+    [self.eventDispatcher.dataStore removeAll:nil];
+    id eventDispatcherMock = OCMPartialMock(self.eventDispatcher);
+    OCMStub([[eventDispatcherMock ignoringNonObjectArgs] URLForEvent:0]).andReturn([self.server.URL URLByAppendingPathComponent:@"v1/events"]);
+    
+    self.generator = [OPTLYDatafileGenerator generatorWithBlock:^(OPTLYDatafileGenerator *generator) {
+        generator.numberOfExperiments = 10;
+        generator.numberOfFeatureFlags = 0;
+        generator.numberOfEvents = 5;
+    }];
+    NSData *datafile = [self.generator datafile];
+    OPTLYEventDispatcherDefault *eventDispatcher = self.eventDispatcher;
+    self.optimizely = [[Optimizely alloc] initWithBuilder:[OPTLYBuilder builderWithBlock:^(OPTLYBuilder * _Nullable builder) {
+        builder.datafile = datafile;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+        builder.eventDispatcher = eventDispatcher;
+    }]];
+    
+    self.deliveredEventUUIDs = [NSMutableSet new];
+    self.deliveryLatencies = [NSMutableArray new];
+    self.duplicateDeliveries = 0;
+    self.issuedEvents = 0;
+}
+
+- (void)tearDown {
+    [self.server stop];
+    self.server.requestHandler = nil;
+    [self.eventDispatcher.dataStore removeAll:nil];
+    self.optimizely = nil;
+    self.eventDispatcher = nil;
+    self.server = nil;
+    [super tearDown];
+}
+
+- (void)testLoadWithHealthyBackend {
+    NSDictionary *report = [self runLoadNamed:@"healthy_backend" during:nil];
+    XCTAssertEqualObjects(report[kReportLostEventsKey], @0);
+    XCTAssertEqualObjects(report[kReportDuplicateDeliveriesKey], @0);
+}
+
+- (void)testLoadWithFailingRequests {
+    self.server.errorRate = 0.2;
+    NSDictionary *report = [self runLoadNamed:@"failing_requests" during:nil];
+    XCTAssertEqualObjects(report[kReportLostEventsKey], @0);
+    XCTAssertGreaterThan([report[kReportFailedRequestsKey] integerValue], 0);
+}
+
+- (void)testLoadWithOutage {
+    OPTLYTestHTTPServer *server = self.server;
+    NSDictionary *report = [self runLoadNamed:@"outage" during:^{
+        // the backend is down for the middle third of the load
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLoadDuration / 3 * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            server.unavailable = YES;
+        });
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kLoadDuration * 2 / 3 * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            server.unavailable = NO;
+        });
+    }];
+    XCTAssertEqualObjects(report[kReportLostEventsKey], @0);
+    XCTAssertGreaterThan([report[kReportMaxSavedEventsKey] integerValue], 0);
+}
+
+#pragma mark - Helper Methods
+
+// Drives the load, drains the queue and returns the report.
+- (NSDictionary *)runLoadNamed:(NSString *)name during:(nullable void (^)(void))scenario {
+    struct rusage usageBefore, usageAfter;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    
+    __block NSInteger maxSavedEvents = 0;
+    __block NSInteger maxInFlightEvents = 0;
+    OPTLYEventDispatcherDefault *eventDispatcher = self.eventDispatcher;
+    dispatch_queue_t samplerQueue = dispatch_queue_create("com.Optimizely.eventLoadTest.sampler", DISPATCH_QUEUE_SERIAL);
+    dispatch_source_t sampler = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, samplerQueue);
+    dispatch_source_set_timer(sampler, DISPATCH_TIME_NOW, (uint64_t)(kQueueSampleInterval * NSEC_PER_SEC), 0);
+    dispatch_source_set_event_handler(sampler, ^{
+        NSInteger savedEvents = [eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeImpression] + [eventDispatcher numberOfSavedEvents:OPTLYDataStoreEventTypeConversion];
+        NSInteger inFlightEvents = [eventDispatcher numberOfInFlightEvents:OPTLYDataStoreEventTypeImpression] + [eventDispatcher numberOfInFlightEvents:OPTLYDataStoreEventTypeConversion];
+        maxSavedEvents = MAX(maxSavedEvents, savedEvents);
+        maxInFlightEvents = MAX(maxInFlightEvents, inFlightEvents);
+    });
+    dispatch_resume(sampler);
+    
+    if (scenario) {
+        scenario();
+    }
+    [self driveLoad];
+    [self drain];
+    
+    dispatch_source_cancel(sampler);
+    // wait for a sample in progress
+    dispatch_sync(samplerQueue, ^{});
+    getrusage(RUSAGE_SELF, &usageAfter);
+    
+    NSDictionary *report = [self reportNamed:name];
+    NSMutableDictionary *fullReport = [report mutableCopy];
+    fullReport[kReportMaxSavedEventsKey] = @(maxSavedEvents);
+    fullReport[kReportMaxInFlightEventsKey] = @(maxInFlightEvents);
+    fullReport[@"cpu_s"] = @([self secondsOfTimeval:usageAfter.ru_utime] + [self secondsOfTimeval:usageAfter.ru_stime]
+                             - [self secondsOfTimeval:usageBefore.ru_utime] - [self secondsOfTimeval:usageBefore.ru_stime]);
+    fullReport[@"max_resident_bytes"] = @(usageAfter.ru_maxrss);
+    
+    NSData *line = [NSJSONSerialization dataWithJSONObject:fullReport options:kNilOptions error:nil];
+    NSLog(@"OPTLYLoadTest %@", [[NSString alloc] initWithData:line encoding:NSUTF8StringEncoding]);
+    return fullReport;
+}
+
+// Every thread alternates activate and track at its share of kEventsPerSecond for kLoadDuration.
+- (void)driveLoad {
+    Optimizely *optimizely = self.optimizely;
+    OPTLYDatafileGenerator *generator = self.generator;
+    NSDictionary *attributes = [generator userAttributes];
+    NSTimeInterval interval = kNumberOfThreads / kEventsPerSecond;
+    NSUInteger eventsPerThread = (NSUInteger)(kLoadDuration / interval);
+    dispatch_group_t group = dispatch_group_create();
+    for (NSUInteger thread = 0; thread < kNumberOfThreads; thread++) {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            NSDate *start = [NSDate date];
+            for (NSUInteger i = 0; i < eventsPerThread; i++) {
+                @autoreleasepool {
+                    NSString *userId = [NSString stringWithFormat:@"user_%lu_%lu", (unsigned long)thread, (unsigned long)i];
+                    if (i % 2 == 0) {
+                        NSString *experimentKey = [generator experimentKeyAtIndex:i % generator.numberOfExperiments];
+                        if ([optimizely activate:experimentKey userId:userId attributes:attributes]) {
+                            [self recordIssuedEvent];
+                        }
+                    } else {
+                        [optimizely track:[generator eventKeyAtIndex:i % generator.numberOfEvents] userId:userId attributes:attributes];
+                        [self recordIssuedEvent];
+                    }
+                }
+                NSTimeInterval wait = (i + 1) * interval + [start timeIntervalSinceNow];
+                if (wait > 0) {
+                    [NSThread sleepForTimeInterval:wait];
+                }
+            }
+        });
+    }
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+}
+
+// Flushes the saved events until every issued event is delivered or kDrainTimeout passes.
+- (void)drain {
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:kDrainTimeout];
+    while ([self numberOfUndeliveredEvents] > 0 && [deadline timeIntervalSinceNow] > 0) {
+        // keep flushing after the dispatcher would give up, since the test waits for the backend to recover
+        self.eventDispatcher.flushEventAttempts = 0;
+        [self.eventDispatcher flushEvents];
+        [NSThread sleepForTimeInterval:kDrainInterval];
+    }
+}
+
+- (void)recordIssuedEvent {
+    @synchronized (self) {
+        self.issuedEvents++;
+    }
+}
+
+- (NSInteger)numberOfUndeliveredEvents {
+    @synchronized (self) {
+        return (NSInteger)self.issuedEvents - (NSInteger)self.deliveredEventUUIDs.count;
+    }
+}
+
+- (void)recordDeliveryOfRequest:(OPTLYTestHTTPRequest *)request {
+    if (request.responseStatusCode < 200 || request.responseStatusCode >= 300) {
+        return;
+    }
+    NSDictionary *payload = [NSJSONSerialization JSONObjectWithData:request.decodedBody options:kNilOptions error:nil];
+    double now_ms = [[NSDate date] timeIntervalSince1970] * 1000;
+    @synchronized (self) {
+        for (NSDictionary *visitor in payload[OPTLYEventParameterKeysVisitors]) {
+            for (NSDictionary *snapshot in visitor[OPTLYEventParameterKeysSnapshots]) {
+                for (NSDictionary *event in snapshot[OPTLYEventParameterKeysEvents]) {
+                    NSString *uuid = event[OPTLYEventParameterKeysUUID];
+                    if ([self.deliveredEventUUIDs containsObject:uuid]) {
+                        self.duplicateDeliveries++;
+                        continue;
+                    }
+                    [self.deliveredEventUUIDs addObject:uuid];
+                    [self.deliveryLatencies addObject:@(now_ms - [event[OPTLYEventParameterKeysTimestamp] doubleValue])];
+                }
+            }
+        }
+    }
+}
+
+- (NSDictionary *)reportNamed:(NSString *)name {
+    NSArray<OPTLYTestHTTPRequest *> *requests = self.server.requests;
+    NSUInteger failedRequests = 0;
+    for (OPTLYTestHTTPRequest *request in requests) {
+        if (request.responseStatusCode < 200 || request.responseStatusCode >= 300) {
+            failedRequests++;
+        }
+    }
+    @synchronized (self) {
+        NSArray *latencies = [self.deliveryLatencies sortedArrayUsingSelector:@selector(compare:)];
+        NSUInteger delivered = self.deliveredEventUUIDs.count;
+        return @{
+            @"name" : name,
+            kReportIssuedEventsKey : @(self.issuedEvents),
+            kReportDeliveredEventsKey : @(delivered),
+            kReportLostEventsKey : @(MAX((NSInteger)self.issuedEvents - (NSInteger)delivered, 0)),
+            kReportDuplicateDeliveriesKey : @(self.duplicateDeliveries),
+            kReportRequestsKey : @(requests.count),
+            kReportFailedRequestsKey : @(failedRequests),
+            @"requests_per_event" : @(delivered > 0 ? (double)requests.count / delivered : 0),
+            @"latency_p50_ms" : [self percentile:0.5 ofSortedValues:latencies],
+            @"latency_p90_ms" : [self percentile:0.9 ofSortedValues:latencies],
+            @"latency_p99_ms" : [self percentile:0.99 ofSortedValues:latencies],
+            @"latency_max_ms" : latencies.lastObject ?: @0,
+        };
+    }
+}
+
+- (NSNumber *)percentile:(double)percentile ofSortedValues:(NSArray<NSNumber *> *)values {
+    if (values.count == 0) {
+        return @0;
+    }
+    NSUInteger rank = (NSUInteger)ceil(percentile * values.count);
+    return values[MIN(MAX(rank, 1), values.count) - 1];
+}
+
+- (double)secondsOfTimeval:(struct timeval)time {
+    return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+@end
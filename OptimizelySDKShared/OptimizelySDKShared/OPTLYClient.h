@@ -28,8 +28,9 @@
  */
 @interface OPTLYClient : NSObject <Optimizely>
 
-/// Reference to the Optimizely Core instance
-@property (nonatomic, strong, readonly, nullable) Optimizely<Optimizely> *optimizely;
+/// Reference to the Optimizely Core instance.
+/// It can be replaced while the client is in use, e.g. when a background initialization finishes.
+@property (atomic, strong, readwrite, nullable) Optimizely<Optimizely> *optimizely;
 /// The Optimizely Core's logger, or if no logger a default logger
 @property (nonatomic, strong, readonly, nonnull) id<OPTLYLogger> logger;
 /// Optimizely X Mobile Default Attributes
@@ -45,6 +46,14 @@ __attribute((deprecated("Use OPTLYClient initWithBuilder method instead.")));
  */
 - (nonnull instancetype)initWithBuilder:(nullable OPTLYClientBuilder *)builder;
 
+/**
+ * Initializes a client that is not backed by an Optimizely Core instance yet.
+ * All method calls are NoOps until `optimizely` is set.
+ *
+ * @param logger The logger of the client, or nil for a default logger.
+ */
+- (nonnull instancetype)initWithLogger:(nullable id<OPTLYLogger>)logger;
+
 - (OPTLYNotificationCenter *_Nullable)notificationCenter;
 
 @end
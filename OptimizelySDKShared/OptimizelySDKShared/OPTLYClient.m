@@ -53,6 +53,14 @@
     return self;
 }
 
+- (nonnull instancetype)initWithLogger:(nullable id<OPTLYLogger>)logger {
+    self = [super init];
+    if (self) {
+        _logger = logger ?: [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelAll];
+    }
+    return self;
+}
+
 - (nullable OPTLYNotificationCenter *)notificationCenter {
     return self.optimizely.notificationCenter;
 }
@@ -78,6 +86,21 @@
     }
 }
 
+- (nonnull NSDictionary<NSString *, OPTLYVariation *> *)activateExperiments:(nonnull NSArray<NSString *> *)experimentKeys
+                                                                     userId:(nonnull NSString *)userId
+                                                                 attributes:(nullable NSDictionary<NSString *, id> *)attributes {
+    if (self.optimizely == nil) {
+        [self.logger logMessage:OPTLYLoggerMessagesClientDummyOptimizelyError
+                      withLevel:OptimizelyLogLevelError];
+        return @{};
+    }
+    else {
+        return [self.optimizely activateExperiments:experimentKeys
+                                             userId:userId
+                                         attributes:attributes];
+    }
+}
+
 #pragma mark getVariation methods
 - (nullable OPTLYVariation *)variation:(NSString *)experimentKey
                        userId:(NSString *)userId {
@@ -261,6 +284,19 @@
                  eventTags:eventTags];
 }
 
+- (void)trackEvents:(NSArray<NSDictionary<NSString *, id> *> *)events
+             userId:(NSString *)userId
+         attributes:(NSDictionary<NSString *, id> *)attributes {
+    if (self.optimizely == nil) {
+        [self.logger logMessage:OPTLYLoggerMessagesClientDummyOptimizelyError
+                      withLevel:OptimizelyLogLevelError];
+        return;
+    }
+    [self.optimizely trackEvents:events
+                          userId:userId
+                      attributes:attributes];
+}
+
 #pragma mark - description
 
 - (NSString *)description {
@@ -45,6 +45,8 @@ typedef void (^OPTLYClientBuilderBlock)(OPTLYClientBuilder * _Nonnull builder);
 @property (nonatomic, strong, nonnull) NSString *clientVersion;
 /// The client engine
 @property (nonatomic, strong, nonnull) NSString *clientEngine;
+/// Defer materializing experiments, audiences and events until they are first used. Defaults to NO.
+@property (nonatomic, assign) BOOL lazyDatafileParsing;
 
 /// Create an Optimizely Client object.
 + (nonnull instancetype)builderWithBlock:(nonnull OPTLYClientBuilderBlock)block;
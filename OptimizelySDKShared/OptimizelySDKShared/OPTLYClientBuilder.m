@@ -47,6 +47,7 @@
             builder.userProfileService = self->_userProfileService;
             builder.clientEngine = self->_clientEngine;
             builder.clientVersion = self->_clientVersion;
+            builder.lazyDatafileParsing = self->_lazyDatafileParsing;
         }]];
         _logger = _optimizely.logger;
         if (!_logger) {
@@ -40,6 +40,18 @@ typedef NS_ENUM(NSUInteger, OPTLYDataStoreEventType)
     OPTLYDataStoreEventTypeCOUNT
 };
 
+// Why saved events were removed before they could be dispatched
+typedef NS_ENUM(NSUInteger, OPTLYDataStoreEventDropReason)
+{
+    // more than maxNumberOfEventsToSave events were saved
+    OPTLYDataStoreEventDropReasonOverflow,
+    // the saved events exceeded their byte budget
+    OPTLYDataStoreEventDropReasonByteBudget,
+    // the events were older than their max age
+    OPTLYDataStoreEventDropReasonExpired,
+    OPTLYDataStoreEventDropReasonCOUNT
+};
+
 @class OPTLYFileManager;
 
 /*
@@ -53,6 +65,13 @@ typedef NS_ENUM(NSUInteger, OPTLYDataStoreEventType)
 
 /// Max number of events to store before overwriting older events
 @property (nonatomic, assign) NSInteger maxNumberOfEventsToSave;
+/// If YES, the oldest impression events are removed to keep the events of both types within maxTotalNumberOfEventsToSave
+/// (each type is still kept within maxNumberOfEventsToSave)
+@property (nonatomic, assign) BOOL evictImpressionEventsFirst;
+/// Max number of impression and conversion events to store together when evictImpressionEventsFirst is YES
+/// (defaults to 2 * maxNumberOfEventsToSave, the room both types had before, so impressions are only evicted
+/// when it is set lower)
+@property (nonatomic, assign) NSInteger maxTotalNumberOfEventsToSave;
 /// Base directory where Optimizely-related data will persist
 @property (nonatomic, strong, readonly, nonnull) NSString *baseDirectory;
 /// Optional logger for data store logging
@@ -272,6 +291,47 @@ typedef NS_ENUM(NSUInteger, OPTLYDataStoreEventType)
  */
 - (BOOL)removeAllEvents:(NSError * _Nullable __autoreleasing * _Nullable)error;
 
+/**
+ * Returns the total size of the saved events.
+ *
+ * @param eventType The event type of the data.
+ * @param error An error object is returned if an error occurs.
+ * @return The size (in bytes) of the encoded events.
+ */
+- (NSInteger)numberOfBytesOfEvents:(OPTLYDataStoreEventType)eventType
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Sets how many bytes of events of a type are kept and for how long.
+ * The limits are enforced (oldest events first) every time an event of the type is saved.
+ *
+ * @param maxBytes The max total size (in bytes) of the saved events, or 0 for no limit.
+ * @param maxAge The max age (in s) of the saved events, or 0 for no limit.
+ * @param eventType The event type the limits apply to.
+ */
+- (void)setMaxBytesToSave:(NSInteger)maxBytes
+                   maxAge:(NSTimeInterval)maxAge
+                eventType:(OPTLYDataStoreEventType)eventType;
+
+/**
+ * Returns the max total size (in bytes) of the saved events of a type, or 0 if there is no limit.
+ */
+- (NSInteger)maxBytesToSave:(OPTLYDataStoreEventType)eventType;
+
+/**
+ * Returns the max age (in s) of the saved events of a type, or 0 if there is no limit.
+ */
+- (NSTimeInterval)maxAgeOfEvents:(OPTLYDataStoreEventType)eventType;
+
+/**
+ * Returns the number of events of a type removed for a reason since the app was launched.
+ *
+ * @param eventType The event type of the data.
+ * @param reason Why the events were removed.
+ */
+- (NSInteger)numberOfDroppedEvents:(OPTLYDataStoreEventType)eventType
+                            reason:(OPTLYDataStoreEventDropReason)reason;
+
 
 // -------- User Data Storage --------
 // Saves data in dictionary format in NSUserDefault
@@ -17,9 +17,11 @@
 #ifdef UNIVERSAL
     #import "OPTLYLogger.h"
     #import "OPTLYQueue.h"
+    #import "OPTLYStartupReport.h"
 #else
     #import <OptimizelySDKCore/OPTLYLogger.h>
     #import <OptimizelySDKCore/OPTLYQueue.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
 #endif
 #import "OPTLYDataStore.h"
 #import "OPTLYEventDataStore.h"
@@ -40,7 +42,12 @@ static NSString * const kEventDispatcher = @"event-dispatcher";
 static NSString *const kOPTLYDataStoreEventTypeImpression = @"impression_events";
 static NSString *const kOPTLYDataStoreEventTypeConversion = @"conversion_events";
 
-@interface OPTLYDataStore()
+@interface OPTLYDataStore() {
+    // retention limits and drop counters per event type; keep these thread safe by synchronizing on self
+    NSInteger _maxBytesToSave[OPTLYDataStoreEventTypeCOUNT];
+    NSTimeInterval _maxAgeOfEvents[OPTLYDataStoreEventTypeCOUNT];
+    NSInteger _droppedEvents[OPTLYDataStoreEventTypeCOUNT][OPTLYDataStoreEventDropReasonCOUNT];
+}
 @property (nonatomic, strong) OPTLYFileManager *fileManager;
 @property (nonatomic, strong) id<OPTLYEventDataStore> eventDataStore;
 @property (nonatomic, strong) dispatch_queue_t fileManagerCreateQueue;
@@ -53,7 +60,9 @@ static NSString *const kOPTLYDataStoreEventTypeConversion = @"conversion_events"
     static OPTLYDataStore *dataStore;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
+        uint64_t startTime = [OPTLYStartupReport startTime];
         dataStore = [[OPTLYDataStore alloc] init];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDataStore since:startTime];
     });
     return dataStore;
 }
@@ -249,19 +258,37 @@ dispatch_queue_t eventsStorageQueue()
     return _eventsStorageQueue;
 }
 
-// removes a batch of the oldest events from the events table if the table exceeds the max allowed size
+- (NSInteger)maxTotalNumberOfEventsToSave
+{
+    if (_maxTotalNumberOfEventsToSave <= 0) {
+        return 2 * self.maxNumberOfEventsToSave;
+    }
+    return _maxTotalNumberOfEventsToSave;
+}
+
+// removes expired events, then the oldest events over the byte budget,
+// then the oldest impression events over the total budget (if impressions are evicted first),
+// then a batch of the oldest events if the table exceeds the max allowed size
 - (void)trimEvents:(OPTLYDataStoreEventType)eventType completion:(void(^)(void))completion
 {
     dispatch_async(eventsStorageQueue(), ^{
+        [self removeExpiredEvents:eventType];
+        [self removeEventsOverByteBudget:eventType];
+        if (self.evictImpressionEventsFirst) {
+            [self removeImpressionEventsOverTotalBudget];
+        }
+        
         NSInteger numberOfEvents = [self numberOfEvents:eventType error:nil];
         if (numberOfEvents >= self.maxNumberOfEventsToSave) {
             // TODO : make sure that we don't set the percentage to a value greater than 100
             double percentageOfEventsToRemove = OPTLYDataStorePercentageOfEventsToRemoveUponOverflow/100.0;
             NSInteger numberOfEventsToDelete = self.maxNumberOfEventsToSave * percentageOfEventsToRemove;
             if (numberOfEventsToDelete) {
-                [self removeFirstNEvents:numberOfEventsToDelete eventType:eventType error:nil];
                 NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDataStoreDatabaseRemovingOldEvents, numberOfEventsToDelete];
                 [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelWarning];
+                if ([self removeFirstNEvents:numberOfEventsToDelete eventType:eventType error:nil]) {
+                    [self countDroppedEvents:numberOfEventsToDelete eventType:eventType reason:OPTLYDataStoreEventDropReasonOverflow];
+                }
             }
         }
         if (completion) {
@@ -270,6 +297,108 @@ dispatch_queue_t eventsStorageQueue()
     });
 }
 
+// impressions are worth less than conversions, so only they make room for the events over the total budget
+- (void)removeImpressionEventsOverTotalBudget
+{
+    NSInteger numberOfImpressionEvents = [self numberOfEvents:OPTLYDataStoreEventTypeImpression error:nil];
+    NSInteger numberOfConversionEvents = [self numberOfEvents:OPTLYDataStoreEventTypeConversion error:nil];
+    NSInteger maxTotalNumberOfEvents = self.maxTotalNumberOfEventsToSave;
+    NSInteger numberOfEventsToDelete = MIN(numberOfImpressionEvents + numberOfConversionEvents - maxTotalNumberOfEvents, numberOfImpressionEvents);
+    if (numberOfEventsToDelete > 0 &&
+        [self removeFirstNEvents:numberOfEventsToDelete eventType:OPTLYDataStoreEventTypeImpression error:nil]) {
+        [self countDroppedEvents:numberOfEventsToDelete eventType:OPTLYDataStoreEventTypeImpression reason:OPTLYDataStoreEventDropReasonOverflow];
+        NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDataStoreDatabaseRemovingImpressionEventsOverTotalBudget, (long)maxTotalNumberOfEvents, (long)numberOfEventsToDelete];
+        [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelWarning];
+    }
+}
+
+- (void)removeExpiredEvents:(OPTLYDataStoreEventType)eventType
+{
+    NSTimeInterval maxAge = [self maxAgeOfEvents:eventType];
+    if (maxAge <= 0) {
+        return;
+    }
+    NSString *eventTypeName = [OPTLYDataStore stringForDataEventEnum:eventType];
+    NSTimeInterval oldestTimestamp = [[NSDate date] timeIntervalSince1970] - maxAge;
+    NSInteger numberOfEvents = [self.eventDataStore removeEventsOlderThan:oldestTimestamp eventType:eventTypeName error:nil];
+    if (numberOfEvents > 0) {
+        [self countDroppedEvents:numberOfEvents eventType:eventType reason:OPTLYDataStoreEventDropReasonExpired];
+        NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDataStoreDatabaseRemovingExpiredEvents, (long)numberOfEvents, eventTypeName, maxAge];
+        [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelWarning];
+    }
+}
+
+- (void)removeEventsOverByteBudget:(OPTLYDataStoreEventType)eventType
+{
+    NSInteger maxBytes = [self maxBytesToSave:eventType];
+    if (maxBytes <= 0) {
+        return;
+    }
+    NSString *eventTypeName = [OPTLYDataStore stringForDataEventEnum:eventType];
+    NSInteger numberOfEvents = [self.eventDataStore removeFirstEventsExceedingBytes:maxBytes eventType:eventTypeName error:nil];
+    if (numberOfEvents > 0) {
+        [self countDroppedEvents:numberOfEvents eventType:eventType reason:OPTLYDataStoreEventDropReasonByteBudget];
+        NSString *logMessage = [NSString stringWithFormat:OPTLYLoggerMessagesDataStoreDatabaseRemovingEventsOverByteBudget, (long)maxBytes, (long)numberOfEvents, eventTypeName];
+        [self.logger logMessage:logMessage withLevel:OptimizelyLogLevelWarning];
+    }
+}
+
+- (void)countDroppedEvents:(NSInteger)numberOfEvents
+                 eventType:(OPTLYDataStoreEventType)eventType
+                    reason:(OPTLYDataStoreEventDropReason)reason
+{
+    if (eventType >= OPTLYDataStoreEventTypeCOUNT || reason >= OPTLYDataStoreEventDropReasonCOUNT) {
+        return;
+    }
+    @synchronized (self) {
+        _droppedEvents[eventType][reason] += numberOfEvents;
+    }
+}
+
+- (NSInteger)numberOfDroppedEvents:(OPTLYDataStoreEventType)eventType
+                            reason:(OPTLYDataStoreEventDropReason)reason
+{
+    if (eventType >= OPTLYDataStoreEventTypeCOUNT || reason >= OPTLYDataStoreEventDropReasonCOUNT) {
+        return 0;
+    }
+    @synchronized (self) {
+        return _droppedEvents[eventType][reason];
+    }
+}
+
+- (void)setMaxBytesToSave:(NSInteger)maxBytes
+                   maxAge:(NSTimeInterval)maxAge
+                eventType:(OPTLYDataStoreEventType)eventType
+{
+    if (eventType >= OPTLYDataStoreEventTypeCOUNT) {
+        return;
+    }
+    @synchronized (self) {
+        _maxBytesToSave[eventType] = MAX(maxBytes, 0);
+        _maxAgeOfEvents[eventType] = MAX(maxAge, 0);
+    }
+}
+
+- (NSInteger)maxBytesToSave:(OPTLYDataStoreEventType)eventType
+{
+    if (eventType >= OPTLYDataStoreEventTypeCOUNT) {
+        return 0;
+    }
+    @synchronized (self) {
+        return _maxBytesToSave[eventType];
+    }
+}
+
+- (NSTimeInterval)maxAgeOfEvents:(OPTLYDataStoreEventType)eventType
+{
+    if (eventType >= OPTLYDataStoreEventTypeCOUNT) {
+        return 0;
+    }
+    @synchronized (self) {
+        return _maxAgeOfEvents[eventType];
+    }
+}
+
 - (BOOL)saveEvent:(nonnull NSDictionary *)data
         eventType:(OPTLYDataStoreEventType)eventType
             error:(NSError * _Nullable __autoreleasing * _Nullable)error
@@ -384,6 +513,13 @@ dispatch_queue_t eventsStorageQueue()
     return ok;
 }
 
+- (NSInteger)numberOfBytesOfEvents:(OPTLYDataStoreEventType)eventType
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    NSString *eventTypeName = [OPTLYDataStore stringForDataEventEnum:eventType];
+    return [self.eventDataStore numberOfBytesOfEvents:eventTypeName error:error];
+}
+
 - (NSInteger)numberOfEvents:(OPTLYDataStoreEventType)eventType
                       error:(NSError * _Nullable __autoreleasing * _Nullable)error
 {
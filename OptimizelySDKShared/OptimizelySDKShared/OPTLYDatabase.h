@@ -16,10 +16,11 @@
 
 /*
  This class manages all the database reads and writes and will primiarly be used to store events or logs.
- Each row entry contains three columns [OPTLYDatabaseEntity]:
+ Each row entry contains four columns [OPTLYDatabaseEntity]:
  1. id [int]
  2. json [text]
- 3. timestamp [int]
+ 3. timestamp [int], indexed
+ 4. size [int] (the size of json in bytes)
  The table is stored in the Library directory: .../optimizely/database/optly-database.sqlite
  This feature is not available for tvOS as storage is limited.
  */
@@ -87,6 +88,39 @@
                  table:(nonnull NSString *)tableName
                  error:(NSError * _Nullable __autoreleasing * _Nullable)error;
 
+/**
+ * Deletes the rows saved before a time.
+ *
+ * @param timestamp The time (in s since 1970) before which rows are removed.
+ * @param tableName The database table name.
+ * @param error An error object is returned if an error occurs.
+ * @return The number of rows removed.
+ */
+- (NSInteger)deleteEntitiesOlderThan:(NSTimeInterval)timestamp
+                               table:(nonnull NSString *)tableName
+                               error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Deletes the oldest rows until the total size of the table is within a limit.
+ *
+ * @param maxSize The max total size (in bytes) of the rows.
+ * @param tableName The database table name.
+ * @param error An error object is returned if an error occurs.
+ * @return The number of rows removed.
+ */
+- (NSInteger)deleteFirstEntitiesExceedingSize:(NSInteger)maxSize
+                                        table:(nonnull NSString *)tableName
+                                        error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Returns the total size (in bytes) of the rows of a table.
+ *
+ * @param tableName The database table name.
+ * @param error An error object is returned if an error occurs.
+ */
+- (NSInteger)totalSizeOfEntries:(nonnull NSString *)tableName
+                          error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
 /**
  * Retrieve all entries from the table.
  *
@@ -29,8 +29,17 @@
 static NSString * const kDatabaseFileName = @"optly-database.sqlite";
 
 // database queries
-static NSString * const kCreateTableQuery = @"CREATE TABLE IF NOT EXISTS %@ (id INTEGER PRIMARY KEY AUTOINCREMENT, json TEXT,timestamp INTEGER)";
-static NSString * const kInsertEntityQuery = @"INSERT INTO %@ (json,timestamp) VALUES(?,?)";
+static NSString * const kCreateTableQuery = @"CREATE TABLE IF NOT EXISTS %@ (id INTEGER PRIMARY KEY AUTOINCREMENT, json TEXT,timestamp INTEGER,size INTEGER DEFAULT 0)";
+static NSString * const kTableInfoQuery = @"PRAGMA table_info(%@)";
+// tables created by older versions have no size column; their rows are sized from the stored json
+static NSString * const kAddSizeColumnQuery = @"ALTER TABLE %@ ADD COLUMN size INTEGER DEFAULT 0";
+static NSString * const kBackfillSizeQuery = @"UPDATE %@ SET size = length(CAST(json AS BLOB))";
+static NSString * const kCreateTimestampIndexQuery = @"CREATE INDEX IF NOT EXISTS %@_timestamp ON %@ (timestamp)";
+static NSString * const kInsertEntityQuery = @"INSERT INTO %@ (json,timestamp,size) VALUES(?,?,?)";
+static NSString * const kDeleteEntitiesOlderThanQuery = @"DELETE FROM %@ WHERE timestamp < ?";
+static NSString * const kDeleteEntitiesUpToIdQuery = @"DELETE FROM %@ WHERE id <= ?";
+static NSString * const kRetrieveSizesQuery = @"SELECT id, size FROM %@ ORDER BY id";
+static NSString * const kEntitiesSizeQuery = @"SELECT total(size) FROM %@";
 static NSString * const kDeleteEntityIDQuery = @"DELETE FROM %@ where id IN %@";
 static NSString * const kDeleteEntityQuery = @"DELETE FROM %@ where json='%@'";
 static NSString * const kRetrieveEntityQuery = @"SELECT * from %@";
@@ -42,6 +51,8 @@ static NSString * const kEntitiesCountQuery = @"SELECT count(*) FROM %@";
 static NSString * const kColumnKeyId = @"id";
 static NSString * const kColumnKeyJSON = @"json";
 static NSString * const kColumnKeyTimestamp = @"timestamp";
+static NSString * const kColumnKeySize = @"size";
+static NSString * const kColumnKeyName = @"name";
 
 @interface OPTLYDatabase()
 @property (nonatomic, strong) NSString *databaseFileDirectory;
@@ -85,9 +96,17 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
               error:(NSError * __autoreleasing *)error
 {
     __block BOOL ok = YES;
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db) {
+    [self inDatabase:^(OPTLYFMDBDatabase *db) {
         NSString *query = [NSString stringWithFormat:kCreateTableQuery, tableName];
-        if (![db executeUpdate:query]) {
+        BOOL created = [db executeUpdate:query];
+        if (created && ![self table:tableName hasColumn:kColumnKeySize database:db]) {
+            created = [db executeUpdate:[NSString stringWithFormat:kAddSizeColumnQuery, tableName]]
+                && [db executeUpdate:[NSString stringWithFormat:kBackfillSizeQuery, tableName]];
+        }
+        if (created) {
+            created = [db executeUpdate:[NSString stringWithFormat:kCreateTimestampIndexQuery, tableName, tableName]];
+        }
+        if (!created) {
             ok = NO;
             if (error) {
                 *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
@@ -100,6 +119,19 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
     return ok;
 }
 
+- (BOOL)table:(NSString *)tableName hasColumn:(NSString *)columnName database:(OPTLYFMDBDatabase *)db
+{
+    BOOL hasColumn = NO;
+    OPTLYFMDBResultSet *resultSet = [db executeQuery:[NSString stringWithFormat:kTableInfoQuery, tableName]];
+    while ([resultSet next]) {
+        if ([[resultSet stringForColumn:kColumnKeyName] isEqualToString:columnName]) {
+            hasColumn = YES;
+        }
+    }
+    [resultSet close];
+    return hasColumn;
+}
+
 - (BOOL)saveEvent:(NSDictionary *)data
             table:(NSString *)tableName
             error:(NSError * __autoreleasing *)error
@@ -118,13 +150,20 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
         return ok;
     }
     
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db){
-        NSData *jsonData = [NSJSONSerialization dataWithJSONObject:data options:NSJSONWritingPrettyPrinted error:error];
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
+        // stored compact so OPTLYEventDataStore can hand the row back without parsing it
+        NSData *jsonData = [OPTLYJSONWriter dataWithJSONObject:data error:error];
+        if (!jsonData) {
+            ok = NO;
+            OPTLYLogError(@"Unable to encode data for Optimizely table: %@ %@", tableName, data);
+            return;
+        }
         NSString *json = [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding];
         
         NSNumber *timeStamp = [NSNumber numberWithDouble:[[NSDate date] timeIntervalSince1970]];
+        NSNumber *size = @(jsonData.length);
         NSMutableString *query = [NSMutableString stringWithFormat:kInsertEntityQuery, tableName];
-        if (![db executeUpdate:query, json, timeStamp]) {
+        if (![db executeUpdate:query, json, timeStamp, size]) {
             ok = NO;
             if (error) {
                 *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
@@ -149,7 +188,7 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
                  error:(NSError * __autoreleasing *)error
 {
     __block BOOL ok = YES;
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db){
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
         NSString *commaSeperatedIds = [NSString stringWithFormat:@"(%@)", [entityIds componentsJoinedByString:@","]];
         NSString *query = [NSString stringWithFormat:kDeleteEntityIDQuery, tableName, commaSeperatedIds];
         if (![db executeUpdate:query]) {
@@ -171,7 +210,7 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
                        error:(NSError * _Nullable __autoreleasing * _Nullable)error
 {
     __block BOOL ok = YES;
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db){
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
         NSString *query = [NSString stringWithFormat:kDeleteEntityQuery, tableName, json];
         if (![db executeUpdate:query]) {
             ok = NO;
@@ -187,6 +226,94 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
     return ok;
 }
 
+- (NSInteger)deleteEntitiesOlderThan:(NSTimeInterval)timestamp
+                               table:(NSString *)tableName
+                               error:(NSError * __autoreleasing *)error
+{
+    __block NSInteger deleted = 0;
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
+        NSString *query = [NSString stringWithFormat:kDeleteEntitiesOlderThanQuery, tableName];
+        if (![db executeUpdate:query, @(timestamp)]) {
+            if (error) {
+                *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                             code:OPTLYErrorTypesDatabase
+                                         userInfo:@{NSLocalizedDescriptionKey :
+                                                        NSLocalizedString([db lastErrorMessage], nil)}];
+            }
+            OPTLYLogError(@"Unable to remove expired rows of Optimizely table: %@ %@", tableName, [db lastErrorMessage]);
+            return;
+        }
+        deleted = [db changes];
+    }];
+    return deleted;
+}
+
+- (NSInteger)deleteFirstEntitiesExceedingSize:(NSInteger)maxSize
+                                        table:(NSString *)tableName
+                                        error:(NSError * __autoreleasing *)error
+{
+    __block NSInteger deleted = 0;
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
+        long long excessSize = [self totalSizeOfTable:tableName database:db] - maxSize;
+        if (excessSize <= 0) {
+            return;
+        }
+        
+        // find the newest row that has to go so that the oldest rows can be removed with one DELETE
+        long long lastId = -1;
+        OPTLYFMDBResultSet *resultSet = [db executeQuery:[NSString stringWithFormat:kRetrieveSizesQuery, tableName]];
+        while (excessSize > 0 && [resultSet next]) {
+            lastId = [resultSet longLongIntForColumn:kColumnKeyId];
+            excessSize -= [resultSet longLongIntForColumn:kColumnKeySize];
+        }
+        [resultSet close];
+        
+        NSString *query = [NSString stringWithFormat:kDeleteEntitiesUpToIdQuery, tableName];
+        if (lastId < 0 || ![db executeUpdate:query, @(lastId)]) {
+            if (error) {
+                *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                             code:OPTLYErrorTypesDatabase
+                                         userInfo:@{NSLocalizedDescriptionKey :
+                                                        NSLocalizedString([db lastErrorMessage], nil)}];
+            }
+            OPTLYLogError(@"Unable to remove rows over the size limit of Optimizely table: %@ %@", tableName, [db lastErrorMessage]);
+            return;
+        }
+        deleted = [db changes];
+    }];
+    return deleted;
+}
+
+- (NSInteger)totalSizeOfEntries:(NSString *)tableName
+                          error:(NSError * __autoreleasing *)error
+{
+    __block NSInteger size = 0;
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
+        size = (NSInteger)[self totalSizeOfTable:tableName database:db];
+        if ([db hadError]) {
+            if (error) {
+                *error = [NSError errorWithDomain:OPTLYErrorHandlerMessagesDomain
+                                             code:OPTLYErrorTypesDatabase
+                                         userInfo:@{NSLocalizedDescriptionKey :
+                                                        NSLocalizedString([db lastErrorMessage], nil)}];
+            }
+            OPTLYLogError(@"Unable to fetch the size of Optimizely table: %@ %@", tableName, [db lastErrorMessage]);
+        }
+    }];
+    return size;
+}
+
+- (long long)totalSizeOfTable:(NSString *)tableName database:(OPTLYFMDBDatabase *)db
+{
+    long long size = 0;
+    OPTLYFMDBResultSet *resultSet = [db executeQuery:[NSString stringWithFormat:kEntitiesSizeQuery, tableName]];
+    if ([resultSet next]) {
+        size = [resultSet longLongIntForColumnIndex:0];
+    }
+    [resultSet close];
+    return size;
+}
+
 - (NSArray *)retrieveAllEntries:(NSString *)tableName
                           error:(NSError * __autoreleasing *)error
 {
@@ -200,7 +327,7 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
 {
     NSMutableArray *results = [NSMutableArray new];
     
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db){
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
         NSMutableString *query = [NSMutableString stringWithFormat:kRetrieveEntityQuery, tableName];
         if (numberOfEntries) {
             [query appendFormat:kRetrieveEntityQueryLimit, (long)numberOfEntries];
@@ -233,7 +360,7 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
                            error:(NSError * __autoreleasing *)error
 {
     __block NSInteger rowId;
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db){
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
         NSMutableString *query = [NSMutableString stringWithFormat:kRetrieveLastEntityIdQuery];
         
         OPTLYFMDBResultSet *resultSet = [db executeQuery:query];
@@ -261,7 +388,7 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
 {
     __block NSInteger rows = 0;
     
-    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db){
+    [self inDatabase:^(OPTLYFMDBDatabase *db){
         NSString *query = [NSString stringWithFormat:kEntitiesCountQuery, tableName];
         OPTLYFMDBResultSet *resultSet = [db executeQuery:query];
         if (!resultSet) {
@@ -288,4 +415,14 @@ static NSString * const kColumnKeyTimestamp = @"timestamp";
     self.fmDatabaseQueue = nil;
     return [fm removeItemAtPath:self.databaseFilePath error:error];
 }
+
+// runs the block on the database queue, recording how long it holds the database
+- (void)inDatabase:(void (^)(OPTLYFMDBDatabase *db))block
+{
+    [self.fmDatabaseQueue inDatabase:^(OPTLYFMDBDatabase *db) {
+        uint64_t startTime = [OPTLYMetrics startTime];
+        block(db);
+        [OPTLYMetrics recordLatency:OPTLYMetricLatencyDatabase since:startTime];
+    }];
+}
 @end
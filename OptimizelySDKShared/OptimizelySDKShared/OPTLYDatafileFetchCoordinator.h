@@ -0,0 +1,126 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+#ifdef UNIVERSAL
+    #import "OPTLYHTTPRequestManager.h"
+#else
+    #import <OptimizelySDKCore/OPTLYHTTPRequestManager.h>
+#endif
+
+/*
+ * This class coordinates the datafile downloads of all the datafile managers of the process.
+ * Downloads are keyed by datafile URL:
+ *   - A download requested while another download of the same URL with the same validators
+ *     (last modified date and ETag) is in flight is not sent; it is completed with the response of the download in flight.
+ *   - The datafile managers polling the same URL share one poll timer firing at the smallest of their intervals.
+ *     The timer is owned by the coordinator: subscribers suspend and stop it through the coordinator.
+ *     Every time it fires, all of them download the datafile, which sends one request whose response
+ *     (the same data object) is handed to each of them.
+ */
+
+@class OPTLYTimer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol OPTLYDatafileFetchSubscriber <NSObject>
+
+/**
+ * Downloads the datafile. Called every time the poll timer of the subscriber's datafile URL fires.
+ */
+- (void)downloadDatafile;
+
+@end
+
+@interface OPTLYDatafileFetchCoordinator : NSObject
+
+/**
+ * The coordinator shared by all the datafile managers.
+ */
++ (instancetype)sharedCoordinator;
+
+/**
+ * Downloads a datafile, or joins the download of the same URL with the same validators in flight.
+ *
+ * @param datafileURL The URL of the datafile.
+ * @param backoffRetry Whether to retry with exponential backoff. Ignored when joining a download in flight.
+ * @param lastModifiedDate The date the saved datafile was last modified.
+ * @param entityTag The ETag of the saved datafile.
+ * @param completion The completion handler, called with the response of the download.
+ */
+- (void)downloadDatafile:(NSURL *)datafileURL
+            backoffRetry:(BOOL)backoffRetry
+            lastModified:(nullable NSString *)lastModifiedDate
+               entityTag:(nullable NSString *)entityTag
+       completionHandler:(nullable OPTLYHTTPRequestManagerResponse)completion;
+
+/**
+ * Subscribes to the poll schedule of a datafile URL (again) and resumes its timer.
+ * The timer fires at the smallest interval of the subscribers; it is recreated when that interval changes.
+ * Subscribers are held weakly.
+ *
+ * @param subscriber The subscriber downloading the datafile when the timer fires.
+ * @param datafileURL The URL of the datafile.
+ * @param interval The poll interval (in s) the subscriber asks for. Must be greater than 0.
+ */
+- (void)subscribe:(id<OPTLYDatafileFetchSubscriber>)subscriber
+    toDatafileURL:(NSURL *)datafileURL
+         interval:(NSTimeInterval)interval;
+
+/**
+ * Unsubscribes from the poll schedule of a datafile URL.
+ * The timer goes back to the smallest interval of the subscribers left, and is invalidated once none is left.
+ *
+ * @param subscriber The subscriber to remove.
+ * @param datafileURL The URL of the datafile.
+ */
+- (void)unsubscribe:(id<OPTLYDatafileFetchSubscriber>)subscriber
+    fromDatafileURL:(NSURL *)datafileURL;
+
+/**
+ * Suspends the poll timer of a datafile URL until a subscriber subscribes again.
+ *
+ * @param datafileURL The URL of the datafile.
+ */
+- (void)suspendPollingDatafileURL:(NSURL *)datafileURL;
+
+/**
+ * Invalidates the poll timer of a datafile URL and removes all its subscribers.
+ *
+ * @param datafileURL The URL of the datafile.
+ */
+- (void)stopPollingDatafileURL:(NSURL *)datafileURL;
+
+/**
+ * Returns the poll timer of a datafile URL, nil if no subscriber polls it.
+ */
+- (nullable OPTLYTimer *)pollTimerForDatafileURL:(NSURL *)datafileURL;
+
+/**
+ * Returns the poll timer of a datafile URL, nil if the subscriber doesn't poll it.
+ */
+- (nullable OPTLYTimer *)pollTimerForSubscriber:(id<OPTLYDatafileFetchSubscriber>)subscriber
+                                    datafileURL:(NSURL *)datafileURL;
+
+/**
+ * Returns the number of downloads of a datafile URL in flight.
+ */
+- (NSInteger)numberOfDownloadsInFlightForDatafileURL:(NSURL *)datafileURL;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,225 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import "OPTLYDatafileFetchCoordinator.h"
+#ifdef UNIVERSAL
+    #import "OPTLYNetworkService.h"
+    #import "OPTLYTimer.h"
+#else
+    #import <OptimizelySDKCore/OPTLYNetworkService.h>
+    #import <OptimizelySDKCore/OPTLYTimer.h>
+#endif
+
+// The poll timer and the subscribers of a datafile URL
+@interface OPTLYDatafilePollSchedule : NSObject
+// subscriber -> the poll interval it asks for
+@property (nonatomic, strong) NSMapTable<id<OPTLYDatafileFetchSubscriber>, NSNumber *> *intervals;
+@property (nonatomic, strong) OPTLYTimer *timer;
+@end
+
+@implementation OPTLYDatafilePollSchedule
+@end
+
+@interface OPTLYDatafileFetchCoordinator ()
+@property (nonatomic, strong) OPTLYNetworkService *networkService;
+// download key -> completion handlers waiting for the download in flight
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<OPTLYHTTPRequestManagerResponse> *> *pendingCompletions;
+// datafile URL -> poll schedule
+@property (nonatomic, strong) NSMutableDictionary<NSString *, OPTLYDatafilePollSchedule *> *pollSchedules;
+@end
+
+@implementation OPTLYDatafileFetchCoordinator
+
++ (instancetype)sharedCoordinator {
+    static OPTLYDatafileFetchCoordinator *sharedCoordinator = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedCoordinator = [self new];
+    });
+    return sharedCoordinator;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self != nil) {
+        _networkService = [OPTLYNetworkService new];
+        _pendingCompletions = [NSMutableDictionary new];
+        _pollSchedules = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+# pragma mark - Downloads
+- (void)downloadDatafile:(NSURL *)datafileURL
+            backoffRetry:(BOOL)backoffRetry
+            lastModified:(NSString *)lastModifiedDate
+               entityTag:(NSString *)entityTag
+       completionHandler:(OPTLYHTTPRequestManagerResponse)completion {
+    NSString *key = [self downloadKey:datafileURL lastModified:lastModifiedDate entityTag:entityTag];
+    OPTLYHTTPRequestManagerResponse pendingCompletion = completion ?: ^(NSData *data, NSURLResponse *response, NSError *error) {};
+    @synchronized (self) {
+        NSMutableArray<OPTLYHTTPRequestManagerResponse> *completions = self.pendingCompletions[key];
+        if (completions != nil) {
+            [completions addObject:[pendingCompletion copy]];
+            return;
+        }
+        self.pendingCompletions[key] = [NSMutableArray arrayWithObject:[pendingCompletion copy]];
+    }
+    
+    [self.networkService downloadProjectConfig:datafileURL
+                                  backoffRetry:backoffRetry
+                                  lastModified:lastModifiedDate
+                                     entityTag:entityTag
+                             completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                                 NSArray<OPTLYHTTPRequestManagerResponse> *completions = nil;
+                                 @synchronized (self) {
+                                     completions = self.pendingCompletions[key];
+                                     [self.pendingCompletions removeObjectForKey:key];
+                                 }
+                                 for (OPTLYHTTPRequestManagerResponse pendingCompletion in completions) {
+                                     pendingCompletion(data, response, error);
+                                 }
+                             }];
+}
+
+- (NSInteger)numberOfDownloadsInFlightForDatafileURL:(NSURL *)datafileURL {
+    NSString *prefix = [[datafileURL absoluteString] stringByAppendingString:@"\n"];
+    NSInteger count = 0;
+    @synchronized (self) {
+        for (NSString *key in self.pendingCompletions) {
+            if ([key hasPrefix:prefix]) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+// A conditional download can't stand in for a download with other validators:
+// its 304 response has no datafile for a datafile manager that has none saved.
+- (NSString *)downloadKey:(NSURL *)datafileURL lastModified:(NSString *)lastModifiedDate entityTag:(NSString *)entityTag {
+    return [NSString stringWithFormat:@"%@\n%@\n%@", [datafileURL absoluteString], lastModifiedDate ?: @"", entityTag ?: @""];
+}
+
+# pragma mark - Poll Schedules
+- (void)subscribe:(id<OPTLYDatafileFetchSubscriber>)subscriber
+    toDatafileURL:(NSURL *)datafileURL
+         interval:(NSTimeInterval)interval {
+    NSString *key = [datafileURL absoluteString];
+    @synchronized (self) {
+        OPTLYDatafilePollSchedule *schedule = self.pollSchedules[key];
+        if (schedule == nil) {
+            schedule = [OPTLYDatafilePollSchedule new];
+            schedule.intervals = [NSMapTable weakToStrongObjectsMapTable];
+            self.pollSchedules[key] = schedule;
+        }
+        [schedule.intervals setObject:@(interval) forKey:subscriber];
+        [self updateTimerOfSchedule:schedule key:key];
+        [schedule.timer resume];
+    }
+}
+
+- (void)unsubscribe:(id<OPTLYDatafileFetchSubscriber>)subscriber
+    fromDatafileURL:(NSURL *)datafileURL {
+    NSString *key = [datafileURL absoluteString];
+    @synchronized (self) {
+        OPTLYDatafilePollSchedule *schedule = self.pollSchedules[key];
+        if (schedule == nil) {
+            return;
+        }
+        [schedule.intervals removeObjectForKey:subscriber];
+        [self updateTimerOfSchedule:schedule key:key];
+    }
+}
+
+- (void)suspendPollingDatafileURL:(NSURL *)datafileURL {
+    @synchronized (self) {
+        [self.pollSchedules[[datafileURL absoluteString]].timer suspend];
+    }
+}
+
+- (void)stopPollingDatafileURL:(NSURL *)datafileURL {
+    NSString *key = [datafileURL absoluteString];
+    @synchronized (self) {
+        [self.pollSchedules[key].timer invalidate];
+        [self.pollSchedules removeObjectForKey:key];
+    }
+}
+
+- (OPTLYTimer *)pollTimerForDatafileURL:(NSURL *)datafileURL {
+    @synchronized (self) {
+        return self.pollSchedules[[datafileURL absoluteString]].timer;
+    }
+}
+
+- (OPTLYTimer *)pollTimerForSubscriber:(id<OPTLYDatafileFetchSubscriber>)subscriber
+                           datafileURL:(NSURL *)datafileURL {
+    @synchronized (self) {
+        OPTLYDatafilePollSchedule *schedule = self.pollSchedules[[datafileURL absoluteString]];
+        return [schedule.intervals objectForKey:subscriber] != nil ? schedule.timer : nil;
+    }
+}
+
+// Polls at the smallest interval of the subscribers left (the map table skips the deallocated ones),
+// and stops polling once none is left. A new timer keeps the suspended state of the timer it replaces.
+- (void)updateTimerOfSchedule:(OPTLYDatafilePollSchedule *)schedule key:(NSString *)key {
+    NSTimeInterval interval = 0;
+    for (id<OPTLYDatafileFetchSubscriber> subscriber in [[schedule.intervals keyEnumerator] allObjects]) {
+        NSTimeInterval subscriberInterval = [[schedule.intervals objectForKey:subscriber] doubleValue];
+        if (interval <= 0 || subscriberInterval < interval) {
+            interval = subscriberInterval;
+        }
+    }
+    if (interval <= 0) {
+        [schedule.timer invalidate];
+        [self.pollSchedules removeObjectForKey:key];
+        return;
+    }
+    if ([schedule.timer isValid] && schedule.timer.timeInterval == interval) {
+        return;
+    }
+    
+    BOOL suspended = ![schedule.timer isValid] || [schedule.timer isSuspended];
+    [schedule.timer invalidate];
+    __weak typeof(self) weakSelf = self;
+    schedule.timer = [[OPTLYTimer alloc] initWithName:@"datafileFetchCoordinator"
+                                         timeInterval:interval
+                                            tolerance:-1
+                                              handler:^{
+                                                  [weakSelf pollDatafileForKey:key];
+                                              }];
+    if (!suspended) {
+        [schedule.timer resume];
+    }
+}
+
+// All the subscribers download at once, so they share a single request.
+- (void)pollDatafileForKey:(NSString *)key {
+    NSArray<id<OPTLYDatafileFetchSubscriber>> *subscribers = nil;
+    @synchronized (self) {
+        OPTLYDatafilePollSchedule *schedule = self.pollSchedules[key];
+        subscribers = [[schedule.intervals keyEnumerator] allObjects];
+        if (schedule != nil) {
+            [self updateTimerOfSchedule:schedule key:key];
+        }
+    }
+    for (id<OPTLYDatafileFetchSubscriber> subscriber in subscribers) {
+        [subscriber downloadDatafile];
+    }
+}
+
+@end
@@ -64,6 +64,12 @@
  */
 + (BOOL)conformsToOPTLYDatafileManagerProtocol:(nonnull Class)instanceClass;
 
+/**
+ * Returns a hash of the content of a datafile (the hex SHA-256 digest),
+ * used to tell whether a downloaded datafile differs from the saved one
+ */
++ (nonnull NSString *)contentHashOfDatafile:(nonnull NSData *)datafile;
+
 @end
 
 @interface OPTLYDatafileManagerBasic : NSObject<OPTLYDatafileManager>
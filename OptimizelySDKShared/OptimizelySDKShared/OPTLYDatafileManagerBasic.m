@@ -14,12 +14,9 @@
  * limitations under the License.                                           *
  ***************************************************************************/
 
+#import <CommonCrypto/CommonDigest.h>
+#import "OPTLYDatafileFetchCoordinator.h"
 #import "OPTLYDatafileManagerBasic.h"
-#ifdef UNIVERSAL
-    #import "OPTLYNetworkService.h"
-#else
-    #import <OptimizelySDKCore/OPTLYNetworkService.h>
-#endif
 
 @implementation OPTLYDatafileManagerUtility
 
@@ -35,6 +32,16 @@
     return validProtocolDeclaration && implementsDownloadDatafileMethod && implementsSaveDatafileMethod && implementsGetDatafileMethod;
 }
 
++ (NSString *)contentHashOfDatafile:(NSData *)datafile {
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(datafile.bytes, (CC_LONG)datafile.length, digest);
+    NSMutableString *contentHash = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSUInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [contentHash appendFormat:@"%02x", digest[i]];
+    }
+    return [contentHash copy];
+}
+
 @end
 
 @interface OPTLYDatafileManagerBasic ()
@@ -47,18 +54,19 @@
 
 - (void)downloadDatafile:(nonnull OPTLYDatafileConfig *)datafileConfig
        completionHandler:(nullable void (^)(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error))completion {
-    OPTLYNetworkService *networkService = [OPTLYNetworkService new];
-    [networkService downloadProjectConfig:[datafileConfig URLForKey]
-                             backoffRetry:NO
-                        completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
-                            if ([data length] > 0) {
-                                self.savedDatafile = data;
-                            }
-                            // call the completion handler
-                            if (completion != nil) {
-                                completion(data, response, error);
-                            }
-                        }];
+    [[OPTLYDatafileFetchCoordinator sharedCoordinator] downloadDatafile:[datafileConfig URLForKey]
+                                                           backoffRetry:NO
+                                                           lastModified:nil
+                                                              entityTag:nil
+                                                      completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+                                                          if ([data length] > 0) {
+                                                              self.savedDatafile = data;
+                                                          }
+                                                          // call the completion handler
+                                                          if (completion != nil) {
+                                                              completion(data, response, error);
+                                                          }
+                                                      }];
 }
 
 - (NSData * _Nullable)getSavedDatafile:(out NSError * _Nullable __autoreleasing * _Nullable)error NS_SWIFT_NOTHROW {
@@ -94,6 +94,40 @@
  */
 - (NSInteger)numberOfEvents:(nonnull NSString *)eventTypeName
                       error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Returns the total size of the saved events.
+ *
+ * @param eventTypeName The name of the event type of the data.
+ * @param error An error object is returned if an error occurs.
+ * @return The size (in bytes) of the encoded events.
+ */
+- (NSInteger)numberOfBytesOfEvents:(nonnull NSString *)eventTypeName
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Deletes the events saved before a time.
+ *
+ * @param timestamp The time (in s since 1970) before which events are removed.
+ * @param eventTypeName The name of the event type of the data that needs to be removed.
+ * @param error An error object is returned if an error occurs.
+ * @return The number of events removed.
+ */
+- (NSInteger)removeEventsOlderThan:(NSTimeInterval)timestamp
+                         eventType:(nonnull NSString *)eventTypeName
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error;
+
+/**
+ * Deletes the oldest events until the saved events fit in a byte budget.
+ *
+ * @param maxBytes The max total size (in bytes) of the saved events.
+ * @param eventTypeName The name of the event type of the data that needs to be removed.
+ * @param error An error object is returned if an error occurs.
+ * @return The number of events removed.
+ */
+- (NSInteger)removeFirstEventsExceedingBytes:(NSInteger)maxBytes
+                                   eventType:(nonnull NSString *)eventTypeName
+                                       error:(NSError * _Nullable __autoreleasing * _Nullable)error;
 @end
 
 #if TARGET_OS_IOS
@@ -15,8 +15,12 @@
  ***************************************************************************/
 #ifdef UNIVERSAL
     #import "OPTLYErrorHandler.h"
+    #import "OPTLYEventPayload.h"
+    #import "OPTLYStartupReport.h"
 #else
     #import <OptimizelySDKCore/OPTLYErrorHandler.h>
+    #import <OptimizelySDKCore/OPTLYEventPayload.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
 #endif
 #import "OPTLYDataStore.h"
 #import "OPTLYEventDataStore.h"
@@ -39,6 +43,7 @@
     self = [super init];
     if (self)
     {
+        uint64_t startTime = [OPTLYStartupReport startTime];
         _databaseDirectory = [baseDir stringByAppendingPathComponent:[OPTLYDataStore stringForDataTypeEnum:OPTLYDataStoreDataTypeDatabase]];
         _database = [[OPTLYDatabase alloc] initWithBaseDir:_databaseDirectory];
         
@@ -46,6 +51,7 @@
         NSError *error = nil;
         [self createTable:[OPTLYDataStore stringForDataEventEnum:OPTLYDataStoreEventTypeImpression] error:&error];
         [self createTable:[OPTLYDataStore stringForDataEventEnum:OPTLYDataStoreEventTypeConversion] error:&error];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseDatabaseOpen since:startTime];
     }
     
     return self;
@@ -72,8 +78,15 @@
     
     NSArray *firstNEntities = [self.database retrieveFirstNEntries:numberOfEvents table:eventTypeName error:error];
     for (OPTLYDatabaseEntity *entity in firstNEntities) {
-        NSString *entityValue = entity.entityValue;
-        NSDictionary *event = [NSJSONSerialization JSONObjectWithData:[entityValue dataUsingEncoding:NSUTF8StringEncoding] options:0 error:error];
+        NSData *entityData = [entity.entityValue dataUsingEncoding:NSUTF8StringEncoding];
+        // events saved by this version are compact and are passed on without being parsed
+        OPTLYEventPayload *payload = [OPTLYEventPayload payloadWithStoredJSONData:entityData];
+        if (payload) {
+            [firstNEvents addObject:@{@"entityId": entity.entityId, @"json": payload}];
+            continue;
+        }
+        
+        NSDictionary *event = [NSJSONSerialization JSONObjectWithData:entityData options:0 error:error];
         
         if ([event count] > 0) {
             if ((error != nil && *error == nil) || error == nil) {
@@ -149,19 +162,47 @@
     return numberOfEvents;
 }
 
+- (NSInteger)numberOfBytesOfEvents:(nonnull NSString *)eventTypeName
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    return [self.database totalSizeOfEntries:eventTypeName error:error];
+}
+
+- (NSInteger)removeEventsOlderThan:(NSTimeInterval)timestamp
+                         eventType:(nonnull NSString *)eventTypeName
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    return [self.database deleteEntitiesOlderThan:timestamp table:eventTypeName error:error];
+}
+
+- (NSInteger)removeFirstEventsExceedingBytes:(NSInteger)maxBytes
+                                   eventType:(nonnull NSString *)eventTypeName
+                                       error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    return [self.database deleteFirstEntitiesExceedingSize:maxBytes table:eventTypeName error:error];
+}
+
 @end
 #endif
 
 #if TARGET_OS_TV
 
 #ifdef UNIVERSAL
+    #import "OPTLYJSONWriter.h"
     #import "OPTLYQueue.h"
 #else
+    #import <OptimizelySDKCore/OPTLYJSONWriter.h>
     #import <OptimizelySDKCore/OPTLYQueue.h>
 #endif
 
+static NSString * const kEntityKeyTimestamp = @"timestamp";
+static NSString * const kEntityKeySize = @"size";
+
 @interface OPTLYEventDataStoreTVOS()
+/// eventTypeName --> OPTLYQueue of @{ @"entityId" : id, @"json" : event, @"timestamp" : time saved, @"size" : encoded bytes }
 @property (nonatomic, strong) NSMutableDictionary *eventsCache;
+/// eventTypeName --> id of the last saved event; ids are never reused, so they stay valid as events are removed
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSNumber *> *lastEventIds;
 @end
 
 @implementation OPTLYEventDataStoreTVOS
@@ -173,6 +214,7 @@
     if (self)
     {
         _eventsCache = [NSMutableDictionary new];
+        _lastEventIds = [NSMutableDictionary new];
         [_eventsCache setObject:[OPTLYQueue new] forKey:[OPTLYDataStore stringForDataEventEnum:OPTLYDataStoreEventTypeImpression]];
         [_eventsCache setObject:[OPTLYQueue new] forKey:[OPTLYDataStore stringForDataEventEnum:OPTLYDataStoreEventTypeConversion]];
     }
@@ -194,10 +236,15 @@ dispatch_queue_t eventsStorageCacheQueue()
         eventType:(nonnull NSString *)eventTypeName
             error:(NSError * _Nullable __autoreleasing * _Nullable)error
 {
+    NSNumber *timestamp = @([[NSDate date] timeIntervalSince1970]);
+    NSNumber *size = @([OPTLYJSONWriter dataWithJSONObject:data error:nil].length);
     dispatch_async(eventsStorageCacheQueue(), ^{
         __weak typeof(self) weakSelf = self;
         OPTLYQueue *queue = [weakSelf.eventsCache objectForKey:eventTypeName];
-        [queue enqueue:data];
+        NSInteger entityId = [weakSelf.lastEventIds[eventTypeName] integerValue] + 1;
+        if ([queue enqueue:@{ @"entityId" : @(entityId), @"json" : data, kEntityKeyTimestamp : timestamp, kEntityKeySize : size }]) {
+            weakSelf.lastEventIds[eventTypeName] = @(entityId);
+        }
     });
     return YES;
 }
@@ -215,8 +262,8 @@ dispatch_queue_t eventsStorageCacheQueue()
     NSArray *firstNEntities = [queue firstNItems:numberOfEvents];
     NSMutableArray *firstNEvents = [NSMutableArray new];
     for (NSDictionary *entity in firstNEntities) {
-        if ([entity count] > 0) {
-            [firstNEvents addObject:@{@"entityId": @([firstNEntities indexOfObject:entity]) , @"json": entity}];
+        if ([entity[@"json"] count] > 0) {
+            [firstNEvents addObject:entity];
         }
     }
     return firstNEvents;
@@ -225,13 +272,13 @@ dispatch_queue_t eventsStorageCacheQueue()
 - (NSInteger)getLastEventId:(nonnull NSString *)eventTypeName
                       error:(NSError * _Nullable __autoreleasing * _Nullable)error
 {
-    __block OPTLYQueue *queue = nil;
+    __block NSInteger lastEventId = 0;
     dispatch_sync(eventsStorageCacheQueue(), ^{
         __weak typeof(self) weakSelf = self;
-        queue = [weakSelf.eventsCache objectForKey:eventTypeName];
+        lastEventId = [weakSelf.lastEventIds[eventTypeName] integerValue];
     });
     
-    return [queue lastItemIndex];
+    return lastEventId;
 }
 
 - (BOOL)removeFirstNEvents:(NSInteger)numberOfEvents
@@ -256,9 +303,11 @@ dispatch_queue_t eventsStorageCacheQueue()
         dispatch_async(eventsStorageCacheQueue(), ^{
             __weak typeof(self) weakSelf = self;
             OPTLYQueue *queue = [weakSelf.eventsCache objectForKey:eventTypeName];
-            if (queue && [queue.queue count] > [event[@"entityId"] integerValue]) {
-                NSDictionary *eventJSON = [queue.queue objectAtIndex:[event[@"entityId"] integerValue]];
-                [queue removeItem:eventJSON];
+            for (NSDictionary *entity in queue.queue) {
+                if ([entity[@"entityId"] isEqual:event[@"entityId"]]) {
+                    [queue removeItem:entity];
+                    break;
+                }
             }
         });
         retval = YES;
@@ -278,5 +327,60 @@ dispatch_queue_t eventsStorageCacheQueue()
     return [queue size];
 }
 
+- (NSInteger)numberOfBytesOfEvents:(nonnull NSString *)eventTypeName
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    __block NSInteger numberOfBytes = 0;
+    dispatch_sync(eventsStorageCacheQueue(), ^{
+        OPTLYQueue *queue = [self.eventsCache objectForKey:eventTypeName];
+        for (NSDictionary *entity in queue.queue) {
+            numberOfBytes += [entity[kEntityKeySize] integerValue];
+        }
+    });
+    return numberOfBytes;
+}
+
+- (NSInteger)removeEventsOlderThan:(NSTimeInterval)timestamp
+                         eventType:(nonnull NSString *)eventTypeName
+                             error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    __block NSInteger numberOfEvents = 0;
+    dispatch_sync(eventsStorageCacheQueue(), ^{
+        OPTLYQueue *queue = [self.eventsCache objectForKey:eventTypeName];
+        // events are queued in the order they were saved
+        for (NSDictionary *entity in queue.queue) {
+            if ([entity[kEntityKeyTimestamp] doubleValue] >= timestamp) {
+                break;
+            }
+            numberOfEvents++;
+        }
+        [queue dequeueNItems:numberOfEvents];
+    });
+    return numberOfEvents;
+}
+
+- (NSInteger)removeFirstEventsExceedingBytes:(NSInteger)maxBytes
+                                   eventType:(nonnull NSString *)eventTypeName
+                                       error:(NSError * _Nullable __autoreleasing * _Nullable)error
+{
+    __block NSInteger numberOfEvents = 0;
+    dispatch_sync(eventsStorageCacheQueue(), ^{
+        OPTLYQueue *queue = [self.eventsCache objectForKey:eventTypeName];
+        NSInteger excessBytes = -maxBytes;
+        for (NSDictionary *entity in queue.queue) {
+            excessBytes += [entity[kEntityKeySize] integerValue];
+        }
+        for (NSDictionary *entity in queue.queue) {
+            if (excessBytes <= 0) {
+                break;
+            }
+            excessBytes -= [entity[kEntityKeySize] integerValue];
+            numberOfEvents++;
+        }
+        [queue dequeueNItems:numberOfEvents];
+    });
+    return numberOfEvents;
+}
+
 @end
 #endif
@@ -0,0 +1,101 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <Foundation/Foundation.h>
+#ifdef UNIVERSAL
+    #import "OPTLYLogger.h"
+#else
+    #import <OptimizelySDKCore/OPTLYLogger.h>
+#endif
+
+/*
+ This logger keeps logging off the calling thread. Messages are written into a lock-free
+ ring buffer (many producers, one consumer) and drained in batches on a background queue
+ into a sink: stderr, a file or a user provided block.
+ When the buffer is full, messages are dropped or the caller waits, depending on the overflow
+ policy; the number of dropped messages is reported in the log.
+ Pending messages are flushed when the app enters the background or terminates.
+ */
+
+// Default number of messages the ring buffer holds
+extern NSUInteger const OPTLYLoggerAsyncDefaultCapacity;
+
+typedef NS_ENUM(NSUInteger, OPTLYLoggerAsyncOverflowPolicy) {
+    /// Messages logged while the buffer is full are dropped and counted.
+    OPTLYLoggerAsyncOverflowPolicyDrop,
+    /// The caller waits until the buffer has room. Messages logged by the sink itself are dropped.
+    OPTLYLoggerAsyncOverflowPolicyBlock,
+};
+
+/// A sink receives drained log lines in batches, on the logger's background queue.
+typedef void (^OPTLYLoggerAsyncSink)(NSArray<NSString *> * _Nonnull lines);
+
+@interface OPTLYLoggerAsync : NSObject <OPTLYLogger>
+
+/// The log level the logger is initialized with.
+@property (readonly) OptimizelyLogLevel logLevel;
+
+/// The number of messages the ring buffer holds.
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/// What happens to messages logged while the ring buffer is full.
+@property (nonatomic, assign, readonly) OPTLYLoggerAsyncOverflowPolicy overflowPolicy;
+
+/// The number of messages dropped because the ring buffer was full.
+@property (nonatomic, assign, readonly) NSUInteger droppedMessageCount;
+
+/**
+ * Initializer for an asynchronous logger writing to stderr, with the default capacity and the drop policy.
+ *
+ * @param logLevel The log level.
+ * @return An instance of the logger.
+ */
+- (nullable instancetype)initWithLogLevel:(OptimizelyLogLevel)logLevel;
+
+/**
+ * Initializer for an asynchronous logger.
+ *
+ * @param logLevel The log level.
+ * @param capacity The number of messages the ring buffer holds (rounded up to a power of 2).
+ * @param overflowPolicy What happens to messages logged while the ring buffer is full.
+ * @param sink The sink drained lines are written to, or nil for stderr.
+ * @return An instance of the logger.
+ */
+- (nullable instancetype)initWithLogLevel:(OptimizelyLogLevel)logLevel
+                                 capacity:(NSUInteger)capacity
+                           overflowPolicy:(OPTLYLoggerAsyncOverflowPolicy)overflowPolicy
+                                     sink:(nullable OPTLYLoggerAsyncSink)sink;
+
+/**
+ * Waits until all messages logged so far have been written to the sink.
+ */
+- (void)flush;
+
+/**
+ * A sink writing to stderr.
+ */
++ (nonnull OPTLYLoggerAsyncSink)standardErrorSink;
+
+/**
+ * A sink appending to a file, which is created if needed.
+ *
+ * @param path The path of the file.
+ * @return The sink, or nil if the file could not be opened.
+ */
++ (nullable OPTLYLoggerAsyncSink)fileSinkWithPath:(nonnull NSString *)path;
+
+@end
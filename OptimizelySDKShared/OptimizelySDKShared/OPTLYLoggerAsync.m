@@ -0,0 +1,283 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <UIKit/UIKit.h>
+#import <stdatomic.h>
+#import "OPTLYLoggerAsync.h"
+
+NSUInteger const OPTLYLoggerAsyncDefaultCapacity = 1024;
+
+// How long a caller sleeps between attempts while the ring buffer is full, with the block policy
+static useconds_t const kOverflowRetryInterval_us = 100;
+static void *const kDrainQueueKey = (void *)&kDrainQueueKey;
+
+// A ring buffer slot. sequence tells producers and the consumer whose turn it is (Vyukov's bounded queue).
+typedef struct {
+    atomic_size_t sequence;
+    void *message;              // retained NSString
+    OptimizelyLogLevel level;
+    CFAbsoluteTime timestamp;
+} OPTLYLoggerAsyncSlot;
+
+@interface OPTLYLoggerAsync () {
+    OPTLYLoggerAsyncSlot *_slots;
+    size_t _mask;
+    atomic_size_t _enqueuePosition;
+    size_t _dequeuePosition;        // only touched on the drain queue
+    atomic_ullong _droppedMessageCount;
+    unsigned long long _reportedDroppedMessageCount;
+}
+@property (nonatomic, strong) OPTLYLoggerAsyncSink sink;
+@property (nonatomic, strong) dispatch_queue_t drainQueue;
+@property (nonatomic, strong) dispatch_source_t drainSource;
+@property (nonatomic, strong) NSDateFormatter *dateFormatter;
+@end
+
+@implementation OPTLYLoggerAsync
+
+- (instancetype)init {
+    return [self initWithLogLevel:OptimizelyLogLevelInfo];
+}
+
+- (instancetype)initWithLogLevel:(OptimizelyLogLevel)logLevel {
+    return [self initWithLogLevel:logLevel
+                         capacity:OPTLYLoggerAsyncDefaultCapacity
+                   overflowPolicy:OPTLYLoggerAsyncOverflowPolicyDrop
+                             sink:nil];
+}
+
+- (instancetype)initWithLogLevel:(OptimizelyLogLevel)logLevel
+                        capacity:(NSUInteger)capacity
+                  overflowPolicy:(OPTLYLoggerAsyncOverflowPolicy)overflowPolicy
+                            sink:(OPTLYLoggerAsyncSink)sink {
+    self = [super init];
+    if (self != nil) {
+        _logLevel = logLevel;
+        _overflowPolicy = overflowPolicy;
+        _sink = sink ?: [OPTLYLoggerAsync standardErrorSink];
+        
+        // a power of 2 so that positions map to slots with a mask
+        _capacity = 2;
+        while (_capacity < capacity) {
+            _capacity <<= 1;
+        }
+        _mask = _capacity - 1;
+        _slots = calloc(_capacity, sizeof(OPTLYLoggerAsyncSlot));
+        for (size_t i = 0; i < _capacity; i++) {
+            atomic_init(&_slots[i].sequence, i);
+        }
+        atomic_init(&_enqueuePosition, 0);
+        atomic_init(&_droppedMessageCount, 0);
+        
+        _dateFormatter = [NSDateFormatter new];
+        _dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        _dateFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+        
+        _drainQueue = dispatch_queue_create("com.Optimizely.loggerAsync", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_drainQueue, kDrainQueueKey, kDrainQueueKey, NULL);
+        // producers only merge data into the source: wake-ups are coalesced and never allocate
+        _drainSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, _drainQueue);
+        __weak typeof(self) weakSelf = self;
+        dispatch_source_set_event_handler(_drainSource, ^{
+            [weakSelf drain];
+        });
+        dispatch_resume(_drainSource);
+        
+        NSNotificationCenter *defaultCenter = [NSNotificationCenter defaultCenter];
+        [defaultCenter addObserver:self
+                          selector:@selector(applicationWillResignOrTerminate:)
+                              name:UIApplicationDidEnterBackgroundNotification
+                            object:nil];
+        [defaultCenter addObserver:self
+                          selector:@selector(applicationWillResignOrTerminate:)
+                              name:UIApplicationWillTerminateNotification
+                            object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    dispatch_source_cancel(_drainSource);
+    // no drain can be running: the drain handler holds a strong reference while it runs
+    [self drain];
+    free(_slots);
+}
+
+- (NSUInteger)droppedMessageCount {
+    return (NSUInteger)atomic_load_explicit(&_droppedMessageCount, memory_order_relaxed);
+}
+
+- (void)logMessage:(NSString *)message withLevel:(OptimizelyLogLevel)level {
+    if (level > self.logLevel || message == nil) {
+        return;
+    }
+    CFAbsoluteTime timestamp = CFAbsoluteTimeGetCurrent();
+    while (![self enqueueMessage:message level:level timestamp:timestamp]) {
+        if (self.overflowPolicy == OPTLYLoggerAsyncOverflowPolicyDrop || dispatch_get_specific(kDrainQueueKey) != NULL) {
+            atomic_fetch_add_explicit(&_droppedMessageCount, 1, memory_order_relaxed);
+            break;
+        }
+        dispatch_source_merge_data(self.drainSource, 1);
+        usleep(kOverflowRetryInterval_us);
+    }
+    dispatch_source_merge_data(self.drainSource, 1);
+}
+
+- (void)flush {
+    if (dispatch_get_specific(kDrainQueueKey) != NULL) {
+        [self drain];
+    } else {
+        dispatch_sync(self.drainQueue, ^{
+            [self drain];
+        });
+    }
+}
+
++ (OPTLYLoggerAsyncSink)standardErrorSink {
+    return ^(NSArray<NSString *> *lines) {
+        NSData *data = [[[lines componentsJoinedByString:@"\n"] stringByAppendingString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+        fwrite(data.bytes, 1, data.length, stderr);
+        fflush(stderr);
+    };
+}
+
++ (OPTLYLoggerAsyncSink)fileSinkWithPath:(NSString *)path {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (![fileManager fileExistsAtPath:path] && ![fileManager createFileAtPath:path contents:nil attributes:nil]) {
+        return nil;
+    }
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+    if (fileHandle == nil) {
+        return nil;
+    }
+    [fileHandle seekToEndOfFile];
+    return ^(NSArray<NSString *> *lines) {
+        NSData *data = [[[lines componentsJoinedByString:@"\n"] stringByAppendingString:@"\n"] dataUsingEncoding:NSUTF8StringEncoding];
+        [fileHandle writeData:data];
+    };
+}
+
+# pragma mark - Ring Buffer
+
+- (BOOL)enqueueMessage:(NSString *)message level:(OptimizelyLogLevel)level timestamp:(CFAbsoluteTime)timestamp {
+    OPTLYLoggerAsyncSlot *slot = NULL;
+    size_t position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    for (;;) {
+        slot = &_slots[position & _mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            // the slot is free: claim the position
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // the slot still holds the message from one lap ago: the buffer is full
+            return NO;
+        } else {
+            // another producer claimed the position
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+    slot->message = (void *)CFBridgingRetain([message copy]);
+    slot->level = level;
+    slot->timestamp = timestamp;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return YES;
+}
+
+// Must be called on the drain queue
+- (BOOL)dequeueMessage:(NSString * __autoreleasing *)message level:(OptimizelyLogLevel *)level timestamp:(CFAbsoluteTime *)timestamp {
+    OPTLYLoggerAsyncSlot *slot = &_slots[_dequeuePosition & _mask];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if ((intptr_t)sequence - (intptr_t)(_dequeuePosition + 1) < 0) {
+        // empty, or the producer of this slot has not finished writing it
+        return NO;
+    }
+    *message = CFBridgingRelease(slot->message);
+    *level = slot->level;
+    *timestamp = slot->timestamp;
+    slot->message = NULL;
+    // hand the slot over to the producer one lap ahead
+    atomic_store_explicit(&slot->sequence, _dequeuePosition + _mask + 1, memory_order_release);
+    _dequeuePosition++;
+    return YES;
+}
+
+// Must be called on the drain queue
+- (void)drain {
+    NSMutableArray<NSString *> *lines = [NSMutableArray new];
+    NSString *message = nil;
+    OptimizelyLogLevel level = OptimizelyLogLevelOff;
+    CFAbsoluteTime timestamp = 0;
+    while ([self dequeueMessage:&message level:&level timestamp:&timestamp]) {
+        [lines addObject:[self lineWithMessage:message level:level timestamp:timestamp]];
+        // hand over large backlogs in batches so that blocked producers can resume
+        if (lines.count == self.capacity) {
+            self.sink(lines);
+            lines = [NSMutableArray new];
+        }
+    }
+    
+    unsigned long long droppedMessageCount = atomic_load_explicit(&_droppedMessageCount, memory_order_relaxed);
+    if (droppedMessageCount > _reportedDroppedMessageCount) {
+        NSString *message = [NSString stringWithFormat:@"%llu log messages dropped: the log buffer is full.", droppedMessageCount - _reportedDroppedMessageCount];
+        [lines addObject:[self lineWithMessage:message level:OptimizelyLogLevelWarning timestamp:CFAbsoluteTimeGetCurrent()]];
+        _reportedDroppedMessageCount = droppedMessageCount;
+    }
+    
+    if (lines.count > 0) {
+        self.sink(lines);
+    }
+}
+
+- (NSString *)lineWithMessage:(NSString *)message level:(OptimizelyLogLevel)level timestamp:(CFAbsoluteTime)timestamp {
+    NSString *levelTag = @"";
+    switch (level) {
+        case OptimizelyLogLevelCritical:
+            levelTag = OPTLYLogLevelCriticalTag;
+            break;
+        case OptimizelyLogLevelError:
+            levelTag = OPTLYLogLevelErrorTag;
+            break;
+        case OptimizelyLogLevelWarning:
+            levelTag = OPTLYLogLevelWarningTag;
+            break;
+        case OptimizelyLogLevelInfo:
+            levelTag = OPTLYLogLevelInfoTag;
+            break;
+        case OptimizelyLogLevelDebug:
+            levelTag = OPTLYLogLevelDebugTag;
+            break;
+        case OptimizelyLogLevelVerbose:
+            levelTag = OPTLYLogLevelVerboseTag;
+            break;
+        default:
+            break;
+    }
+    NSString *date = [self.dateFormatter stringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:timestamp]];
+    return [NSString stringWithFormat:@"%@ [OPTIMIZELY SDK][%@]:%@", date, levelTag, message];
+}
+
+# pragma mark - Application Lifecycle
+
+- (void)applicationWillResignOrTerminate:(id)notification {
+    [self flush];
+}
+
+@end
@@ -28,6 +28,7 @@ extern NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension;
 @protocol OPTLYDatafileManager, OPTLYErrorHandler, OPTLYEventDispatcher, OPTLYLogger, OPTLYUserProfileService;
 
 typedef void (^OPTLYManagerBuilderBlock)(OPTLYManagerBuilder * _Nullable builder);
+typedef void (^OPTLYManagerReadyCallback)(NSError * _Nullable error, OPTLYClient * _Nullable client);
 
 @protocol OPTLYManager
 /**
@@ -63,6 +64,8 @@ typedef void (^OPTLYManagerBuilderBlock)(OPTLYManagerBuilder * _Nullable builder
 @property (nonatomic, readwrite, strong, nullable) id<OPTLYLogger> logger;
 /// User profile to be used by the client to store user-specific data.
 @property (nonatomic, readwrite, strong, nullable) id<OPTLYUserProfileService> userProfileService;
+/// If YES, the clients parse the experiments, audiences and events of the datafile when they are first used
+@property (nonatomic, readwrite, assign) BOOL lazyDatafileParsing;
 /// The client engine
 @property (nonatomic, readonly, strong, nonnull) NSString *clientEngine;
 /// Version number of the Optimizely iOS SDK
@@ -73,6 +76,10 @@ typedef void (^OPTLYManagerBuilderBlock)(OPTLYManagerBuilder * _Nullable builder
 @property (nonatomic, readonly, strong, nonnull) NSString *osVersion;
 /// iOS App Version
 @property (nonatomic, readonly, strong, nonnull) NSString *appVersion;
+/// YES once the client returned by initializeAsync: answers with the loaded datafile
+@property (atomic, readonly, assign, getter=isReady) BOOL ready;
+/// Time (in s) from initializeAsync: until the client was ready, or 0 if it is not ready yet
+@property (atomic, readonly, assign) NSTimeInterval initializationDuration;
 
 
 /**
@@ -108,6 +115,29 @@ typedef void (^OPTLYManagerBuilderBlock)(OPTLYManagerBuilder * _Nullable builder
 - (void)initializeWithCallback:(void(^ _Nullable)(NSError * _Nullable error,
                                       OPTLYClient * _Nullable client))callback;
 
+/**
+ * Initializes the client without blocking the calling thread.
+ *
+ * The returned client can be used right away: its method calls are NoOps
+ * until the latest cached datafile (with a fallback of the bundled datafile)
+ * has been read and parsed on a background queue. The client then switches
+ * to the parsed datafile atomically and the ready callbacks are called.
+ *
+ * @param readyCallback The block called on a background queue once the client is ready.
+ *   If neither a cached nor a bundled datafile could be loaded, the client stays a NoOp
+ *   and the error of the cached datafile load is passed.
+ * @return The client, which is also returned by getOptimizely.
+ */
+- (nonnull OPTLYClient *)initializeAsync:(nullable OPTLYManagerReadyCallback)readyCallback;
+
+/**
+ * Calls the block once the client returned by initializeAsync: is ready,
+ * or right away if no initialization is in progress.
+ *
+ * @param readyCallback The block called once the client is ready.
+ */
+- (void)notifyWhenReady:(nonnull OPTLYManagerReadyCallback)readyCallback;
+
 /**
  * Synchronously instantiates the client from the provided datafile
  * with no fallbacks. If the datafile is invalid, then a dummy client instance
@@ -19,6 +19,7 @@
 #import "OPTLYEventDispatcher.h"
 #import "OPTLYLogger.h"
 #import "OPTLYLoggerMessages.h"
+#import "OPTLYStartupReport.h"
 #else
 #import <OptimizelySDKCore/OPTLYExperiment.h>
 #import <OptimizelySDKCore/OPTLYProjectConfig.h>
@@ -26,6 +27,7 @@
 #import <OptimizelySDKCore/OPTLYEventDispatcherBasic.h>
 #import <OptimizelySDKCore/OPTLYLogger.h>
 #import <OptimizelySDKCore/OPTLYLoggerMessages.h>
+#import <OptimizelySDKCore/OPTLYStartupReport.h>
 #endif
 #import "OPTLYDatafileConfig.h"
 #import "OPTLYClient.h"
@@ -57,6 +59,8 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
 
 @interface OPTLYManagerBase()
 @property (strong, readwrite, nonatomic, nullable) OPTLYClient *optimizelyClient;
+/// content hash of the datafile optimizelyClient was built from by initializeWithCallback:, nil if unknown
+@property (atomic, strong, nullable) NSString *optimizelyClientDatafileHash;
 /// Version number of the Optimizely iOS SDK
 @property (nonatomic, readwrite, strong, nonnull) NSString *clientVersion;
 /// iOS Device Model
@@ -65,23 +69,26 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
 @property (nonatomic, readwrite, strong, nonnull) NSString *osVersion;
 /// iOS App Version
 @property (nonatomic, readwrite, strong, nonnull) NSString *appVersion;
+@property (atomic, readwrite, assign, getter=isReady) BOOL ready;
+@property (atomic, readwrite, assign) NSTimeInterval initializationDuration;
+/// callbacks waiting for initializeAsync: to finish, nil if no initialization is in progress
+/// keep this thread safe by synchronizing on self
+@property (nonatomic, strong, nullable) NSMutableArray<OPTLYManagerReadyCallback> *readyCallbacks;
+@property (nonatomic, strong, nullable) NSError *readyError;
 @end
 
 @implementation OPTLYManagerBase
 
-- (void)cleanUserProfileService:(NSArray<OPTLYExperiment *><OPTLYExperiment> *)experiments {
-    if (experiments == nil) return;
+// takes the experiment ids so that lazily parsed experiments are not all materialized
+- (void)cleanUserProfileServiceWithExperimentIds:(NSArray<NSString *> *)experimentIds {
+    if (experimentIds == nil) return;
     
     SEL selector = NSSelectorFromString(@"removeInvalidExperimentsForAllUsers:");
     
     if (_userProfileService != nil && [(NSObject *)_userProfileService respondsToSelector:selector]) {
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
             if (self.userProfileService != nil) {
-                NSMutableArray<NSString*> *ids = [[NSMutableArray alloc] initWithCapacity:experiments.count];
-                for (int i = 0; i < experiments.count; i++) {
-                    NSString *exKey = ((OPTLYExperiment *)experiments[i]).experimentId;
-                    [ids addObject:exKey];
-                }
+                NSArray<NSString*> *ids = [experimentIds copy];
 // can't suppress the warning because travis-ci keeps complaining.
 //#pragma clang diagnostic push
 //#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
@@ -151,14 +158,22 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
     OPTLYClient *client = [self initializeWithDatafile:data];
     
     if (cleanUserProfile) {
-        [self cleanUserProfileService:client.optimizely.config.experiments];
+        [self cleanUserProfileServiceWithExperimentIds:[client.optimizely.config experimentIds]];
     }
 
     return client;
 }
 
 - (OPTLYClient *)initializeWithDatafile:(NSData *)datafile {
+    return [self initializeWithDatafile:datafile contentHash:nil];
+}
+
+- (OPTLYClient *)initializeWithDatafile:(NSData *)datafile contentHash:(NSString *)contentHash {
+    self.optimizelyClientDatafileHash = nil;
     self.optimizelyClient = [self initializeClientWithManagerSettingsAndDatafile:datafile];
+    if (self.optimizelyClient.optimizely) {
+        self.optimizelyClientDatafileHash = contentHash;
+    }
     return self.optimizelyClient;
 }
 
@@ -191,10 +206,21 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
             cleanUserProfileService = YES;
         }
         
-        OPTLYClient *client = [self initializeWithDatafile:data];
+        // the datafile is not parsed again if the current client was built from the same content
+        OPTLYClient *client = nil;
+        NSString *contentHash = data ? [OPTLYDatafileManagerUtility contentHashOfDatafile:data] : nil;
+        OPTLYClient *currentClient = self.optimizelyClient;
+        if (contentHash && currentClient.optimizely && [contentHash isEqualToString:self.optimizelyClientDatafileHash]) {
+            [self.logger logMessage:OPTLYLoggerMessagesManagerInitWithCallbackDatafileUnchanged
+                          withLevel:OptimizelyLogLevelDebug];
+            client = currentClient;
+            cleanUserProfileService = NO;
+        } else {
+            client = [self initializeWithDatafile:data contentHash:contentHash];
+        }
         
         if (cleanUserProfileService) {
-            [self cleanUserProfileService:client.optimizely.config.experiments];
+            [self cleanUserProfileServiceWithExperimentIds:[client.optimizely.config experimentIds]];
         }
         
         if (callback) {
@@ -203,6 +229,96 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
     }];
 }
 
+- (OPTLYClient *)initializeAsync:(OPTLYManagerReadyCallback)readyCallback {
+    OPTLYClient *client = nil;
+    @synchronized (self) {
+        if (self.readyCallbacks) {
+            // an initialization is already in progress
+            if (readyCallback) {
+                [self.readyCallbacks addObject:readyCallback];
+            }
+            return self.optimizelyClient;
+        }
+        
+        [self.logger logMessage:[NSString stringWithFormat:OPTLYLoggerMessagesManagerInitAsync, self.projectId, self.sdkKey]
+                      withLevel:OptimizelyLogLevelInfo];
+        
+        client = [[OPTLYClient alloc] initWithLogger:self.logger];
+        client.defaultAttributes = [self newDefaultAttributes];
+        self.optimizelyClient = client;
+        self.optimizelyClientDatafileHash = nil;
+        self.ready = NO;
+        self.initializationDuration = 0;
+        self.readyError = nil;
+        self.readyCallbacks = [NSMutableArray new];
+        if (readyCallback) {
+            [self.readyCallbacks addObject:readyCallback];
+        }
+    }
+    
+    NSTimeInterval startTime = [NSProcessInfo processInfo].systemUptime;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        NSError *error = nil;
+        NSData *data = [self.datafileManager getSavedDatafile:&error];
+        BOOL cleanUserProfileService = NO;
+        // fall back to the datafile provided by the manager builder if we can't get the saved datafile
+        if (data == nil) {
+            data = self.datafile;
+            [self.logger logMessage:OPTLYLoggerMessagesManagerBundledDataLoaded withLevel:OptimizelyLogLevelInfo];
+        }
+        else {
+            // cleanup user profile service in background
+            cleanUserProfileService = YES;
+        }
+        if (data != nil) {
+            error = nil;
+        }
+        
+        // the client keeps answering with NoOps until the parsed datafile is swapped in
+        client.optimizely = [self initializeClientWithManagerSettingsAndDatafile:data].optimizely;
+        NSString *contentHash = (data && client.optimizely) ? [OPTLYDatafileManagerUtility contentHashOfDatafile:data] : nil;
+        
+        if (cleanUserProfileService) {
+            [self cleanUserProfileServiceWithExperimentIds:[client.optimizely.config experimentIds]];
+        }
+        
+        NSTimeInterval duration = [NSProcessInfo processInfo].systemUptime - startTime;
+        [self.logger logMessage:[NSString stringWithFormat:OPTLYLoggerMessagesManagerInitAsyncReady, duration]
+                      withLevel:OptimizelyLogLevelInfo];
+        
+        NSArray<OPTLYManagerReadyCallback> *readyCallbacks = nil;
+        @synchronized (self) {
+            // a later initialize call may have installed a different client in the meantime
+            if (self.optimizelyClient == client) {
+                self.optimizelyClientDatafileHash = contentHash;
+            }
+            self.initializationDuration = duration;
+            self.readyError = error;
+            self.ready = YES;
+            readyCallbacks = self.readyCallbacks;
+            self.readyCallbacks = nil;
+        }
+        for (OPTLYManagerReadyCallback callback in readyCallbacks) {
+            callback(error, client);
+        }
+    });
+    
+    return client;
+}
+
+- (void)notifyWhenReady:(OPTLYManagerReadyCallback)readyCallback {
+    if (!readyCallback) {
+        return;
+    }
+    @synchronized (self) {
+        if (self.readyCallbacks) {
+            [self.readyCallbacks addObject:readyCallback];
+            return;
+        }
+    }
+    readyCallback(self.readyError, self.optimizelyClient);
+}
+
 - (OPTLYClient *)getOptimizely {
     return self.optimizelyClient;
 }
@@ -215,6 +331,7 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
 }
 
 - (OPTLYClient *)initializeClientWithManagerSettingsAndDatafile:(NSData *)datafile {
+    uint64_t startTime = [OPTLYStartupReport startTime];
     OPTLYClient *client = [[OPTLYClient alloc] initWithBuilder:[OPTLYClientBuilder builderWithBlock:^(OPTLYClientBuilder * _Nonnull builder) {
         builder.datafile = datafile;
         builder.errorHandler = self.errorHandler;
@@ -223,8 +340,15 @@ NSString * _Nonnull const OptimizelyBundleDatafileFileTypeExtension = @"json";
         builder.userProfileService = self.userProfileService;
         builder.clientEngine = self.clientEngine;
         builder.clientVersion = self.clientVersion;
+        builder.lazyDatafileParsing = self.lazyDatafileParsing;
     }]];
     client.defaultAttributes = [self newDefaultAttributes];
+    [OPTLYStartupReport recordPhase:OPTLYStartupPhaseClientInitialization since:startTime];
+    // startup ends with the first client; only the manager that ends it logs the report
+    if ([OPTLYStartupReport seal]) {
+        [self.logger logMessage:[NSString stringWithFormat:OPTLYLoggerMessagesManagerStartupReport, [OPTLYStartupReport report]]
+                      withLevel:OptimizelyLogLevelDebug];
+    }
     return client;
 }
 
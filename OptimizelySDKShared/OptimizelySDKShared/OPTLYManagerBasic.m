@@ -88,6 +88,8 @@
         
         self.sdkKey = builder.sdkKey;
         
+        self.lazyDatafileParsing = builder.lazyDatafileParsing;
+        
         self.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:self.projectId withSDKKey:self.sdkKey];
         
         // --- datafile manager ---
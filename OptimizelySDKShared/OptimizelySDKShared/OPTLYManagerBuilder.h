@@ -41,6 +41,8 @@ typedef void (^OPTLYManagerBuilderBlock)(OPTLYManagerBuilder * _Nullable builder
 @property (nonatomic, readwrite, strong, nullable) id<OPTLYLogger> logger;
 /// User profile to be used by the client to store user-specific data.
 @property (nonatomic, readwrite, strong, nullable) id<OPTLYUserProfileService> userProfileService;
+/// Defer materializing experiments, audiences and events until they are first used. Defaults to NO.
+@property (nonatomic, readwrite, assign) BOOL lazyDatafileParsing;
 
 /// init is disabled. Please use builderWithBlock to create a Manager Builder
 - (nonnull instancetype)init NS_UNAVAILABLE;
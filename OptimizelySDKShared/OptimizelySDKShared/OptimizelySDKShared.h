@@ -24,8 +24,10 @@
     #import "OPTLYDatabaseEntity.h"
 #endif
 #import "OPTLYDataStore.h"
+#import "OPTLYDatafileFetchCoordinator.h"
 #import "OPTLYDatafileManagerBasic.h"
 #import "OPTLYFileManager.h"
+#import "OPTLYLoggerAsync.h"
 #import "OPTLYManagerBase.h"
 #import "OPTLYManagerBasic.h"
 #import "OPTLYManagerBuilder.h"
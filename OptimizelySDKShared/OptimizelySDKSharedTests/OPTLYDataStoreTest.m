@@ -438,6 +438,88 @@ static NSString * const kClientEngine = @"objective-c-sdk";
     NSInteger numberOfSavedEvents = [self.dataStore numberOfEvents:OPTLYDataStoreEventTypeConversion error:nil];
     double percentageOfEventsToRemove = OPTLYDataStorePercentageOfEventsToRemoveUponOverflow/100.0;
     XCTAssert(numberOfSavedEvents == (maxNumberEvents - maxNumberEvents*percentageOfEventsToRemove), @"Invalid number of events saved: %lu.", numberOfSavedEvents);
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeConversion reason:OPTLYDataStoreEventDropReasonOverflow], maxNumberEvents*percentageOfEventsToRemove);
  }
 
+- (void)testConversionEventsEvictImpressionEventsOverTotalBudget {
+    self.dataStore.maxNumberOfEventsToSave = 10;
+    self.dataStore.maxTotalNumberOfEventsToSave = 15;
+    self.dataStore.evictImpressionEventsFirst = YES;
+    for (NSInteger i = 0; i < 8; ++i) {
+        [self saveEventAndWait:OPTLYDataStoreEventTypeImpression];
+    }
+    for (NSInteger i = 0; i < 7; ++i) {
+        [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    }
+    // at the total budget: nothing is removed
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeImpression error:nil], 8);
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeConversion error:nil], 7);
+    
+    // every conversion over the total budget removes one impression
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeImpression error:nil], 6);
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeConversion error:nil], 9);
+    
+    // the conversions are still kept within their own max
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeImpression error:nil], 5);
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeConversion error:nil], 9);
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeImpression reason:OPTLYDataStoreEventDropReasonOverflow], 3);
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeConversion reason:OPTLYDataStoreEventDropReasonOverflow], 3);
+}
+
+- (void)testEventSaveDoesNotExceedByteBudget {
+    [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    NSInteger eventSize = [self.dataStore numberOfBytesOfEvents:OPTLYDataStoreEventTypeConversion error:nil];
+    XCTAssertGreaterThan(eventSize, 0);
+    
+    NSInteger maxBytes = 3 * eventSize + eventSize / 2;
+    [self.dataStore setMaxBytesToSave:maxBytes maxAge:0 eventType:OPTLYDataStoreEventTypeConversion];
+    for (NSInteger i = 0; i < 4; ++i) {
+        [self saveEventAndWait:OPTLYDataStoreEventTypeConversion];
+    }
+    
+    // the oldest events are dropped first
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeConversion error:nil], 3);
+    XCTAssertLessThanOrEqual([self.dataStore numberOfBytesOfEvents:OPTLYDataStoreEventTypeConversion error:nil], maxBytes);
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeConversion reason:OPTLYDataStoreEventDropReasonByteBudget], 2);
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeConversion reason:OPTLYDataStoreEventDropReasonExpired], 0);
+    // the budget of one event type does not apply to the other
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression];
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeImpression reason:OPTLYDataStoreEventDropReasonByteBudget], 0);
+}
+
+- (void)testExpiredEventsAreRemoved {
+    NSTimeInterval maxAge = 1;
+    [self.dataStore setMaxBytesToSave:0 maxAge:maxAge eventType:OPTLYDataStoreEventTypeImpression];
+    XCTAssertEqual([self.dataStore maxAgeOfEvents:OPTLYDataStoreEventTypeImpression], maxAge);
+    XCTAssertEqual([self.dataStore maxAgeOfEvents:OPTLYDataStoreEventTypeConversion], 0);
+    
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression];
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeImpression error:nil], 2);
+    
+    [NSThread sleepForTimeInterval:maxAge + 0.5];
+    [self saveEventAndWait:OPTLYDataStoreEventTypeImpression];
+    
+    XCTAssertEqual([self.dataStore numberOfEvents:OPTLYDataStoreEventTypeImpression error:nil], 1);
+    XCTAssertEqual([self.dataStore numberOfDroppedEvents:OPTLYDataStoreEventTypeImpression reason:OPTLYDataStoreEventDropReasonExpired], 2);
+}
+
+- (void)saveEventAndWait:(OPTLYDataStoreEventType)eventType {
+    dispatch_group_t dispatchSavedEventsGroup = dispatch_group_create();
+    dispatch_group_enter(dispatchSavedEventsGroup);
+    [self.dataStore saveEvent:self.testDataNSUserDefault
+                    eventType:eventType
+                        error:nil
+                   completion:^{
+                       dispatch_group_leave(dispatchSavedEventsGroup);
+                   }];
+    dispatch_group_wait(dispatchSavedEventsGroup, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(3.0 * NSEC_PER_SEC)));
+}
+
 @end
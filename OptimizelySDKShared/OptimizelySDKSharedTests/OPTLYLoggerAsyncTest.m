@@ -0,0 +1,150 @@
+/****************************************************************************
+ * Copyright 2020, Optimizely, Inc. and contributors                        *
+ *                                                                          *
+ * Licensed under the Apache License, Version 2.0 (the "License");          *
+ * you may not use this file except in compliance with the License.         *
+ * You may obtain a copy of the License at                                  *
+ *                                                                          *
+ *    http://www.apache.org/licenses/LICENSE-2.0                            *
+ *                                                                          *
+ * Unless required by applicable law or agreed to in writing, software      *
+ * distributed under the License is distributed on an "AS IS" BASIS,        *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. *
+ * See the License for the specific language governing permissions and      *
+ * limitations under the License.                                           *
+ ***************************************************************************/
+
+
+#import <UIKit/UIKit.h>
+#import <XCTest/XCTest.h>
+#import <OptimizelySDKShared/OptimizelySDKShared.h>
+
+@interface OPTLYLoggerAsyncTest : XCTestCase
+@property (nonatomic, strong) NSMutableArray<NSString *> *lines;
+@property (nonatomic, strong) OPTLYLoggerAsyncSink sink;
+@end
+
+@implementation OPTLYLoggerAsyncTest
+
+- (void)setUp {
+    [super setUp];
+    self.lines = [NSMutableArray new];
+    NSMutableArray<NSString *> *lines = self.lines;
+    self.sink = ^(NSArray<NSString *> *batch) {
+        @synchronized (lines) {
+            [lines addObjectsFromArray:batch];
+        }
+    };
+}
+
+- (void)tearDown {
+    self.lines = nil;
+    self.sink = nil;
+    [super tearDown];
+}
+
+- (void)testInitWithLogLevel {
+    OPTLYLoggerAsync *logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelDebug];
+    XCTAssertEqual(logger.logLevel, OptimizelyLogLevelDebug);
+    XCTAssertEqual(logger.capacity, OPTLYLoggerAsyncDefaultCapacity);
+    XCTAssertEqual(logger.overflowPolicy, OPTLYLoggerAsyncOverflowPolicyDrop);
+    XCTAssertTrue([OPTLYLoggerUtility conformsToOPTLYLoggerProtocol:[OPTLYLoggerAsync class]]);
+    
+    logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelDebug capacity:100 overflowPolicy:OPTLYLoggerAsyncOverflowPolicyBlock sink:self.sink];
+    XCTAssertEqual(logger.capacity, 128);
+}
+
+- (void)testMessagesAreWrittenInOrderAboveTheLogLevel {
+    OPTLYLoggerAsync *logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelInfo capacity:16 overflowPolicy:OPTLYLoggerAsyncOverflowPolicyBlock sink:self.sink];
+    for (NSUInteger i = 0; i < 100; i++) {
+        [logger logMessage:[NSString stringWithFormat:@"message %lu", (unsigned long)i] withLevel:OptimizelyLogLevelInfo];
+        [logger logMessage:@"debug" withLevel:OptimizelyLogLevelDebug];
+    }
+    [logger logMessage:@"error" withLevel:OptimizelyLogLevelError];
+    [logger flush];
+    
+    XCTAssertEqual(self.lines.count, 101);
+    for (NSUInteger i = 0; i < 100; i++) {
+        XCTAssertTrue([self.lines[i] hasSuffix:[NSString stringWithFormat:@"[OPTIMIZELY SDK][INFO]:message %lu", (unsigned long)i]], @"%@", self.lines[i]);
+    }
+    XCTAssertTrue([self.lines[100] hasSuffix:@"[OPTIMIZELY SDK][ERROR]:error"]);
+    XCTAssertEqual(logger.droppedMessageCount, 0);
+}
+
+- (void)testMessagesAreDroppedAndCountedWhenTheBufferIsFull {
+    dispatch_semaphore_t sinkStarted = dispatch_semaphore_create(0);
+    dispatch_semaphore_t sinkReleased = dispatch_semaphore_create(0);
+    __block BOOL firstBatch = YES;
+    OPTLYLoggerAsyncSink sink = self.sink;
+    OPTLYLoggerAsyncSink blockingSink = ^(NSArray<NSString *> *batch) {
+        if (firstBatch) {
+            firstBatch = NO;
+            dispatch_semaphore_signal(sinkStarted);
+            dispatch_semaphore_wait(sinkReleased, DISPATCH_TIME_FOREVER);
+        }
+        sink(batch);
+    };
+    OPTLYLoggerAsync *logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelInfo capacity:4 overflowPolicy:OPTLYLoggerAsyncOverflowPolicyDrop sink:blockingSink];
+    
+    // stall the drain, then log more than the buffer holds
+    [logger logMessage:@"first" withLevel:OptimizelyLogLevelInfo];
+    XCTAssertEqual(dispatch_semaphore_wait(sinkStarted, dispatch_time(DISPATCH_TIME_NOW, 2 * NSEC_PER_SEC)), 0);
+    for (NSUInteger i = 0; i < 14; i++) {
+        [logger logMessage:@"next" withLevel:OptimizelyLogLevelInfo];
+    }
+    XCTAssertEqual(logger.droppedMessageCount, 10);
+    
+    dispatch_semaphore_signal(sinkReleased);
+    [logger flush];
+    XCTAssertEqual(self.lines.count, 6);
+    XCTAssertTrue([self.lines.lastObject hasSuffix:@"[OPTIMIZELY SDK][WARNING]:10 log messages dropped: the log buffer is full."], @"%@", self.lines.lastObject);
+}
+
+- (void)testConcurrentProducers {
+    for (NSNumber *policy in @[@(OPTLYLoggerAsyncOverflowPolicyDrop), @(OPTLYLoggerAsyncOverflowPolicyBlock)]) {
+        [self.lines removeAllObjects];
+        OPTLYLoggerAsync *logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelInfo capacity:64 overflowPolicy:policy.unsignedIntegerValue sink:self.sink];
+        dispatch_apply(8, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t thread) {
+            for (NSUInteger i = 0; i < 1000; i++) {
+                [logger logMessage:[NSString stringWithFormat:@"%zu-%lu", thread, (unsigned long)i] withLevel:OptimizelyLogLevelInfo];
+            }
+        });
+        [logger flush];
+        
+        // every message is written once or counted as dropped
+        NSUInteger droppedMessageCount = logger.droppedMessageCount;
+        NSArray<NSString *> *messages = [self.lines filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"NOT SELF CONTAINS 'log messages dropped'"]];
+        XCTAssertEqual(messages.count, 8000 - droppedMessageCount);
+        XCTAssertEqual([NSSet setWithArray:messages].count, messages.count);
+        if (policy.unsignedIntegerValue == OPTLYLoggerAsyncOverflowPolicyBlock) {
+            XCTAssertEqual(droppedMessageCount, 0);
+        }
+    }
+}
+
+- (void)testPendingMessagesAreFlushedWhenTheAppTerminates {
+    OPTLYLoggerAsync *logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelInfo capacity:16 overflowPolicy:OPTLYLoggerAsyncOverflowPolicyDrop sink:self.sink];
+    [logger logMessage:@"message" withLevel:OptimizelyLogLevelInfo];
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationWillTerminateNotification object:nil];
+    XCTAssertEqual(self.lines.count, 1);
+}
+
+- (void)testFileSink {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"OPTLYLoggerAsyncTest.log"];
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    OPTLYLoggerAsync *logger = [[OPTLYLoggerAsync alloc] initWithLogLevel:OptimizelyLogLevelInfo capacity:16 overflowPolicy:OPTLYLoggerAsyncOverflowPolicyDrop sink:[OPTLYLoggerAsync fileSinkWithPath:path]];
+    [logger logMessage:@"one" withLevel:OptimizelyLogLevelInfo];
+    [logger logMessage:@"two" withLevel:OptimizelyLogLevelWarning];
+    [logger flush];
+    
+    NSString *contents = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+    NSArray<NSString *> *lines = [contents componentsSeparatedByString:@"\n"];
+    XCTAssertEqual(lines.count, 3);
+    XCTAssertTrue([lines[0] hasSuffix:@"[OPTIMIZELY SDK][INFO]:one"]);
+    XCTAssertTrue([lines[1] hasSuffix:@"[OPTIMIZELY SDK][WARNING]:two"]);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    
+    XCTAssertNil([OPTLYLoggerAsync fileSinkWithPath:@"/nonexistent/directory/file.log"]);
+}
+
+@end
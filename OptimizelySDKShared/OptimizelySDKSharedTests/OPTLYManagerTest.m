@@ -35,6 +35,7 @@ static NSString *const kRevision = @"58";
 static NSString *const kAlternateProjectId = @"7519590183";
 static NSString *const kAlternateDatafilename = @"optimizely_7519590183";
 static NSString * const kClientVersion = @"objective-c-sdk";
+static NSTimeInterval const kInitializeAsyncTimeout = 2;
 #if TARGET_OS_IOS
 static NSString * const kClientEngine = @"ios-sdk";
 #elif TARGET_OS_TV
@@ -42,7 +43,7 @@ static NSString * const kClientEngine = @"tvos-sdk";
 #endif
 
 @interface OPTLYManagerBase(Tests)
-- (void)cleanUserProfileService:(NSArray<OPTLYExperiment *><OPTLYExperiment> *)experiments;
+- (void)cleanUserProfileServiceWithExperimentIds:(NSArray<NSString *> *)experimentIds;
 @end
 
 @interface OPTLYManagerTest : XCTestCase
@@ -90,8 +91,8 @@ static NSString * const kClientEngine = @"tvos-sdk";
                datafile:self.alternateDatafile];
     [self checkConfigIsUsingAlternativeDatafile:client.optimizely.config];
 
-    NSArray<OPTLYExperiment *><OPTLYExperiment> *experiments = [[[manager getOptimizely] optimizely].config experiments];
-    OCMVerify([managerMock cleanUserProfileService:experiments]);
+    NSArray<NSString *> *experimentIds = [[[manager getOptimizely] optimizely].config experimentIds];
+    OCMVerify([managerMock cleanUserProfileServiceWithExperimentIds:experimentIds]);
     
 }
 
@@ -106,9 +107,7 @@ static NSString * const kClientEngine = @"tvos-sdk";
     }]];
     id partialMockManager = OCMPartialMock(manager);
     
-    NSArray<OPTLYExperiment *><OPTLYExperiment> *experiments = [[NSArray<OPTLYExperiment *><OPTLYExperiment> alloc] init];
-    
-    [[partialMockManager reject] cleanUserProfileService:experiments];
+    [[partialMockManager reject] cleanUserProfileServiceWithExperimentIds:[OCMArg any]];
     
     OPTLYClient *client = [partialMockManager initialize];
     
@@ -224,6 +223,41 @@ static NSString * const kClientEngine = @"tvos-sdk";
     }
 }
 
+- (void)testLazyDatafileParsingGetsPropogatedAndInitializeDoesNotMaterializeExperiments {
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.datafile = self.defaultDatafile;
+        builder.lazyDatafileParsing = YES;
+        builder.projectId = kProjectId;
+    }]];
+    XCTAssertTrue(manager.lazyDatafileParsing);
+    
+    OPTLYClient *client = [manager initialize];
+    OPTLYProjectConfig *config = client.optimizely.config;
+    OPTLYLazyEntityMap *lazyExperiments = [config valueForKey:@"lazyExperiments"];
+    XCTAssertNotNil(lazyExperiments);
+    XCTAssertGreaterThan([config experimentIds].count, 0);
+    // the user profile service clean up only needs the experiment ids
+    XCTAssertEqual([lazyExperiments materializedCount], 0);
+}
+
+// the startup report ends with the first client, so later clients are not counted
+- (void)testFirstClientSealsStartupReport {
+    [OPTLYStartupReport reset];
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.datafile = self.defaultDatafile;
+        builder.projectId = kProjectId;
+    }]];
+    XCTAssertNotNil([manager initializeWithDatafile:self.defaultDatafile]);
+    XCTAssertTrue([OPTLYStartupReport isSealed]);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseClientInitialization], 1);
+    int64_t numberOfParses = [OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileJSONParse];
+    
+    XCTAssertNotNil([manager initializeWithDatafile:self.alternateDatafile]);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseClientInitialization], 1);
+    XCTAssertEqual([OPTLYStartupReport countOfPhase:OPTLYStartupPhaseDatafileJSONParse], numberOfParses);
+    [OPTLYStartupReport reset];
+}
+
 - (void)testInitializeWithDatafile {
     // initialize manager
     OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
@@ -431,6 +465,169 @@ static NSString * const kClientEngine = @"tvos-sdk";
     [self waitForExpectationsWithTimeout:2 handler:nil];
 }
 
+#pragma mark - `initializeAsync` Tests
+
+// The client is returned before the datafile is loaded and answers with NoOps
+//  until it switches to the cached datafile.
+- (void)testInitializeAsyncWithCachedDatafile
+{
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.projectId = kAlternateProjectId;
+        builder.datafile = self.defaultDatafile;
+    }]];
+    
+    // hold the cached datafile load until the client has been checked
+    dispatch_semaphore_t loadSemaphore = dispatch_semaphore_create(0);
+    __unsafe_unretained NSData *cachedDatafile = self.alternateDatafile;
+    id partialDatafileManagerMock = OCMPartialMock((NSObject*)manager.datafileManager);
+    OCMStub([partialDatafileManagerMock getSavedDatafile:[OCMArg anyObjectRef]]).andDo(^(NSInvocation *invocation) {
+        dispatch_semaphore_wait(loadSemaphore, DISPATCH_TIME_FOREVER);
+        [invocation setReturnValue:&cachedDatafile];
+    });
+    
+    __weak XCTestExpectation *expectation = [self expectationWithDescription:@"testInitializeAsyncWithCachedDatafile"];
+    __block OPTLYClient *readyClient = nil;
+    OPTLYClient *client = [manager initializeAsync:^(NSError * _Nullable error, OPTLYClient * _Nullable client) {
+        XCTAssertNil(error);
+        readyClient = client;
+        [expectation fulfill];
+    }];
+    
+    XCTAssertNotNil(client);
+    XCTAssertNotNil(client.logger);
+    XCTAssertNil(client.optimizely, @"Client should be a NoOp until the datafile is loaded.");
+    XCTAssertNil([client activate:@"testExperiment" userId:@"userId"]);
+    XCTAssertFalse(manager.ready);
+    XCTAssertEqual(manager.initializationDuration, 0);
+    XCTAssertEqual([manager getOptimizely], client);
+    [self checkClientDefaultAttributes:client];
+    
+    dispatch_semaphore_signal(loadSemaphore);
+    [self waitForExpectationsWithTimeout:kInitializeAsyncTimeout handler:nil];
+    
+    XCTAssertEqual(readyClient, client, @"The returned client should be switched to the loaded datafile.");
+    XCTAssertTrue(manager.ready);
+    XCTAssertGreaterThan(manager.initializationDuration, 0);
+    [self isClientValid:client datafile:self.alternateDatafile];
+    [self checkConfigIsUsingAlternativeDatafile:client.optimizely.config];
+}
+
+// If no datafile is cached, the client should switch to the bundled datafile
+- (void)testInitializeAsyncNoCachedDatafile
+{
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.projectId = kProjectId;
+        builder.datafile = self.alternateDatafile;
+    }]];
+    
+    __weak XCTestExpectation *expectation = [self expectationWithDescription:@"testInitializeAsyncNoCachedDatafile"];
+    OPTLYClient *client = [manager initializeAsync:^(NSError * _Nullable error, OPTLYClient * _Nullable client) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:kInitializeAsyncTimeout handler:nil];
+    
+    [self isClientValid:client datafile:self.alternateDatafile];
+    [self checkConfigIsUsingAlternativeDatafile:client.optimizely.config];
+}
+
+// If no datafile is cached or bundled, the client should stay a NoOp
+- (void)testInitializeAsyncNoDatafile
+{
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.projectId = kProjectId;
+    }]];
+    
+    __weak XCTestExpectation *expectation = [self expectationWithDescription:@"testInitializeAsyncNoDatafile"];
+    OPTLYClient *client = [manager initializeAsync:^(NSError * _Nullable error, OPTLYClient * _Nullable client) {
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:kInitializeAsyncTimeout handler:nil];
+    
+    XCTAssertTrue(manager.ready);
+    XCTAssertNil(client.optimizely, @"Client config should be nil when no datafile is saved or bundled.");
+}
+
+// A later initializeWithCallback: with the same datafile keeps the client parsed by initializeAsync:
+- (void)testInitializeWithCallbackAfterInitializeAsyncReusesClient
+{
+    [self stubResponse:304 data:nil];
+    
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.projectId = kAlternateProjectId;
+    }]];
+    // save the datafile (default)
+    [manager.datafileManager saveDatafile:self.defaultDatafile];
+    
+    __weak XCTestExpectation *readyExpectation = [self expectationWithDescription:@"testInitializeWithCallbackAfterInitializeAsyncReusesClient ready"];
+    OPTLYClient *client = [manager initializeAsync:^(NSError * _Nullable error, OPTLYClient * _Nullable client) {
+        [readyExpectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:kInitializeAsyncTimeout handler:nil];
+    Optimizely *optimizely = client.optimizely;
+    XCTAssertNotNil(optimizely);
+    
+    __weak XCTestExpectation *expectation = [self expectationWithDescription:@"testInitializeWithCallbackAfterInitializeAsyncReusesClient"];
+    [manager initializeWithCallback:^(NSError * _Nullable error, OPTLYClient * _Nullable callbackClient) {
+        XCTAssertEqual(callbackClient, client, @"The client parsed by initializeAsync should be reused.");
+        XCTAssertEqual(callbackClient.optimizely, optimizely);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+}
+
+// Callbacks registered while initializing or after the client is ready are all called
+- (void)testNotifyWhenReady
+{
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.projectId = kProjectId;
+        builder.datafile = self.defaultDatafile;
+    }]];
+    
+    __weak XCTestExpectation *pendingExpectation = [self expectationWithDescription:@"testNotifyWhenReady pending"];
+    OPTLYClient *client = [manager initializeAsync:nil];
+    [manager notifyWhenReady:^(NSError * _Nullable error, OPTLYClient * _Nullable readyClient) {
+        XCTAssertEqual(readyClient, client);
+        XCTAssertNotNil(readyClient.optimizely);
+        [pendingExpectation fulfill];
+    }];
+    // a second initialization while the first is in progress returns the same client
+    XCTAssertEqual([manager initializeAsync:nil], client);
+    [self waitForExpectationsWithTimeout:kInitializeAsyncTimeout handler:nil];
+    
+    __block BOOL calledRightAway = NO;
+    [manager notifyWhenReady:^(NSError * _Nullable error, OPTLYClient * _Nullable readyClient) {
+        XCTAssertEqual(readyClient, client);
+        calledRightAway = YES;
+    }];
+    XCTAssertTrue(calledRightAway);
+    [self checkConfigIsUsingDefaultDatafile:client.optimizely.config];
+}
+
+#pragma mark - Launch Benchmarks
+
+// time the calling (launch) thread spends getting a client from a cached datafile
+
+- (void)testLaunchPerformanceSmallDatafile
+{
+    [self measureLaunchWithDatafile:self.alternateDatafile async:NO];
+}
+
+- (void)testLaunchPerformanceSmallDatafileAsync
+{
+    [self measureLaunchWithDatafile:self.alternateDatafile async:YES];
+}
+
+- (void)testLaunchPerformanceLargeDatafile
+{
+    [self measureLaunchWithDatafile:self.defaultDatafile async:NO];
+}
+
+- (void)testLaunchPerformanceLargeDatafileAsync
+{
+    [self measureLaunchWithDatafile:self.defaultDatafile async:YES];
+}
+
 #pragma mark - testCleanUserProfileService
 
 - (void)testCleanUserProfileService
@@ -442,8 +639,6 @@ static NSString * const kClientEngine = @"tvos-sdk";
     }]];
     id partialMockManager = OCMPartialMock(manager);
     
-    NSArray<OPTLYExperiment *><OPTLYExperiment> *experiments = [[NSArray<OPTLYExperiment *><OPTLYExperiment> alloc] init];
-    
     OPTLYClient *client = [partialMockManager initialize];
     
     [self isClientValid:client
@@ -451,11 +646,11 @@ static NSString * const kClientEngine = @"tvos-sdk";
     [self checkConfigIsUsingAlternativeDatafile:client.optimizely.config];
     
     // pass in nil
-    [manager cleanUserProfileService:nil];
+    [manager cleanUserProfileServiceWithExperimentIds:nil];
     // pass in empty
-    [manager cleanUserProfileService:experiments];
+    [manager cleanUserProfileServiceWithExperimentIds:@[]];
     // pass in experiements
-    [manager cleanUserProfileService:client.optimizely.config.experiments];
+    [manager cleanUserProfileServiceWithExperimentIds:[client.optimizely.config experimentIds]];
 }
 
 #pragma mark - isValidKeyString
@@ -487,6 +682,32 @@ static NSString * const kClientEngine = @"tvos-sdk";
     XCTAssertNotNil(client.logger, @"Logger should not be nil.");
 }
 
+- (void)measureLaunchWithDatafile:(NSData *)datafile async:(BOOL)async
+{
+    OPTLYManagerBasic *manager = [[OPTLYManagerBasic alloc] initWithBuilder:[OPTLYManagerBuilder builderWithBlock:^(OPTLYManagerBuilder * _Nullable builder) {
+        builder.projectId = kProjectId;
+        builder.logger = [[OPTLYLoggerDefault alloc] initWithLogLevel:OptimizelyLogLevelOff];
+    }]];
+    [manager.datafileManager saveDatafile:datafile];
+    
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        dispatch_semaphore_t readySemaphore = dispatch_semaphore_create(0);
+        [self startMeasuring];
+        if (async) {
+            [manager initializeAsync:^(NSError * _Nullable error, OPTLYClient * _Nullable client) {
+                dispatch_semaphore_signal(readySemaphore);
+            }];
+        } else {
+            [manager initialize];
+            dispatch_semaphore_signal(readySemaphore);
+        }
+        [self stopMeasuring];
+        // let the background work finish before the next iteration
+        dispatch_semaphore_wait(readySemaphore, DISPATCH_TIME_FOREVER);
+        XCTAssertNotNil([manager getOptimizely].optimizely);
+    }];
+}
+
 - (void)checkConfigIsUsingDefaultDatafile:(OPTLYProjectConfig *)config {
     XCTAssertEqualObjects(config.revision, @"58");
     XCTAssertEqualObjects(config.projectId, @"6372300739");
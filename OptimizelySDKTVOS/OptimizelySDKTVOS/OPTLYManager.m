@@ -19,10 +19,12 @@
     #import "OPTLYEventDispatcher.h"
     #import "OPTLYLogger.h"
     #import "OPTLYManagerBuilder.h"
+    #import "OPTLYStartupReport.h"
     #import "OPTLYUserProfileService.h"
 #else
     #import <OptimizelySDKCore/OPTLYErrorHandler.h>
     #import <OptimizelySDKCore/OPTLYLogger.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
     #import <OptimizelySDKDatafileManager/OPTLYDatafileManager.h>
     #import <OptimizelySDKEventDispatcher/OPTLYEventDispatcher.h>
     #import <OptimizelySDKShared/OPTLYManagerBuilder.h>
@@ -48,6 +50,7 @@ static NSString * const kClientEngine = @"tvos-sdk";
 }
 
 - (instancetype)initWithBuilder:(OPTLYManagerBuilder *)builder {
+    uint64_t startTime = [OPTLYStartupReport startTime];
     self = [super init];
     if (self != nil) {
         
@@ -87,6 +90,8 @@ static NSString * const kClientEngine = @"tvos-sdk";
         
         self.sdkKey = builder.sdkKey;
         
+        self.lazyDatafileParsing = builder.lazyDatafileParsing;
+        
         self.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:self.projectId withSDKKey:self.sdkKey];
         
         // --- datafile manager ---
@@ -130,6 +135,7 @@ static NSString * const kClientEngine = @"tvos-sdk";
 #else
         _clientVersion = OPTIMIZELY_SDK_VERSION;
 #endif
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseManagerInitialization since:startTime];
     }
     return self;
 }
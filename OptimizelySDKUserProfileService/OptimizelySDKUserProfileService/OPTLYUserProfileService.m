@@ -19,11 +19,13 @@
     #import "OPTLYLogger.h"
     #import "OPTLYDataStore.h"
     #import "OPTLYExperimentBucketMapEntity.h"
+    #import "OPTLYStartupReport.h"
     #import "OPTLYUserProfile.h"
 #else
     #import <OptimizelySDKCore/OPTLYExperimentBucketMapEntity.h>
     #import <OptimizelySDKCore/OPTLYUserProfileServiceBasic.h>
     #import <OptimizelySDKCore/OPTLYLogger.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
     #import <OptimizelySDKCore/OPTLYUserProfile.h>
     #import <OptimizelySDKShared/OPTLYDataStore.h>
 #endif
@@ -49,7 +51,9 @@
         _logger = builder.logger;
         _dataStore = [OPTLYDataStore dataStore];
         _dataStore.logger = builder.logger;
+        uint64_t startTime = [OPTLYStartupReport startTime];
         [self migrateLegacyUserProfileIfNeeded];
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseUserProfileMigration since:startTime];
     }
     return self;
 }
@@ -20,10 +20,12 @@
     #import "OPTLYEventDispatcher.h"
     #import "OPTLYLogger.h"
     #import "OPTLYManagerBuilder.h"
+    #import "OPTLYStartupReport.h"
     #import "OPTLYUserProfileService.h"
 #else
     #import <OptimizelySDKCore/OPTLYErrorHandler.h>
     #import <OptimizelySDKCore/OPTLYLogger.h>
+    #import <OptimizelySDKCore/OPTLYStartupReport.h>
     #import <OptimizelySDKDatafileManager/OPTLYDatafileManager.h>
     #import <OptimizelySDKEventDispatcher/OPTLYEventDispatcher.h>
     #import <OptimizelySDKShared/OPTLYManagerBuilder.h>
@@ -51,6 +53,7 @@ static NSString * const kClientEngine = @"ios-sdk";
 }
 
 - (instancetype)initWithBuilder:(OPTLYManagerBuilder *)builder {
+    uint64_t startTime = [OPTLYStartupReport startTime];
     self = [super init];
     if (self != nil) {
 
@@ -90,6 +93,8 @@ static NSString * const kClientEngine = @"ios-sdk";
         
         self.sdkKey = builder.sdkKey;
         
+        self.lazyDatafileParsing = builder.lazyDatafileParsing;
+        
         self.datafileConfig = [[OPTLYDatafileConfig alloc] initWithProjectId:self.projectId withSDKKey:self.sdkKey];
         
         // --- datafile manager ---
@@ -133,6 +138,7 @@ static NSString * const kClientEngine = @"ios-sdk";
 #else
         _clientVersion = OPTIMIZELY_SDK_VERSION;
 #endif
+        [OPTLYStartupReport recordPhase:OPTLYStartupPhaseManagerInitialization since:startTime];
     }
     return self;
 }